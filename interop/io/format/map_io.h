@@ -17,6 +17,7 @@
 
 #include "interop/io/format/stream_util.h"
 #include "interop/util/length_of.h"
+#include "interop/util/fixed_vector.h"
 
 namespace illumina { namespace interop { namespace io
 {
@@ -295,6 +296,70 @@ namespace illumina { namespace interop { namespace io
         return read_array_helper<ReadType,ValueType>::read_array_from_stream(in, &vals.front(), n, offset);
     }
 
+    /** Read an array of values of type ReadType from the given input stream into inline storage
+     *
+     * @param in input stream
+     * @param vals destination array of values
+     * @param n number of values to read
+     * @return number of bytes read from the stream
+     */
+    template<typename ReadType, typename ValueType, size_t N>
+    std::streamsize stream_map(std::istream &in, util::fixed_vector<ValueType, N>&vals, const size_t n)
+    {
+        INTEROP_RANGE_CHECK_GT(n, N, bad_format_exception, "Number of values exceeds inline storage");
+        vals.resize(n);
+        INTEROP_ASSERTMSG(!vals.empty(), "n="<<n);
+        return read_array_helper<ReadType,ValueType>::read_array_from_stream(in, vals.data(), n);
+    }
+
+    /** Read an array of values of type ReadType from the given input stream into inline storage
+     *
+     * @param in input stream
+     * @param vals destination array of values
+     * @param n number of values to read
+     * @return number of bytes read from the stream
+     */
+    template<typename ReadType, typename ValueType, size_t N>
+    std::streamsize stream_map(char*& in, util::fixed_vector<ValueType, N>&vals, const size_t n)
+    {
+        INTEROP_RANGE_CHECK_GT(n, N, bad_format_exception, "Number of values exceeds inline storage");
+        vals.resize(n);
+        INTEROP_ASSERT(!vals.empty());
+        return read_array_helper<ReadType,ValueType>::read_array_from_stream(in, vals.data(), n);
+    }
+
+    /** Read an array of values of type ReadType from the given input stream into inline storage
+     *
+     * @param in input stream
+     * @param vals destination array of values
+     * @param n number of values to read
+     * @return number of bytes read from the stream
+     */
+    template<typename ReadType, typename ValueType, size_t N>
+    std::streamsize padded_stream_map(std::istream &in, util::fixed_vector<ValueType, N>&vals, const size_t n, const ReadType)
+    {
+        INTEROP_RANGE_CHECK_GT(n, N, bad_format_exception, "Number of values exceeds inline storage");
+        vals.resize(n);
+        INTEROP_ASSERTMSG(!vals.empty(), "n="<<n);
+        return read_array_helper<ReadType,ValueType>::read_array_from_stream(in, vals.data(), n);
+    }
+
+    /** Read an array of values of type ReadType from the given input stream into inline storage
+     *
+     * @param in input stream
+     * @param vals destination array of values
+     * @param n number of values to read
+     * @return number of bytes read from the stream
+     */
+    template<typename ReadType, typename ValueType, size_t N>
+    std::streamsize padded_stream_map(char*& in, util::fixed_vector<ValueType, N>&vals, const size_t n, const ReadType)
+    {
+        INTEROP_RANGE_CHECK_GT(n, N, bad_format_exception, "Number of values exceeds inline storage");
+        vals.resize(n);
+        INTEROP_ASSERT(!vals.empty());
+        return read_array_helper<ReadType,ValueType>::read_array_from_stream(in, vals.data(), n);
+    }
+
     /** Read an array of values of type ReadType from the given input stream
      *
      * TODO: create more efficient buffered version
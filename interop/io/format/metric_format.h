@@ -95,10 +95,17 @@ namespace illumina { namespace interop { namespace io
             const std::streamsize record_size = read_header_impl(in, metric_set);
             offset_map_t& metric_offset_map = metric_set.offset_map();
             metric_t metric(metric_set);
+            size_t skipped_count = 0;
             if(file_size > 0 && !Layout::MULTI_RECORD)
             {
-                const size_t record_count = static_cast<size_t>((file_size-header_size(metric_set))/record_size);
-                metric_set.resize(metric_set.size()+record_count);
+                // Only reserve space for every record when none can be skipped. The file size may be an estimate, e.g.
+                // from a gzip trailer, so records are only added as they are read.
+                const size_t header_byte_count = header_size(metric_set);
+                if(!metric_set.read_filter().is_active() && file_size > header_byte_count)
+                {
+                    const size_t record_count = static_cast<size_t>((file_size-header_byte_count)/record_size);
+                    metric_set.reserve(metric_set.size()+record_count);
+                }
                 std::vector<char> buffer(static_cast<size_t>(record_size));
                 INTEROP_ASSERT(!buffer.empty());
                 while (in)
@@ -108,8 +115,8 @@ namespace illumina { namespace interop { namespace io
                     const std::streamsize count = in.gcount();
                     try
                     {
-                        if (!test_stream(in, metric_offset_map, count, record_size)) break;
-                        read_record(in_ptr, metric_set, metric_offset_map, metric, record_size);
+                        if (!test_stream(in, metric_offset_map.size()+skipped_count, count, record_size)) break;
+                        read_record(in_ptr, metric_set, metric_offset_map, metric, record_size, skipped_count);
                     }
                     catch(const incomplete_file_exception& ex)
                     {
@@ -122,7 +129,7 @@ namespace illumina { namespace interop { namespace io
             {
                 while (in)
                 {
-                    read_record(in, metric_set, metric_offset_map, metric, record_size);
+                    read_record(in, metric_set, metric_offset_map, metric, record_size, skipped_count);
                 }
             }
             metric_set.trim(metric_offset_map.size());
@@ -240,13 +247,13 @@ namespace illumina { namespace interop { namespace io
 
     private:
         static bool test_stream(std::istream& in,
-                         const offset_map_t& metric_offset_map,
+                         const size_t record_count,
                          const std::streamsize count,
                          const std::streamsize record_size)
         {
             if (in.fail())
             {
-                if (count == 0 && !metric_offset_map.empty()) return false;
+                if (count == 0 && record_count > 0) return false;
                 INTEROP_THROW(incomplete_file_exception, "Insufficient data read from the file, got: " << count
                                                          << " != expected: " << record_size << " for "
                                                          << Metric::prefix() <<  " "  << Metric::suffix()  <<  " v"
@@ -254,31 +261,66 @@ namespace illumina { namespace interop { namespace io
             }
             return true;
         }
-        static bool test_stream(const char*, const offset_map_t&, const std::streamsize, const std::streamsize)
+        static bool test_stream(const char*, const size_t, const std::streamsize, const std::streamsize)
         {return true;}
         template<typename InputStream>
+        static std::streamsize skip_record(InputStream& in,
+                                           metric_t& metric,
+                                           metric_set_t& metric_set,
+                                           const std::streamsize,
+                                           is_multi_record_t)
+        {
+            return Layout::map_stream(in, metric, metric_set, true);
+        }
+        static std::streamsize skip_record(std::istream& in,
+                                           metric_t&,
+                                           metric_set_t&,
+                                           const std::streamsize byte_count,
+                                           is_single_record_t)
+        {
+            in.ignore(byte_count);
+            return in.gcount();
+        }
+        static std::streamsize skip_record(char*& in,
+                                           metric_t&,
+                                           metric_set_t&,
+                                           const std::streamsize byte_count,
+                                           is_single_record_t)
+        {
+            in += byte_count;
+            return byte_count;
+        }
+        template<typename InputStream>
         static void read_record(InputStream& in,
                                 model::metric_base::metric_set<Metric>& metric_set,
                                 offset_map_t& metric_offset_map,
                                 metric_t& metric,
-                                const std::streamsize record_size)
+                                const std::streamsize record_size,
+                                size_t& skipped_count)
         {
             metric_id_t id;
             const std::streamsize read_byte_count = read_binary_with_count (in, id);
-            if(!test_stream(in, metric_offset_map, read_byte_count, record_size)) return;
+            if(!test_stream(in, metric_offset_map.size()+skipped_count, read_byte_count, record_size)) return;
             std::streamsize count=read_byte_count;
             if (Layout::is_valid(id))
                 // TODO: Refactor tile metrics to move record type into layout id, then we can remove skip_metric,
                 // simplifiy all this logic
             {
                 metric.set_base(id);// TODO replace with static call
-                if (metric_offset_map.find(metric.id()) == metric_offset_map.end())
+                if (!metric_set.read_filter()(metric))
+                {
+                    // Skip the record without storing it, only records that vary in size are decoded
+                    count += skip_record(in, metric, metric_set, record_size-read_byte_count,
+                                         int_constant_type<Layout::MULTI_RECORD>::null());
+                    ++skipped_count;
+                }
+                else if (metric_offset_map.find(metric.id()) == metric_offset_map.end())
                 {
                     const size_t offset = metric_offset_map.size();
                     if(offset>= metric_set.size()) metric_set.resize(offset+1);
                     metric_set[offset].set_base(id);
                     count += Layout::map_stream(in, metric_set[offset], metric_set, true);
-                    if(!test_stream(in, metric_offset_map, count, record_size)) return;
+                    if(!test_stream(in, metric_offset_map.size()+skipped_count, count, record_size)) return;
                     if(Layout::skip_metric(metric_set[offset]))//Avoid adding control lanes in tile metrics
                     {
                         metric_set.resize(offset);
@@ -297,7 +339,7 @@ namespace illumina { namespace interop { namespace io
                 count += Layout::map_stream(in, metric, metric_set, true);
                 //TODO: replace with skip function, simplify code, required for index metrics
             }
-            if(!test_stream(in, metric_offset_map, count, record_size)) return;
+            if(!test_stream(in, metric_offset_map.size()+skipped_count, count, record_size)) return;
             if (count != record_size)
             {
                 INTEROP_THROW(bad_format_exception, "Record does not match expected size! for "
@@ -0,0 +1,131 @@
+/** Double buffered stream that reads the next block of a file while the current block is decoded
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+
+#pragma once
+
+#include <istream>
+#include <cstddef>
+#include <vector>
+#include "interop/util/exception.h"
+#include "interop/util/thread_pool.h"
+#include "interop/io/stream_exceptions.h"
+#include "interop/model/metric_base/metric_exceptions.h"
+
+namespace illumina { namespace interop { namespace io
+{
+    namespace detail
+    {
+        /** Stream buffer that fills a back buffer from the source stream while the front buffer is consumed
+         *
+         * The back buffer is filled by a task on the shared thread pool. When the pool is not concurrent, e.g. for
+         * C++98, the back buffer is filled when the front buffer is exhausted.
+         *
+         * Only the current position can be queried, e.g. tellg, other seeks fail.
+         */
+        class double_buffer : public std::streambuf
+        {
+        public:
+            enum
+            {
+                /** Default number of bytes in each buffer */
+                DefaultBufferSize = 4 << 20
+            };
+
+        public:
+            /** Constructor
+             *
+             * @param source source stream
+             * @param buffer_size number of bytes in each buffer
+             */
+            double_buffer(std::istream& source, const size_t buffer_size=DefaultBufferSize);
+            /** Destructor waits for any pending read of the source stream */
+            ~double_buffer();
+
+        protected:
+            /** Swap in the next buffer when the current buffer is exhausted
+             *
+             * @return next character or eof
+             */
+            int_type underflow();
+            /** Get the current position of the stream
+             *
+             * @param off offset, must be 0
+             * @param dir seek direction, must be current
+             * @param which open mode, must include input
+             * @return current position or -1 if the seek is not supported
+             */
+            pos_type seekoff(off_type off,
+                             std::ios_base::seekdir dir,
+                             std::ios_base::openmode which = std::ios_base::in | std::ios_base::out);
+
+        private:
+            void start_fill();
+            void fill();
+            void wait();
+
+        private:
+            double_buffer(const double_buffer&);
+            double_buffer& operator=(const double_buffer&);
+
+        private:
+            /** Fill the back buffer on the thread pool */
+            class fill_task : public util::abstract_task
+            {
+            public:
+                fill_task(double_buffer& buffer) : m_buffer(buffer){}
+                void operator()()
+                {
+                    m_buffer.fill();
+                }
+
+            private:
+                double_buffer& m_buffer;
+            };
+
+        private:
+            std::istream& m_source;
+            std::vector<char> m_front;
+            std::vector<char> m_back;
+            std::streamsize m_back_count;
+            std::streamoff m_position;
+            bool m_pending;
+            fill_task m_fill_task;
+            util::task_group m_fill_group;
+        };
+
+        /** Interface for decoding from a stream with read_double_buffered
+         */
+        class abstract_stream_reader
+        {
+        public:
+            /** Destructor */
+            virtual ~abstract_stream_reader(){}
+            /** Decode data from the input stream
+             *
+             * @param in input stream
+             */
+            virtual void operator()(std::istream& in)=0;
+        };
+
+        /** Decode the source stream, reading the next block of the source while the current block is decoded
+         *
+         * The io::file_not_found_exception, io::bad_format_exception, io::incomplete_file_exception and
+         * model::index_out_of_bounds_exception exceptions thrown by the reader are rethrown with the same type,
+         * any other exception is rethrown as io::bad_format_exception.
+         *
+         * @param source source stream
+         * @param buffer_size number of bytes in each buffer
+         * @param reader decodes the buffered stream
+         */
+        void read_double_buffered(std::istream& source, const size_t buffer_size, abstract_stream_reader& reader)
+        INTEROP_THROW_SPEC((io::file_not_found_exception,
+        io::bad_format_exception,
+        io::incomplete_file_exception,
+        model::index_out_of_bounds_exception));
+    }
+}}}
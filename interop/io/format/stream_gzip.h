@@ -0,0 +1,98 @@
+/** Stream buffer that decompresses a gzip compressed file
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+#include "interop/util/cstdint.h"
+
+/** Opaque zlib file handle */
+struct gzFile_s;
+
+namespace illumina { namespace interop { namespace io
+{
+    namespace detail
+    {
+        /** Stream buffer that decompresses a gzip compressed file one block at a time
+         *
+         * Only the current position in the decompressed stream can be queried, e.g. tellg, other seeks fail.
+         *
+         * @note If the library was built without zlib, no file can be opened
+         */
+        class gzip_buffer : public std::streambuf
+        {
+        public:
+            enum
+            {
+                /** Default number of decompressed bytes in the buffer */
+                DefaultBufferSize = 1 << 20
+            };
+
+        public:
+            /** Constructor
+             *
+             * @param file_name path to the gzip compressed file
+             * @param buffer_size number of decompressed bytes in the buffer
+             */
+            gzip_buffer(const std::string& file_name, const size_t buffer_size=DefaultBufferSize);
+            /** Destructor closes the file */
+            ~gzip_buffer();
+
+        public:
+            /** Test if the file was opened
+             *
+             * @return true if the file was opened
+             */
+            bool is_open()const;
+
+        protected:
+            /** Decompress the next block of the file when the buffer is exhausted
+             *
+             * @return next character or eof
+             */
+            int_type underflow();
+            /** Get the current position of the decompressed stream
+             *
+             * @param off offset, must be 0
+             * @param dir seek direction, must be current
+             * @param which open mode, must include input
+             * @return current position or -1 if the seek is not supported
+             */
+            pos_type seekoff(off_type off,
+                             std::ios_base::seekdir dir,
+                             std::ios_base::openmode which = std::ios_base::in | std::ios_base::out);
+
+        private:
+            gzip_buffer(const gzip_buffer&);
+            gzip_buffer& operator=(const gzip_buffer&);
+
+        private:
+            gzFile_s* m_file;
+            std::vector<char> m_buffer;
+            std::streamoff m_position;
+        };
+
+        /** Estimate the size of the decompressed file
+         *
+         * This reads the size stored in the gzip trailer, which is only a hint: it holds the size modulo 2^32
+         * of the last member of the file. A size that deflate cannot reach from the compressed size is rejected. The
+         * hint may still be wrong, so it is only used to reserve memory.
+         *
+         * @param file_name path to the gzip compressed file
+         * @return size of the decompressed file or 0 if unknown
+         */
+        size_t gzip_uncompressed_size_hint(const std::string& file_name);
+    }
+    /** Test if the library can read gzip compressed InterOp files
+     *
+     * @return true if the library was built with zlib
+     */
+    bool is_gzip_supported();
+}}}
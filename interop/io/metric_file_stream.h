@@ -11,11 +11,46 @@
 #include "interop/util/exception.h"
 #include "interop/util/filesystem.h"
 #include "interop/io/format/stream_membuf.h"
+#include "interop/io/format/stream_double_buffer.h"
+#include "interop/io/format/stream_gzip.h"
 #include "interop/io/metric_stream.h"
 #include "interop/model/metric_base/metric_exceptions.h"
 
 namespace illumina { namespace interop { namespace io
 {
+    namespace detail
+    {
+        /** Read a metric set from the stream given to read_double_buffered
+         */
+        template<class MetricSet>
+        class read_metrics_func : public abstract_stream_reader
+        {
+        public:
+            /** Constructor
+             *
+             * @param metrics destination metric set
+             * @param file_size number of bytes in the file
+             * @param rebuild whether to rebuild the id map
+             */
+            read_metrics_func(MetricSet& metrics, const size_t file_size, const bool rebuild) :
+                    m_metrics(metrics), m_file_size(file_size), m_rebuild(rebuild)
+            {
+            }
+            /** Read a metric set from the input stream
+             *
+             * @param in input stream
+             */
+            void operator()(std::istream& in)
+            {
+                read_metrics(in, m_metrics, m_file_size, m_rebuild);
+            }
+
+        private:
+            MetricSet& m_metrics;
+            size_t m_file_size;
+            bool m_rebuild;
+        };
+    }
 
     /** @defgroup file_io Reading/Writing Binary InterOp files
      *
@@ -91,6 +126,64 @@ namespace illumina { namespace interop { namespace io
         std::istringstream in(buffer);
         read_metrics(in, metrics, buffer.length(), rebuild);
     }
+    /** Read the binary InterOp file into the given metric set, reading the next block of the stream while the
+     * current block is decoded
+     *
+     * @param in input stream
+     * @param metrics metric set
+     * @param file_size number of bytes in the file
+     * @param buffer_size number of bytes in each buffer
+     * @param rebuild whether to rebuild the id map
+     * @throw file_not_found_exception
+     * @throw bad_format_exception
+     * @throw incomplete_file_exception
+     * @throw model::index_out_of_bounds_exception
+     */
+    template<class MetricSet>
+    void read_metrics_double_buffered(std::istream& in,
+                                      MetricSet& metrics,
+                                      const size_t file_size,
+                                      const size_t buffer_size=detail::double_buffer::DefaultBufferSize,
+                                      const bool rebuild=true)
+    INTEROP_THROW_SPEC((io::file_not_found_exception,
+    io::bad_format_exception,
+    io::incomplete_file_exception,
+    model::index_out_of_bounds_exception))
+    {
+        detail::read_metrics_func<MetricSet> reader(metrics, file_size, rebuild);
+        detail::read_double_buffered(in, buffer_size, reader);
+    }
+    /** Read a gzip compressed binary InterOp file into the given metric set
+     *
+     * Decompression runs in the buffer fill of read_metrics_double_buffered, so it overlaps with decoding. The size
+     * in the gzip trailer only reserves memory, records are added as they are decompressed.
+     *
+     * @param file_name path to the uncompressed InterOp file, the `.gz` extension is appended
+     * @param metrics metric set
+     * @param rebuild whether to rebuild the id map
+     * @return true if the compressed file was found
+     * @throw bad_format_exception
+     * @throw incomplete_file_exception
+     * @throw model::index_out_of_bounds_exception
+     */
+    template<class MetricSet>
+    bool read_interop_gzip(const std::string& file_name, MetricSet& metrics, const bool rebuild=true)
+    INTEROP_THROW_SPEC((io::file_not_found_exception,
+    io::bad_format_exception,
+    io::incomplete_file_exception,
+    model::index_out_of_bounds_exception))
+    {
+        const std::string gzip_file_name = file_name + ".gz";
+        detail::gzip_buffer gzip_buffer(gzip_file_name);
+        if(!gzip_buffer.is_open()) return false;
+        std::istream in(&gzip_buffer);
+        read_metrics_double_buffered(in,
+                                     metrics,
+                                     detail::gzip_uncompressed_size_hint(gzip_file_name),
+                                     detail::gzip_buffer::DefaultBufferSize,
+                                     rebuild);
+        return true;
+    }
     /** Write the binary InterOp file into the given string using the given metric set
      *
      * @param buffer string holding a byte buffer
@@ -153,6 +246,7 @@ namespace illumina { namespace interop { namespace io
      *
      * @note The 'Out' suffix (parameter: use_out) is appended when we read the file. We excluded the Out in certain
      * conditions when writing the file.
+     * @note If neither uncompressed file exists, a gzip compressed sibling with the `.gz` extension is read
      *
      * @param run_directory file path to the run directory
      * @param metrics metric set
@@ -185,8 +279,18 @@ namespace illumina { namespace interop { namespace io
             file_name = interop_filename<MetricSet>(run_directory, !use_out);
             fin.open(file_name.c_str(), std::ios::binary);
         }
-        if(!fin.good()) INTEROP_THROW(file_not_found_exception, "File not found: " << file_name);
-        read_metrics(fin, metrics, static_cast<size_t>(file_size(file_name)));
+        if(!fin.good())
+        {
+            if(read_interop_gzip(interop_filename<MetricSet>(run_directory, use_out), metrics)) return;
+            if(read_interop_gzip(file_name, metrics)) return;
+            INTEROP_THROW(file_not_found_exception, "File not found: " << file_name);
+        }
+        const size_t size_in_bytes = static_cast<size_t>(file_size(file_name));
+        // Overlap reading from disk with decoding only when the file spans several buffers
+        if(size_in_bytes > 2*static_cast<size_t>(detail::double_buffer::DefaultBufferSize))
+            read_metrics_double_buffered(fin, metrics, size_in_bytes);
+        else
+            read_metrics(fin, metrics, size_in_bytes);
     }
     /** Write the metric set to a binary InterOp file
      *
@@ -296,6 +400,8 @@ namespace illumina { namespace interop { namespace io
      *
      * @note The 'Out' suffix (parameter: use_out) is appended when we read the file. We excluded the Out in certain
      * conditions when writing the file.
+     * @note If the uncompressed file of a cycle does not exist, a gzip compressed sibling with the `.gz` extension
+     * is read
      *
      * @param run_directory file path to the run directory
      * @param metrics metric set
@@ -320,7 +426,18 @@ namespace illumina { namespace interop { namespace io
         {
             const std::string file_name = interop_filename<MetricSet>(run_directory, cycle, use_out);
             const int64_t file_size_in_bytes = file_size(file_name);
-            if(file_size_in_bytes < 0) continue;
+            if(file_size_in_bytes < 0)
+            {
+                try
+                {
+                    read_interop_gzip(file_name, metrics, false);
+                }
+                catch(const incomplete_file_exception& ex)
+                {
+                    incomplete_file_message = ex.what();
+                }
+                continue;
+            }
             std::ifstream fin(file_name.c_str(), std::ios::binary);
             if(fin.good())
             {
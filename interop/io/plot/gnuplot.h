@@ -13,6 +13,7 @@
 #include "interop/model/plot/candle_stick_point.h"
 #include "interop/model/plot/plot_data.h"
 #include "interop/io/table/csv_format.h"
+#include "interop/util/number_format.h"
 
 namespace illumina { namespace interop { namespace io { namespace plot
 {
@@ -113,14 +114,18 @@ namespace illumina { namespace interop { namespace io { namespace plot
             out << "set palette defined (0 \"white\", 0.333 \"green\", 0.667 \"yellow\", 1 \"red\")\n";
             out << "set datafile separator \",\"\n";
             out << "plot \"-\" matrix with image" << "\n";
+            util::number_formatter formatter(out);
             for (size_t y = 0; y < data.column_count(); ++y)
             {
-                out << data(0, y);
+                formatter.clear();
+                formatter.append(data(0, y));
                 for (size_t x = 1; x < data.row_count(); ++x)
                 {
-                    out << "," << table::handle_nan(data(x, y));
+                    formatter.append(',');
+                    formatter.append(table::handle_nan(data(x, y)));
                 }
-                out << "\n";
+                formatter.append('\n');
+                formatter.write(out);
             }
         }
 
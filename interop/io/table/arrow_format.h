@@ -0,0 +1,65 @@
+/** Write tables in the Apache Arrow IPC format
+ *
+ * The Arrow IPC format holds each column in a contiguous, aligned buffer, so analytics tools (e.g. Pandas, Polars
+ * and DuckDB) can load or memory map the output without parsing text. This writer has no dependencies, it encodes
+ * the flatbuffer metadata directly.
+ *
+ * Each sub column of the imaging table becomes its own column, e.g. P90_A. Id columns, e.g. lane and tile, are
+ * dictionary encoded with 32-bit indices into an ordered dictionary of unsigned integers. Missing values (NaN) are
+ * written as nulls.
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include "interop/util/exception.h"
+#include "interop/io/stream_exceptions.h"
+
+namespace illumina { namespace interop { namespace model { namespace table
+{
+    class imaging_table;
+}}}}
+
+namespace illumina { namespace interop { namespace io { namespace table
+{
+    /** Arrow IPC layouts */
+    enum arrow_layout
+    {
+        /** Random access file format, e.g. .arrow or .feather, which can be memory mapped */
+        ArrowFile,
+        /** Streaming format, e.g. .arrows, which can be written to a pipe */
+        ArrowStream
+    };
+    /** Default number of rows in each record batch */
+    static const size_t DefaultArrowBatchSize = 65536;
+
+    /** Write the imaging table in the Apache Arrow IPC format
+     *
+     * @param out binary output stream
+     * @param table imaging table
+     * @param layout file or stream layout
+     * @param rows_per_batch maximum number of rows in each record batch
+     */
+    void write_arrow(std::ostream& out,
+                     const model::table::imaging_table& table,
+                     const arrow_layout layout=ArrowFile,
+                     const size_t rows_per_batch=DefaultArrowBatchSize);
+    /** Write the imaging table to a file in the Apache Arrow IPC format
+     *
+     * @param file_name path to the output file
+     * @param table imaging table
+     * @param layout file or stream layout
+     * @param rows_per_batch maximum number of rows in each record batch
+     * @return true if the file was written
+     */
+    bool write_arrow(const std::string& file_name,
+                     const model::table::imaging_table& table,
+                     const arrow_layout layout=ArrowFile,
+                     const size_t rows_per_batch=DefaultArrowBatchSize)
+    INTEROP_THROW_SPEC((io::file_not_found_exception));
+}}}}
@@ -8,6 +8,7 @@
 #pragma once
 #include "interop/util/lexical_cast.h"
 #include "interop/util/math.h"
+#include "interop/util/number_format.h"
 
 
 namespace illumina { namespace interop { namespace io {  namespace  table
@@ -24,12 +25,15 @@ namespace illumina { namespace interop { namespace io {  namespace  table
         values.clear();
         std::string line;
         std::getline(in, line);
-        std::istringstream sin(line);
         std::string cell;
-        while(std::getline(sin, cell, ','))
+        for(size_t beg=0;beg < line.length();)
         {
+            size_t end = line.find(',', beg);
+            if(end == std::string::npos) end = line.length();
+            cell.assign(line, beg, end-beg);
             if(cell=="") values.push_back(missing);
             else values.push_back(util::lexical_cast<T>(cell));
+            beg = end+1;
         }
     }
     /** Read delimited value from the input stream and cast to proper destination type
@@ -118,16 +122,20 @@ namespace illumina { namespace interop { namespace io {  namespace  table
     {
         if(beg == end) return;
         std::ios::fmtflags previous_state( out.flags() );
-        out << handle_nan(*beg);
+        util::number_formatter formatter(out);
+        formatter.append(handle_nan(*beg));
         ++beg;
+        // The first value keeps the precision of the stream, which is then left at the given precision
+        const bool set_precision = precision > 0 && beg != end;
+        if(set_precision) formatter.precision(static_cast<std::streamsize>(precision));
         for(;beg != end;++beg)
         {
-            if(precision>0)
-                out << "," << std::setprecision(precision) << handle_nan(*beg);
-            else
-                out << "," << handle_nan(*beg);
+            formatter.append(',');
+            formatter.append(handle_nan(*beg));
         }
-        if(eol != '\0') out << eol;
+        if(eol != '\0') formatter.append(eol);
+        formatter.write(out);
+        if(set_precision) out.precision(static_cast<std::streamsize>(precision));
         out.flags(previous_state);
     }
     /** Write a vector of values as a single in a CSV file
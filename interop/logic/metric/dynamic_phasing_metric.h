@@ -20,15 +20,20 @@ namespace illumina { namespace interop { namespace logic { namespace metric
 {
 
     /** Populate the dynamic phasing metrics (slope & offset for phasing & prephasing) data structure given the phasing metrics data
+     *
+     * The fits of each tile and read are accumulated in double precision into a dense array. The result does not
+     * depend on the number of threads.
      *
      * @param phasing_metrics phasing metric set
      * @param cycle_to_read map of cycle to read information
      * @param dynamic_phasing_metrics dynamic phasing metric set (to be populated)
      * @param tile_metrics tile metric set (to be populated)
+     * @param thread_count number of threads fitting tiles concurrently, 0 for the default thread count
      */
     void populate_dynamic_phasing_metrics(model::metric_base::metric_set<model::metrics::phasing_metric>& phasing_metrics,
                                           const logic::summary::read_cycle_vector_t& cycle_to_read,
                                           model::metric_base::metric_set<model::metrics::dynamic_phasing_metric>& dynamic_phasing_metrics,
-                                          model::metric_base::metric_set<model::metrics::tile_metric>& tile_metrics);
+                                          model::metric_base::metric_set<model::metrics::tile_metric>& tile_metrics,
+                                          const size_t thread_count=1);
 
 }}}}
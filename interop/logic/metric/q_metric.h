@@ -10,6 +10,7 @@
 #include "interop/model/metrics/q_metric.h"
 #include "interop/model/metrics/q_collapsed_metric.h"
 #include "interop/model/metrics/q_by_lane_metric.h"
+#include "interop/model/metrics/q_score_cube.h"
 #include "interop/model/model_exceptions.h"
 #include "interop/model/metric_base/metric_set.h"
 
@@ -296,5 +297,89 @@ namespace illumina { namespace interop { namespace logic { namespace metric
                                   model::metric_base::metric_set<model::metrics::q_by_lane_metric>& bylane,
                                   const constants::instrument_type instrument)
                                         INTEROP_THROW_SPEC((model::index_out_of_bounds_exception));
+    /** Generate all Q-metric data derived from Q-metrics in a single pass
+     *
+     * This populates the cumulative distribution of the Q-metrics and, if they are empty, creates the
+     * collapsed and by lane Q-metrics. The cumulative distributions of the collapsed and by lane Q-metrics
+     * are also populated.
+     *
+     * @param metric_set Q-metrics
+     * @param collapsed collapsed Q-metrics
+     * @param bylane bylane Q-metrics
+     * @param instrument instrument type
+     * @param populate_tile_cumulative if false, the q-metric cumulative histogram is left empty
+     * @throws index_out_of_bounds_exception
+     */
+    void create_derived_q_metrics(model::metric_base::metric_set<model::metrics::q_metric>& metric_set,
+                                  model::metric_base::metric_set<model::metrics::q_collapsed_metric>& collapsed,
+                                  model::metric_base::metric_set<model::metrics::q_by_lane_metric>& bylane,
+                                  const constants::instrument_type instrument,
+                                  const bool populate_tile_cumulative=true)
+                                        INTEROP_THROW_SPEC((model::index_out_of_bounds_exception));
+    /** Compute the cumulative q-score histogram of a tile up to the given cycle
+     *
+     * This sums the q-score histograms of the tile over all cycles up to and including the given
+     * cycle. It does not require the cumulative histogram stored in each record.
+     *
+     * @param metric_set q-metric set
+     * @param lane lane number
+     * @param tile tile number
+     * @param cycle last cycle to include
+     * @param hist destination cumulative q-score histogram
+     */
+    void cumulative_qscore_hist(const model::metric_base::metric_set<model::metrics::q_metric>& metric_set,
+                                const size_t lane,
+                                const size_t tile,
+                                const size_t cycle,
+                                std::vector< ::uint64_t >& hist);
+    /** Create the key of the data a q-score cube is built from
+     *
+     * The key holds the size, version and revision of the q-metric set, the tile naming method and the version of
+     * the run metrics.
+     *
+     * @param metric_set q-metric set
+     * @param naming_method tile naming method used to determine the surface
+     * @param data_version version of the run metrics
+     * @return key of the source data
+     */
+    inline model::metrics::q_score_cube::source_key_t qscore_cube_source(
+            const model::metric_base::metric_set<model::metrics::q_metric>& metric_set,
+            const constants::tile_naming_method naming_method,
+            const size_t data_version)
+    {
+        model::metrics::q_score_cube::source_key_t key;
+        metric_set.append_source_key(key);
+        key.push_back(static_cast<size_t>(naming_method));
+        key.push_back(data_version);
+        return key;
+    }
+    /** Populate the q-score cube from the q-metrics of each tile
+     *
+     * The cube is left empty if a record has a lane, surface or cycle of 0, or if the records have
+     * different number of bins. The key of the source data is set either way.
+     *
+     * @param metric_set q-metric set
+     * @param naming_method tile naming method used to determine the surface
+     * @param data_version version of the run metrics
+     * @param cube destination q-score cube
+     */
+    void populate_qscore_cube(const model::metric_base::metric_set<model::metrics::q_metric>& metric_set,
+                              const constants::tile_naming_method naming_method,
+                              const size_t data_version,
+                              model::metrics::q_score_cube& cube);
+    /** Test if the q-score cube was built from the current q-metric set
+     *
+     * @param metric_set q-metric set
+     * @param naming_method tile naming method used to determine the surface
+     * @param data_version current version of the run metrics
+     * @param cube q-score cube
+     * @return true if the cube was built from the same q-metric set, naming method and data version
+     */
+    inline bool is_qscore_cube_current(const model::metric_base::metric_set<model::metrics::q_metric>& metric_set,
+                                       const constants::tile_naming_method naming_method,
+                                       const size_t data_version,
+                                       const model::metrics::q_score_cube& cube)
+    {
+        return cube.source() == qscore_cube_source(metric_set, naming_method, data_version);
+    }
 }}}}
-
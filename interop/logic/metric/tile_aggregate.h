@@ -0,0 +1,108 @@
+/** Logic for the per tile aggregate table
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+#include "interop/constants/enums.h"
+#include "interop/model/metrics/tile_aggregate_table.h"
+#include "interop/model/metrics/tile_metric.h"
+#include "interop/model/metrics/extended_tile_metric.h"
+#include "interop/model/metrics/error_metric.h"
+#include "interop/model/metrics/q_metric.h"
+#include "interop/logic/summary/map_cycle_to_read.h"
+
+namespace illumina { namespace interop { namespace logic { namespace metric
+{
+    /** Populate the per tile aggregate table
+     *
+     * The table has a row for each tile with a tile or extended tile metric. The error rate and percent over Q30
+     * of each read are averaged over the cycles of the read, excluding the last cycle as the summary does. The key of
+     * the source data is set even if the table is empty.
+     *
+     * @param tile_metrics tile metric set
+     * @param extended_tile_metrics extended tile metric set
+     * @param error_metrics error metric set
+     * @param q_metrics q-metric set
+     * @param cycle_to_read map cycle to the read number and cycle within read
+     * @param data_version version of the run metrics the table is built from
+     * @param table destination table
+     */
+    void populate_tile_aggregate_table(
+            const model::metric_base::metric_set<model::metrics::tile_metric>& tile_metrics,
+            const model::metric_base::metric_set<model::metrics::extended_tile_metric>& extended_tile_metrics,
+            const model::metric_base::metric_set<model::metrics::error_metric>& error_metrics,
+            const model::metric_base::metric_set<model::metrics::q_metric>& q_metrics,
+            const summary::read_cycle_vector_t& cycle_to_read,
+            const size_t data_version,
+            model::metrics::tile_aggregate_table& table);
+    /** Test if the value of a metric type is held by the per tile aggregate table
+     *
+     * @param type metric type
+     * @return true if the metric type is a tile or extended tile metric type
+     */
+    bool is_tile_aggregate_metric(const constants::metric_type type);
+    /** Get the value of a metric type for a tile in the per tile aggregate table
+     *
+     * The value matches the value plotted for the corresponding tile or extended tile metric.
+     *
+     * @param table per tile aggregate table
+     * @param row index of the tile in the table
+     * @param type metric type
+     * @param read read number, used by the read metric types
+     * @return value of the metric, or NaN if the tile has no value or the type is not held by the table
+     */
+    float tile_aggregate_value(const model::metrics::tile_aggregate_table& table,
+                               const size_t row,
+                               const constants::metric_type type,
+                               const size_t read);
+    /** Get the key of the data the per tile aggregate table is built from
+     *
+     * The key holds the size, version and revision of each metric set, followed by the data version.
+     *
+     * @param tile_metrics tile metric set
+     * @param extended_tile_metrics extended tile metric set
+     * @param error_metrics error metric set
+     * @param q_metrics q-metric set
+     * @param data_version version of the run metrics
+     * @return key of the source data
+     */
+    inline model::metrics::tile_aggregate_table::source_key_t tile_aggregate_source(
+            const model::metric_base::metric_set<model::metrics::tile_metric>& tile_metrics,
+            const model::metric_base::metric_set<model::metrics::extended_tile_metric>& extended_tile_metrics,
+            const model::metric_base::metric_set<model::metrics::error_metric>& error_metrics,
+            const model::metric_base::metric_set<model::metrics::q_metric>& q_metrics,
+            const size_t data_version)
+    {
+        model::metrics::tile_aggregate_table::source_key_t key;
+        tile_metrics.append_source_key(key);
+        extended_tile_metrics.append_source_key(key);
+        error_metrics.append_source_key(key);
+        q_metrics.append_source_key(key);
+        key.push_back(data_version);
+        return key;
+    }
+    /** Test if the per tile aggregate table was built from the current metrics
+     *
+     * @param tile_metrics tile metric set
+     * @param extended_tile_metrics extended tile metric set
+     * @param error_metrics error metric set
+     * @param q_metrics q-metric set
+     * @param data_version current version of the run metrics
+     * @param table per tile aggregate table
+     * @return true if the table was built from the same metric sets and data version
+     */
+    inline bool is_tile_aggregate_table_current(
+            const model::metric_base::metric_set<model::metrics::tile_metric>& tile_metrics,
+            const model::metric_base::metric_set<model::metrics::extended_tile_metric>& extended_tile_metrics,
+            const model::metric_base::metric_set<model::metrics::error_metric>& error_metrics,
+            const model::metric_base::metric_set<model::metrics::q_metric>& q_metrics,
+            const size_t data_version,
+            const model::metrics::tile_aggregate_table& table)
+    {
+        return table.source() ==
+               tile_aggregate_source(tile_metrics, extended_tile_metrics, error_metrics, q_metrics, data_version);
+    }
+}}}}
@@ -10,29 +10,36 @@
 #include <algorithm>
 #include <iterator>
 #include "interop/util/statistics.h"
+#include "interop/util/quantile_sketch.h"
 #include "interop/model/plot/candle_stick_point.h"
 
 namespace illumina { namespace interop { namespace logic { namespace plot {
 
-    /** Logic for creating a candle stick point
+    /** Logic for creating a candle stick point from sorted values and known quartiles
      *
      * @param point candle stick point
-     * @param beg iterator to start of collection of values
-     * @param end iterator to end of collection of values
+     * @param beg iterator to start of sorted collection of values
+     * @param end iterator to end of sorted collection of values
+     * @param p25 25th percentile
+     * @param p50 50th percentile
+     * @param p75 75th percentile
+     * @param count number of values summarized by the point
      * @param x x-coordinate
      * @param outliers reusable memory for collecting outliers
      */
     template<typename I>
-    void plot_candle_stick(model::plot::candle_stick_point& point, I beg, I end, const float x, std::vector<float>& outliers)
+    void plot_candle_stick_sorted(model::plot::candle_stick_point& point,
+                                  I beg,
+                                  I end,
+                                  const float p25,
+                                  const float p50,
+                                  const float p75,
+                                  const size_t count,
+                                  const float x,
+                                  std::vector<float>& outliers)
     {
         const float eps = 1e-7f;
         const float NaN = std::numeric_limits<float>::quiet_NaN();
-        INTEROP_ASSERT(beg != end);
-        //std::sort(beg, end);
-        std::stable_sort(beg, end);
-        const float p25 = util::percentile_sorted<float>(beg, end, 25);
-        const float p50 = util::percentile_sorted<float>(beg, end, 50);
-        const float p75 = util::percentile_sorted<float>(beg, end, 75);
 
         // Really just some arbitrary criteria derived by empirical observation in the 70s.
         const float tukey_constant = 1.5f;
@@ -44,7 +51,6 @@ namespace illumina { namespace interop { namespace logic { namespace plot {
             util::outliers_lower(beg, end, lower, std::back_inserter(outliers));
             util::outliers_upper(beg, end, upper, std::back_inserter(outliers));
         }
-        const size_t count = static_cast<size_t>(std::distance(beg,end));
 
         I upper_it = std::lower_bound(beg, end, upper);// Not less
         I lower_it = std::lower_bound(beg, end, lower-(eps*lower));
@@ -60,6 +66,64 @@ namespace illumina { namespace interop { namespace logic { namespace plot {
         point = model::plot::candle_stick_point(x, p25, p50, p75, min_val, max_val, count, outliers);
         outliers.clear();
     }
+    /** Logic for creating a candle stick point
+     *
+     * @param point candle stick point
+     * @param beg iterator to start of collection of values
+     * @param end iterator to end of collection of values
+     * @param x x-coordinate
+     * @param outliers reusable memory for collecting outliers
+     */
+    template<typename I>
+    void plot_candle_stick(model::plot::candle_stick_point& point, I beg, I end, const float x, std::vector<float>& outliers)
+    {
+        INTEROP_ASSERT(beg != end);
+        //std::sort(beg, end);
+        std::stable_sort(beg, end);
+        const float p25 = util::percentile_sorted<float>(beg, end, 25);
+        const float p50 = util::percentile_sorted<float>(beg, end, 50);
+        const float p75 = util::percentile_sorted<float>(beg, end, 75);
+        const size_t count = static_cast<size_t>(std::distance(beg,end));
+        plot_candle_stick_sorted(point, beg, end, p25, p50, p75, count, x, outliers);
+    }
+    /** Logic for creating a candle stick point from a quantile sketch
+     *
+     * While the sketch holds every value, the point matches the one built from the values. Otherwise, the quartiles
+     * are estimated by the sketch, and the whiskers and outliers are taken from the retained values and the exact
+     * minimum and maximum.
+     *
+     * @param point candle stick point
+     * @param sketch quantile sketch over the values
+     * @param x x-coordinate
+     * @param outliers reusable memory for collecting outliers
+     * @param values reusable memory for the retained values
+     */
+    inline void plot_candle_stick(model::plot::candle_stick_point& point,
+                                  const util::quantile_sketch& sketch,
+                                  const float x,
+                                  std::vector<float>& outliers,
+                                  std::vector<float>& values)
+    {
+        INTEROP_ASSERT(!sketch.empty());
+        sketch.sorted_values(values);
+        if(sketch.is_exact())
+        {
+            plot_candle_stick(point, values.begin(), values.end(), x, outliers);
+            return;
+        }
+        // The extremes may have been compacted away, but the sketch tracks them exactly
+        if(values.front() != sketch.min_value()) values.insert(values.begin(), sketch.min_value());
+        if(values.back() != sketch.max_value()) values.push_back(sketch.max_value());
+        plot_candle_stick_sorted(point,
+                                 values.begin(),
+                                 values.end(),
+                                 sketch.percentile(25),
+                                 sketch.percentile(50),
+                                 sketch.percentile(75),
+                                 static_cast<size_t>(sketch.count()),
+                                 x,
+                                 outliers);
+    }
 
 
 }}}}
@@ -0,0 +1,72 @@
+/** Summary logic for a batch of run folders
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+#include <string>
+#include <vector>
+#include "interop/util/cstdint.h"
+#include "interop/model/summary/run_summary.h"
+#include "interop/model/summary/index_flowcell_summary.h"
+
+
+namespace illumina { namespace interop { namespace logic { namespace summary
+{
+    /** Run and index summary of a single run folder in a batch
+     */
+    struct batch_run_summary
+    {
+        /** Constructor */
+        batch_run_summary() : memory_estimate(0){}
+
+        /** Run folder path */
+        std::string run_folder;
+        /** Summary of the run metrics */
+        model::summary::run_summary run;
+        /** Summary of the index metrics */
+        model::summary::index_flowcell_summary index;
+        /** Error reported while summarizing the run folder, empty on success
+         *
+         * If the InterOp files hold more cycles than the RunInfo.xml, the extra cycles are dropped, the summaries
+         * are still filled and the error is reported here.
+         */
+        std::string error;
+        /** Estimated peak memory in bytes used to summarize the run folder */
+        ::uint64_t memory_estimate;
+    };
+
+    /** Estimate the peak memory used to summarize a run folder
+     *
+     * The estimate is the size of the InterOp files read by the summary. As the Q-metrics are collapsed before the
+     * other files are read, it is the larger of the Q-metric files and all other files.
+     *
+     * @ingroup summary_logic
+     * @param run_folder run folder path
+     * @return estimated peak memory in bytes, 0 if the RunInfo.xml cannot be read
+     */
+    ::uint64_t estimate_summary_memory(const std::string& run_folder);
+
+    /** Summarize the run and index metrics of many run folders on a shared pool of threads
+     *
+     * Each thread takes the next run folder whose memory estimate fits in the budget along with the run folders
+     * being summarized. A run folder larger than the budget is summarized alone. Errors are reported in each
+     * summary rather than thrown, so one bad run folder does not stop the batch.
+     *
+     * @ingroup summary_logic
+     * @param run_folders run folder paths
+     * @param summaries destination summaries in the same order as the run folders
+     * @param thread_count number of run folders summarized at the same time, 0 for the number of processors
+     * @param memory_budget maximum estimated memory in bytes of the run folders summarized at the same time,
+     *        0 for no limit
+     * @param skip_median skip the median calculation
+     */
+    void summarize_run_folders(const std::vector<std::string>& run_folders,
+                               std::vector<batch_run_summary>& summaries,
+                               const size_t thread_count=0,
+                               const ::uint64_t memory_budget=0,
+                               const bool skip_median=false);
+
+}}}}
@@ -0,0 +1,95 @@
+/** Preview summary estimated from a stratified sample of tiles
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+#include <string>
+#include <vector>
+#include "interop/model/model_exceptions.h"
+#include "interop/model/summary/run_summary.h"
+#include "interop/model/summary/summary_estimate.h"
+#include "interop/model/run_metrics.h"
+
+
+namespace illumina { namespace interop { namespace logic { namespace summary
+{
+    /** Vector of unique lane/tile ids */
+    typedef std::vector<model::metric_base::base_metric::id_t> tile_id_vector_t;
+
+    /** List the lane/tile id of every tile in the flowcell layout
+     *
+     * The tiles listed in the RunInfo.xml are used when available, otherwise the tiles are generated from the
+     * number of lanes, surfaces, swaths, sections and tiles of the layout.
+     *
+     * @ingroup summary_logic
+     * @param layout flowcell layout
+     * @param tile_ids destination sorted vector of lane/tile ids
+     */
+    void list_flowcell_tiles(const model::run::flowcell_layout& layout, tile_id_vector_t& tile_ids);
+
+    /** Select a stratified sample of tiles from the flowcell layout
+     *
+     * Each lane and surface is a stratum. The sampled tiles of a stratum are spread evenly over its tiles, in
+     * order of swath then tile number, so every swath is represented when the sample is large enough.
+     *
+     * @ingroup summary_logic
+     * @param layout flowcell layout
+     * @param tiles_per_surface number of tiles sampled from each surface of each lane
+     * @param tile_ids destination sorted vector of lane/tile ids
+     */
+    void select_preview_tiles(const model::run::flowcell_layout& layout,
+                              const size_t tiles_per_surface,
+                              tile_id_vector_t& tile_ids);
+
+    /** Estimate the mean density, percent PF, error rate and percent over Q30 of each lane from sampled tiles
+     *
+     * The estimates are the stratified means over the lanes and surfaces of the flowcell layout, computed from the
+     * per tile aggregate table built by finalize_after_load. The strata without a sampled tile are left out. When
+     * every tile is loaded, each interval collapses to its mean.
+     *
+     * @ingroup summary_logic
+     * @param metrics run metrics holding a sample of tiles
+     * @param estimate destination run summary estimate
+     */
+    void estimate_run_summary(const model::metrics::run_metrics& metrics,
+                              model::summary::run_summary_estimate& estimate)
+    INTEROP_THROW_SPEC((model::index_out_of_bounds_exception));
+
+    /** Summarize a stratified sample of tiles from the InterOp files in a run folder
+     *
+     * Only the records of the sampled tiles are decoded. The run summary covers the sampled tiles, so its counts
+     * and yields are those of the sample, and the estimate holds the means with their confidence intervals.
+     * A later call to summarize_run_metrics with the same run summary replaces the preview with the full summary.
+     *
+     * @ingroup summary_logic
+     * @param run_folder run folder path
+     * @param summary destination run summary over the sampled tiles
+     * @param estimate destination run summary estimate
+     * @param tiles_per_surface number of tiles sampled from each surface of each lane
+     * @param thread_count number of threads to use for network loading
+     */
+    void summarize_run_metrics_preview(const std::string& run_folder,
+                                       model::summary::run_summary& summary,
+                                       model::summary::run_summary_estimate& estimate,
+                                       const size_t tiles_per_surface=4,
+                                       const size_t thread_count=1)
+    INTEROP_THROW_SPEC(( xml::xml_file_not_found_exception,
+    xml::bad_xml_format_exception,
+    xml::empty_xml_format_exception,
+    xml::missing_xml_element_exception,
+    xml::xml_parse_exception,
+    io::file_not_found_exception,
+    io::bad_format_exception,
+    io::incomplete_file_exception,
+    model::index_out_of_bounds_exception,
+    model::invalid_channel_exception,
+    model::invalid_tile_naming_method,
+    model::invalid_tile_list_exception,
+    model::invalid_run_info_exception,
+    model::invalid_run_info_cycle_exception,
+    model::invalid_parameter ));
+
+}}}}
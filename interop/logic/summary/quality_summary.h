@@ -13,7 +13,10 @@
 #include "interop/logic/summary/summary_statistics.h"
 #include "interop/logic/summary/map_cycle_to_read.h"
 #include "interop/model/metrics/q_metric.h"
+#include "interop/model/metrics/q_score_cube.h"
+#include "interop/model/metric_base/metric_set.h"
 #include "interop/model/summary/run_summary.h"
+#include "interop/util/histogram.h"
 
 namespace illumina { namespace interop { namespace logic { namespace summary
 {
@@ -93,6 +96,41 @@ namespace illumina { namespace interop { namespace logic { namespace summary
             INTEROP_ASSERT(lane_surface_index < m_metrics_in_read[read_number].size());
             m_metrics_in_read[read_number][lane_surface_index] += 1;
         }
+        /** Accumulate the calls of several metrics into the cache
+         *
+         * @param calls calls above Q30 and total calls
+         * @param metric_count number of metrics summed in calls
+         * @param read_number index of the read
+         * @param lane index of the lane
+         * @param surface surface index
+         */
+        void add(const qval_total& calls,
+                 const size_t metric_count,
+                 const size_t read_number,
+                 const size_t lane,
+                 const size_t surface=0)
+        {
+            INTEROP_ASSERT(read_number < m_read_lane_cache.size());
+            const size_t lane_surface_index = index_of(lane, surface);
+            INTEROP_ASSERT(lane_surface_index < m_read_lane_cache[read_number].size());
+            m_read_lane_cache[read_number][lane_surface_index].above_qval += calls.above_qval;
+            m_read_lane_cache[read_number][lane_surface_index].total += calls.total;
+            m_metrics_in_read[read_number][lane_surface_index] += metric_count;
+        }
+        /** Add tile numbers to a lane/surface
+         *
+         * @param beg iterator to start of a collection of tile numbers
+         * @param end iterator to end of a collection of tile numbers
+         * @param lane index of the lane
+         * @param surface surface index
+         */
+        template<typename I>
+        void add_tiles(I beg, I end, const size_t lane, const size_t surface=0)
+        {
+            const size_t lane_surface_index = index_of(lane, surface);
+            INTEROP_ASSERT(lane_surface_index < m_tile_lookup.size());
+            m_tile_lookup[lane_surface_index].insert(beg, end);
+        }
         /** Get qval_total struct for given read/lane/surface
          *
          * @param read_number read index
@@ -147,57 +185,18 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         size_t m_surface_count;
     };
 
-   /** Summarize a collection collapsed quality metrics
-    *
-    * @sa model::summary::lane_summary::percent_gt_q30
-    * @sa model::summary::lane_summary::yield_g
-    * @sa model::summary::lane_summary::projected_yield_g
-    *
-    * @sa model::summary::read_summary::percent_gt_q30
-    * @sa model::summary::read_summary::yield_g
-    * @sa model::summary::read_summary::projected_yield_g
-    *
-    * @sa model::summary::run_summary::percent_gt_q30
-    * @sa model::summary::run_summary::yield_g
-    * @sa model::summary::run_summary::projected_yield_g
+   /** Summarize the calls above Q30 cached by read/lane and read/lane/surface
     *
-    * @param beg iterator to start of a collection of collapsed q metrics
-    * @param end iterator to end of a collection of collapsed q metrics
-    * @param cycle_to_read map cycle to the read number and cycle within read number
-    * @param naming_method tile naming convention
+    * @param read_lane_cache calls by read and lane
+    * @param read_lane_surface_cache calls by read, lane and surface
     * @param run destination run summary
     */
-    template<typename I>
-    void summarize_collapsed_quality_metrics(I beg,
-                                             I end,
-                                             const read_cycle_vector_t& cycle_to_read,
-                                             const constants::tile_naming_method naming_method,
-                                             model::summary::run_summary &run)
-                                             INTEROP_THROW_SPEC(( model::index_out_of_bounds_exception ))
+    inline void summarize_quality_caches(const qval_cache& read_lane_cache,
+                                         const qval_cache& read_lane_surface_cache,
+                                         model::summary::run_summary &run)
     {
         typedef model::summary::lane_summary lane_summary;
-        if( beg == end ) return;
-        if( run.size()==0 )return;
         const size_t surface_count = run.surface_count();
-        qval_cache read_lane_cache(run);
-        qval_cache read_lane_surface_cache(run, surface_count);
-
-        for(;beg != end;++beg)
-        {
-            INTEROP_ASSERT(beg->cycle() > 0);
-            INTEROP_BOUNDS_CHECK(beg->cycle() - 1, cycle_to_read.size(), "Cycle exceeds total cycles from Reads in the RunInfo.xml");
-            const size_t read_number = cycle_to_read[beg->cycle()-1].number-1;
-            if(cycle_to_read[beg->cycle()-1].is_last_cycle_in_read) continue;
-            const size_t lane = beg->lane()-1;
-            INTEROP_BOUNDS_CHECK(lane, run.lane_count(), "Lane exceeds number of lanes in RunInfo.xml");
-            read_lane_cache.add(*beg, read_number, lane);
-
-            if(surface_count < 2) continue;
-            const size_t surface = beg->surface(naming_method);
-            INTEROP_ASSERT(surface > 0);
-            read_lane_surface_cache.add(*beg, read_number, lane, surface-1);
-        }
-
         ::uint64_t total_useable_calls = 0;
         ::uint64_t useable_calls_gt_q30 = 0;
         float overall_projected_yield = 0;
@@ -315,5 +314,117 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         run.total_summary().yield_g(yield_g);
         run.total_summary().percent_gt_q30(100 * divide(float(useable_calls_gt_q30), float(total_useable_calls)));
     }
+   /** Summarize a collection collapsed quality metrics
+    *
+    * @sa model::summary::lane_summary::percent_gt_q30
+    * @sa model::summary::lane_summary::yield_g
+    * @sa model::summary::lane_summary::projected_yield_g
+    *
+    * @sa model::summary::read_summary::percent_gt_q30
+    * @sa model::summary::read_summary::yield_g
+    * @sa model::summary::read_summary::projected_yield_g
+    *
+    * @sa model::summary::run_summary::percent_gt_q30
+    * @sa model::summary::run_summary::yield_g
+    * @sa model::summary::run_summary::projected_yield_g
+    *
+    * @param beg iterator to start of a collection of collapsed q metrics
+    * @param end iterator to end of a collection of collapsed q metrics
+    * @param cycle_to_read map cycle to the read number and cycle within read number
+    * @param naming_method tile naming convention
+    * @param run destination run summary
+    */
+    template<typename I>
+    void summarize_collapsed_quality_metrics(I beg,
+                                             I end,
+                                             const read_cycle_vector_t& cycle_to_read,
+                                             const constants::tile_naming_method naming_method,
+                                             model::summary::run_summary &run)
+                                             INTEROP_THROW_SPEC(( model::index_out_of_bounds_exception ))
+    {
+        if( beg == end ) return;
+        if( run.size()==0 )return;
+        const size_t surface_count = run.surface_count();
+        qval_cache read_lane_cache(run);
+        qval_cache read_lane_surface_cache(run, surface_count);
+
+        for(;beg != end;++beg)
+        {
+            INTEROP_ASSERT(beg->cycle() > 0);
+            INTEROP_BOUNDS_CHECK(beg->cycle() - 1, cycle_to_read.size(), "Cycle exceeds total cycles from Reads in the RunInfo.xml");
+            const size_t read_number = cycle_to_read[beg->cycle()-1].number-1;
+            if(cycle_to_read[beg->cycle()-1].is_last_cycle_in_read) continue;
+            const size_t lane = beg->lane()-1;
+            INTEROP_BOUNDS_CHECK(lane, run.lane_count(), "Lane exceeds number of lanes in RunInfo.xml");
+            read_lane_cache.add(*beg, read_number, lane);
+
+            if(surface_count < 2) continue;
+            const size_t surface = beg->surface(naming_method);
+            INTEROP_ASSERT(surface > 0);
+            read_lane_surface_cache.add(*beg, read_number, lane, surface-1);
+        }
+        summarize_quality_caches(read_lane_cache, read_lane_surface_cache, run);
+    }
+   /** Summarize the q-score histograms summed by lane, surface and cycle
+    *
+    * This gives the same result as summarizing the collapsed q-metrics derived from the q-metrics the cube was
+    * built from, without collapsing each record. The tiles of each lane and surface are taken from the q-metrics.
+    *
+    * @param cube q-score histograms summed by lane, surface and cycle
+    * @param q_metrics q-metrics the cube was built from
+    * @param q30_index index of the first bin at or above Q30
+    * @param cycle_to_read map cycle to the read number and cycle within read number
+    * @param naming_method tile naming convention
+    * @param run destination run summary
+    */
+    inline void summarize_quality_cube(const model::metrics::q_score_cube& cube,
+                                       const model::metric_base::metric_set<model::metrics::q_metric>& q_metrics,
+                                       const size_t q30_index,
+                                       const read_cycle_vector_t& cycle_to_read,
+                                       const constants::tile_naming_method naming_method,
+                                       model::summary::run_summary &run)
+                                       INTEROP_THROW_SPEC(( model::index_out_of_bounds_exception ))
+    {
+        typedef model::metrics::q_score_cube::count_t count_t;
+        typedef model::metric_base::metric_set<model::metrics::q_metric>::id_vector id_vector;
+        typedef model::metric_base::metric_set<model::metrics::q_metric>::uint_t uint_t;
+        if( cube.empty() ) return;
+        if( run.size()==0 )return;
+        const size_t surface_count = run.surface_count();
+        qval_cache read_lane_cache(run);
+        qval_cache read_lane_surface_cache(run, surface_count);
+
+        for(size_t lane=1;lane <= cube.lane_count();++lane)
+        {
+            for(size_t surface=1;surface <= cube.surface_count();++surface)
+            {
+                bool has_calls = false;
+                for(size_t cycle=1;cycle <= cube.cycle_count();++cycle)
+                {
+                    const size_t metric_count = cube.record_count(lane, surface, cycle);
+                    if(metric_count == 0) continue;
+                    INTEROP_BOUNDS_CHECK(cycle - 1, cycle_to_read.size(), "Cycle exceeds total cycles from Reads in the RunInfo.xml");
+                    const size_t read_number = cycle_to_read[cycle-1].number-1;
+                    if(cycle_to_read[cycle-1].is_last_cycle_in_read) continue;
+                    INTEROP_BOUNDS_CHECK(lane-1, run.lane_count(), "Lane exceeds number of lanes in RunInfo.xml");
+                    const count_t* hist = cube.histogram(lane, surface, cycle);
+                    const qval_total calls(util::histogram_tail_sum(hist, hist+cube.bin_count(), q30_index),
+                                           util::histogram_sum(hist, hist+cube.bin_count()));
+                    read_lane_cache.add(calls, metric_count, read_number, lane-1);
+                    has_calls = true;
+                    if(surface_count < 2) continue;
+                    read_lane_surface_cache.add(calls, metric_count, read_number, lane-1, surface-1);
+                }
+                if(!has_calls) continue;
+                const id_vector& tiles = q_metrics.lane_surface_tile_numbers(static_cast<uint_t>(lane),
+                                                                             static_cast<uint_t>(surface),
+                                                                             naming_method);
+                read_lane_cache.add_tiles(tiles.begin(), tiles.end(), lane-1);
+                if(surface_count < 2) continue;
+                read_lane_surface_cache.add_tiles(tiles.begin(), tiles.end(), lane-1, surface-1);
+            }
+        }
+        summarize_quality_caches(read_lane_cache, read_lane_surface_cache, run);
+    }
 }}}}
 
@@ -34,5 +34,38 @@ namespace illumina { namespace interop { namespace logic { namespace summary
     model::invalid_run_info_exception ));
 
 
+    /** Summarize the InterOp files in a run folder without holding every Q-score histogram in memory
+     *
+     * The Q-score histograms are collapsed and released before the other InterOp files are read, so the peak memory
+     * is the larger of the Q-metrics alone and the remaining summary metrics, rather than their sum.
+     *
+     * @ingroup summary_logic
+     * @param run_folder run folder path
+     * @param summary destination run summary
+     * @param skip_median skip the median calculation
+     * @param trim flag indicating whether to trim the summary model (default: true)
+     * @param thread_count number of threads to use for network loading
+     */
+    void summarize_run_metrics(const std::string& run_folder,
+                               model::summary::run_summary& summary,
+                               const bool skip_median=false,
+                               const bool trim=true,
+                               const size_t thread_count=1)
+    INTEROP_THROW_SPEC(( xml::xml_file_not_found_exception,
+    xml::bad_xml_format_exception,
+    xml::empty_xml_format_exception,
+    xml::missing_xml_element_exception,
+    xml::xml_parse_exception,
+    io::file_not_found_exception,
+    io::bad_format_exception,
+    io::incomplete_file_exception,
+    model::index_out_of_bounds_exception,
+    model::invalid_channel_exception,
+    model::invalid_tile_naming_method,
+    model::invalid_tile_list_exception,
+    model::invalid_run_info_exception,
+    model::invalid_run_info_cycle_exception,
+    model::invalid_parameter ));
+
 }}}}
 
@@ -12,18 +12,20 @@
 #include "interop/model/model_exceptions.h"
 #include "interop/logic/summary/summary_statistics.h"
 #include "interop/model/metrics/tile_metric.h"
+#include "interop/model/metrics/tile_aggregate_table.h"
 #include "interop/model/summary/run_summary.h"
 
 namespace illumina { namespace interop { namespace logic { namespace summary
 {
      /** Use the cached data to update a stat summary
      *
+     * @tparam ExtendedTile tile_aggregate
      * @param extended_tile_data cached tile data
      * @param stat_summary destination stat summary to update
      * @param skip_median skip the median calculation
      */
-     template<class ExtendedTileVector>
-     void update_extended_tile_summary_from_cache(std::vector<ExtendedTileVector>& extended_tile_data,
+     template<class ExtendedTile>
+     void update_extended_tile_summary_from_cache(std::vector<ExtendedTile>& extended_tile_data,
                                                   model::summary::stat_summary& stat_summary,
                                                   const bool skip_median)
      {
@@ -31,8 +33,8 @@ namespace illumina { namespace interop { namespace logic { namespace summary
          nan_summarize(extended_tile_data.begin(),
                        extended_tile_data.end(),
                        stat,
-                       util::op::const_member_function(&model::metrics::extended_tile_metric::percent_occupied),
-                       util::op::const_member_function_less(&model::metrics::extended_tile_metric::percent_occupied),
+                       util::op::const_member_function(&ExtendedTile::percent_occupied),
+                       util::op::const_member_function_less(&ExtendedTile::percent_occupied),
                        skip_median);
          stat_summary.percent_occupied(stat);
      }
@@ -40,12 +42,13 @@ namespace illumina { namespace interop { namespace logic { namespace summary
 
      /** Use the cached data to update a stat summary
      *
+     * @tparam Tile tile_aggregate
      * @param tile_data cached tile data
      * @param stat_summary destination stat summary to update
      * @param skip_median skip the median calculation
      */
-    template<class TileVector>
-    void update_tile_summary_from_cache(std::vector<TileVector>& tile_data,
+    template<class Tile>
+    void update_tile_summary_from_cache(std::vector<Tile>& tile_data,
                                         model::summary::stat_summary& stat_summary,
                                         const bool skip_median)
     {
@@ -53,52 +56,52 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         nan_summarize(tile_data.begin(),
                   tile_data.end(),
                   stat,
-                  util::op::const_member_function(&model::metrics::tile_metric::cluster_density),
-                  util::op::const_member_function_less(&model::metrics::tile_metric::cluster_density),
+                  util::op::const_member_function(&Tile::cluster_density),
+                  util::op::const_member_function_less(&Tile::cluster_density),
                   skip_median);
         stat_summary.density(stat);
         stat.clear();
         nan_summarize(tile_data.begin(),
                   tile_data.end(),
                   stat,
-                  util::op::const_member_function(&model::metrics::tile_metric::cluster_density_pf),
-                  util::op::const_member_function_less(&model::metrics::tile_metric::cluster_density_pf),
+                  util::op::const_member_function(&Tile::cluster_density_pf),
+                  util::op::const_member_function_less(&Tile::cluster_density_pf),
                   skip_median);
         stat_summary.density_pf(stat);
         stat.clear();
         nan_summarize(tile_data.begin(),
                   tile_data.end(),
                   stat,
-                  util::op::const_member_function(&model::metrics::tile_metric::cluster_count),
-                  util::op::const_member_function_less(&model::metrics::tile_metric::cluster_count),
+                  util::op::const_member_function(&Tile::cluster_count),
+                  util::op::const_member_function_less(&Tile::cluster_count),
                   skip_median);
         stat_summary.cluster_count(stat);
         stat.clear();
         nan_summarize(tile_data.begin(),
                   tile_data.end(),
                   stat,
-                  util::op::const_member_function(&model::metrics::tile_metric::cluster_count_pf),
-                  util::op::const_member_function_less(&model::metrics::tile_metric::cluster_count_pf),
+                  util::op::const_member_function(&Tile::cluster_count_pf),
+                  util::op::const_member_function_less(&Tile::cluster_count_pf),
                   skip_median);
         stat_summary.cluster_count_pf(stat);
         stat.clear();
         nan_summarize(tile_data.begin(),
                   tile_data.end(),
                   stat,
-                  util::op::const_member_function(&model::metrics::tile_metric::percent_pf),
-                  util::op::const_member_function_less(&model::metrics::tile_metric::percent_pf),
+                  util::op::const_member_function(&Tile::percent_pf),
+                  util::op::const_member_function_less(&Tile::percent_pf),
                   skip_median);
         stat_summary.percent_pf(stat);
         stat_summary.reads(nan_accumulate(tile_data.begin(),
                                            tile_data.end(),
                                            uint64_t(0),
                                            util::op::const_member_function(
-                                                   &model::metrics::tile_metric::cluster_count)));
+                                                   &Tile::cluster_count)));
         stat_summary.reads_pf(nan_accumulate(tile_data.begin(),
                                              tile_data.end(),
                                               uint64_t(0),
                                              util::op::const_member_function(
-                                                     &model::metrics::tile_metric::cluster_count_pf)));
+                                                     &Tile::cluster_count_pf)));
     }
     /** Update the stat summary with cached read metrics
      *
@@ -139,76 +142,25 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         stat_summary.phasing(stat);
         return non_nan;
     }
-    /** Summarize a collection tile metrics
-    *
-    * @sa model::summary::lane_summary::density
-    * @sa model::summary::lane_summary::density_pf
-    * @sa model::summary::lane_summary::cluster_count
-    * @sa model::summary::lane_summary::cluster_count_pf
-    * @sa model::summary::lane_summary::percent_pf
-    * @sa model::summary::lane_summary::reads
-    * @sa model::summary::lane_summary::reads_pf
-    * @sa model::summary::lane_summary::percent_aligned
-    * @sa model::summary::lane_summary::prephasing
-    * @sa model::summary::lane_summary::phasing
-    *
-    * @sa model::summary::read_summary::percent_aligned
-    * @sa model::summary::run_summary::percent_aligned
-    *
-    * @param beg iterator to start of a collection of tile metrics
-    * @param end iterator to end of a collection of tile metrics
-    * @param naming_method tile naming convention
-    * @param run destination run summary
-    * @param skip_median skip the median calculation
-    */
-    template<typename I>
-    void summarize_tile_metrics(I beg,
-                                I end,
-                                const constants::tile_naming_method naming_method,
-                                model::summary::run_summary &run,
-                                const bool skip_median=false)
-                                    INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+    /** Summarize the tile and read values grouped by lane and by lane and surface
+     *
+     * @tparam Tile tile_aggregate
+     * @param tile_data_by_lane tile values grouped by lane
+     * @param tile_data_by_lane_surface tile values grouped by lane and surface
+     * @param read_data_by_lane_read read values grouped by read and lane
+     * @param read_data_by_surface_lane_read read values grouped by read, lane and surface
+     * @param run destination run summary
+     * @param skip_median skip the median calculation
+     */
+    template<class Tile>
+    void summarize_tile_values(std::vector< std::vector<Tile> >& tile_data_by_lane,
+                               std::vector< std::vector<Tile> >& tile_data_by_lane_surface,
+                               summary_by_lane_read<model::metrics::read_metric>& read_data_by_lane_read,
+                               summary_by_lane_read<model::metrics::read_metric>& read_data_by_surface_lane_read,
+                               model::summary::run_summary &run,
+                               const bool skip_median)
     {
-        typedef typename model::metrics::tile_metric::read_metric_vector read_metric_vector_t;
-        typedef typename read_metric_vector_t::const_iterator const_read_metric_iterator;
-        typedef std::vector<model::metrics::tile_metric> tile_vector_t;
-        typedef std::vector<tile_vector_t> tile_by_lane_vector_t;
-
-        if (beg == end) return;
-        if (run.size() == 0)return;
         const size_t surface_count = run.surface_count();
-        const ptrdiff_t n = std::distance(beg, end);
-
-        tile_by_lane_vector_t tile_data_by_lane(run.lane_count());
-        reserve(tile_data_by_lane.begin(), tile_data_by_lane.end(), n);
-        tile_by_lane_vector_t tile_data_by_lane_surface(run.lane_count()*surface_count);
-        reserve(tile_data_by_lane_surface.begin(), tile_data_by_lane_surface.end(), n);
-
-        summary_by_lane_read<model::metrics::read_metric> read_data_by_lane_read(run, n);
-        summary_by_lane_read<model::metrics::read_metric> read_data_by_surface_lane_read(run, n, surface_count);
-
-        for (; beg != end; ++beg)
-        {
-            const size_t surface = beg->surface(naming_method);
-            INTEROP_ASSERT(surface > 0);
-            const size_t lane = beg->lane() - 1;
-            INTEROP_BOUNDS_CHECK(lane, tile_data_by_lane.size(), "Lane exceeds number of lanes in RunInfo.xml");
-            tile_data_by_lane[beg->lane() - 1].push_back(*beg);// TODO: make more efficient by copying only tile data
-            for (const_read_metric_iterator rb = beg->read_metrics().begin(), re = beg->read_metrics().end();
-                 rb != re; ++rb)
-            {
-                const size_t read = rb->read() - 1;
-                INTEROP_BOUNDS_CHECK(read, read_data_by_lane_read.read_count(), "Read exceeds number of reads in RunInfo.xml");
-                read_data_by_lane_read(read, lane).push_back(*rb);
-                if(surface_count < 2) continue;
-                read_data_by_surface_lane_read(read, lane, surface-1).push_back(*rb);
-            }
-            if(surface_count < 2) continue;
-            const size_t index = lane*surface_count+(surface-1);
-            tile_data_by_lane_surface[index].push_back(*beg);// TODO: make more efficient by copying only tile data
-        }
-
-
         //reads and reads pf
         // percent pf
         INTEROP_ASSERT(run.size() > 0);
@@ -312,47 +264,99 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         run.nonindex_summary().cluster_count_pf(cluster_count_pf);
         run.total_summary().cluster_count_pf(cluster_count_pf);
     }
-
-    /** Summarize a collection extended tile metrics
+    /** Summarize the tiles of the per tile aggregate table
+     *
+     * The summary is built from the tile and read values of each tile with a tile metric.
+     *
+     * @sa model::summary::lane_summary::density
+     * @sa model::summary::lane_summary::density_pf
+     * @sa model::summary::lane_summary::cluster_count
+     * @sa model::summary::lane_summary::cluster_count_pf
+     * @sa model::summary::lane_summary::percent_pf
+     * @sa model::summary::lane_summary::reads
+     * @sa model::summary::lane_summary::reads_pf
+     * @sa model::summary::lane_summary::percent_aligned
+     * @sa model::summary::lane_summary::prephasing
+     * @sa model::summary::lane_summary::phasing
      *
-     * @note This must be called after summarize_tile_metrics!
+     * @sa model::summary::read_summary::percent_aligned
+     * @sa model::summary::run_summary::percent_aligned
      *
-     * @param beg iterator to start of a collection of extended tile metrics
-     * @param end iterator to end of a collection of extended tile metrics
+     * @param table per tile aggregate table
      * @param naming_method tile naming convention
      * @param run destination run summary
+     * @param skip_median skip the median calculation
      */
-    template<typename I>
-    void summarize_extended_tile_metrics(I beg,
-                                         I end,
-                                         const constants::tile_naming_method naming_method,
-                                         model::summary::run_summary &run)
-    INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+    inline void summarize_tile_aggregates(const model::metrics::tile_aggregate_table& table,
+                                          const constants::tile_naming_method naming_method,
+                                          model::summary::run_summary &run,
+                                          const bool skip_median=false)
+                                          INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
     {
-        typedef std::vector<model::metrics::extended_tile_metric> tile_vector_t;
+        typedef std::vector<model::metrics::tile_aggregate> tile_vector_t;
         typedef std::vector<tile_vector_t> tile_by_lane_vector_t;
-        if (beg == end) return;
+
+        if (table.tile_metric_count() == 0) return;
         if (run.size() == 0)return;
+        INTEROP_BOUNDS_CHECK(table.read_count(), run.size()+1, "Read exceeds number of reads in RunInfo.xml");
         const size_t surface_count = run.surface_count();
-        const ptrdiff_t n = std::distance(beg, end);
+        const ptrdiff_t n = static_cast<ptrdiff_t>(table.tile_metric_count());
+
         tile_by_lane_vector_t tile_data_by_lane(run.lane_count());
         reserve(tile_data_by_lane.begin(), tile_data_by_lane.end(), n);
         tile_by_lane_vector_t tile_data_by_lane_surface(run.lane_count()*surface_count);
         reserve(tile_data_by_lane_surface.begin(), tile_data_by_lane_surface.end(), n);
 
-        for (; beg != end; ++beg)
+        summary_by_lane_read<model::metrics::read_metric> read_data_by_lane_read(run, n);
+        summary_by_lane_read<model::metrics::read_metric> read_data_by_surface_lane_read(run, n, surface_count);
+
+        for (size_t row = 0; row < table.size(); ++row)
         {
-            const size_t surface = beg->surface(naming_method);
+            const model::metrics::tile_aggregate& tile = table[row];
+            if (!tile.has_tile_metric()) continue;
+            const size_t surface = tile.surface(naming_method);
             INTEROP_ASSERT(surface > 0);
-            const size_t lane = beg->lane() - 1;
+            const size_t lane = tile.lane() - 1;
             INTEROP_BOUNDS_CHECK(lane, tile_data_by_lane.size(), "Lane exceeds number of lanes in RunInfo.xml");
-            tile_data_by_lane[beg->lane() - 1].push_back(*beg);// TODO: make more efficient by copying only tile data
+            tile_data_by_lane[lane].push_back(tile);
+            for (size_t read = 0; read < table.read_count(); ++read)
+            {
+                const model::metrics::tile_read_aggregate& values = table.read(row, read+1);
+                if (std::isnan(values.percent_aligned()) && std::isnan(values.percent_phasing()) &&
+                    std::isnan(values.percent_prephasing()))
+                    continue;
+                const model::metrics::read_metric read_metric(static_cast< ::uint32_t >(read+1),
+                                                              values.percent_aligned(),
+                                                              values.percent_phasing(),
+                                                              values.percent_prephasing());
+                read_data_by_lane_read(read, lane).push_back(read_metric);
+                if(surface_count < 2) continue;
+                read_data_by_surface_lane_read(read, lane, surface-1).push_back(read_metric);
+            }
             if(surface_count < 2) continue;
-            const size_t index = lane*surface_count+(surface-1);
-            tile_data_by_lane_surface[index].push_back(*beg);// TODO: make more efficient by copying only tile data
+            tile_data_by_lane_surface[lane*surface_count+(surface-1)].push_back(tile);
         }
+        summarize_tile_values(tile_data_by_lane,
+                              tile_data_by_lane_surface,
+                              read_data_by_lane_read,
+                              read_data_by_surface_lane_read,
+                              run,
+                              skip_median);
+    }
 
-
+    /** Summarize the extended tile values grouped by lane and by lane and surface
+     *
+     * @tparam ExtendedTile tile_aggregate
+     * @param tile_data_by_lane extended tile values grouped by lane
+     * @param tile_data_by_lane_surface extended tile values grouped by lane and surface
+     * @param run destination run summary
+     */
+    template<class ExtendedTile>
+    void summarize_extended_tile_values(std::vector< std::vector<ExtendedTile> >& tile_data_by_lane,
+                                        std::vector< std::vector<ExtendedTile> >& tile_data_by_lane_surface,
+                                        model::summary::run_summary &run)
+    {
+        const size_t surface_count = run.surface_count();
         model::summary::metric_stat count_stat;
         double total_cluster_occupied = 0;
         double total_cluster_count = 0;
@@ -362,14 +366,15 @@ namespace illumina { namespace interop { namespace logic { namespace summary
             INTEROP_ASSERT(lane < tile_data_by_lane.size());
             INTEROP_ASSERT(lane < run[0].size());
 
-            tile_vector_t& tile_lane_data = tile_data_by_lane[lane];
-            tile_vector_t::iterator tile_lane_end = util::remove_nan(tile_lane_data.begin(), tile_lane_data.end(),
-                                                                     util::op::const_member_function(&model::metrics::extended_tile_metric::cluster_count_occupied));
+            std::vector<ExtendedTile>& tile_lane_data = tile_data_by_lane[lane];
+            typename std::vector<ExtendedTile>::iterator tile_lane_end =
+                    util::remove_nan(tile_lane_data.begin(), tile_lane_data.end(),
+                                     util::op::const_member_function(&ExtendedTile::cluster_count_occupied));
             const float occupied_mean =
                     util::mean<float>(tile_lane_data.begin(),
                                       tile_lane_end,
                                       util::op::const_member_function(
-                                              &model::metrics::extended_tile_metric::cluster_count_occupied));
+                                              &ExtendedTile::cluster_count_occupied));
             count_stat = run[0][lane].cluster_count();
             update_extended_tile_summary_from_cache(tile_data_by_lane[lane], run[0][lane], skip_median);
             if(!std::isnan(count_stat.mean()) && !std::isnan(occupied_mean))
@@ -403,5 +408,42 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         run.total_summary().percent_occupied(static_cast<float>(divide(total_cluster_occupied, total_cluster_count))*100);
     }
 
-}}}}
+    /** Summarize the extended tiles of the per tile aggregate table
+     *
+     * @note This must be called after summarize_tile_aggregates!
+     *
+     * @param table per tile aggregate table
+     * @param naming_method tile naming convention
+     * @param run destination run summary
+     */
+    inline void summarize_extended_tile_aggregates(const model::metrics::tile_aggregate_table& table,
+                                                   const constants::tile_naming_method naming_method,
+                                                   model::summary::run_summary &run)
+    INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+    {
+        typedef std::vector<model::metrics::tile_aggregate> tile_vector_t;
+        typedef std::vector<tile_vector_t> tile_by_lane_vector_t;
+        if (table.extended_tile_metric_count() == 0) return;
+        if (run.size() == 0)return;
+        const size_t surface_count = run.surface_count();
+        const ptrdiff_t n = static_cast<ptrdiff_t>(table.extended_tile_metric_count());
+        tile_by_lane_vector_t tile_data_by_lane(run.lane_count());
+        reserve(tile_data_by_lane.begin(), tile_data_by_lane.end(), n);
+        tile_by_lane_vector_t tile_data_by_lane_surface(run.lane_count()*surface_count);
+        reserve(tile_data_by_lane_surface.begin(), tile_data_by_lane_surface.end(), n);
 
+        for (model::metrics::tile_aggregate_table::const_iterator beg = table.begin(); beg != table.end(); ++beg)
+        {
+            if (!beg->has_extended_tile_metric()) continue;
+            const size_t surface = beg->surface(naming_method);
+            INTEROP_ASSERT(surface > 0);
+            const size_t lane = beg->lane() - 1;
+            INTEROP_BOUNDS_CHECK(lane, tile_data_by_lane.size(), "Lane exceeds number of lanes in RunInfo.xml");
+            tile_data_by_lane[lane].push_back(*beg);
+            if(surface_count < 2) continue;
+            tile_data_by_lane_surface[lane*surface_count+(surface-1)].push_back(*beg);
+        }
+        summarize_extended_tile_values(tile_data_by_lane, tile_data_by_lane_surface, run);
+    }
+
+}}}}
@@ -8,6 +8,7 @@
 #pragma once
 #include <vector>
 #include "interop/util/exception.h"
+#include "interop/util/fixed_vector.h"
 #include "interop/util/constant_mapping.h"
 #include "interop/constants/enums.h"
 #include "interop/logic/utils/enums.h"
@@ -207,6 +208,17 @@ namespace illumina { namespace interop { namespace logic { namespace table
         {
             return !values.empty();
         }
+
+        /** Test if an inline array is valid
+         *
+         * @param values inline array of values
+         * @return true if not empty
+         */
+        template<typename T, size_t N>
+        static bool is_valid(const util::fixed_vector<T, N> &values)
+        {
+            return !values.empty();
+        }
     };
 }}}}
 
@@ -8,6 +8,7 @@
 #pragma once
 #include <vector>
 #include "interop/util/exception.h"
+#include "interop/util/fixed_vector.h"
 #include "interop/util/constant_mapping.h"
 #include "interop/constants/enums.h"
 #include "interop/model/run_metrics.h"
@@ -103,6 +104,88 @@ namespace illumina { namespace interop { namespace logic { namespace table
             INTEROP_IMAGING_COLUMN_TYPES
 #           undef INTEROP_TUPLE7 // Reuse this for another conversion
         }
+        /** Populate the tile columns of the table from the per tile aggregate table
+         *
+         * @param table per tile aggregate table
+         * @param row index of the tile in the aggregate table
+         * @param read read number
+         * @param columns vector of table columns
+         * @param data_it iterator to current row of table data
+         * @param data_end iterator to end of table data
+         */
+        template<typename OutputIterator>
+        static void populate(const model::metrics::tile_aggregate_table& table,
+                             const size_t row,
+                             const size_t read,
+                             const std::vector <size_t> &columns,
+                             OutputIterator data_it, OutputIterator data_end)
+        {
+            /* For every entry in INTEROP_IMAGING_COLUMN_TYPES
+             * Copy the value of the column held by the aggregate table, rounded as the metric column
+             */
+#           define INTEROP_TUPLE7(Id, Ignore1, Ignore2, Ignore3, Ignore4, Ignore5, Round) \
+                    populate_tile_aggregate(table, row, read, model::table:: Id##Column, Round, columns, data_it, data_end);
+            INTEROP_IMAGING_COLUMN_TYPES
+#           undef INTEROP_TUPLE7 // Reuse this for another conversion
+        }
+        /** Get the value of an imaging table column held by the per tile aggregate table
+         *
+         * @param table per tile aggregate table
+         * @param row index of the tile in the aggregate table
+         * @param read read number
+         * @param column imaging table column id
+         * @return value of the column, or NaN if the column is not a tile column or the tile has no value
+         */
+        static float tile_aggregate_value(const model::metrics::tile_aggregate_table& table,
+                                          const size_t row,
+                                          const size_t read,
+                                          const model::table::column_id column)
+        {
+            const model::metrics::tile_aggregate& tile = table[row];
+            switch (column)
+            {
+                case model::table::DensityKPermm2Column:
+                    return tile.cluster_density_k();
+                case model::table::DensityPfKPermm2Column:
+                    return tile.cluster_density_pf_k();
+                case model::table::ClusterCountKColumn:
+                    return tile.cluster_count_k();
+                case model::table::ClusterCountPfKColumn:
+                    return tile.cluster_count_pf_k();
+                case model::table::PercentPassFilterColumn:
+                    return tile.percent_pf();
+                case model::table::PercentAlignedColumn:
+                    return table.percent_aligned_at(row, read);
+                case model::table::LegacyPhasingRateColumn:
+                    return table.percent_phasing_at(row, read);
+                case model::table::LegacyPrephasingRateColumn:
+                    return table.percent_prephasing_at(row, read);
+                case model::table::ClusterCountOccupiedKColumn:
+                    return tile.cluster_count_occupied_k();
+                case model::table::PercentOccupiedColumn:
+                    return tile.percent_occupied();
+                default:
+                    return std::numeric_limits<float>::quiet_NaN();
+            }
+        }
+
+    private:
+        template<typename OutputIterator>
+        static void populate_tile_aggregate(const model::metrics::tile_aggregate_table& table,
+                                            const size_t row,
+                                            const size_t read,
+                                            const model::table::column_id column,
+                                            const size_t num_digits,
+                                            const std::vector<size_t>& columns,
+                                            OutputIterator data_it, OutputIterator data_end)
+        {
+            INTEROP_ASSERT( column < columns.size() );
+            const size_t index = columns[column];
+            if(!is_valid(index)) return; /*Missing column */
+            const float value = tile_aggregate_value(table, row, read, column);
+            if(!is_valid(value)) return;
+            copy_to(data_it+index, data_end, value, num_digits);
+        }
 
     private:
         /* For every entry in INTEROP_IMAGING_COLUMN_TYPES
@@ -210,6 +293,25 @@ namespace illumina { namespace interop { namespace logic { namespace table
             }
         }
 
+        /** Assign an inline array to an iterator
+         *
+         * @param destination iterator to desination collection
+         * @param end iterator to end of destination collection
+         * @param source  inline array to assign
+         * @param num_digits number of digits after the decimal
+         */
+        template<typename OutputIterator, typename U, size_t N>
+        static void
+        copy_to(OutputIterator destination, OutputIterator end, const util::fixed_vector<U, N> &source, const size_t num_digits)
+        {
+            (void) end;
+            for (typename util::fixed_vector<U, N>::const_iterator it = source.begin(); it != source.end(); ++it, ++destination)
+            {
+                INTEROP_ASSERT(destination < end);
+                assign(*destination, *it, num_digits);
+            }
+        }
+
         /** Test if a metric type is valid
          *
          * @param val floating point value
@@ -241,6 +343,17 @@ namespace illumina { namespace interop { namespace logic { namespace table
         {
             return !values.empty();
         }
+
+        /** Test if an inline array is valid
+         *
+         * @param values inline array of values
+         * @return true if not empty
+         */
+        template<typename T, size_t N>
+        static bool is_valid(const util::fixed_vector<T, N> &values)
+        {
+            return !values.empty();
+        }
     };
 }}}}
 
@@ -15,12 +15,16 @@
 #include <numeric>
 #include <utility>
 #include "interop/util/map.h"
+#include "interop/util/pool_allocator.h"
 #include "interop/util/exception.h"
 #include "interop/model/metric_base/base_cycle_metric.h"
 #include "interop/model/metric_base/base_read_metric.h"
 #include "interop/model/metric_base/metric_exceptions.h"
+#include "interop/model/metric_base/metric_view.h"
+#include "interop/model/metric_base/record_filter.h"
 #include "interop/util/lexical_cast.h"
 #include "interop/util/assert.h"
+#include "interop/util/thread_pool.h"
 
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -32,9 +36,61 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
 
     /** Compare metrics across type */
     template<class Metric, class Type=typename Metric::base_t> struct metric_comparison;
+    /** Number of changes made to a metric set
+     *
+     * A copy has the revision of its source. Assignment moves past both revisions, so a metric set never returns
+     * to a revision it had before.
+     */
+    class metric_set_revision
+    {
+    public:
+        /** Constructor */
+        metric_set_revision() : m_value(0){}
+        /** Copy constructor keeps the revision of the source
+         *
+         * @param other source revision
+         */
+        metric_set_revision(const metric_set_revision& other) : m_value(other.m_value){}
+        /** Assignment moves past both revisions
+         *
+         * @param other source revision
+         * @return this revision
+         */
+        metric_set_revision& operator=(const metric_set_revision& other)
+        {
+            m_value = std::max(m_value, other.m_value) + 1;
+            return *this;
+        }
+
+    public:
+        /** Record a change */
+        void increment()
+        {
+            ++m_value;
+        }
+        /** Get the number of the revision
+         *
+         * @return revision number
+         */
+        size_t value() const
+        {
+            return m_value;
+        }
+
+    private:
+        size_t m_value;
+    };
     /** Metric set holds a collection metrics
      *
      * This class holds a map that maps a unique id to the metric.
+     *
+     * The lane, cycle and tile lookups are built on first use under a lock, so any number of threads may read the
+     * same metric set. They are cleared by every member function that changes the record array. Changing the lane,
+     * tile or cycle of a record through operator[], get_metric_ref or an iterator, or reordering the records through
+     * iterators, requires a call to rebuild_index or clear_lookup, as it does for the id map.
+     *
+     * The revision counts the changes made through the member functions that clear the lookups, so derived data,
+     * such as the q-score cube, can test whether it was built from the current records.
      */
     template<typename T>
     class metric_set : public T::header_type
@@ -63,12 +119,28 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         typedef typename metric_array_t::size_type size_type;
         /** Define a set of ids */
         typedef std::set<uint_t> id_set_t; // TODO: Do the same for set
-        /** Define offset map */
+        /** Define offset map, nodes are allocated from a pool released with the map */
 #ifdef INTEROP_HAS_UNORDERED_MAP // Workaround for SWIG not understanding the macro
-        typedef std::unordered_map<id_t, size_t> offset_map_t;
+        typedef std::unordered_map<id_t,
+                                   size_t,
+                                   std::hash<id_t>,
+                                   std::equal_to<id_t>,
+                                   util::pool_allocator< std::pair<const id_t, size_t> > > offset_map_t;
 #else
         typedef std::map<id_t, size_t> offset_map_t;
 #endif
+        /** Define a collection of offsets */
+        typedef std::vector<size_t> offset_vector_t;
+        /** Define a map of lane or cycle to the offsets of its metrics */
+        typedef std::map<uint_t, offset_vector_t> offset_index_t;
+        /** Define a map of lane to its tile numbers */
+        typedef std::map<uint_t, id_vector> tile_index_t;
+        /** Define a map of lane and surface to its tile numbers */
+        typedef std::map<std::pair<uint_t, uint_t>, id_vector> surface_tile_index_t;
+        /** Define a map of lane and surface to tile numbers for each tile naming method */
+        typedef std::map<constants::tile_naming_method, surface_tile_index_t> naming_surface_index_t;
+        /** Define a view of the metrics */
+        typedef metric_view<T> metric_view_t;
 
     public:
         /** Define a safe comparison for ids */
@@ -91,7 +163,10 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          * @param version version of the file format
          */
         metric_set(const ::int16_t version )
-                : header_type(header_type::default_header()), m_version(version), m_data_source_exists(false)
+                : header_type(header_type::default_header()),
+                  m_version(version),
+                  m_data_source_exists(false),
+                  m_secondary_index_valid(false)
         { }
         /** Constructor
          *
@@ -99,7 +174,10 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          * @param version version of the file format
          */
         metric_set(const header_type &header = header_type::default_header(), const ::int16_t version = 0)
-                : header_type(header), m_version(version), m_data_source_exists(false)
+                : header_type(header),
+                  m_version(version),
+                  m_data_source_exists(false),
+                  m_secondary_index_valid(false)
         { }
 
         /** Constructor
@@ -112,7 +190,8 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
                 header_type(header),
                 m_data(vec),
                 m_version(version),
-                m_data_source_exists(false)
+                m_data_source_exists(false),
+                m_secondary_index_valid(false)
         {
             rebuild_index(true);
         }
@@ -159,6 +238,24 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         {
             m_data_source_exists = exists;
         }
+        /** Get the filter applied to each record as it is read
+         *
+         * @return record filter
+         */
+        const record_filter& read_filter()const
+        {
+            return m_read_filter;
+        }
+        /** Set the filter applied to each record as it is read
+         *
+         * The filter is kept when the metric set is cleared.
+         *
+         * @param filter record filter
+         */
+        void read_filter(const record_filter& filter)
+        {
+            m_read_filter = filter;
+        }
         /** Get start of metric collection
          *
          * @return iterator to start of metric collection
@@ -200,6 +297,7 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         void sort()
         {
+            clear_secondary_index();
             std::sort(m_data.begin(), m_data.end());
         }
 
@@ -209,9 +307,11 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          * @note This function clears the lookup table for most metrics if update_ids is false (exceptions are Tile and DynamicPhasing
          *
          * @param update_ids rebuild the lookup table with new ids
+         * @param shrink release unused capacity in the metric vector
          */
-        void rebuild_index(const bool update_ids=false)
+        void rebuild_index(const bool update_ids=false, const bool shrink=true)
         {
+            clear_secondary_index();
             size_t offset = 0;
             for (const_iterator b = begin(), e = end(); b != e; ++b)
             {
@@ -231,9 +331,23 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
             {
                 clear_lookup();
             }
+            if(shrink) shrink_to_fit();
+        }
+        /** Release unused capacity in the metric vector
+         *
+         * With C++11, the records are moved into the smaller buffer, so the data held by each record, e.g. the
+         * q-score histogram, is not copied.
+         */
+        void shrink_to_fit()
+        {
+            if(m_data.capacity() == m_data.size()) return;
+#ifdef INTEROP_HAS_UNORDERED_MAP
+            m_data.shrink_to_fit();
+#else
             metric_array_t tmp;
             tmp.assign(m_data.begin(), m_data.end());
             tmp.swap(m_data);
+#endif
         }
         /** Resize the number of places in the metric vector
          *
@@ -241,6 +355,7 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         void resize(const size_t n)
         {
+            clear_secondary_index();
             m_data.resize(n, metric_type(*this));
         }
         /** Reserve the number of places in the metric vector
@@ -257,6 +372,7 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         void trim(const size_t n)
         {
+            clear_secondary_index();
             m_data.resize(n);
         }
 
@@ -279,6 +395,7 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
             INTEROP_ASSERT(id != 0);
             // TODO: remove the following
             m_id_map[id] = size();
+            clear_secondary_index();
 
             T::header_type::update_max_cycle(metric);
             m_data.push_back(metric);
@@ -353,6 +470,7 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         void set_version(const ::int16_t version)
         {
             m_version = version;
+            m_revision.increment();
         }
 
         /** Get a list of all available lane numbers
@@ -372,9 +490,12 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         id_vector lanes() const
         {
-            id_set_t id_set;
-            std::transform(begin(), end(), std::inserter(id_set, id_set.begin()), to_lane);
-            return id_vector(id_set.begin(), id_set.end());
+            build_secondary_index();
+            id_vector lane_numbers;
+            lane_numbers.reserve(m_lane_index.size());
+            for(typename offset_index_t::const_iterator it = m_lane_index.begin();it != m_lane_index.end();++it)
+                lane_numbers.push_back(it->first);
+            return lane_numbers;
         }
 
         /** Get the number of lanes in the data
@@ -405,10 +526,7 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         id_vector tile_numbers_for_lane(const uint_t lane) const
         {
-            id_set_t tile_number_set;
-            populate_tile_numbers_for_lane(tile_number_set, lane);
-            id_vector tile_numbers(tile_number_set.begin(), tile_number_set.end());
-            return tile_numbers;
+            return lane_tile_numbers(lane);
         }
         /** Get a list of all available tile numbers for the specified lane
          *
@@ -419,11 +537,8 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         void populate_tile_numbers_for_lane(id_set_t& tile_number_set, const uint_t lane) const
         {
-            transform_if(begin(),
-                         end(),
-                         std::inserter(tile_number_set, tile_number_set.begin()),
-                         lane_equals(lane),
-                         to_tile);
+            const id_vector& tile_numbers = lane_tile_numbers(lane);
+            tile_number_set.insert(tile_numbers.begin(), tile_numbers.end());
         }
         /** Get a list of all available tile numbers for the specified lane
          *
@@ -439,11 +554,38 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
                                                     const uint_t surface,
                                                     const constants::tile_naming_method naming_convention) const
         {
-            transform_if(begin(),
-                         end(),
-                         std::inserter(tile_number_set, tile_number_set.begin()),
-                         lane_surface_equals(lane, surface, naming_convention),
-                         to_tile);
+            const id_vector& tile_numbers = lane_surface_tile_numbers(lane, surface, naming_convention);
+            tile_number_set.insert(tile_numbers.begin(), tile_numbers.end());
+        }
+        /** Get the sorted tile numbers for the specified lane
+         *
+         * @note The lookup is built on first use under a lock, so this may be called concurrently
+         * @param lane lane number
+         * @return reference to vector of tile numbers, valid until the metric set is modified
+         */
+        const id_vector& lane_tile_numbers(const uint_t lane) const
+        {
+            build_secondary_index();
+            typename tile_index_t::const_iterator it = m_lane_tile_index.find(lane);
+            if(it == m_lane_tile_index.end()) return m_empty_ids;
+            return it->second;
+        }
+        /** Get the sorted tile numbers for the specified lane and surface
+         *
+         * @note The lookup is built on first use under a lock, so this may be called concurrently
+         * @param lane lane number
+         * @param surface surface number
+         * @param naming_convention tile naming convetion enum
+         * @return reference to vector of tile numbers, valid until the metric set is modified
+         */
+        const id_vector& lane_surface_tile_numbers(const uint_t lane,
+                                                   const uint_t surface,
+                                                   const constants::tile_naming_method naming_convention) const
+        {
+            const surface_tile_index_t& index = build_surface_index(naming_convention);
+            typename surface_tile_index_t::const_iterator it = index.find(std::make_pair(lane, surface));
+            if(it == index.end()) return m_empty_ids;
+            return it->second;
         }
 
         /** Get a list of all available tile numbers
@@ -480,12 +622,36 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
          */
         void metrics_for_lane(metric_array_t& lane_metrics, const uint_t lane) const
         {
-            lane_metrics.reserve(size());
-            copy_if(begin(),
-                    end(),
-                    std::back_inserter(lane_metrics),
-                    lane_equals(lane));
-            metric_array_t(lane_metrics).swap(lane_metrics); // Shrink to fit
+            const metric_view_t view = lane_view(lane);
+            lane_metrics.reserve(lane_metrics.size() + view.size());
+            lane_metrics.insert(lane_metrics.end(), view.begin(), view.end());
+        }
+        /** Get a view of the metrics for the specified lane
+         *
+         * @note The lookup is built on first use under a lock, so this may be called concurrently
+         * @param lane lane number
+         * @return view of the metrics, valid until the metric set is modified
+         */
+        metric_view_t lane_view(const uint_t lane) const
+        {
+            build_secondary_index();
+            typename offset_index_t::const_iterator it = m_lane_index.find(lane);
+            if(it == m_lane_index.end()) return metric_view_t();
+            return metric_view_t(m_data, it->second);
+        }
+        /** Get a view of the metrics for the specified cycle
+         *
+         * @note Returns an empty view for metrics that do not have a cycle identifier
+         * @note The lookup is built on first use under a lock, so this may be called concurrently
+         * @param cycle cycle number
+         * @return view of the metrics, valid until the metric set is modified
+         */
+        metric_view_t cycle_view(const uint_t cycle) const
+        {
+            build_secondary_index();
+            typename offset_index_t::const_iterator it = m_cycle_index.find(cycle);
+            if(it == m_cycle_index.end()) return metric_view_t();
+            return metric_view_t(m_data, it->second);
         }
 
         /** Get a list of all cycles listed in the metric set
@@ -536,6 +702,27 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         {
             return m_version;
         }
+        /** Get the revision of the records
+         *
+         * The revision changes whenever records are added, removed, reordered or cleared through this class. It does
+         * not track values changed in place through a reference to a record.
+         *
+         * @return revision number
+         */
+        size_t revision() const
+        {
+            return m_revision.value();
+        }
+        /** Append the size, version and revision of the set to a key of data derived from it
+         *
+         * @param key destination key
+         */
+        void append_source_key(std::vector<size_t>& key) const
+        {
+            key.push_back(size());
+            key.push_back(static_cast<size_t>(m_version));
+            key.push_back(revision());
+        }
 
         /** Clear the metrics in the metric set
          */
@@ -581,6 +768,14 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         {
             return m_id_map;
         }
+        /** Get the current id offset map
+         *
+         * @return id offset map
+         */
+        const offset_map_t& offset_map()const
+        {
+            return m_id_map;
+        }
 
     public:
         /** Get metric for lane, tile and cycle
@@ -735,19 +930,14 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         void clear_lookup()
         {
             INTEROP_CLEAR_MAP(m_id_map);
+            clear_secondary_index();
         }
 
     private:
         metric_array_t metrics_for_cycle(const uint_t cycle, const constants::base_cycle_t*) const
         {
-            metric_array_t cycle_metrics;
-            cycle_metrics.reserve(size());
-            copy_if(begin(),
-                    end(),
-                    std::back_inserter(cycle_metrics),
-                    cycle_equals(cycle));
-            metric_array_t(cycle_metrics).swap(cycle_metrics); // Shrink to fit
-            return cycle_metrics;
+            const metric_view_t view = cycle_view(cycle);
+            return metric_array_t(view.begin(), view.end());
         }
 
         metric_array_t metrics_for_cycle(const uint_t, const void *) const
@@ -756,6 +946,62 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         }
 
 
+    private:
+        void clear_secondary_index()
+        {
+            m_revision.increment();
+            if(!m_secondary_index_valid && m_lane_surface_tile_index.empty()) return;
+            m_lane_index.clear();
+            m_cycle_index.clear();
+            m_lane_tile_index.clear();
+            m_lane_surface_tile_index.clear();
+            m_secondary_index_valid = false;
+        }
+
+        void build_secondary_index() const
+        {
+            util::scoped_lock lock(m_index_mutex);
+            if(m_secondary_index_valid) return;
+            std::map<uint_t, id_set_t> tile_number_sets;
+            size_t offset = 0;
+            for (const_iterator b = begin(), e = end(); b != e; ++b, ++offset)
+            {
+                const uint_t lane = to_lane(*b);
+                m_lane_index[lane].push_back(offset);
+                tile_number_sets[lane].insert(to_tile(*b));
+                index_cycle(*b, offset, base_t::null());
+            }
+            for(typename std::map<uint_t, id_set_t>::const_iterator it = tile_number_sets.begin();
+                it != tile_number_sets.end();++it)
+                m_lane_tile_index[it->first].assign(it->second.begin(), it->second.end());
+            m_secondary_index_valid = true;
+        }
+
+        const surface_tile_index_t& build_surface_index(const constants::tile_naming_method naming_convention) const
+        {
+            // Each naming method has its own lookup, so building one never moves a lookup another reader holds
+            util::scoped_lock lock(m_index_mutex);
+            typename naming_surface_index_t::iterator found = m_lane_surface_tile_index.find(naming_convention);
+            if(found != m_lane_surface_tile_index.end()) return found->second;
+            surface_tile_index_t& index = m_lane_surface_tile_index[naming_convention];
+            std::map<std::pair<uint_t, uint_t>, id_set_t> tile_number_sets;
+            for (const_iterator b = begin(), e = end(); b != e; ++b)
+                tile_number_sets[std::make_pair(b->lane(), b->surface(naming_convention))].insert(to_tile(*b));
+            for(typename std::map<std::pair<uint_t, uint_t>, id_set_t>::const_iterator it = tile_number_sets.begin();
+                it != tile_number_sets.end();++it)
+                index[it->first].assign(it->second.begin(), it->second.end());
+            return index;
+        }
+
+        void index_cycle(const metric_type& metric, const size_t offset, const constants::base_cycle_t*) const
+        {
+            m_cycle_index[metric.cycle()].push_back(offset);
+        }
+
+        void index_cycle(const metric_type&, const size_t, const void *) const
+        {
+        }
+
     private:
         static id_t to_id(const metric_type &metric)
         {
@@ -779,19 +1025,15 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
 
         void cycles(id_set_t& cycles_set, const constants::base_cycle_t*) const
         {
-            std::transform(begin(), end(), std::inserter(cycles_set, cycles_set.begin()), to_cycle);
+            build_secondary_index();
+            for(typename offset_index_t::const_iterator it = m_cycle_index.begin();it != m_cycle_index.end();++it)
+                cycles_set.insert(cycles_set.end(), it->first);
         }
 
         void cycles(id_set_t&, const void *) const
         {
         }
 
-        static uint_t to_cycle(const metric_type &metric)
-        {
-            //TODO: ensure that this isn't called from a non-base_cycle metric set?
-            return metric.cycle();
-        }
-
         template<class I, class OIterator, class Operation>
         static OIterator transform(I beg, I end, OIterator it, Operation op)
         {
@@ -803,72 +1045,6 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
             return it;
         }
 
-        template<class I, class OIterator, class Predicate, class Operation>
-        static OIterator transform_if(I beg, I end, OIterator it, Predicate pred, Operation op)
-        {
-            while (beg != end)
-            {
-                if (pred(*beg))
-                    *it++ = op(*beg);
-                ++beg;
-            }
-            return it;
-        }
-
-        template<class OIterator, class Predicate>
-        static OIterator copy_if(const_iterator beg, const_iterator end, OIterator it, Predicate pred)
-        {
-            while (beg != end)
-            {
-                if (pred(*beg))
-                    *it++ = *beg;
-                ++beg;
-            }
-            return it;
-        }
-
-        struct lane_equals
-        {
-            lane_equals(const uint_t lane) : m_lane(lane)
-            { }
-
-            bool operator()(const metric_type &metric) const
-            { return metric_comparison_t::to_lane(metric) == m_lane; }
-
-            const uint_t m_lane;
-        };
-        struct lane_surface_equals
-        {
-            lane_surface_equals(const uint_t lane,
-                                const uint_t surface,
-                                const constants::tile_naming_method naming_convention) :
-                    m_lane(lane), m_surface(surface), m_naming_convention(naming_convention)
-            { }
-
-            bool operator()(const metric_type &metric) const
-            { return check(metric, base_t::null());}
-
-            bool check(const metric_type& metric, const void *)const
-            {
-                return metric.lane() == m_lane && metric.surface(m_naming_convention) == m_surface;
-            }
-
-            const uint_t m_lane;
-            const uint_t m_surface;
-            const constants::tile_naming_method m_naming_convention;
-        };
-
-        struct cycle_equals
-        {
-            cycle_equals(uint_t cycle) : m_cycle(cycle)
-            { }
-
-            bool operator()(const metric_type &metric) const
-            { return metric.cycle() == m_cycle; }
-
-            uint_t m_cycle;
-        };
-
     protected:
         /** Array of metric data */
         metric_array_t m_data;
@@ -876,10 +1052,23 @@ namespace illumina { namespace interop { namespace model { namespace metric_base
         ::int16_t m_version;
         /** Does the file or other source exist */
         bool m_data_source_exists;
+        /** Filter applied to each record as it is read */
+        record_filter m_read_filter;
 
         // TODO: remove the following
         /** Map unique identifiers to the index of the metric */
         offset_map_t m_id_map;
+
+    private:
+        // Secondary lookups built on first use, cleared whenever the metric array changes
+        mutable offset_index_t m_lane_index;
+        mutable offset_index_t m_cycle_index;
+        mutable tile_index_t m_lane_tile_index;
+        mutable naming_surface_index_t m_lane_surface_tile_index;
+        mutable bool m_secondary_index_valid;
+        mutable util::member_mutex m_index_mutex;
+        metric_set_revision m_revision;
+        id_vector m_empty_ids;
     };
 
     template<class Metric, class Type>
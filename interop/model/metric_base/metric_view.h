@@ -0,0 +1,194 @@
+/** Non-owning view over a subset of metrics in a metric set
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <iterator>
+#include "interop/util/assert.h"
+
+namespace illumina { namespace interop { namespace model { namespace metric_base
+{
+    /** View of selected metrics in a metric set
+     *
+     * The view holds pointers to the metric array and a list of offsets into it. It does not copy any
+     * metric and is only valid until the metric set it was taken from is modified.
+     */
+    template<typename T>
+    class metric_view
+    {
+    public:
+        /** Define a collection of metrics */
+        typedef std::vector<T> metric_array_t;
+        /** Define a collection of offsets */
+        typedef std::vector<size_t> offset_vector_t;
+        /** Define a metric type */
+        typedef T metric_type;
+        /** Define a constant reference to a metric */
+        typedef const T& const_reference;
+        /** Define the size type */
+        typedef size_t size_type;
+
+    public:
+        /** Constant iterator over the metrics in the view
+         */
+        class const_iterator
+        {
+        public:
+            /** Iterator category */
+            typedef std::forward_iterator_tag iterator_category;
+            /** Value type */
+            typedef T value_type;
+            /** Difference type */
+            typedef std::ptrdiff_t difference_type;
+            /** Pointer type */
+            typedef const T* pointer;
+            /** Reference type */
+            typedef const T& reference;
+
+        public:
+            /** Constructor
+             */
+            const_iterator() : m_data(0), m_it(0)
+            {
+            }
+            /** Constructor
+             *
+             * @param data metric array
+             * @param it pointer to offset
+             */
+            const_iterator(const metric_array_t* data, const size_t* it) : m_data(data), m_it(it)
+            {
+            }
+
+        public:
+            /** Get the current metric
+             *
+             * @return metric
+             */
+            reference operator*() const
+            {
+                return (*m_data)[*m_it];
+            }
+            /** Get the current metric
+             *
+             * @return pointer to metric
+             */
+            pointer operator->() const
+            {
+                return &(*m_data)[*m_it];
+            }
+            /** Advance to the next metric
+             *
+             * @return this iterator
+             */
+            const_iterator& operator++()
+            {
+                ++m_it;
+                return *this;
+            }
+            /** Advance to the next metric
+             *
+             * @return copy of the iterator before advancing
+             */
+            const_iterator operator++(int)
+            {
+                const_iterator tmp(*this);
+                ++m_it;
+                return tmp;
+            }
+            /** Test if two iterators point to the same metric
+             *
+             * @param other other iterator
+             * @return true if both iterators are at the same position
+             */
+            bool operator==(const const_iterator& other) const
+            {
+                return m_it == other.m_it;
+            }
+            /** Test if two iterators point to different metrics
+             *
+             * @param other other iterator
+             * @return true if the iterators are at different positions
+             */
+            bool operator!=(const const_iterator& other) const
+            {
+                return m_it != other.m_it;
+            }
+
+        private:
+            const metric_array_t* m_data;
+            const size_t* m_it;
+        };
+
+    public:
+        /** Constructor
+         */
+        metric_view() : m_data(0), m_offsets(0)
+        {
+        }
+        /** Constructor
+         *
+         * @param data metric array
+         * @param offsets offsets of the selected metrics
+         */
+        metric_view(const metric_array_t& data, const offset_vector_t& offsets) : m_data(&data), m_offsets(&offsets)
+        {
+        }
+
+    public:
+        /** Get the number of metrics in the view
+         *
+         * @return number of metrics
+         */
+        size_t size() const
+        {
+            return m_offsets == 0 ? 0 : m_offsets->size();
+        }
+        /** Test if the view is empty
+         *
+         * @return true if there are no metrics
+         */
+        bool empty() const
+        {
+            return size() == 0;
+        }
+        /** Get the metric at the given index
+         *
+         * @param n index
+         * @return metric
+         */
+        const_reference operator[](const size_t n) const
+        {
+            INTEROP_ASSERT(n < size());
+            return (*m_data)[(*m_offsets)[n]];
+        }
+        /** Get iterator to the first metric
+         *
+         * @return iterator to the first metric
+         */
+        const_iterator begin() const
+        {
+            if (empty()) return const_iterator();
+            return const_iterator(m_data, &(*m_offsets)[0]);
+        }
+        /** Get iterator to one past the last metric
+         *
+         * @return iterator to one past the last metric
+         */
+        const_iterator end() const
+        {
+            if (empty()) return const_iterator();
+            return const_iterator(m_data, &(*m_offsets)[0] + m_offsets->size());
+        }
+
+    private:
+        const metric_array_t* m_data;
+        const offset_vector_t* m_offsets;
+    };
+}}}}
@@ -0,0 +1,181 @@
+/** Filter applied to the id of each record while reading an InterOp file
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "interop/util/cstdint.h"
+#include "interop/constants/typedefs.h"
+#include "interop/model/metric_base/base_metric.h"
+
+namespace illumina { namespace interop { namespace model { namespace metric_base
+{
+    /** Select records by lane, tile and cycle before the body of the record is decoded
+     *
+     * A value of 0 means the corresponding part of the id is not filtered. The cycle range only applies
+     * to metrics organized by cycle, and no part of the filter applies to metrics that describe the whole run.
+     * A list of lane/tile ids selects a sample of tiles, and does not apply to metrics that describe a lane.
+     */
+    class record_filter
+    {
+    public:
+        /** Define a lane/tile/cycle id type */
+        typedef ::uint32_t uint_t;
+        /** Define a unique lane/tile id type */
+        typedef base_metric::id_t id_t;
+        /** Define a vector of lane/tile ids */
+        typedef std::vector<id_t> id_vector;
+
+    public:
+        /** Constructor
+         *
+         * @param lane selected lane, 0 for all lanes
+         * @param tile selected tile id, 0 for all tiles
+         * @param first_cycle first selected cycle, 0 for no lower bound
+         * @param last_cycle last selected cycle, 0 for no upper bound
+         * @param max_tile_number largest selected tile number within a swath, 0 for no bound
+         */
+        record_filter(const uint_t lane=0,
+                      const uint_t tile=0,
+                      const uint_t first_cycle=0,
+                      const uint_t last_cycle=0,
+                      const uint_t max_tile_number=0) :
+                m_lane(lane),
+                m_tile(tile),
+                m_first_cycle(first_cycle),
+                m_last_cycle(last_cycle),
+                m_max_tile_number(max_tile_number)
+        {
+        }
+        /** Constructor
+         *
+         * @param tile_ids selected lane/tile ids, created with base_metric::create_id
+         */
+        explicit record_filter(const id_vector& tile_ids) :
+                m_lane(0),
+                m_tile(0),
+                m_first_cycle(0),
+                m_last_cycle(0),
+                m_max_tile_number(0),
+                m_tile_ids(tile_ids)
+        {
+            std::sort(m_tile_ids.begin(), m_tile_ids.end());
+            m_tile_ids.erase(std::unique(m_tile_ids.begin(), m_tile_ids.end()), m_tile_ids.end());
+        }
+
+    public:
+        /** Test if the record with the given id should be read
+         *
+         * @param metric metric holding the id of the record
+         * @return true if the record should be read
+         */
+        template<class Metric>
+        bool operator()(const Metric& metric) const
+        {
+            return accept(metric, Metric::base_t::null());
+        }
+        /** Test if any part of the id is filtered
+         *
+         * @return true if a record could be skipped
+         */
+        bool is_active() const
+        {
+            return m_lane > 0 || m_tile > 0 || m_first_cycle > 0 || m_last_cycle > 0 || m_max_tile_number > 0 ||
+                   !m_tile_ids.empty();
+        }
+
+    public:
+        /** Get the selected lane
+         *
+         * @return selected lane, 0 for all lanes
+         */
+        uint_t lane() const
+        {
+            return m_lane;
+        }
+        /** Get the selected tile id
+         *
+         * @return selected tile id, 0 for all tiles
+         */
+        uint_t tile() const
+        {
+            return m_tile;
+        }
+        /** Get the first selected cycle
+         *
+         * @return first selected cycle, 0 for no lower bound
+         */
+        uint_t first_cycle() const
+        {
+            return m_first_cycle;
+        }
+        /** Get the last selected cycle
+         *
+         * @return last selected cycle, 0 for no upper bound
+         */
+        uint_t last_cycle() const
+        {
+            return m_last_cycle;
+        }
+        /** Get the largest selected tile number
+         *
+         * @return largest selected tile number within a swath, 0 for no bound
+         */
+        uint_t max_tile_number() const
+        {
+            return m_max_tile_number;
+        }
+        /** Get the selected lane/tile ids
+         *
+         * @return sorted lane/tile ids, empty for all tiles
+         */
+        const id_vector& tile_ids() const
+        {
+            return m_tile_ids;
+        }
+
+    private:
+        template<class Metric>
+        bool accept(const Metric& metric, const constants::base_cycle_t*) const
+        {
+            if (m_first_cycle > 0 && metric.cycle() < m_first_cycle) return false;
+            if (m_last_cycle > 0 && metric.cycle() > m_last_cycle) return false;
+            return accept(metric, static_cast<const void*>(0));
+        }
+        template<class Metric>
+        bool accept(const Metric& metric, const constants::base_lane_t*) const
+        {
+            return m_lane == 0 || metric.lane() == m_lane;
+        }
+        template<class Metric>
+        bool accept(const Metric&, const constants::base_run_t*) const
+        {
+            return true;
+        }
+        template<class Metric>
+        bool accept(const Metric& metric, const void*) const
+        {
+            if (m_lane > 0 && metric.lane() != m_lane) return false;
+            if (m_tile > 0 && metric.tile() != m_tile) return false;
+            if (!m_tile_ids.empty() && !std::binary_search(m_tile_ids.begin(),
+                                                           m_tile_ids.end(),
+                                                           base_metric::create_id(metric.lane(), metric.tile())))
+                return false;
+            // The tile number does not depend on the tile naming method
+            return m_max_tile_number == 0 || metric.number(constants::UnknownTileNamingMethod) <= m_max_tile_number;
+        }
+
+    private:
+        uint_t m_lane;
+        uint_t m_tile;
+        uint_t m_first_cycle;
+        uint_t m_last_cycle;
+        uint_t m_max_tile_number;
+        id_vector m_tile_ids;
+    };
+}}}}
@@ -25,6 +25,7 @@
 #include <fstream>
 #include "interop/util/math.h"
 #include "interop/util/exception.h"
+#include "interop/util/fixed_vector.h"
 #include "interop/constants/enums.h"
 #include "interop/io/format/generic_layout.h"
 #include "interop/model/metric_base/metric_set.h"
@@ -60,6 +61,17 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         /** Define a diffference type
          */
         typedef ::intptr_t difference_type;
+#ifdef INTEROP_INLINE_CHANNEL_STORAGE
+        /** Define a uint16_t array using inline storage
+         */
+        typedef util::fixed_vector<ushort_t, constants::NUM_OF_BASES> ushort_array_t;
+        /** Define a uint array using inline storage
+         */
+        typedef util::fixed_vector<uint_t, constants::NUM_OF_BASES_AND_NC> uint_array_t;
+        /** Define a float array using inline storage
+         */
+        typedef util::fixed_vector<float, constants::NUM_OF_BASES> float_array_t;
+#else
         /** Define a uint16_t array using an underlying vector
          */
         typedef std::vector<ushort_t> ushort_array_t;
@@ -69,6 +81,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         /** Define a float array using an underlying vector
          */
         typedef std::vector<float> float_array_t;
+#endif
         /** Define a uint16_t pointer to a uint16_t array
          */
         typedef ::uint16_t *ushort_pointer_t;
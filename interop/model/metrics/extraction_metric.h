@@ -18,6 +18,7 @@
 #include <algorithm>
 #include "interop/util/exception.h"
 #include "interop/util/time.h"
+#include "interop/util/fixed_vector.h"
 #include "interop/io/format/generic_layout.h"
 #include "interop/io/layout/base_metric.h"
 #include "interop/model/metric_base/base_cycle_metric.h"
@@ -96,12 +97,21 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         };
         /** Extraction metric header */
         typedef extraction_metric_header header_type;
+#ifdef INTEROP_INLINE_CHANNEL_STORAGE
+        /** Define a uint16_t array using inline storage
+         */
+        typedef util::fixed_vector<ushort_t, MAX_CHANNELS> ushort_array_t;
+        /** Define a float array using inline storage
+         */
+        typedef util::fixed_vector<float, MAX_CHANNELS> float_array_t;
+#else
         /** Define a uint16_t array using an underlying vector
          */
         typedef std::vector<ushort_t> ushort_array_t;
         /** Define a float array using an underlying vector
          */
         typedef std::vector<float> float_array_t;
+#endif
         /** Define a uint16_t pointer to a uint16_t array
          */
         typedef ::uint16_t *ushort_pointer_t;
@@ -15,6 +15,7 @@
 
 #include <cstring>
 #include "interop/util/exception.h"
+#include "interop/util/fixed_vector.h"
 #include "interop/io/format/generic_layout.h"
 #include "interop/io/layout/base_metric.h"
 #include "interop/model/metric_base/base_cycle_metric.h"
@@ -109,9 +110,15 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         /** Image metric header
          */
         typedef image_metric_header header_type;
+#ifdef INTEROP_INLINE_CHANNEL_STORAGE
+        /** Define a uint16_t array using inline storage
+         */
+        typedef util::fixed_vector<ushort_t, MAX_CHANNELS> ushort_array_t;
+#else
         /** Define a uint16_t array using an underlying vector
          */
         typedef std::vector<ushort_t> ushort_array_t;
+#endif
         /** Define a uint16_t pointer to a uint16_t array
          */
         typedef ::uint16_t *ushort_pointer_t;
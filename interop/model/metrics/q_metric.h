@@ -18,6 +18,7 @@
 #include <cstring>
 #include <numeric>
 #include "interop/util/exception.h"
+#include "interop/util/histogram.h"
 #include "interop/model/metric_base/base_cycle_metric.h"
 #include "interop/model/metric_base/metric_set.h"
 #include "interop/io/layout/base_metric.h"
@@ -388,7 +389,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
          */
         uint64_t sum_qscore() const
         {
-            return std::accumulate(m_qscore_hist.begin(), m_qscore_hist.end(), uint64_t(0));
+            return util::histogram_sum(m_qscore_hist.begin(), m_qscore_hist.end());
         }
 
         /** Sum the cumulative q-score histogram
@@ -397,9 +398,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
          */
         ::uint64_t sum_qscore_cumulative() const
         {
-            return std::accumulate(m_qscore_hist_cumulative.begin(),
-                                   m_qscore_hist_cumulative.end(),
-                                   static_cast< ::uint64_t >(0));
+            return util::histogram_sum(m_qscore_hist_cumulative.begin(), m_qscore_hist_cumulative.end());
         }
 
         /** Number of clusters over the given q-score
@@ -441,10 +440,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
          */
         uint64_t total_over_qscore(const size_t qscore_index) const
         {
-            uint64_t total_count = 0;
-            if(qscore_index <= m_qscore_hist.size())
-                total_count = std::accumulate(m_qscore_hist.begin() + qscore_index, m_qscore_hist.end(), uint64_t(0));
-            return total_count;
+            return util::histogram_tail_sum(m_qscore_hist.begin(), m_qscore_hist.end(), qscore_index);
         }
 
         /** Number of clusters over the given q-score
@@ -459,12 +455,9 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         ::uint64_t total_over_qscore_cumulative(const size_t qscore_index) const
         {
             INTEROP_ASSERT(m_qscore_hist_cumulative.size() > 0);
-            ::uint64_t total_count = 0;
-            if(qscore_index <= m_qscore_hist_cumulative.size())
-                total_count = std::accumulate(m_qscore_hist_cumulative.begin() + qscore_index,
-                                              m_qscore_hist_cumulative.end(),
-                                              static_cast< ::uint64_t >(0));
-            return total_count;
+            return util::histogram_tail_sum(m_qscore_hist_cumulative.begin(),
+                                            m_qscore_hist_cumulative.end(),
+                                            qscore_index);
         }
 
         /** Percent of clusters over the given q-score
@@ -586,19 +579,11 @@ namespace illumina { namespace interop { namespace model { namespace metrics
          */
         uint64_t median(const qscore_bin_vector_type &bins = qscore_bin_vector_type()) const
         {
-            const uint64_t total = sum_qscore();
-            const uint64_t position = total % 2 == 0 ? total / 2 + 1 : (total + 1) / 2;
-            uint_t i = 0;
-            uint64_t sum = 0;
-            for (; i < m_qscore_hist.size(); i++)
+            const size_t i = util::histogram_median_index(m_qscore_hist.begin(), m_qscore_hist.end(), sum_qscore());
+            if (i < m_qscore_hist.size())
             {
-                sum += m_qscore_hist[i];
-                if (sum >= position)
-                {
-                    if (bins.size() == 0 || m_qscore_hist.size() == MAX_Q_BINS) return i + 1;
-                    if (i < bins.size()) return bins[i].value();
-                    break;
-                }
+                if (bins.size() == 0 || m_qscore_hist.size() == MAX_Q_BINS) return i + 1;
+                if (i < bins.size()) return bins[i].value();
             }
             return std::numeric_limits<uint64_t>::max();
         }
@@ -0,0 +1,256 @@
+/** Q-score histograms aggregated by lane, surface and cycle
+ *
+ * The cube holds the sum of the q-score histograms over all tiles that share a lane, surface and cycle. Plots
+ * and summaries filtered only by lane and surface can slice the cube rather than walk every tile record.
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include "interop/util/cstdint.h"
+#include "interop/util/assert.h"
+
+namespace illumina { namespace interop { namespace model { namespace metrics
+{
+    /** Dense lane x surface x cycle x bin array of q-score counts
+     *
+     * Lane, surface and cycle numbers start at 1. Passing 0 (ALL) for the lane or surface of a query
+     * sums over all lanes or surfaces.
+     */
+    class q_score_cube
+    {
+    public:
+        /** Define the count type */
+        typedef ::uint64_t count_t;
+        /** Define the count vector */
+        typedef std::vector<count_t> count_vector_t;
+        /** Define the key of the data the cube was built from */
+        typedef std::vector<size_t> source_key_t;
+        enum
+        {
+            /** Select all lanes or all surfaces */
+            ALL = 0
+        };
+
+    public:
+        /** Constructor
+         */
+        q_score_cube() :
+                m_lane_count(0),
+                m_surface_count(0),
+                m_cycle_count(0),
+                m_bin_count(0),
+                m_record_count(0)
+        {
+        }
+
+    public:
+        /** Resize the cube and set all counts to 0
+         *
+         * @param lane_count number of lanes
+         * @param surface_count number of surfaces
+         * @param cycle_count number of cycles
+         * @param bin_count number of q-score bins
+         */
+        void resize(const size_t lane_count,
+                    const size_t surface_count,
+                    const size_t cycle_count,
+                    const size_t bin_count)
+        {
+            m_lane_count = lane_count;
+            m_surface_count = surface_count;
+            m_cycle_count = cycle_count;
+            m_bin_count = bin_count;
+            m_record_count = 0;
+            m_counts.assign(lane_count * surface_count * cycle_count * bin_count, 0);
+            m_record_counts.assign(lane_count * surface_count * cycle_count, 0);
+        }
+        /** Clear the cube
+         */
+        void clear()
+        {
+            m_lane_count = m_surface_count = m_cycle_count = m_bin_count = m_record_count = 0;
+            count_vector_t().swap(m_counts);
+            std::vector<size_t>().swap(m_record_counts);
+            source_key_t().swap(m_source);
+        }
+        /** Set the key of the data the cube was built from
+         *
+         * @param key key of the source data
+         */
+        void source(const source_key_t& key)
+        {
+            m_source = key;
+        }
+        /** Add a q-score histogram to the cube
+         *
+         * @param lane lane number
+         * @param surface surface number
+         * @param cycle cycle number
+         * @param beg iterator to start of the histogram
+         * @param end iterator to end of the histogram
+         */
+        template<typename I>
+        void accumulate(const size_t lane, const size_t surface, const size_t cycle, I beg, I end)
+        {
+            INTEROP_ASSERT(static_cast<size_t>(std::distance(beg, end)) <= m_bin_count);
+            count_t* hist = &m_counts[offset(lane, surface, cycle)];
+            for (; beg != end; ++beg, ++hist) *hist += *beg;
+            ++m_record_counts[cell_offset(lane, surface, cycle)];
+            ++m_record_count;
+        }
+
+    public:
+        /** Sum the histograms over a range of cycles
+         *
+         * @param lane lane number or ALL
+         * @param surface surface number or ALL
+         * @param first_cycle first cycle to include
+         * @param last_cycle last cycle to include
+         * @param hist destination histogram, resized to the number of bins
+         */
+        void sum_histogram(const size_t lane,
+                           const size_t surface,
+                           const size_t first_cycle,
+                           const size_t last_cycle,
+                           count_vector_t& hist) const
+        {
+            hist.assign(m_bin_count, 0);
+            const size_t cycle_end = std::min(last_cycle, m_cycle_count);
+            for (size_t cycle = std::max(first_cycle, static_cast<size_t>(1)); cycle <= cycle_end; ++cycle)
+                add_cycle(lane, surface, cycle, hist);
+        }
+        /** Sum the histograms of a single cycle
+         *
+         * @param lane lane number or ALL
+         * @param surface surface number or ALL
+         * @param cycle cycle number
+         * @param hist destination histogram, counts are added to existing values
+         */
+        void add_cycle(const size_t lane, const size_t surface, const size_t cycle, count_vector_t& hist) const
+        {
+            INTEROP_ASSERT(hist.size() >= m_bin_count);
+            if (cycle == 0 || cycle > m_cycle_count) return;
+            const size_t lane_beg = lane == ALL ? 1 : lane;
+            const size_t lane_end = lane == ALL ? m_lane_count : std::min(lane, m_lane_count);
+            const size_t surface_beg = surface == ALL ? 1 : surface;
+            const size_t surface_end = surface == ALL ? m_surface_count : std::min(surface, m_surface_count);
+            for (size_t l = lane_beg; l <= lane_end; ++l)
+            {
+                for (size_t s = surface_beg; s <= surface_end; ++s)
+                {
+                    const count_t* src = &m_counts[offset(l, s, cycle)];
+                    for (size_t bin = 0; bin < m_bin_count; ++bin) hist[bin] += src[bin];
+                }
+            }
+        }
+        /** Get the q-score histogram of a lane, surface and cycle
+         *
+         * @param lane lane number
+         * @param surface surface number
+         * @param cycle cycle number
+         * @return pointer to bin_count() counts
+         */
+        const count_t* histogram(const size_t lane, const size_t surface, const size_t cycle) const
+        {
+            return &m_counts[offset(lane, surface, cycle)];
+        }
+
+    public:
+        /** Test if the cube is empty
+         *
+         * @return true if no histogram was added
+         */
+        bool empty() const
+        {
+            return m_record_count == 0;
+        }
+        /** Get the number of lanes
+         *
+         * @return number of lanes
+         */
+        size_t lane_count() const
+        {
+            return m_lane_count;
+        }
+        /** Get the number of surfaces
+         *
+         * @return number of surfaces
+         */
+        size_t surface_count() const
+        {
+            return m_surface_count;
+        }
+        /** Get the number of cycles
+         *
+         * @return number of cycles
+         */
+        size_t cycle_count() const
+        {
+            return m_cycle_count;
+        }
+        /** Get the number of q-score bins
+         *
+         * @return number of q-score bins
+         */
+        size_t bin_count() const
+        {
+            return m_bin_count;
+        }
+        /** Get the number of histograms added to the cube
+         *
+         * @return number of histograms added
+         */
+        size_t record_count() const
+        {
+            return m_record_count;
+        }
+        /** Get the number of histograms added to a lane, surface and cycle
+         *
+         * @param lane lane number
+         * @param surface surface number
+         * @param cycle cycle number
+         * @return number of histograms, one for each tile with a record in the cycle
+         */
+        size_t record_count(const size_t lane, const size_t surface, const size_t cycle) const
+        {
+            return m_record_counts[cell_offset(lane, surface, cycle)];
+        }
+        /** Get the key of the data the cube was built from
+         *
+         * @return key of the source data
+         */
+        const source_key_t& source() const
+        {
+            return m_source;
+        }
+
+    private:
+        size_t offset(const size_t lane, const size_t surface, const size_t cycle) const
+        {
+            return cell_offset(lane, surface, cycle) * m_bin_count;
+        }
+        size_t cell_offset(const size_t lane, const size_t surface, const size_t cycle) const
+        {
+            INTEROP_ASSERT(lane > 0 && lane <= m_lane_count);
+            INTEROP_ASSERT(surface > 0 && surface <= m_surface_count);
+            INTEROP_ASSERT(cycle > 0 && cycle <= m_cycle_count);
+            return ((lane - 1) * m_surface_count + (surface - 1)) * m_cycle_count + (cycle - 1);
+        }
+
+    private:
+        size_t m_lane_count;
+        size_t m_surface_count;
+        size_t m_cycle_count;
+        size_t m_bin_count;
+        size_t m_record_count;
+        count_vector_t m_counts;
+        std::vector<size_t> m_record_counts;
+        source_key_t m_source;
+    };
+}}}}
@@ -0,0 +1,524 @@
+/** Tile level values aggregated from the tile, extended tile, error and q-metrics
+ *
+ * The table holds one row per lane and tile, sorted by tile id, with the values of the tile and extended tile
+ * metrics along with a dense array of per read values. Plots, summaries and tables that work on one value per
+ * tile read the rows directly rather than looking up each tile in every metric set.
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "interop/util/assert.h"
+#include "interop/model/metric_base/base_metric.h"
+
+namespace illumina { namespace interop { namespace model { namespace metrics
+{
+    /** Values of the tile and extended tile metrics of a single tile
+     *
+     * The accessors match those of tile_metric and extended_tile_metric, so the same summary and plot
+     * logic works on either.
+     */
+    class tile_aggregate : public metric_base::base_metric
+    {
+    public:
+        /** Constructor
+         *
+         * @param lane lane number
+         * @param tile tile number
+         */
+        tile_aggregate(const uint_t lane=0, const uint_t tile=0) :
+                metric_base::base_metric(lane, tile),
+                m_cluster_density(std::numeric_limits<float>::quiet_NaN()),
+                m_cluster_density_pf(std::numeric_limits<float>::quiet_NaN()),
+                m_cluster_count(std::numeric_limits<float>::quiet_NaN()),
+                m_cluster_count_pf(std::numeric_limits<float>::quiet_NaN()),
+                m_cluster_count_occupied(std::numeric_limits<float>::quiet_NaN()),
+                m_percent_occupied(std::numeric_limits<float>::quiet_NaN()),
+                m_has_tile_metric(false),
+                m_has_extended_tile_metric(false)
+        {
+        }
+
+    public:
+        /** Set the values of the tile metric
+         *
+         * @param cluster_density density of clusters for each tile (in clusters per mm2)
+         * @param cluster_density_pf density of clusters passing filter for each tile (in clusters per mm2)
+         * @param cluster_count number of clusters for each tile
+         * @param cluster_count_pf number of clusters passing filter for each tile
+         */
+        void tile_values(const float cluster_density,
+                         const float cluster_density_pf,
+                         const float cluster_count,
+                         const float cluster_count_pf)
+        {
+            m_cluster_density = cluster_density;
+            m_cluster_density_pf = cluster_density_pf;
+            m_cluster_count = cluster_count;
+            m_cluster_count_pf = cluster_count_pf;
+            m_has_tile_metric = true;
+        }
+        /** Set the values of the extended tile metric
+         *
+         * @param cluster_count_occupied number of occupied wells
+         * @param percent_occupied percent of wells occupied
+         */
+        void extended_tile_values(const float cluster_count_occupied, const float percent_occupied)
+        {
+            m_cluster_count_occupied = cluster_count_occupied;
+            m_percent_occupied = percent_occupied;
+            m_has_extended_tile_metric = true;
+        }
+
+    public:
+        /** Test if the tile has a tile metric
+         *
+         * @return true if the tile values were set
+         */
+        bool has_tile_metric() const
+        { return m_has_tile_metric; }
+        /** Test if the tile has an extended tile metric
+         *
+         * @return true if the extended tile values were set
+         */
+        bool has_extended_tile_metric() const
+        { return m_has_extended_tile_metric; }
+        /** Density of clusters for each tile (in clusters per mm2)
+         *
+         * @return density of clusters
+         */
+        float cluster_density() const
+        { return m_cluster_density; }
+        /** Density of clusters for each tile (in thousands of clusters per mm2)
+         *
+         * @return density of clusters in K/mm2
+         */
+        float cluster_density_k() const
+        { return m_cluster_density/1000.0f; }
+        /** Density of clusters passing filter for each tile (in clusters per mm2)
+         *
+         * @return density of clusters passing filter
+         */
+        float cluster_density_pf() const
+        { return m_cluster_density_pf; }
+        /** Density of clusters passing filter for each tile (in thousands of clusters per mm2)
+         *
+         * @return density of clusters passing filter in K/mm2
+         */
+        float cluster_density_pf_k() const
+        { return m_cluster_density_pf/1000.0f; }
+        /** Number of clusters for each tile
+         *
+         * @return number of clusters
+         */
+        float cluster_count() const
+        { return m_cluster_count; }
+        /** Number of clusters for each tile (in thousands)
+         *
+         * @return number of clusters in K
+         */
+        float cluster_count_k() const
+        { return m_cluster_count/1000.0f; }
+        /** Number of clusters for each tile (in millions)
+         *
+         * @return number of clusters in millions
+         */
+        float cluster_count_m() const
+        { return m_cluster_count/1000000.0f; }
+        /** Number of clusters passing filter for each tile
+         *
+         * @return number of clusters passing filter
+         */
+        float cluster_count_pf() const
+        { return m_cluster_count_pf; }
+        /** Number of clusters passing filter for each tile (in thousands)
+         *
+         * @return number of clusters passing filter in K
+         */
+        float cluster_count_pf_k() const
+        { return m_cluster_count_pf/1000.0f; }
+        /** Number of clusters passing filter for each tile (in millions)
+         *
+         * @return number of clusters passing filter in millions
+         */
+        float cluster_count_pf_m() const
+        { return m_cluster_count_pf/1000000.0f; }
+        /** Percent of clusters passing filter
+         *
+         * @return percent of clusters passing filter
+         */
+        float percent_pf() const
+        { return 100 * m_cluster_count_pf / m_cluster_count; }
+        /** Number of occupied wells
+         *
+         * @return number of occupied wells
+         */
+        float cluster_count_occupied() const
+        { return m_cluster_count_occupied; }
+        /** Number of occupied wells (in thousands)
+         *
+         * @return number of occupied wells in K
+         */
+        float cluster_count_occupied_k() const
+        { return m_cluster_count_occupied / 1000; }
+        /** Percent of wells occupied
+         *
+         * @return percent of wells occupied
+         */
+        float percent_occupied() const
+        { return m_percent_occupied; }
+
+    private:
+        float m_cluster_density;
+        float m_cluster_density_pf;
+        float m_cluster_count;
+        float m_cluster_count_pf;
+        float m_cluster_count_occupied;
+        float m_percent_occupied;
+        bool m_has_tile_metric;
+        bool m_has_extended_tile_metric;
+    };
+
+    /** Values of a single read of a single tile
+     *
+     * Each value is NaN when the tile has no data for the read.
+     */
+    class tile_read_aggregate
+    {
+    public:
+        /** Constructor */
+        tile_read_aggregate() :
+                m_percent_aligned(std::numeric_limits<float>::quiet_NaN()),
+                m_percent_phasing(std::numeric_limits<float>::quiet_NaN()),
+                m_percent_prephasing(std::numeric_limits<float>::quiet_NaN()),
+                m_error_rate(std::numeric_limits<float>::quiet_NaN()),
+                m_percent_over_q30(std::numeric_limits<float>::quiet_NaN())
+        {
+        }
+
+    public:
+        /** Set the values of the read metric of the tile metric
+         *
+         * @param percent_aligned percent of clusters aligned to PhiX
+         * @param percent_phasing percent of clusters phasing
+         * @param percent_prephasing percent of clusters prephasing
+         */
+        void read_values(const float percent_aligned, const float percent_phasing, const float percent_prephasing)
+        {
+            m_percent_aligned = percent_aligned;
+            m_percent_phasing = percent_phasing;
+            m_percent_prephasing = percent_prephasing;
+        }
+        /** Set the mean error rate over the cycles of the read
+         *
+         * @param rate mean error rate
+         */
+        void error_rate(const float rate)
+        { m_error_rate = rate; }
+        /** Set the percent of bases with a q-score of 30 or more over the cycles of the read
+         *
+         * @param percent percent of bases over Q30
+         */
+        void percent_over_q30(const float percent)
+        { m_percent_over_q30 = percent; }
+
+    public:
+        /** Percent aligned for the read
+         *
+         * @return percent aligned
+         */
+        float percent_aligned() const
+        { return m_percent_aligned; }
+        /** Percent phasing for the read
+         *
+         * @return percent phasing
+         */
+        float percent_phasing() const
+        { return m_percent_phasing; }
+        /** Percent prephasing for the read
+         *
+         * @return percent prephasing
+         */
+        float percent_prephasing() const
+        { return m_percent_prephasing; }
+        /** Mean error rate over the cycles of the read, excluding the last cycle
+         *
+         * @return mean error rate
+         */
+        float error_rate() const
+        { return m_error_rate; }
+        /** Percent of bases with a q-score of 30 or more over the cycles of the read, excluding the last cycle
+         *
+         * @return percent of bases over Q30
+         */
+        float percent_over_q30() const
+        { return m_percent_over_q30; }
+
+    private:
+        float m_percent_aligned;
+        float m_percent_phasing;
+        float m_percent_prephasing;
+        float m_error_rate;
+        float m_percent_over_q30;
+    };
+
+    /** Table with one row of aggregated values per lane and tile
+     *
+     * Rows are sorted by tile id. The per read values of each row are stored contiguously in a single array
+     * indexed by row and read.
+     */
+    class tile_aggregate_table
+    {
+    public:
+        /** Define the row vector */
+        typedef std::vector<tile_aggregate> tile_vector_t;
+        /** Define the key of the data the table was built from */
+        typedef std::vector<size_t> source_key_t;
+        /** Define the read vector */
+        typedef std::vector<tile_read_aggregate> read_vector_t;
+        /** Constant iterator over the rows */
+        typedef tile_vector_t::const_iterator const_iterator;
+        /** Tile id type */
+        typedef metric_base::base_metric::id_t id_t;
+
+    public:
+        /** Constructor
+         */
+        tile_aggregate_table() :
+                m_read_count(0),
+                m_lane_count(0),
+                m_tile_metric_count(0),
+                m_extended_tile_metric_count(0)
+        {
+        }
+
+    public:
+        /** Assign the tiles of the table
+         *
+         * All values are set to NaN.
+         *
+         * @param tiles tile rows sorted by tile id
+         * @param read_count number of reads
+         */
+        void assign(const tile_vector_t& tiles, const size_t read_count)
+        {
+            m_tiles = tiles;
+            m_read_count = read_count;
+            m_reads.assign(tiles.size() * read_count, tile_read_aggregate());
+            m_lane_count = 0;
+            for (const_iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
+                m_lane_count = std::max(m_lane_count, static_cast<size_t>(it->lane()));
+            m_tile_metric_count = 0;
+            m_extended_tile_metric_count = 0;
+        }
+        /** Clear the table
+         */
+        void clear()
+        {
+            tile_vector_t().swap(m_tiles);
+            read_vector_t().swap(m_reads);
+            m_read_count = m_lane_count = m_tile_metric_count = m_extended_tile_metric_count = 0;
+            source_key_t().swap(m_source);
+        }
+        /** Set the number of tile and extended tile metrics and the key of the data the table was built from
+         *
+         * @param tile_metric_count number of tile metrics
+         * @param extended_tile_metric_count number of extended tile metrics
+         * @param key key of the source data
+         */
+        void source(const size_t tile_metric_count, const size_t extended_tile_metric_count, const source_key_t& key)
+        {
+            m_tile_metric_count = tile_metric_count;
+            m_extended_tile_metric_count = extended_tile_metric_count;
+            m_source = key;
+        }
+
+    public:
+        /** Find the row of a tile
+         *
+         * @param lane lane number
+         * @param tile tile number
+         * @return index of the row, or size() if the tile is not in the table
+         */
+        size_t find(const id_t lane, const id_t tile) const
+        {
+            return find(metric_base::base_metric::create_id(lane, tile));
+        }
+        /** Find the row of a tile
+         *
+         * @param id tile id
+         * @return index of the row, or size() if the tile is not in the table
+         */
+        size_t find(const id_t id) const
+        {
+            const_iterator it = std::lower_bound(m_tiles.begin(), m_tiles.end(), id, less_id);
+            if (it == m_tiles.end() || it->id() != id) return m_tiles.size();
+            return static_cast<size_t>(std::distance(m_tiles.begin(), it));
+        }
+        /** Get the values of a tile
+         *
+         * @param row index of the row
+         * @return tile values
+         */
+        const tile_aggregate& operator[](const size_t row) const
+        {
+            INTEROP_ASSERT(row < m_tiles.size());
+            return m_tiles[row];
+        }
+        /** Get the values of a tile
+         *
+         * @param row index of the row
+         * @return tile values
+         */
+        tile_aggregate& operator[](const size_t row)
+        {
+            INTEROP_ASSERT(row < m_tiles.size());
+            return m_tiles[row];
+        }
+        /** Get the values of a read of a tile
+         *
+         * @param row index of the row
+         * @param read read number, starting at 1
+         * @return read values
+         */
+        const tile_read_aggregate& read(const size_t row, const size_t read) const
+        {
+            return m_reads[read_offset(row, read)];
+        }
+        /** Get the values of a read of a tile
+         *
+         * @param row index of the row
+         * @param read read number, starting at 1
+         * @return read values
+         */
+        tile_read_aggregate& read(const size_t row, const size_t read)
+        {
+            return m_reads[read_offset(row, read)];
+        }
+        /** Get the percent aligned of a read of a tile
+         *
+         * @param row index of the row
+         * @param read read number, starting at 1
+         * @return percent aligned or NaN if the read is not in the table
+         */
+        float percent_aligned_at(const size_t row, const size_t read) const
+        {
+            return has_read(read) ? this->read(row, read).percent_aligned() : std::numeric_limits<float>::quiet_NaN();
+        }
+        /** Get the percent phasing of a read of a tile
+         *
+         * @param row index of the row
+         * @param read read number, starting at 1
+         * @return percent phasing or NaN if the read is not in the table
+         */
+        float percent_phasing_at(const size_t row, const size_t read) const
+        {
+            return has_read(read) ? this->read(row, read).percent_phasing() : std::numeric_limits<float>::quiet_NaN();
+        }
+        /** Get the percent prephasing of a read of a tile
+         *
+         * @param row index of the row
+         * @param read read number, starting at 1
+         * @return percent prephasing or NaN if the read is not in the table
+         */
+        float percent_prephasing_at(const size_t row, const size_t read) const
+        {
+            return has_read(read) ?
+                   this->read(row, read).percent_prephasing() : std::numeric_limits<float>::quiet_NaN();
+        }
+        /** Test if the table holds values for a read
+         *
+         * @param read read number, starting at 1
+         * @return true if 0 < read <= read_count()
+         */
+        bool has_read(const size_t read) const
+        {
+            return read > 0 && read <= m_read_count;
+        }
+
+    public:
+        /** Get iterator to the first row
+         *
+         * @return iterator to the first row
+         */
+        const_iterator begin() const
+        { return m_tiles.begin(); }
+        /** Get iterator to the end of the rows
+         *
+         * @return iterator to the end of the rows
+         */
+        const_iterator end() const
+        { return m_tiles.end(); }
+        /** Test if the table is empty
+         *
+         * @return true if the table has no rows
+         */
+        bool empty() const
+        { return m_tiles.empty(); }
+        /** Get the number of rows
+         *
+         * @return number of rows
+         */
+        size_t size() const
+        { return m_tiles.size(); }
+        /** Get the number of reads
+         *
+         * @return number of reads
+         */
+        size_t read_count() const
+        { return m_read_count; }
+        /** Get the largest lane number
+         *
+         * @return largest lane number
+         */
+        size_t max_lane() const
+        { return m_lane_count; }
+        /** Get the number of tile metrics the table was built from
+         *
+         * @return number of tile metrics
+         */
+        size_t tile_metric_count() const
+        { return m_tile_metric_count; }
+        /** Get the number of extended tile metrics the table was built from
+         *
+         * @return number of extended tile metrics
+         */
+        size_t extended_tile_metric_count() const
+        { return m_extended_tile_metric_count; }
+        /** Get the key of the data the table was built from
+         *
+         * This is used to check whether the table is still in sync with the metrics.
+         *
+         * @return key of the source data
+         */
+        const source_key_t& source() const
+        { return m_source; }
+
+    private:
+        size_t read_offset(const size_t row, const size_t read) const
+        {
+            INTEROP_ASSERT(row < m_tiles.size());
+            INTEROP_ASSERT(has_read(read));
+            return row * m_read_count + (read - 1);
+        }
+        static bool less_id(const tile_aggregate& lhs, const id_t id)
+        {
+            return lhs.id() < id;
+        }
+
+    private:
+        tile_vector_t m_tiles;
+        read_vector_t m_reads;
+        size_t m_read_count;
+        size_t m_lane_count;
+        size_t m_tile_metric_count;
+        size_t m_extended_tile_metric_count;
+        source_key_t m_source;
+    };
+}}}}
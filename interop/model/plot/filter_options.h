@@ -306,6 +306,15 @@ namespace illumina { namespace interop { namespace model { namespace plot
         {
             return m_section == static_cast<id_t>(ALL_IDS);
         }
+        /** Test if tiles are only filtered by lane and surface
+         *
+         * @param naming_method tile naming method that must be used to determine the surface
+         * @return true if all tile numbers, swaths and sections were requested
+         */
+        bool is_lane_surface_only(const constants::tile_naming_method naming_method) const
+        {
+            return m_naming_method == naming_method && all_tile_numbers() && all_swaths() && all_sections();
+        }
         /** Test if metric is read metric and specific read is chosen
          *
          * @param type metric type
@@ -28,6 +28,31 @@ namespace illumina { namespace interop { namespace model { namespace plot
         /** Constructor */
         flowcell_data() : m_data(0), m_swath_count(0), m_tile_count(0), m_free(false)
         { }
+        /** Copy constructor
+         *
+         * The copy owns its own buffers, even if the source uses external buffers
+         *
+         * @param other source flowcell heat map
+         */
+        flowcell_data(const flowcell_data& other) : heatmap_data(other), m_data(0), m_subtitle(other.m_subtitle),
+                                                    m_swath_count(0), m_tile_count(0), m_free(false)
+        {
+            copy_ids(other);
+        }
+        /** Assignment operator
+         *
+         * @param other source flowcell heat map
+         * @return this flowcell heat map
+         */
+        flowcell_data& operator=(const flowcell_data& other)
+        {
+            if(this == &other) return *this;
+            clear();
+            heatmap_data::operator=(other);
+            m_subtitle = other.m_subtitle;
+            copy_ids(other);
+            return *this;
+        }
 
         /** Destructor */
         virtual ~flowcell_data()
@@ -315,6 +340,17 @@ namespace illumina { namespace interop { namespace model { namespace plot
             return in;
         }
 
+private:
+    void copy_ids(const flowcell_data& other)
+    {
+        m_swath_count = other.m_swath_count;
+        m_tile_count = other.m_tile_count;
+        if(other.m_data == 0 || length() == 0) return;
+        m_data = new ::uint32_t[length()];
+        m_free = true;
+        std::copy(other.m_data, other.m_data+length(), m_data);
+    }
+
 protected:
     /** Array of tile numbers for each tile */
     ::uint32_t* m_data;
@@ -26,6 +26,30 @@ namespace illumina { namespace interop { namespace model { namespace plot
         /** Constructor */
         heatmap_data() : m_data(0), m_num_columns(0), m_num_rows(0), m_free(false)
         { }
+        /** Copy constructor
+         *
+         * The copy owns its own buffer, even if the source uses an external buffer
+         *
+         * @param other source heat map
+         */
+        heatmap_data(const heatmap_data& other) : chart_data(other), m_data(0), m_num_columns(0), m_num_rows(0),
+                                                  m_free(false)
+        {
+            copy_data(other);
+        }
+        /** Assignment operator
+         *
+         * @param other source heat map
+         * @return this heat map
+         */
+        heatmap_data& operator=(const heatmap_data& other)
+        {
+            if(this == &other) return *this;
+            clear();
+            chart_data::operator=(other);
+            copy_data(other);
+            return *this;
+        }
         /** Destructor */
         virtual ~heatmap_data()
         {
@@ -251,6 +275,17 @@ namespace illumina { namespace interop { namespace model { namespace plot
             return in;
         }
 
+    private:
+        void copy_data(const heatmap_data& other)
+        {
+            if(other.m_data == 0 || other.length() == 0) return;
+            m_data = new float[other.length()];
+            m_num_columns = other.m_num_columns;
+            m_num_rows = other.m_num_rows;
+            m_free = true;
+            std::copy(other.m_data, other.m_data+other.length(), m_data);
+        }
+
     private:
         float* m_data;
         size_t m_num_columns;
@@ -0,0 +1,209 @@
+/** Cache of plot and summary results computed from the run metrics
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <string>
+#include <sstream>
+#include "interop/util/lru_cache.h"
+#include "interop/model/plot/filter_options.h"
+#include "interop/model/plot/plot_data.h"
+#include "interop/model/plot/candle_stick_point.h"
+#include "interop/model/plot/flowcell_data.h"
+#include "interop/model/summary/run_summary.h"
+
+namespace illumina { namespace interop { namespace model { namespace metrics
+{
+    /** Least recently used cache of plots and summaries
+     *
+     * Each kind of result is held in a separate cache bounded by the same number of entries; the size of an entry
+     * in bytes is not counted. The cache is disabled until a capacity greater than 0 is set. The owner
+     * invalidates the cache whenever the metrics change, which also increments the data version.
+     *
+     * @note This class is not thread safe, run_metrics locks it
+     */
+    class result_cache
+    {
+    public:
+        /** Define a candle stick plot */
+        typedef plot::plot_data<plot::candle_stick_point> candle_stick_plot_t;
+
+    public:
+        /** Constructor
+         *
+         * @param capacity maximum number of entries for each kind of result
+         */
+        result_cache(const size_t capacity=0) :
+                m_candle_stick_plots(capacity),
+                m_flowcell_maps(capacity),
+                m_summaries(capacity),
+                m_version(0)
+        {
+        }
+
+    public:
+        /** Create a key for a result
+         *
+         * @param name name of the function that produces the result
+         * @param type metric type or other integer argument
+         * @param options filter options
+         * @param flag boolean argument
+         * @return key
+         */
+        static std::string key(const char* name,
+                               const int type,
+                               const plot::filter_options& options,
+                               const bool flag)
+        {
+            std::ostringstream out;
+            out << name << "_" << type << "_" << options << options.naming_method() << "_" << options.subsample()
+                << "_" << flag;
+            return out.str();
+        }
+        /** Create a key for a result that does not depend on filter options
+         *
+         * @param name name of the function that produces the result
+         * @param flag1 first boolean argument
+         * @param flag2 second boolean argument
+         * @return key
+         */
+        static std::string key(const char* name, const bool flag1, const bool flag2)
+        {
+            std::ostringstream out;
+            out << name << "_" << flag1 << "_" << flag2;
+            return out.str();
+        }
+
+    public:
+        /** Find a candle stick plot
+         *
+         * @param key key of the plot
+         * @param data destination plot
+         * @return true if found
+         */
+        bool find(const std::string& key, candle_stick_plot_t& data)
+        {
+            return m_candle_stick_plots.find(key, data);
+        }
+        /** Find a flowcell map
+         *
+         * @param key key of the plot
+         * @param data destination flowcell map
+         * @return true if found
+         */
+        bool find(const std::string& key, plot::flowcell_data& data)
+        {
+            return m_flowcell_maps.find(key, data);
+        }
+        /** Find a run summary
+         *
+         * @param key key of the summary
+         * @param summary destination summary
+         * @return true if found
+         */
+        bool find(const std::string& key, summary::run_summary& summary)
+        {
+            return m_summaries.find(key, summary);
+        }
+        /** Store a candle stick plot
+         *
+         * @param key key of the plot
+         * @param data plot
+         */
+        void insert(const std::string& key, const candle_stick_plot_t& data)
+        {
+            m_candle_stick_plots.insert(key, data);
+        }
+        /** Store a flowcell map
+         *
+         * @param key key of the plot
+         * @param data flowcell map
+         */
+        void insert(const std::string& key, const plot::flowcell_data& data)
+        {
+            m_flowcell_maps.insert(key, data);
+        }
+        /** Store a run summary
+         *
+         * @param key key of the summary
+         * @param summary run summary
+         */
+        void insert(const std::string& key, const summary::run_summary& summary)
+        {
+            m_summaries.insert(key, summary);
+        }
+
+    public:
+        /** Remove all results and increment the data version
+         */
+        void invalidate()
+        {
+            m_candle_stick_plots.clear();
+            m_flowcell_maps.clear();
+            m_summaries.clear();
+            ++m_version;
+        }
+        /** Remove all results without changing the data version
+         *
+         * Use when a setting that changes the results, but not the data, is modified.
+         */
+        void clear()
+        {
+            m_candle_stick_plots.clear();
+            m_flowcell_maps.clear();
+            m_summaries.clear();
+        }
+        /** Set the maximum number of entries for each kind of result
+         *
+         * @param capacity maximum number of entries, 0 disables the cache
+         */
+        void capacity(const size_t capacity)
+        {
+            m_candle_stick_plots.capacity(capacity);
+            m_flowcell_maps.capacity(capacity);
+            m_summaries.capacity(capacity);
+        }
+        /** Get the maximum number of entries for each kind of result
+         *
+         * @return maximum number of entries
+         */
+        size_t capacity() const
+        {
+            return m_candle_stick_plots.capacity();
+        }
+        /** Test if the cache stores results
+         *
+         * @return true if the capacity is greater than 0
+         */
+        bool enabled() const
+        {
+            return capacity() > 0;
+        }
+        /** Get the total number of cached results
+         *
+         * @return number of cached results
+         */
+        size_t size() const
+        {
+            return m_candle_stick_plots.size() + m_flowcell_maps.size() + m_summaries.size();
+        }
+        /** Get the data version
+         *
+         * @return number of times the cache was invalidated
+         */
+        size_t version() const
+        {
+            return m_version;
+        }
+
+    private:
+        util::lru_cache<std::string, candle_stick_plot_t> m_candle_stick_plots;
+        util::lru_cache<std::string, plot::flowcell_data> m_flowcell_maps;
+        util::lru_cache<std::string, summary::run_summary> m_summaries;
+        size_t m_version;
+    };
+}}}}
@@ -9,12 +9,14 @@
 
 #include "interop/util/exception.h"
 #include "interop/util/object_list.h"
+#include "interop/util/task_graph.h"
 #include "interop/model/metric_base/metric_set.h"
 #include "interop/model/model_exceptions.h"
 #include "interop/io/stream_exceptions.h"
 #include "interop/io/metric_file_stream.h"
 #include "interop/model/run/info.h"
 #include "interop/model/run/parameters.h"
+#include "interop/model/result_cache.h"
 
 //Metrics
 #include "interop/model/metrics/corrected_intensity_metric.h"
@@ -28,6 +30,8 @@
 #include "interop/model/metrics/q_metric.h"
 #include "interop/model/metrics/q_by_lane_metric.h"
 #include "interop/model/metrics/q_collapsed_metric.h"
+#include "interop/model/metrics/q_score_cube.h"
+#include "interop/model/metrics/tile_aggregate_table.h"
 #include "interop/model/metrics/tile_metric.h"
 #include "interop/model/metrics/summary_run_metric.h"
 
@@ -95,7 +99,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
     public:
         /** Constructor
          */
-        run_metrics()
+        run_metrics() : m_tile_q_cumulative_on_demand(false), m_quantile_sketch_accuracy(0)
         {
         }
 
@@ -106,7 +110,9 @@ namespace illumina { namespace interop { namespace model { namespace metrics
          */
         run_metrics(const run::info &run_info, const run::parameters &run_param = run::parameters()) :
                 m_run_info(run_info),
-                m_run_parameters(run_param)
+                m_run_parameters(run_param),
+                m_tile_q_cumulative_on_demand(false),
+                m_quantile_sketch_accuracy(0)
         {
         }
 
@@ -204,6 +210,9 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         xml::xml_parse_exception));
 
         /** Finalize the metric sets after loading from disk
+         *
+         * The derivation steps form a dependency graph, where steps that touch disjoint metric sets run
+         * concurrently on the shared thread pool. The time spent in each step is reported by finalize_timings.
          *
          * @param count number of bins for legacy q-metrics
          */
@@ -215,6 +224,16 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         model::invalid_run_info_exception,
         model::invalid_run_info_cycle_exception,
         model::invalid_parameter));
+        /** Get the time spent in each step of the last call to finalize_after_load
+         *
+         * Steps that did not run, e.g. after a step threw an exception, are marked as such.
+         *
+         * @return timing of each step
+         */
+        const std::vector<util::task_timing>& finalize_timings()const
+        {
+            return m_finalize_timings;
+        }
 
         /** Test if all metrics are empty
          *
@@ -233,6 +252,49 @@ namespace illumina { namespace interop { namespace model { namespace metrics
          * @param naming_method tile naming method
          */
         void set_naming_method(const constants::tile_naming_method naming_method);
+        /** Set the filter that selects which records are read from each InterOp file
+         *
+         * Records that do not match the lane, tile or cycle of the filter are skipped before the body of the
+         * record is decoded. The filter applies to all subsequent reads, and is kept when the metrics are cleared.
+         *
+         * @param filter record filter, a default constructed filter reads all records
+         */
+        void set_read_filter(const metric_base::record_filter& filter);
+        /** Get the filter that selects which records are read from each InterOp file
+         *
+         * @return record filter
+         */
+        const metric_base::record_filter& read_filter() const
+        {
+            return m_read_filter;
+        }
+        /** Compute the cumulative q-score histogram of each tile on demand
+         *
+         * When enabled, finalize_after_load does not store a cumulative histogram in each q_metric record,
+         * which roughly halves the memory of the q-metric set. Use logic::metric::cumulative_qscore_hist
+         * to compute the cumulative histogram of a tile. The collapsed and by lane q-metrics still hold their
+         * cumulative values.
+         *
+         * @param on_demand true if the tile cumulative histogram should not be stored
+         */
+        void set_tile_q_cumulative_on_demand(const bool on_demand);
+        /** Build candle stick plots from quantile sketches
+         *
+         * When enabled, the by cycle and by lane candle stick plots summarize the tile values of each point with a
+         * util::quantile_sketch holding about 3k values, instead of collecting every tile value. The quartiles then
+         * have a rank error of roughly 1.7/k. Points with fewer than k values are still exact.
+         *
+         * @param accuracy capacity k of the sketch, 0 (default) collects every tile value
+         */
+        void set_quantile_sketch_accuracy(const size_t accuracy);
+        /** Get the capacity of the quantile sketch used by the candle stick plots
+         *
+         * @return capacity k of the sketch, 0 if every tile value is collected
+         */
+        size_t quantile_sketch_accuracy() const
+        {
+            return m_quantile_sketch_accuracy;
+        }
         /** Get number of legacy bins
          *
          * @param legacy_bin_count known number of bins
@@ -265,6 +327,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         void run_info(const run::info &info)
         {
             m_run_info = info;
+            m_result_cache.invalidate();
         }
         /** @} */
         /** Get parameters describing the run
@@ -283,7 +346,117 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         void run_parameters(const run::parameters &param)
         {
             m_run_parameters = param;
+            m_result_cache.invalidate();
         }
+        /** Set the number of plots and summaries kept in the result cache
+         *
+         * The plot and summary logic returns a copy of a cached result when it is called again with the same
+         * arguments. The cache is emptied when metrics are read, set or finalized, and when a metric set gains,
+         * loses or reorders records. Call invalidate_results after changing the values of records in place.
+         *
+         * The capacity bounds the number of entries, not their size in bytes: each of the candle stick plot,
+         * flowcell map and summary caches keeps up to capacity results. A flowcell map holds a value for every
+         * tile and a plot a candle stick for every cycle, so the memory used grows with the run.
+         *
+         * @param capacity maximum number of cached results of each kind, 0 (default) disables the cache
+         */
+        void set_result_cache_size(const size_t capacity)
+        {
+            util::scoped_lock lock(m_result_mutex);
+            m_result_cache.capacity(capacity);
+        }
+        /** Get the number of plots and summaries kept in the result cache
+         *
+         * @return maximum number of cached results of each kind
+         */
+        size_t result_cache_size() const
+        {
+            util::scoped_lock lock(m_result_mutex);
+            return m_result_cache.capacity();
+        }
+        /** Get the number of plots and summaries in the result cache
+         *
+         * @return number of cached results
+         */
+        size_t cached_result_count() const
+        {
+            util::scoped_lock lock(m_result_mutex);
+            return m_result_cache.size();
+        }
+        /** Remove all cached plots and summaries
+         */
+        void invalidate_results()
+        {
+            util::scoped_lock lock(m_result_mutex);
+            m_result_cache.invalidate();
+        }
+        /** Find a cached plot or summary
+         *
+         * The cache is locked, so this may be called concurrently. Results stored before a metric set changed are
+         * removed first.
+         *
+         * @param key key of the result
+         * @param result destination result
+         * @return true if the result was found
+         */
+        template<class Result>
+        bool find_result(const std::string& key, Result& result) const
+        {
+            util::scoped_lock lock(m_result_mutex);
+            if(!m_result_cache.enabled()) return false;
+            sync_result_cache();
+            return m_result_cache.find(key, result);
+        }
+        /** Store a plot or summary in the cache
+         *
+         * The cache is locked, so this may be called concurrently.
+         *
+         * @param key key of the result
+         * @param result result to store
+         */
+        template<class Result>
+        void store_result(const std::string& key, const Result& result) const
+        {
+            util::scoped_lock lock(m_result_mutex);
+            if(!m_result_cache.enabled()) return;
+            sync_result_cache();
+            m_result_cache.insert(key, result);
+        }
+        /** Test if the result cache stores plots and summaries
+         *
+         * @return true if the capacity is greater than 0
+         */
+        bool is_result_cache_enabled() const
+        {
+            util::scoped_lock lock(m_result_mutex);
+            return m_result_cache.enabled();
+        }
+        /** Get the version of the loaded data
+         *
+         * @return number of times the metrics were modified through this class
+         */
+        size_t data_version() const
+        {
+            return m_result_cache.version();
+        }
+        /** Get the q-score histograms summed by lane, surface and cycle
+         *
+         * The cube is built on first use under a lock, and rebuilt when the q-metric set, the tile naming method
+         * or the data version changed since it was built. Call invalidate_results after modifying q-metric
+         * records in place.
+         *
+         * @return q-score cube, empty if there are no q-metrics or they cannot be binned by lane, surface and cycle
+         */
+        const metrics::q_score_cube& qscore_cube() const;
+        /** Get the table of values aggregated by tile
+         *
+         * The table is built by finalize_after_load, and rebuilt under a lock when the tile, extended tile, error
+         * or q-metric set, or the data version changed since it was built. Call invalidate_results after modifying
+         * records of these sets in place.
+         *
+         * @return per tile aggregate table
+         */
+        const metrics::tile_aggregate_table& tile_aggregates() const;
 
         /** List all filenames for a specific metric
          *
@@ -321,6 +494,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         {
             //static_assert( )
             m_metrics.get< T >() = metrics;
+            m_result_cache.invalidate();
         }
         /** Get a metric set
          *
@@ -525,10 +699,93 @@ namespace illumina { namespace interop { namespace model { namespace metrics
          */
          void clear();
 
+    private:
+        /** Read the per-cycle InterOp files of all selected and empty metric sets in batches of cycles
+         *
+         * Each batch of files is read concurrently, then each metric set is decoded from memory in cycle order.
+         *
+         * @param run_folder run folder path
+         * @param last_cycle last cycle of run
+         * @param valid_to_load boolean vector indicating which files to load
+         * @param thread_count number of threads to use for network loading
+         */
+        void read_by_cycle_batched(const std::string &run_folder,
+                                   const size_t last_cycle,
+                                   const std::vector<unsigned char>& valid_to_load,
+                                   const size_t thread_count) INTEROP_THROW_SPEC((io::bad_format_exception));
+        /** Rebuild the lookup index of every metric set
+         *
+         * @param count number of bins for legacy q-metrics (unused)
+         */
+        void finalize_rebuild_index(const size_t count);
+        /** Determine the tile naming method from the metrics, if unknown
+         *
+         * @param count number of bins for legacy q-metrics (unused)
+         */
+        void finalize_tile_naming(const size_t count);
+        /** Populate the cluster counts of the index metrics from the tile metrics
+         *
+         * @param count number of bins for legacy q-metrics (unused)
+         */
+        void finalize_indices(const size_t count);
+        /** Populate the q-score bins and compress the q-metrics of legacy runs
+         *
+         * @param count number of bins for legacy q-metrics
+         */
+        void finalize_legacy_q_bins(const size_t count);
+        /** Create the collapsed and by lane q-metrics along with the cumulative distributions
+         *
+         * @param count number of bins for legacy q-metrics (unused)
+         */
+        void finalize_derived_q_metrics(const size_t count);
+        /** Populate the percent occupied of the extended tile metrics
+         *
+         * @param count number of bins for legacy q-metrics (unused)
+         */
+        void finalize_percent_occupied(const size_t count);
+        /** Update the channels of legacy runs and trim the excess channels of the extraction and image metrics
+         *
+         * @param count number of bins for legacy q-metrics (unused)
+         */
+        void finalize_channels(const size_t count);
+        /** Validate the metrics against the run info
+         *
+         * @param count number of bins for legacy q-metrics (unused)
+         */
+        void finalize_validate(const size_t count);
+        /** Populate the dynamic phasing metrics from the phasing metrics
+         *
+         * @param count number of bins for legacy q-metrics (unused)
+         */
+        void finalize_dynamic_phasing(const size_t count);
+        /** Build the per tile aggregate table
+         *
+         * @param count number of bins for legacy q-metrics (unused)
+         */
+        void finalize_tile_aggregates(const size_t count);
+        /** Build the per tile aggregate table from the current metrics
+         */
+        void populate_tile_aggregates() const;
+        /** Remove the cached results if a metric set changed since they were stored
+         *
+         * @note The result mutex must be held
+         */
+        void sync_result_cache() const;
+
     private:
         metric_list_t m_metrics;
         run::info m_run_info;
         run::parameters m_run_parameters;
+        bool m_tile_q_cumulative_on_demand;
+        size_t m_quantile_sketch_accuracy;
+        mutable metrics::q_score_cube m_qscore_cube;
+        mutable metrics::tile_aggregate_table m_tile_aggregates;
+        mutable metrics::result_cache m_result_cache;
+        mutable std::vector<size_t> m_result_source;
+        mutable util::member_mutex m_result_mutex;
+        metric_base::record_filter m_read_filter;
+        std::vector<util::task_timing> m_finalize_timings;
+        mutable util::member_mutex m_derived_mutex;
 
     };
 
@@ -0,0 +1,154 @@
+/** Versioned snapshots of the run metrics shared by concurrent readers
+ *
+ * A writer loads and finalizes its own run_metrics, then publishes a copy as the next version. Readers take the
+ * current snapshot without locking and keep using it, unchanged, while newer versions are published. A version is
+ * freed when the last snapshot referring to it is released.
+ *
+ * Without std::thread (C++98), the reference counts are not atomic and the classes must be used from one thread.
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <cstddef>
+#include "interop/model/run_metrics.h"
+#include "interop/model/model_exceptions.h"
+
+namespace illumina { namespace interop { namespace model { namespace metrics
+{
+    /** Immutable version of the run metrics
+     *
+     * Copying a snapshot shares the same version of the run metrics.
+     */
+    class run_metrics_snapshot
+    {
+        friend class run_metrics_publisher;
+
+    public:
+        /** Version of the run metrics along with its reference count, defined by the implementation */
+        struct holder;
+
+    public:
+        /** Constructor of an empty snapshot */
+        run_metrics_snapshot();
+        /** Copy constructor
+         *
+         * @param other snapshot to share
+         */
+        run_metrics_snapshot(const run_metrics_snapshot& other);
+        /** Assignment operator
+         *
+         * @param other snapshot to share
+         * @return this snapshot
+         */
+        run_metrics_snapshot& operator=(const run_metrics_snapshot& other);
+        /** Destructor releases the version */
+        ~run_metrics_snapshot();
+
+    public:
+        /** Test if the snapshot refers to a version of the run metrics
+         *
+         * @return true if nothing was published when the snapshot was taken
+         */
+        bool empty() const;
+        /** Get the version of the run metrics
+         *
+         * @return version number starting at 1, 0 if empty
+         */
+        size_t version() const;
+        /** Get the run metrics of this version
+         *
+         * @throws invalid_parameter if the snapshot is empty
+         * @return run metrics
+         */
+        const run_metrics& metrics() const INTEROP_THROW_SPEC((model::invalid_parameter));
+        /** Get the run metrics of this version for the plot, summary and table logic
+         *
+         * The logic takes a non-const run_metrics to build the collapsed q-metrics on demand and to use the result
+         * cache. A published version already holds its collapsed q-metrics and has no result cache, so the logic
+         * only reads its records. The lane, cycle and tile lookups of each metric set are built on first use under a
+         * lock, so any number of threads may run the logic on the same snapshot. Do not modify the returned metrics.
+         *
+         * @throws invalid_parameter if the snapshot is empty
+         * @return run metrics
+         */
+        run_metrics& logic_metrics() const INTEROP_THROW_SPEC((model::invalid_parameter));
+        /** Get the run metrics of this version
+         *
+         * @return run metrics
+         */
+        const run_metrics& operator*() const
+        {
+            return metrics();
+        }
+        /** Get the run metrics of this version
+         *
+         * @return pointer to run metrics
+         */
+        const run_metrics* operator->() const
+        {
+            return &metrics();
+        }
+
+    private:
+        /** Take ownership of a reference to a version
+         *
+         * @param version version with a reference held for this snapshot
+         */
+        explicit run_metrics_snapshot(holder* version);
+
+    private:
+        holder* m_holder;
+    };
+
+    /** Publish new versions of the run metrics to concurrent readers
+     *
+     * Readers call snapshot and never wait on a writer. Publishing copies the metrics, then swaps the current
+     * version atomically; the writer waits only for readers that are in the middle of taking a snapshot.
+     * Concurrent calls to publish are serialized.
+     */
+    class run_metrics_publisher
+    {
+    public:
+        /** Publication state, defined by the implementation */
+        struct state;
+
+    public:
+        /** Constructor */
+        run_metrics_publisher();
+        /** Destructor releases the current version, snapshots keep their own version */
+        ~run_metrics_publisher();
+
+    public:
+        /** Publish a copy of the run metrics as the next version
+         *
+         * The copy has its result cache disabled, and holds the collapsed q-metrics when they can be derived from
+         * the q-metrics, so readers sharing it never modify its records. The writer keeps its own run metrics and
+         * may continue to load newer cycles into it.
+         *
+         * @param metrics run metrics to publish
+         * @return snapshot of the published version
+         */
+        run_metrics_snapshot publish(const run_metrics& metrics);
+        /** Get the current version of the run metrics
+         *
+         * @return snapshot of the current version, empty if nothing was published
+         */
+        run_metrics_snapshot snapshot() const;
+        /** Get the number of the current version
+         *
+         * @return version number, 0 if nothing was published
+         */
+        size_t version() const;
+
+    private:
+        run_metrics_publisher(const run_metrics_publisher&);
+        run_metrics_publisher& operator=(const run_metrics_publisher&);
+
+    private:
+        state* m_state;
+    };
+}}}}
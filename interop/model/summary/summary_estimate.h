@@ -0,0 +1,333 @@
+/** Estimates of summary statistics from a sample of tiles
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "interop/model/model_exceptions.h"
+
+namespace illumina { namespace interop { namespace model { namespace summary
+{
+    /** Estimate of the mean of a tile metric with a confidence interval
+     */
+    class metric_estimate
+    {
+    public:
+        /** Constructor
+         *
+         * @param mean estimated mean over all tiles
+         * @param lower lower bound of the confidence interval
+         * @param upper upper bound of the confidence interval
+         * @param sample_count number of sampled tiles with a value
+         */
+        metric_estimate(const float mean = std::numeric_limits<float>::quiet_NaN(),
+                        const float lower = std::numeric_limits<float>::quiet_NaN(),
+                        const float upper = std::numeric_limits<float>::quiet_NaN(),
+                        const size_t sample_count = 0) :
+                m_mean(mean),
+                m_lower(lower),
+                m_upper(upper),
+                m_sample_count(sample_count)
+        {
+        }
+
+    public:
+        /** Get the estimated mean over all tiles
+         *
+         * @return estimated mean
+         */
+        float mean() const
+        {
+            return m_mean;
+        }
+        /** Get the lower bound of the confidence interval
+         *
+         * @return lower bound, NaN if the interval cannot be estimated
+         */
+        float lower() const
+        {
+            return m_lower;
+        }
+        /** Get the upper bound of the confidence interval
+         *
+         * @return upper bound, NaN if the interval cannot be estimated
+         */
+        float upper() const
+        {
+            return m_upper;
+        }
+        /** Get the number of sampled tiles with a value
+         *
+         * @return number of sampled tiles
+         */
+        size_t sample_count() const
+        {
+            return m_sample_count;
+        }
+
+    private:
+        float m_mean;
+        float m_lower;
+        float m_upper;
+        size_t m_sample_count;
+    };
+
+    /** Estimates of the tile metrics of a lane, or of the whole run, from a sample of tiles
+     *
+     * The error rate and percent over Q30 are estimated for each read, indexed by read number minus one.
+     */
+    class summary_estimate
+    {
+    public:
+        /** Vector of estimates for each read */
+        typedef std::vector<metric_estimate> metric_estimate_vector_t;
+
+    public:
+        /** Constructor
+         *
+         * @param lane lane number, 0 for the whole run
+         * @param read_count number of reads
+         */
+        summary_estimate(const size_t lane = 0, const size_t read_count = 0) :
+                m_lane(lane),
+                m_tile_count(0),
+                m_sampled_tile_count(0),
+                m_error_rate(read_count),
+                m_percent_gt_q30(read_count)
+        {
+        }
+
+    public:
+        /** @defgroup summary_estimate Summary estimate
+         *
+         * Estimates of tile metrics from a sample of tiles
+         *
+         * @ingroup summary
+         * @{
+         */
+        /** Get the lane number
+         *
+         * @return lane number, 0 for the whole run
+         */
+        size_t lane() const
+        {
+            return m_lane;
+        }
+        /** Get the number of tiles in the flowcell layout
+         *
+         * @return number of tiles
+         */
+        size_t tile_count() const
+        {
+            return m_tile_count;
+        }
+        /** Get the number of sampled tiles
+         *
+         * @return number of sampled tiles
+         */
+        size_t sampled_tile_count() const
+        {
+            return m_sampled_tile_count;
+        }
+        /** Get the number of reads
+         *
+         * @return number of reads
+         */
+        size_t read_count() const
+        {
+            return m_error_rate.size();
+        }
+        /** Get the estimated cluster density
+         *
+         * @return estimated cluster density
+         */
+        const metric_estimate& density() const
+        {
+            return m_density;
+        }
+        /** Get the estimated percent of clusters passing filter
+         *
+         * @return estimated percent of clusters passing filter
+         */
+        const metric_estimate& percent_pf() const
+        {
+            return m_percent_pf;
+        }
+        /** Get the estimated error rate of a read
+         *
+         * @param read_index index of the read, read number minus one
+         * @return estimated error rate
+         */
+        const metric_estimate& error_rate(const size_t read_index) const
+        INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+        {
+            INTEROP_BOUNDS_CHECK(read_index, m_error_rate.size(), "Read index out of bounds");
+            return m_error_rate[read_index];
+        }
+        /** Get the estimated percent of bases over Q30 of a read
+         *
+         * @param read_index index of the read, read number minus one
+         * @return estimated percent of bases over Q30
+         */
+        const metric_estimate& percent_gt_q30(const size_t read_index) const
+        INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+        {
+            INTEROP_BOUNDS_CHECK(read_index, m_percent_gt_q30.size(), "Read index out of bounds");
+            return m_percent_gt_q30[read_index];
+        }
+        /** @} */
+
+    public:
+        /** Set the number of tiles in the layout and the number of sampled tiles
+         *
+         * @param tile_count number of tiles in the flowcell layout
+         * @param sampled_tile_count number of sampled tiles
+         */
+        void tile_count(const size_t tile_count, const size_t sampled_tile_count)
+        {
+            m_tile_count = tile_count;
+            m_sampled_tile_count = sampled_tile_count;
+        }
+        /** Set the estimated cluster density
+         *
+         * @param estimate estimated cluster density
+         */
+        void density(const metric_estimate& estimate)
+        {
+            m_density = estimate;
+        }
+        /** Set the estimated percent of clusters passing filter
+         *
+         * @param estimate estimated percent of clusters passing filter
+         */
+        void percent_pf(const metric_estimate& estimate)
+        {
+            m_percent_pf = estimate;
+        }
+        /** Set the estimated error rate of a read
+         *
+         * @param read_index index of the read, read number minus one
+         * @param estimate estimated error rate
+         */
+        void error_rate(const size_t read_index, const metric_estimate& estimate)
+        INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+        {
+            INTEROP_BOUNDS_CHECK(read_index, m_error_rate.size(), "Read index out of bounds");
+            m_error_rate[read_index] = estimate;
+        }
+        /** Set the estimated percent of bases over Q30 of a read
+         *
+         * @param read_index index of the read, read number minus one
+         * @param estimate estimated percent of bases over Q30
+         */
+        void percent_gt_q30(const size_t read_index, const metric_estimate& estimate)
+        INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+        {
+            INTEROP_BOUNDS_CHECK(read_index, m_percent_gt_q30.size(), "Read index out of bounds");
+            m_percent_gt_q30[read_index] = estimate;
+        }
+
+    private:
+        size_t m_lane;
+        size_t m_tile_count;
+        size_t m_sampled_tile_count;
+        metric_estimate m_density;
+        metric_estimate m_percent_pf;
+        metric_estimate_vector_t m_error_rate;
+        metric_estimate_vector_t m_percent_gt_q30;
+    };
+
+    /** Estimates of the tile metrics of a run from a stratified sample of tiles
+     *
+     * Each lane and surface is a stratum. The 95% confidence intervals are normal approximations with a finite
+     * population correction, and are NaN when a stratum has too few sampled tiles to estimate its variance.
+     */
+    class run_summary_estimate
+    {
+    public:
+        /** Vector of lane estimates */
+        typedef std::vector<summary_estimate> summary_estimate_vector_t;
+        /** Constant random access iterator to the lane estimates */
+        typedef summary_estimate_vector_t::const_iterator const_iterator;
+
+    public:
+        /** Get the estimates over all lanes
+         *
+         * @return estimates over all lanes
+         */
+        const summary_estimate& total() const
+        {
+            return m_total;
+        }
+        /** Get the estimates of a lane
+         *
+         * @param n index of the lane estimate
+         * @return estimates of the lane
+         */
+        const summary_estimate& operator[](const size_t n) const
+        INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+        {
+            INTEROP_BOUNDS_CHECK(n, m_lanes.size(), "Lane index out of bounds");
+            return m_lanes[n];
+        }
+        /** Get the number of lane estimates
+         *
+         * @return number of lanes
+         */
+        size_t size() const
+        {
+            return m_lanes.size();
+        }
+        /** Get iterator to the start of the lane estimates
+         *
+         * @return iterator to the start of the lane estimates
+         */
+        const_iterator begin() const
+        {
+            return m_lanes.begin();
+        }
+        /** Get iterator to the end of the lane estimates
+         *
+         * @return iterator to the end of the lane estimates
+         */
+        const_iterator end() const
+        {
+            return m_lanes.end();
+        }
+
+    public:
+        /** Set the estimates over all lanes
+         *
+         * @param total estimates over all lanes
+         */
+        void total(const summary_estimate& total)
+        {
+            m_total = total;
+        }
+        /** Add the estimates of a lane
+         *
+         * @param lane estimates of the lane
+         */
+        void push_back(const summary_estimate& lane)
+        {
+            m_lanes.push_back(lane);
+        }
+        /** Clear the estimates
+         */
+        void clear()
+        {
+            m_total = summary_estimate();
+            m_lanes.clear();
+        }
+
+    private:
+        summary_estimate m_total;
+        summary_estimate_vector_t m_lanes;
+    };
+}}}}
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "interop/util/cstdint.h"
 
 namespace illumina { namespace interop { namespace io
@@ -69,6 +70,20 @@ namespace illumina { namespace interop { namespace io
      * @return size of the file or -1 if the operation failed
      */
     ::int64_t file_size(const std::string& path);
+    /** Read the whole content of each file in a batch
+     *
+     * The files are stat'ed, opened and read concurrently, which hides the latency of network filesystems when
+     * reading many small files.
+     *
+     * @param file_names paths to the files
+     * @param contents destination content of each file, empty if missing
+     * @param found destination flag for each file, 1 if the file was read
+     * @param thread_count number of files to read concurrently
+     */
+    void read_files(const std::vector<std::string>& file_names,
+                    std::vector<std::string>& contents,
+                    std::vector<unsigned char>& found,
+                    const size_t thread_count);
 }}}
 
 
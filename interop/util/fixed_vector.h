@@ -0,0 +1,326 @@
+/** Vector with a fixed capacity and inline storage
+ *
+ * Per channel and per base values only ever hold a handful of elements. This container keeps those
+ * elements inside the owning object, so a metric record does not need a separate heap allocation
+ * for each small array.
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+#include "interop/config.h"
+#include "interop/util/assert.h"
+#include "interop/util/exception.h"
+#include "interop/util/length_of.h"
+
+namespace illumina { namespace interop { namespace util
+{
+    /** Vector-like container that stores at most Capacity elements inline
+     *
+     * This supports the subset of the std::vector interface used by the metric records and
+     * the InterOp layouts. Resizing beyond the capacity throws std::length_error.
+     *
+     * @tparam T type of element
+     * @tparam Capacity maximum number of elements
+     */
+    template<typename T, size_t Capacity>
+    class fixed_vector
+    {
+    public:
+        /** Element type */
+        typedef T value_type;
+        /** Reference to element */
+        typedef T& reference;
+        /** Constant reference to element */
+        typedef const T& const_reference;
+        /** Pointer to element */
+        typedef T* pointer;
+        /** Constant pointer to element */
+        typedef const T* const_pointer;
+        /** Iterator over elements */
+        typedef T* iterator;
+        /** Constant iterator over elements */
+        typedef const T* const_iterator;
+        /** Size type */
+        typedef size_t size_type;
+        /** Difference type */
+        typedef std::ptrdiff_t difference_type;
+
+    public:
+        /** Constructor
+         */
+        fixed_vector() : m_size(0)
+        {
+        }
+        /** Constructor
+         *
+         * @param n number of elements
+         * @param val value of each element
+         */
+        explicit fixed_vector(const size_t n, const T& val=T()) : m_size(0)
+        {
+            resize(n, val);
+        }
+        /** Constructor
+         *
+         * @param beg pointer to first element
+         * @param end pointer to one past the last element
+         */
+        template<typename U>
+        fixed_vector(const U* beg, const U* end) : m_size(0)
+        {
+            assign(beg, end);
+        }
+        /** Constructor
+         *
+         * @param vec vector of elements
+         */
+        fixed_vector(const std::vector<T>& vec) : m_size(0)
+        {
+            assign(vec.begin(), vec.end());
+        }
+
+    public:
+        /** Assign a range of elements
+         *
+         * @param beg iterator to first element
+         * @param end iterator to one past the last element
+         */
+        template<typename InputIterator>
+        void assign(InputIterator beg, InputIterator end)
+        {
+            m_size = 0;
+            for (; beg != end; ++beg) push_back(static_cast<T>(*beg));
+        }
+        /** Add an element to the end of the array
+         *
+         * @param val element value
+         */
+        void push_back(const T& val)
+        {
+            if (m_size >= Capacity)
+                INTEROP_THROW(std::length_error, "Exceeded fixed capacity - " << m_size+1 << " > " << Capacity);
+            m_values[m_size++] = val;
+        }
+        /** Resize the array
+         *
+         * New elements are set to the given value.
+         *
+         * @param n number of elements
+         * @param val value of new elements
+         */
+        void resize(const size_t n, const T& val=T())
+        {
+            if (n > Capacity)
+                INTEROP_THROW(std::length_error, "Exceeded fixed capacity - " << n << " > " << Capacity);
+            for (size_t i = m_size; i < n; ++i) m_values[i] = val;
+            m_size = n;
+        }
+        /** Remove all elements
+         */
+        void clear()
+        {
+            m_size = 0;
+        }
+
+    public:
+        /** Get the number of elements
+         *
+         * @return number of elements
+         */
+        size_t size() const
+        {
+            return m_size;
+        }
+        /** Test if the array is empty
+         *
+         * @return true if there are no elements
+         */
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+        /** Get the maximum number of elements
+         *
+         * @return capacity
+         */
+        static size_t capacity()
+        {
+            return Capacity;
+        }
+        /** Get the maximum number of elements
+         *
+         * @return capacity
+         */
+        static size_t max_size()
+        {
+            return Capacity;
+        }
+        /** Get element at index
+         *
+         * @param index index of element
+         * @return element
+         */
+        reference operator[](const size_t index)
+        {
+            INTEROP_ASSERT(index < m_size);
+            return m_values[index];
+        }
+        /** Get element at index
+         *
+         * @param index index of element
+         * @return element
+         */
+        const_reference operator[](const size_t index) const
+        {
+            INTEROP_ASSERT(index < m_size);
+            return m_values[index];
+        }
+        /** Get first element
+         *
+         * @return first element
+         */
+        reference front()
+        {
+            INTEROP_ASSERT(m_size > 0);
+            return m_values[0];
+        }
+        /** Get first element
+         *
+         * @return first element
+         */
+        const_reference front() const
+        {
+            INTEROP_ASSERT(m_size > 0);
+            return m_values[0];
+        }
+        /** Get last element
+         *
+         * @return last element
+         */
+        reference back()
+        {
+            INTEROP_ASSERT(m_size > 0);
+            return m_values[m_size - 1];
+        }
+        /** Get last element
+         *
+         * @return last element
+         */
+        const_reference back() const
+        {
+            INTEROP_ASSERT(m_size > 0);
+            return m_values[m_size - 1];
+        }
+        /** Get pointer to the underlying storage
+         *
+         * @return pointer to first element
+         */
+        pointer data()
+        {
+            return m_values;
+        }
+        /** Get pointer to the underlying storage
+         *
+         * @return pointer to first element
+         */
+        const_pointer data() const
+        {
+            return m_values;
+        }
+        /** Get iterator to first element
+         *
+         * @return iterator to first element
+         */
+        iterator begin()
+        {
+            return m_values;
+        }
+        /** Get iterator to first element
+         *
+         * @return iterator to first element
+         */
+        const_iterator begin() const
+        {
+            return m_values;
+        }
+        /** Get iterator to one past the last element
+         *
+         * @return iterator to one past the last element
+         */
+        iterator end()
+        {
+            return m_values + m_size;
+        }
+        /** Get iterator to one past the last element
+         *
+         * @return iterator to one past the last element
+         */
+        const_iterator end() const
+        {
+            return m_values + m_size;
+        }
+        /** Copy elements to a std::vector
+         *
+         * @return std::vector of elements
+         */
+        std::vector<T> to_vector() const
+        {
+            return std::vector<T>(begin(), end());
+        }
+
+    private:
+        T m_values[Capacity];
+        size_t m_size;
+    };
+
+    /** Test if two arrays hold the same elements
+     *
+     * @param lhs left array
+     * @param rhs right array
+     * @return true if both arrays have the same size and elements
+     */
+    template<typename T, size_t Capacity>
+    bool operator==(const fixed_vector<T, Capacity>& lhs, const fixed_vector<T, Capacity>& rhs)
+    {
+        if (lhs.size() != rhs.size()) return false;
+        for (size_t i = 0; i < lhs.size(); ++i)
+            if (!(lhs[i] == rhs[i])) return false;
+        return true;
+    }
+
+    /** Test if two arrays differ
+     *
+     * @param lhs left array
+     * @param rhs right array
+     * @return true if the arrays differ in size or elements
+     */
+    template<typename T, size_t Capacity>
+    bool operator!=(const fixed_vector<T, Capacity>& lhs, const fixed_vector<T, Capacity>& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    /** Length of a fixed capacity vector
+     *
+     * Returns fixed_vector::size()
+     */
+    template<typename T, size_t Capacity>
+    struct length_of_type<fixed_vector<T, Capacity> >
+    {
+        /** Length of a fixed capacity vector
+         *
+         * @param vec fixed capacity vector
+         * @return fixed_vector::size()
+         */
+        static size_t size(const fixed_vector<T, Capacity> &vec)
+        { return vec.size(); }
+    };
+
+}}}
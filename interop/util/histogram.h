@@ -0,0 +1,107 @@
+/** Reductions over histograms
+ *
+ * The q-score histograms are reduced once per record when collapsing, summarizing and plotting. These
+ * kernels split each reduction over several independent accumulators so the compiler can vectorize the
+ * inner loop without relying on a specific instruction set.
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <cstddef>
+#include "interop/util/cstdint.h"
+
+namespace illumina { namespace interop { namespace util
+{
+    /** Sum the counts in a histogram
+     *
+     * @param beg random access iterator to start of histogram
+     * @param end random access iterator to end of histogram
+     * @return sum of all counts
+     */
+    template<typename I>
+    ::uint64_t histogram_sum(I beg, I end)
+    {
+        const size_t n = static_cast<size_t>(end - beg);
+        ::uint64_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            sum0 += beg[i];
+            sum1 += beg[i + 1];
+            sum2 += beg[i + 2];
+            sum3 += beg[i + 3];
+        }
+        for (; i < n; ++i) sum0 += beg[i];
+        return (sum0 + sum1) + (sum2 + sum3);
+    }
+
+    /** Sum the counts in a histogram at or above the given index
+     *
+     * @param beg random access iterator to start of histogram
+     * @param end random access iterator to end of histogram
+     * @param index first bin to include
+     * @return sum of counts at or above index, 0 if index is past the end
+     */
+    template<typename I>
+    ::uint64_t histogram_tail_sum(I beg, I end, const size_t index)
+    {
+        if (index >= static_cast<size_t>(end - beg)) return 0;
+        return histogram_sum(beg + index, end);
+    }
+
+    /** Sum the total counts and the counts at or above two indices in a single pass
+     *
+     * @param beg random access iterator to start of histogram
+     * @param end random access iterator to end of histogram
+     * @param first_index first threshold bin (e.g. Q20)
+     * @param second_index second threshold bin (e.g. Q30)
+     * @param total sum of all counts
+     * @param over_first sum of counts at or above first_index
+     * @param over_second sum of counts at or above second_index
+     */
+    template<typename I>
+    void histogram_tail_sums(I beg,
+                             I end,
+                             size_t first_index,
+                             size_t second_index,
+                             ::uint64_t& total,
+                             ::uint64_t& over_first,
+                             ::uint64_t& over_second)
+    {
+        const size_t n = static_cast<size_t>(end - beg);
+        if (first_index > n) first_index = n;
+        if (second_index > n) second_index = n;
+        const size_t lower = first_index < second_index ? first_index : second_index;
+        const size_t upper = first_index < second_index ? second_index : first_index;
+        const ::uint64_t over_upper = histogram_sum(beg + upper, end);
+        const ::uint64_t over_lower = over_upper + histogram_sum(beg + lower, beg + upper);
+        total = over_lower + histogram_sum(beg, beg + lower);
+        over_first = first_index == lower ? over_lower : over_upper;
+        over_second = second_index == lower ? over_lower : over_upper;
+    }
+
+    /** Find the bin holding the median count of a histogram
+     *
+     * @param beg random access iterator to start of histogram
+     * @param end random access iterator to end of histogram
+     * @param total sum of all counts in the histogram
+     * @return index of the median bin, or the size of the histogram if the histogram is empty
+     */
+    template<typename I>
+    size_t histogram_median_index(I beg, I end, const ::uint64_t total)
+    {
+        const size_t n = static_cast<size_t>(end - beg);
+        const ::uint64_t position = total % 2 == 0 ? total / 2 + 1 : (total + 1) / 2;
+        ::uint64_t sum = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            sum += beg[i];
+            if (sum >= position) return i;
+        }
+        return n;
+    }
+}}}
@@ -16,6 +16,7 @@
 #include <iomanip>
 #include <limits>
 #include "interop/util/math.h"
+#include "interop/util/number_format.h"
 #include "interop/util/type_traits.h"
 
 namespace illumina { namespace interop { namespace util
@@ -49,13 +50,28 @@ namespace illumina { namespace interop { namespace util
             {
                 return inf_value(static_cast<Destination*>(0));
             }
-            std::istringstream iss(str);
             Destination val = Destination();
+            if(parse_value(str, val)) return val;
+            val = Destination();
+            std::istringstream iss(str);
             iss >> val;
             return val;
         }
 
     private:
+        static bool parse_value(const std::string &str, double& val)
+        {
+            return parse_number(str, val);
+        }
+        static bool parse_value(const std::string &str, float& val)
+        {
+            return parse_number(str, val);
+        }
+        template<class T>
+        static bool parse_value(const std::string &, T&)
+        {
+            return false;
+        }
         static double nan_value(double*)
         {
             return std::numeric_limits<double>::quiet_NaN();
@@ -174,9 +190,9 @@ namespace illumina { namespace interop { namespace util
          */
         static std::string cast(const Source &source)
         {
-            std::ostringstream oss;
-            oss << source;
-            return oss.str();
+            number_formatter formatter;
+            formatter.append(source);
+            return formatter.str();
         }
     };
 
@@ -278,18 +294,20 @@ namespace illumina { namespace interop { namespace util
     inline std::string format(const float val, const int width, const int precision, const char fill = ' ',
                               const bool fixed = true)
     {
-        std::ostringstream oss;
+        number_formatter formatter;
         if(std::isnan(val))
         {
-            oss << std::numeric_limits<float>::quiet_NaN();
-            return oss.str();
+            formatter.append(std::numeric_limits<float>::quiet_NaN());
+            return formatter.str();
+        }
+        if (fixed) formatter.append_fixed(val, precision > -1 ? precision : 6);
+        else
+        {
+            if (precision > -1) formatter.precision(precision);
+            formatter.append(val);
         }
-        if (fixed) oss << std::fixed;
-        if (width > -1) oss << std::setw(width);
-        if (precision > -1) oss << std::setprecision(precision);
-        if (fill != 0) oss << std::setfill(fill);
-        oss << val;
-        return oss.str();
+        if (width > -1) formatter.pad_left(static_cast<size_t>(width), fill != 0 ? fill : ' ');
+        return formatter.str();
     }
 
 }}}
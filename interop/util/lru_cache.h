@@ -0,0 +1,167 @@
+/** Cache that evicts the least recently used entry
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <list>
+#include <utility>
+#include "interop/util/map.h"
+
+namespace illumina { namespace interop { namespace util
+{
+    /** Map with a bounded number of entries that evicts the least recently used entry
+     *
+     * A capacity of 0 disables the cache, nothing is stored.
+     *
+     * @note This class is not thread safe
+     * @tparam K key type
+     * @tparam V value type
+     */
+    template<typename K, typename V>
+    class lru_cache
+    {
+        typedef std::pair<K, V> entry_t;
+        typedef std::list<entry_t> entry_list_t;
+        typedef typename entry_list_t::iterator entry_iterator;
+        typedef INTEROP_UNORDERED_MAP(K, entry_iterator) index_map_t;
+    public:
+        /** Key type */
+        typedef K key_type;
+        /** Value type */
+        typedef V value_type;
+
+    public:
+        /** Constructor
+         *
+         * @param capacity maximum number of entries
+         */
+        lru_cache(const size_t capacity=0) : m_capacity(capacity), m_size(0)
+        {
+        }
+        /** Copy constructor
+         *
+         * @param other source cache
+         */
+        lru_cache(const lru_cache& other) : m_capacity(other.m_capacity), m_size(0)
+        {
+            for (typename entry_list_t::const_reverse_iterator it = other.m_entries.rbegin();
+                 it != other.m_entries.rend(); ++it)
+                insert(it->first, it->second);
+        }
+        /** Assignment operator
+         *
+         * @param other source cache
+         * @return this cache
+         */
+        lru_cache& operator=(const lru_cache& other)
+        {
+            if (this == &other) return *this;
+            lru_cache tmp(other);
+            swap(tmp);
+            return *this;
+        }
+
+    public:
+        /** Find an entry and mark it as the most recently used
+         *
+         * @param key key of the entry
+         * @param value destination for a copy of the value
+         * @return true if the entry was found
+         */
+        bool find(const K& key, V& value)
+        {
+            typename index_map_t::iterator it = m_index.find(key);
+            if (it == m_index.end()) return false;
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            value = it->second->second;
+            return true;
+        }
+        /** Insert or replace an entry, evicting the least recently used entry if the cache is full
+         *
+         * @param key key of the entry
+         * @param value value of the entry
+         */
+        void insert(const K& key, const V& value)
+        {
+            if (m_capacity == 0) return;
+            typename index_map_t::iterator it = m_index.find(key);
+            if (it != m_index.end())
+            {
+                it->second->second = value;
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+                return;
+            }
+            m_entries.push_front(entry_t(key, value));
+            m_index[key] = m_entries.begin();
+            ++m_size;
+            trim();
+        }
+        /** Remove all entries
+         */
+        void clear()
+        {
+            m_entries.clear();
+            m_index.clear();
+            m_size = 0;
+        }
+        /** Swap the contents of two caches
+         *
+         * @param other other cache
+         */
+        void swap(lru_cache& other)
+        {
+            std::swap(m_capacity, other.m_capacity);
+            std::swap(m_size, other.m_size);
+            m_entries.swap(other.m_entries);
+            m_index.swap(other.m_index);
+        }
+
+    public:
+        /** Get the number of entries
+         *
+         * @return number of entries
+         */
+        size_t size() const
+        {
+            return m_size;
+        }
+        /** Get the maximum number of entries
+         *
+         * @return maximum number of entries
+         */
+        size_t capacity() const
+        {
+            return m_capacity;
+        }
+        /** Set the maximum number of entries, evicting the least recently used entries if necessary
+         *
+         * @param capacity maximum number of entries
+         */
+        void capacity(const size_t capacity)
+        {
+            m_capacity = capacity;
+            trim();
+        }
+
+    private:
+        void trim()
+        {
+            while (m_size > m_capacity)
+            {
+                m_index.erase(m_entries.back().first);
+                m_entries.pop_back();
+                --m_size;
+            }
+        }
+
+    private:
+        size_t m_capacity;
+        size_t m_size;
+        entry_list_t m_entries;
+        index_map_t m_index;
+    };
+}}}
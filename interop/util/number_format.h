@@ -0,0 +1,390 @@
+/** Format and parse numbers without the overhead of a string stream
+ *
+ * The formatted text is identical to writing the number to a std::ostream with the same precision and format
+ * flags. The parsed value is identical to reading the number with a std::istream.
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <ios>
+#include <locale>
+#include <sstream>
+#include <string>
+
+namespace illumina { namespace interop { namespace util
+{
+    namespace detail
+    {
+        /** Get the decimal point used by printf and strtod for the current C locale
+         *
+         * @return decimal point, "." for the classic locale
+         */
+        inline const char* c_decimal_point()
+        {
+            const char* point = std::localeconv()->decimal_point;
+            return point == 0 || *point == '\0' ? "." : point;
+        }
+        /** Test if printf and strtod use the decimal point of the classic locale
+         *
+         * @return true if the decimal point is '.'
+         */
+        inline bool is_classic_decimal_point()
+        {
+            const char* point = c_decimal_point();
+            return point[0] == '.' && point[1] == '\0';
+        }
+    }
+
+    /** Append formatted values to a reusable character buffer, which is written to a stream in one call
+     *
+     * Integers are converted directly and floating point numbers use the same printf conversion as std::ostream.
+     * The printf conversion follows LC_NUMERIC, so its decimal point is replaced with the '.' of the classic locale.
+     * Any other type is formatted with a string stream. If the format of the target stream is not the default,
+     * e.g. fixed or a width is set, every value is formatted with a string stream that copies the format.
+     *
+     * @note The format of the target stream is captured when the formatter is created
+     */
+    class number_formatter
+    {
+        enum
+        {
+            /** Largest precision formatted without a string stream */
+            MaxPrecision = 40,
+            /** Number of characters to hold any formatted number up to the largest precision */
+            BufferSize = 64
+        };
+
+    public:
+        /** Constructor for the default format of a stream
+         *
+         * @param capacity number of characters to reserve
+         */
+        number_formatter(const size_t capacity=0) : m_precision(6), m_stream(0)
+        {
+            m_buffer.reserve(capacity);
+        }
+        /** Constructor for the format of the given stream
+         *
+         * @param format stream whose format is copied
+         * @param capacity number of characters to reserve
+         */
+        number_formatter(const std::ios& format, const size_t capacity=0) :
+                m_precision(format.precision()),
+                m_stream(0)
+        {
+            if(!is_default_stream(format))
+            {
+                m_stream = new std::ostringstream;
+                m_stream->copyfmt(format);
+            }
+            else m_buffer.reserve(capacity);
+        }
+        /** Destructor */
+        ~number_formatter()
+        {
+            delete m_stream;
+        }
+
+    public:
+        /** Test if the stream has the default format flags, no width and the classic locale
+         *
+         * @param format stream format
+         * @return true if values can be formatted without a string stream
+         */
+        static bool is_default_stream(const std::ios_base& format)
+        {
+            const std::ios_base::fmtflags non_default = std::ios_base::floatfield | std::ios_base::showpoint |
+                                                        std::ios_base::showpos | std::ios_base::uppercase |
+                                                        std::ios_base::basefield | std::ios_base::showbase |
+                                                        std::ios_base::boolalpha;
+            if((format.flags() & non_default) != std::ios_base::dec) return false;
+            return format.width() == 0 && format.getloc() == std::locale::classic();
+        }
+
+    public:
+        /** Append a value
+         *
+         * @param value value to format
+         */
+        template<class T>
+        void append(const T& value)
+        {
+            if(m_stream != 0) (*m_stream) << value;
+            else format(value, m_precision);
+        }
+        /** Append a string
+         *
+         * @param value string
+         */
+        void append(const std::string& value)
+        {
+            if(m_stream != 0) (*m_stream) << value;
+            else m_buffer += value;
+        }
+        /** Append a string
+         *
+         * @param value string
+         */
+        void append(const char* value)
+        {
+            if(m_stream != 0) (*m_stream) << value;
+            else m_buffer += value;
+        }
+        /** Append a character
+         *
+         * @param ch character
+         */
+        void append(const char ch)
+        {
+            if(m_stream != 0) (*m_stream) << ch;
+            else m_buffer += ch;
+        }
+        /** Append a floating point value with a fixed number of digits after the decimal point
+         *
+         * @note This ignores the format of the target stream
+         * @param value value to format
+         * @param precision number of digits after the decimal point
+         */
+        void append_fixed(const double value, const std::streamsize precision)
+        {
+            if(m_stream != 0)
+            {
+                std::ostringstream out;
+                out << std::fixed;
+                out.precision(precision);
+                out << value;
+                (*m_stream) << out.str();
+            }
+            else format_double(value, precision, true);
+        }
+        /** Insert a fill character before the formatted text until it reaches the width
+         *
+         * This matches the right alignment of a stream.
+         *
+         * @param width minimum number of characters
+         * @param fill fill character
+         */
+        void pad_left(const size_t width, const char fill)
+        {
+            if(m_stream != 0)
+            {
+                const std::string text = m_stream->str();
+                if(text.length() < width) m_stream->str(std::string(width - text.length(), fill) + text);
+                m_stream->seekp(0, std::ios_base::end);
+            }
+            else if(m_buffer.length() < width) m_buffer.insert(static_cast<size_t>(0), width - m_buffer.length(), fill);
+        }
+        /** Set the number of significant digits for floating point numbers
+         *
+         * @param precision number of significant digits
+         */
+        void precision(const std::streamsize precision)
+        {
+            m_precision = precision;
+            if(m_stream != 0) m_stream->precision(precision);
+        }
+
+    public:
+        /** Write the formatted text to the stream
+         *
+         * The width of the stream is reset as it would be by writing the values directly.
+         *
+         * @param out output stream
+         */
+        void write(std::ostream& out)const
+        {
+            if(m_stream != 0)
+            {
+                const std::string text = m_stream->str();
+                out.write(text.data(), static_cast<std::streamsize>(text.size()));
+                if(!text.empty()) out.width(0);
+            }
+            else out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        }
+        /** Remove the formatted text, keeping the allocated memory
+         */
+        void clear()
+        {
+            if(m_stream != 0) m_stream->str("");
+            else m_buffer.clear();
+        }
+        /** Get the formatted text
+         *
+         * @return formatted text
+         */
+        std::string str()const
+        {
+            if(m_stream != 0) return m_stream->str();
+            return m_buffer;
+        }
+
+    private:
+        template<class T>
+        void format(const T& value, const std::streamsize precision)
+        {
+            std::ostringstream out;
+            out.precision(precision);
+            out << value;
+            m_buffer += out.str();
+        }
+        void format(const std::string& value, const std::streamsize)
+        {
+            m_buffer += value;
+        }
+        void format(const float value, const std::streamsize precision)
+        {
+            format_double(static_cast<double>(value), precision, false);
+        }
+        void format(const double value, const std::streamsize precision)
+        {
+            format_double(value, precision, false);
+        }
+        void format(const short value, const std::streamsize)
+        {
+            format_signed(static_cast<long>(value));
+        }
+        void format(const int value, const std::streamsize)
+        {
+            format_signed(static_cast<long>(value));
+        }
+        void format(const long value, const std::streamsize)
+        {
+            format_signed(value);
+        }
+        void format(const unsigned short value, const std::streamsize)
+        {
+            format_unsigned(static_cast<unsigned long>(value));
+        }
+        void format(const unsigned int value, const std::streamsize)
+        {
+            format_unsigned(static_cast<unsigned long>(value));
+        }
+        void format(const unsigned long value, const std::streamsize)
+        {
+            format_unsigned(value);
+        }
+        void format_double(const double value, const std::streamsize precision, const bool fixed)
+        {
+            // Large fixed values and precisions do not fit in the local buffer
+            if(precision < 0 || precision > MaxPrecision || (fixed && (value >= 1e20 || value <= -1e20)))
+            {
+                std::ostringstream out;
+                out.imbue(std::locale::classic());
+                if(fixed) out << std::fixed;
+                out.precision(precision);
+                out << value;
+                m_buffer += out.str();
+                return;
+            }
+            char buffer[BufferSize];
+#           if defined(_MSC_VER) && _MSC_VER < 1900
+            const int count = ::_snprintf(buffer, BufferSize, fixed ? "%.*f" : "%.*g", static_cast<int>(precision), value);
+#           else
+            const int count = ::snprintf(buffer, BufferSize, fixed ? "%.*f" : "%.*g", static_cast<int>(precision), value);
+#           endif
+            if(count <= 0 || count >= BufferSize) return;
+            const size_t length = static_cast<size_t>(count);
+            if(detail::is_classic_decimal_point())
+            {
+                m_buffer.append(buffer, length);
+                return;
+            }
+            // Replace the decimal point of LC_NUMERIC, printf never groups digits without the ' flag
+            const std::string point = detail::c_decimal_point();
+            std::string text(buffer, length);
+            const size_t found = text.find(point);
+            if(found != std::string::npos) text.replace(found, point.length(), 1, '.');
+            m_buffer += text;
+        }
+        void format_unsigned(unsigned long value)
+        {
+            char buffer[BufferSize];
+            char* end = buffer + BufferSize;
+            char* beg = end;
+            do
+            {
+                *--beg = static_cast<char>('0' + (value % 10));
+                value /= 10;
+            } while(value != 0);
+            m_buffer.append(beg, end);
+        }
+        void format_signed(const long value)
+        {
+            if(value < 0)
+            {
+                m_buffer += '-';
+                // Negate in unsigned arithmetic so the smallest value does not overflow
+                format_unsigned(0ul - static_cast<unsigned long>(value));
+            }
+            else format_unsigned(static_cast<unsigned long>(value));
+        }
+
+    private:
+        number_formatter(const number_formatter&);
+        number_formatter& operator=(const number_formatter&);
+
+    private:
+        std::string m_buffer;
+        std::streamsize m_precision;
+        std::ostringstream* m_stream;
+    };
+
+    namespace detail
+    {
+        /** Test if the number parsed by strtod or strtof is the same as the number parsed by a stream
+         *
+         * @param str string holding the number
+         * @param end first character that was not parsed
+         * @return true if the stream gives the same number
+         */
+        inline bool is_parsed_as_stream(const std::string& str, const char* end)
+        {
+            // Under another LC_NUMERIC, strtod stops at the '.' a stream reads or reads a separator it does not
+            if(!is_classic_decimal_point()) return false;
+            const char* beg = str.c_str();
+            // A stream does not accept hexadecimal or special values and fails on an incomplete exponent
+            if(end == beg) return str.find_first_of("xXiInN") == std::string::npos;
+            if(*end == 'e' || *end == 'E' || *end == 'x' || *end == 'X') return false;
+            if(*end == '.' || (*end >= '0' && *end <= '9')) return false;
+            return std::string(beg, end).find_first_of("xXiInNpP") == std::string::npos;
+        }
+    }
+
+    /** Parse a floating point number with the same result as reading it from a std::istream
+     *
+     * @param str string holding the number
+     * @param value destination value
+     * @return false if the string must be parsed by a stream to get the same result
+     */
+    inline bool parse_number(const std::string& str, double& value)
+    {
+        char* end = 0;
+        errno = 0;
+        value = ::strtod(str.c_str(), &end);
+        if(errno == ERANGE) return false;
+        return detail::is_parsed_as_stream(str, end);
+    }
+    /** Parse a floating point number with the same result as reading it from a std::istream
+     *
+     * @param str string holding the number
+     * @param value destination value
+     * @return false if the string must be parsed by a stream to get the same result
+     */
+    inline bool parse_number(const std::string& str, float& value)
+    {
+        char* end = 0;
+        errno = 0;
+        value = ::strtof(str.c_str(), &end);
+        if(errno == ERANGE) return false;
+        return detail::is_parsed_as_stream(str, end);
+    }
+}}}
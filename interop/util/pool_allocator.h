@@ -0,0 +1,448 @@
+/** Memory pool and allocator for long lived, fixed size nodes
+ *
+ * Containers such as the metric set offset map allocate one node per record. The memory pool hands these
+ * nodes out of large chunks with a bump pointer and releases all of them at once, which avoids one heap
+ * allocation per record on load and one heap free per record on teardown. Freed nodes are kept on a free list
+ * for their size and reused, so a container that erases and inserts records does not grow without bound.
+ *
+ *  @file
+ *  @date 10/18/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <new>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include "interop/util/map.h"
+#include "interop/util/assert.h"
+#ifdef INTEROP_HAS_UNORDERED_MAP
+#   include <type_traits>
+#endif
+
+namespace illumina { namespace interop { namespace util
+{
+    /** Bump pointer arena that releases all allocations at once
+     *
+     * Memory is returned to the heap when the pool is destroyed. A deallocated block is put on a free list for its
+     * size and alignment, and the next allocation of the same size and alignment reuses it. The pool keeps up to
+     * MAX_FREE_LISTS such lists, which covers the few node types of a container; blocks of any further size are
+     * held until the pool is released.
+     *
+     * @note This class is not thread safe, including its reference count
+     */
+    class memory_pool
+    {
+        struct chunk_header
+        {
+            chunk_header* next;
+        };
+        struct free_list
+        {
+            size_t size;
+            size_t alignment;
+            void* head;
+        };
+        enum
+        {
+            /** Size of the first chunk */
+            INITIAL_CHUNK_SIZE = 4096,
+            /** Maximum size of a chunk */
+            MAX_CHUNK_SIZE = 1 << 20,
+            /** Maximum number of block sizes with a free list */
+            MAX_FREE_LISTS = 4
+        };
+    public:
+        /** Constructor
+         */
+        memory_pool() :
+                m_head(0),
+                m_current(0),
+                m_end(0),
+                m_next_chunk_size(INITIAL_CHUNK_SIZE),
+                m_reserved_bytes(0),
+                m_free_list_count(0),
+                m_ref_count(1)
+        {
+        }
+        /** Destructor
+         */
+        ~memory_pool()
+        {
+            release();
+        }
+
+    public:
+        /** Allocate memory from the current chunk
+         *
+         * @param n number of bytes
+         * @param alignment alignment of the memory
+         * @return pointer to memory
+         */
+        void* allocate(const size_t n, const size_t alignment)
+        {
+            free_list* list = find_free_list(n, alignment);
+            if (list != 0 && list->head != 0)
+            {
+                void* block = list->head;
+                std::memcpy(&list->head, block, sizeof(void*));
+                return block;
+            }
+            // Each block must be able to hold the link of the free list
+            const size_t size = n < sizeof(void*) ? sizeof(void*) : n;
+            char* ptr = align(m_current, alignment);
+            if (ptr == 0 || ptr + size > m_end)
+            {
+                add_chunk(size + alignment);
+                ptr = align(m_current, alignment);
+            }
+            m_current = ptr + size;
+            return ptr;
+        }
+        /** Put a block on the free list for its size, so the next allocation of that size reuses it
+         *
+         * @param ptr memory returned by allocate
+         * @param n number of bytes given to allocate
+         * @param alignment alignment given to allocate
+         */
+        void deallocate(void* ptr, const size_t n, const size_t alignment)
+        {
+            if (ptr == 0) return;
+            free_list* list = find_free_list(n, alignment);
+            if (list == 0)
+            {
+                if (m_free_list_count == static_cast<size_t>(MAX_FREE_LISTS)) return;
+                list = &m_free_lists[m_free_list_count++];
+                list->size = n;
+                list->alignment = alignment;
+                list->head = 0;
+            }
+            std::memcpy(ptr, &list->head, sizeof(void*));
+            list->head = ptr;
+        }
+        /** Free all memory held by the pool
+         */
+        void release()
+        {
+            while (m_head != 0)
+            {
+                chunk_header* next = m_head->next;
+                ::operator delete(m_head);
+                m_head = next;
+            }
+            m_current = 0;
+            m_end = 0;
+            m_next_chunk_size = INITIAL_CHUNK_SIZE;
+            m_reserved_bytes = 0;
+            m_free_list_count = 0;
+        }
+        /** Get the number of bytes reserved from the heap
+         *
+         * @return number of bytes reserved
+         */
+        size_t reserved_bytes() const
+        {
+            return m_reserved_bytes;
+        }
+
+    public:
+        /** Add a reference to the pool
+         */
+        void add_reference()
+        {
+            ++m_ref_count;
+        }
+        /** Remove a reference to the pool
+         *
+         * @return true if there are no remaining references
+         */
+        bool remove_reference()
+        {
+            INTEROP_ASSERT(m_ref_count > 0);
+            return --m_ref_count == 0;
+        }
+
+    private:
+        free_list* find_free_list(const size_t n, const size_t alignment)
+        {
+            for (size_t i = 0; i < m_free_list_count; ++i)
+            {
+                if (m_free_lists[i].size == n && m_free_lists[i].alignment == alignment) return &m_free_lists[i];
+            }
+            return 0;
+        }
+        static char* align(char* ptr, const size_t alignment)
+        {
+            if (ptr == 0) return 0;
+            const size_t offset = reinterpret_cast<size_t>(ptr) % alignment;
+            return offset == 0 ? ptr : ptr + (alignment - offset);
+        }
+        void add_chunk(const size_t min_size)
+        {
+            size_t chunk_size = m_next_chunk_size;
+            while (chunk_size < min_size + sizeof(chunk_header)) chunk_size *= 2;
+            if (m_next_chunk_size < static_cast<size_t>(MAX_CHUNK_SIZE)) m_next_chunk_size *= 2;
+            chunk_header* chunk = static_cast<chunk_header*>(::operator new(chunk_size));
+            chunk->next = m_head;
+            m_head = chunk;
+            m_current = reinterpret_cast<char*>(chunk) + sizeof(chunk_header);
+            m_end = reinterpret_cast<char*>(chunk) + chunk_size;
+            m_reserved_bytes += chunk_size;
+        }
+
+    private:
+        memory_pool(const memory_pool&);
+        memory_pool& operator=(const memory_pool&);
+
+    private:
+        chunk_header* m_head;
+        char* m_current;
+        char* m_end;
+        size_t m_next_chunk_size;
+        size_t m_reserved_bytes;
+        free_list m_free_lists[MAX_FREE_LISTS];
+        size_t m_free_list_count;
+        size_t m_ref_count;
+    };
+
+    /** Determine the alignment of a type */
+    template<typename T>
+    struct alignment_of
+    {
+    private:
+        struct helper
+        {
+            char c;
+            T value;
+        };
+    public:
+        enum
+        {
+            /** Alignment of the type */
+            value = sizeof(helper) - sizeof(T)
+        };
+    };
+
+    /** Allocator that places single objects in a shared memory pool
+     *
+     * Node allocations (n == 1) come from the pool, freed nodes are reused by later node allocations and the
+     * memory is released together with the pool. Array allocations, e.g. hash table buckets, are passed through to
+     * the heap since they are resized.
+     *
+     * Each default constructed allocator creates its own pool, copies share the pool. A container
+     * copy receives a new pool, so copies of a container never share memory.
+     *
+     * @note The pool and its reference count are not thread safe. A container using this allocator may be read
+     * concurrently, but must be modified, copied and destroyed by one thread at a time, as a std container.
+     */
+    template<typename T>
+    class pool_allocator
+    {
+        template<typename U> friend class pool_allocator;
+    public:
+        /** Value type */
+        typedef T value_type;
+        /** Pointer type */
+        typedef T* pointer;
+        /** Constant pointer type */
+        typedef const T* const_pointer;
+        /** Reference type */
+        typedef T& reference;
+        /** Constant reference type */
+        typedef const T& const_reference;
+        /** Size type */
+        typedef size_t size_type;
+        /** Difference type */
+        typedef std::ptrdiff_t difference_type;
+#ifdef INTEROP_HAS_UNORDERED_MAP
+        /** Move the pool with the container */
+        typedef std::true_type propagate_on_container_move_assignment;
+        /** Swap the pool with the container */
+        typedef std::true_type propagate_on_container_swap;
+#endif
+        /** Rebind allocator to another type */
+        template<typename U>
+        struct rebind
+        {
+            /** Allocator for another type */
+            typedef pool_allocator<U> other;
+        };
+
+    public:
+        /** Constructor
+         */
+        pool_allocator() : m_pool(new memory_pool)
+        {
+        }
+        /** Copy constructor
+         *
+         * @param other source allocator
+         */
+        pool_allocator(const pool_allocator& other) : m_pool(other.m_pool)
+        {
+            m_pool->add_reference();
+        }
+        /** Copy constructor
+         *
+         * @param other source allocator
+         */
+        template<typename U>
+        pool_allocator(const pool_allocator<U>& other) : m_pool(other.m_pool)
+        {
+            m_pool->add_reference();
+        }
+        /** Assignment operator
+         *
+         * @param other source allocator
+         * @return this allocator
+         */
+        pool_allocator& operator=(const pool_allocator& other)
+        {
+            other.m_pool->add_reference();
+            release_pool();
+            m_pool = other.m_pool;
+            return *this;
+        }
+        /** Destructor
+         */
+        ~pool_allocator()
+        {
+            release_pool();
+        }
+
+    public:
+        /** Allocate memory for n objects
+         *
+         * @param n number of objects
+         * @return pointer to memory
+         */
+        pointer allocate(const size_type n, const void* =0)
+        {
+            if (n == 1)
+                return static_cast<pointer>(m_pool->allocate(sizeof(T), alignment_of<T>::value));
+            return static_cast<pointer>(::operator new(n * sizeof(T)));
+        }
+        /** Free memory for n objects
+         *
+         * @note single objects are kept by the pool for reuse, and freed when the pool is released
+         * @param ptr pointer to memory
+         * @param n number of objects
+         */
+        void deallocate(pointer ptr, const size_type n)
+        {
+            if (n == 1) m_pool->deallocate(ptr, sizeof(T), alignment_of<T>::value);
+            else ::operator delete(ptr);
+        }
+        /** Allocator used by a copy of a container
+         *
+         * @return allocator with a new pool
+         */
+        pool_allocator select_on_container_copy_construction() const
+        {
+            return pool_allocator();
+        }
+        /** Construct an object in place
+         *
+         * @param ptr pointer to memory
+         * @param val value to copy
+         */
+        void construct(pointer ptr, const_reference val)
+        {
+            new(static_cast<void*>(ptr)) T(val);
+        }
+        /** Destroy an object in place
+         *
+         * @param ptr pointer to object
+         */
+        void destroy(pointer ptr)
+        {
+            ptr->~T();
+        }
+#ifdef INTEROP_HAS_UNORDERED_MAP
+        /** Construct an object in place
+         *
+         * @param ptr pointer to memory
+         * @param args constructor arguments
+         */
+        template<typename U, typename... Args>
+        void construct(U* ptr, Args&&... args)
+        {
+            ::new(static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+        }
+        /** Destroy an object in place
+         *
+         * @param ptr pointer to object
+         */
+        template<typename U>
+        void destroy(U* ptr)
+        {
+            ptr->~U();
+        }
+#endif
+        /** Get the address of an object
+         *
+         * @param val object
+         * @return address of object
+         */
+        pointer address(reference val) const
+        {
+            return &val;
+        }
+        /** Get the address of an object
+         *
+         * @param val object
+         * @return address of object
+         */
+        const_pointer address(const_reference val) const
+        {
+            return &val;
+        }
+        /** Maximum number of objects that can be allocated
+         *
+         * @return maximum number of objects
+         */
+        size_type max_size() const
+        {
+            return std::numeric_limits<size_type>::max() / sizeof(T);
+        }
+        /** Get the number of bytes reserved by the underlying pool
+         *
+         * @return number of bytes reserved
+         */
+        size_t reserved_bytes() const
+        {
+            return m_pool->reserved_bytes();
+        }
+        /** Test if two allocators share a pool
+         *
+         * @param other other allocator
+         * @return true if both allocators share a pool
+         */
+        template<typename U>
+        bool operator==(const pool_allocator<U>& other) const
+        {
+            return m_pool == other.m_pool;
+        }
+        /** Test if two allocators use different pools
+         *
+         * @param other other allocator
+         * @return true if the allocators use different pools
+         */
+        template<typename U>
+        bool operator!=(const pool_allocator<U>& other) const
+        {
+            return m_pool != other.m_pool;
+        }
+
+    private:
+        void release_pool()
+        {
+            if (m_pool->remove_reference()) delete m_pool;
+        }
+
+    private:
+        memory_pool* m_pool;
+    };
+}}}
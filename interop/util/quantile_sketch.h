@@ -0,0 +1,275 @@
+/** Mergeable quantile sketch with bounded memory
+ *
+ * The sketch follows the KLL design: values are kept in a stack of compactors, where a value at level h stands for
+ * 2^h of the values added. When the sketch is full, the lowest full compactor is sorted and every other value is
+ * promoted to the next level. The compaction alternates between the odd and even values, so the sketch is
+ * deterministic for a given order of updates and merges.
+ *
+ * The accuracy is set by the capacity of the top compactor, k. The rank error is roughly 1.7/k, and the memory is
+ * about 3k values regardless of the number of values added. Until the first compaction, the sketch holds every value
+ * and its percentiles are exact.
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "interop/util/cstdint.h"
+#include "interop/util/math.h"
+#include "interop/util/statistics.h"
+
+namespace illumina { namespace interop { namespace util
+{
+    /** Mergeable quantile sketch with bounded memory
+     */
+    class quantile_sketch
+    {
+    public:
+        /** Value and the number of values it stands for */
+        typedef std::pair<float, ::uint64_t> weighted_value_t;
+        /** Vector of weighted values */
+        typedef std::vector<weighted_value_t> weighted_vector_t;
+        /** Default capacity of the top compactor */
+        static const size_t DEFAULT_ACCURACY = 200;
+
+    private:
+        typedef std::vector<float> compactor_t;
+        typedef std::vector<compactor_t> compactor_vector_t;
+        enum { MIN_ACCURACY = 8, MIN_CAPACITY = 2 };
+
+    public:
+        /** Constructor
+         *
+         * @param k capacity of the top compactor, larger values are more accurate
+         */
+        explicit quantile_sketch(const size_t k = DEFAULT_ACCURACY) :
+                m_k(std::max<size_t>(k, MIN_ACCURACY)),
+                m_count(0),
+                m_min(std::numeric_limits<float>::quiet_NaN()),
+                m_max(std::numeric_limits<float>::quiet_NaN()),
+                m_odd(false),
+                m_compactors(1)
+        {
+        }
+
+    public:
+        /** Add a value to the sketch
+         *
+         * @param value value to add, NaN values are ignored
+         */
+        void update(const float value)
+        {
+            if (std::isnan(value)) return;
+            if (m_count == 0 || value < m_min) m_min = value;
+            if (m_count == 0 || value > m_max) m_max = value;
+            ++m_count;
+            m_compactors[0].push_back(value);
+            if (m_compactors[0].size() >= capacity(0)) compress();
+        }
+        /** Merge the values of another sketch into this sketch
+         *
+         * @param other sketch to merge
+         */
+        void merge(const quantile_sketch& other)
+        {
+            if (other.m_count == 0) return;
+            if (m_count == 0 || other.m_min < m_min) m_min = other.m_min;
+            if (m_count == 0 || other.m_max > m_max) m_max = other.m_max;
+            m_count += other.m_count;
+            if (other.m_compactors.size() > m_compactors.size()) m_compactors.resize(other.m_compactors.size());
+            for (size_t level = 0; level < other.m_compactors.size(); ++level)
+            {
+                m_compactors[level].insert(m_compactors[level].end(),
+                                           other.m_compactors[level].begin(),
+                                           other.m_compactors[level].end());
+            }
+            compress();
+        }
+        /** Remove all values from the sketch
+         */
+        void clear()
+        {
+            m_count = 0;
+            m_min = m_max = std::numeric_limits<float>::quiet_NaN();
+            m_odd = false;
+            m_compactors.assign(1, compactor_t());
+        }
+
+    public:
+        /** Get the number of values added to the sketch
+         *
+         * @return number of values
+         */
+        ::uint64_t count() const
+        {
+            return m_count;
+        }
+        /** Test if the sketch is empty
+         *
+         * @return true if no value was added
+         */
+        bool empty() const
+        {
+            return m_count == 0;
+        }
+        /** Get the smallest value added
+         *
+         * @return smallest value, NaN if empty
+         */
+        float min_value() const
+        {
+            return m_min;
+        }
+        /** Get the largest value added
+         *
+         * @return largest value, NaN if empty
+         */
+        float max_value() const
+        {
+            return m_max;
+        }
+        /** Get the capacity of the top compactor
+         *
+         * @return accuracy parameter k
+         */
+        size_t accuracy() const
+        {
+            return m_k;
+        }
+        /** Test if the sketch holds every value added
+         *
+         * @return true if no value was compacted
+         */
+        bool is_exact() const
+        {
+            return m_compactors.size() == 1;
+        }
+        /** Get the number of values held by the sketch
+         *
+         * @return number of retained values
+         */
+        size_t retained() const
+        {
+            size_t total = 0;
+            for (size_t level = 0; level < m_compactors.size(); ++level) total += m_compactors[level].size();
+            return total;
+        }
+        /** Copy the retained values and their weights, sorted by value
+         *
+         * @param values destination vector of weighted values
+         */
+        void weighted_values(weighted_vector_t& values) const
+        {
+            values.clear();
+            values.reserve(retained());
+            for (size_t level = 0; level < m_compactors.size(); ++level)
+            {
+                const ::uint64_t weight = ::uint64_t(1) << level;
+                for (size_t i = 0; i < m_compactors[level].size(); ++i)
+                    values.push_back(weighted_value_t(m_compactors[level][i], weight));
+            }
+            std::sort(values.begin(), values.end());
+        }
+        /** Copy the retained values, sorted by value
+         *
+         * When the sketch is exact, these are all the values added.
+         *
+         * @param values destination vector of values
+         */
+        void sorted_values(std::vector<float>& values) const
+        {
+            values.clear();
+            values.reserve(retained());
+            for (size_t level = 0; level < m_compactors.size(); ++level)
+                values.insert(values.end(), m_compactors[level].begin(), m_compactors[level].end());
+            std::sort(values.begin(), values.end());
+        }
+        /** Estimate the interpolated percentile of the values added
+         *
+         * The percentile is interpolated between the rank midpoints of the retained values, so an exact sketch gives
+         * the same result as util::percentile_sorted over all values.
+         *
+         * @param target_percentile target percentile [0-100]
+         * @return estimated percentile, NaN if empty
+         */
+        float percentile(const size_t target_percentile) const
+        {
+            if (m_count == 0) return std::numeric_limits<float>::quiet_NaN();
+            if (is_exact())
+            {
+                std::vector<float> values;
+                sorted_values(values);
+                return util::percentile_sorted<float>(values.begin(), values.end(), target_percentile);
+            }
+            weighted_vector_t values;
+            weighted_values(values);
+            const double target = target_percentile * static_cast<double>(m_count) / 100.0;
+            double previous_midpoint = 0;
+            ::uint64_t cumulative = 0;
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                const double midpoint = cumulative + values[i].second / 2.0;
+                if (target <= midpoint)
+                {
+                    if (i == 0) return values[i].first;
+                    return util::interpolate_linear(values[i - 1].first,
+                                                    values[i].first,
+                                                    static_cast<float>(previous_midpoint),
+                                                    static_cast<float>(midpoint),
+                                                    static_cast<float>(target));
+                }
+                previous_midpoint = midpoint;
+                cumulative += values[i].second;
+            }
+            return values.back().first;
+        }
+
+    private:
+        /** Get the capacity of a compactor
+         *
+         * The capacity shrinks by 2/3 for each level below the top compactor.
+         *
+         * @param level level of the compactor
+         * @return capacity of the compactor
+         */
+        size_t capacity(const size_t level) const
+        {
+            const size_t depth = m_compactors.size() - 1 - level;
+            const double scale = std::pow(2.0 / 3.0, static_cast<double>(depth));
+            return std::max<size_t>(MIN_CAPACITY, static_cast<size_t>(std::ceil(m_k * scale)));
+        }
+        /** Compact full compactors until the sketch is within its capacity
+         */
+        void compress()
+        {
+            for (size_t level = 0; level < m_compactors.size(); ++level)
+            {
+                if (m_compactors[level].size() < capacity(level)) continue;
+                if (level + 1 == m_compactors.size()) m_compactors.push_back(compactor_t());
+                compactor_t& compactor = m_compactors[level];
+                compactor_t& next = m_compactors[level + 1];
+                std::sort(compactor.begin(), compactor.end());
+                // An odd value out stays at this level, so the total weight is unchanged
+                const size_t first = compactor.size() % 2;
+                for (size_t i = first + (m_odd ? 1 : 0); i < compactor.size(); i += 2) next.push_back(compactor[i]);
+                m_odd = !m_odd;
+                compactor.resize(first);
+            }
+        }
+
+    private:
+        size_t m_k;
+        ::uint64_t m_count;
+        float m_min;
+        float m_max;
+        bool m_odd;
+        compactor_vector_t m_compactors;
+    };
+}}}
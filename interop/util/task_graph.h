@@ -0,0 +1,122 @@
+/** Graph of named tasks that run on the shared thread pool once their dependencies finish
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include "interop/util/thread_pool.h"
+
+namespace illumina { namespace interop { namespace util
+{
+    /** Wall clock time spent in a single task of a task graph
+     */
+    struct task_timing
+    {
+        /** Constructor
+         *
+         * @param task_name name of the task
+         */
+        task_timing(const std::string& task_name="") : name(task_name), start(0), duration(0), ran(false){}
+
+        /** Name of the task */
+        std::string name;
+        /** Seconds from the start of the graph to the start of the task */
+        double start;
+        /** Seconds spent in the task */
+        double duration;
+        /** False if the task did not run, e.g. after another task threw an exception */
+        bool ran;
+    };
+
+    /** Run a member function of an object as a task
+     */
+    template<class T, typename Arg>
+    class member_function_task : public abstract_task
+    {
+    public:
+        /** Member function of T taking a single argument */
+        typedef void (T::*function_t)(Arg);
+
+    public:
+        /** Constructor
+         *
+         * @param object object called
+         * @param function member function to call
+         * @param argument argument given to the member function
+         */
+        member_function_task(T& object, function_t function, Arg argument) :
+                m_object(object), m_function(function), m_argument(argument)
+        {
+        }
+        /** Call the member function */
+        void operator()()
+        {
+            (m_object.*m_function)(m_argument);
+        }
+
+    private:
+        T& m_object;
+        function_t m_function;
+        Arg m_argument;
+    };
+
+    /** Graph of named tasks where each task runs once all of its dependencies finish
+     *
+     * Independent tasks run concurrently on the shared thread pool, so the latency of the graph approaches the
+     * longest chain of dependencies. The first exception thrown by a task stops any task that has not started
+     * and is rethrown by run.
+     *
+     * Tasks are not copied, so each task must outlive the call to run.
+     */
+    class task_graph
+    {
+    public:
+        /** Add a task to the graph
+         *
+         * @param name name of the task, reported in the timings
+         * @param task task to run
+         * @return index of the task in the graph
+         */
+        size_t add(const std::string& name, abstract_task& task);
+        /** Add a dependency between two tasks of the graph
+         *
+         * @param task index of the dependent task
+         * @param dependency index of the task that must finish first, added before the dependent task
+         */
+        void depends_on(const size_t task, const size_t dependency);
+        /** Run all tasks of the graph
+         *
+         * @param thread_count 1 runs the tasks serially in the order added, otherwise the tasks run on the shared
+         *        thread pool
+         */
+        void run(const size_t thread_count=0);
+        /** Get the time spent in each task of the last run
+         *
+         * @return timings in the order the tasks were added
+         */
+        const std::vector<task_timing>& timings()const
+        {
+            return m_timings;
+        }
+        /** Get the number of tasks in the graph
+         *
+         * @return number of tasks
+         */
+        size_t size()const
+        {
+            return m_tasks.size();
+        }
+
+    private:
+        std::vector<abstract_task*> m_tasks;
+        std::vector< std::vector<size_t> > m_dependents;
+        std::vector<size_t> m_dependency_count;
+        std::vector<task_timing> m_timings;
+    };
+
+}}}
@@ -0,0 +1,284 @@
+/** Work stealing pool of threads shared by the loading, summary and table logic
+ *
+ * Each worker thread owns a queue of tasks. A worker takes the most recent task from its own queue and, when it is
+ * empty, steals the oldest task from another queue. A thread waiting on a group of tasks runs queued tasks rather
+ * than blocking, so groups can be nested without exhausting the pool.
+ *
+ * The pool requires std::thread (C++11). Otherwise, e.g. when compiled for C++98, tasks run serially on the thread
+ * that waits for them.
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#pragma once
+
+#include <cstddef>
+
+namespace illumina { namespace interop { namespace util
+{
+    /** Interface for a unit of work run by a task_group
+     */
+    class abstract_task
+    {
+    public:
+        /** Destructor */
+        virtual ~abstract_task(){}
+        /** Run the task */
+        virtual void operator()()=0;
+    };
+
+    /** Interface for the body of a loop run by parallel_for
+     */
+    class abstract_loop_body
+    {
+    public:
+        /** Destructor */
+        virtual ~abstract_loop_body(){}
+        /** Run a single iteration of the loop
+         *
+         * @param index index of the iteration
+         */
+        virtual void operator()(const size_t index)=0;
+    };
+
+    /** Group of tasks scheduled on the shared thread pool that can be waited on, like a future, or cancelled
+     *
+     * Tasks are not copied, so each task must outlive the call to wait. The first exception thrown by a task
+     * cancels the group and is rethrown by wait. While waiting, a thread only runs queued tasks of its own group,
+     * so a nested wait never picks up unrelated work.
+     *
+     * @note Only the thread that created the group may call wait, tasks of the group may call run
+     */
+    class task_group
+    {
+    public:
+        /** State shared with the threads running the tasks, defined by the implementation */
+        struct state;
+
+    public:
+        /** Constructor
+         *
+         * @param thread_count number of threads running the tasks of the group, including the waiting thread,
+         *        0 for the default thread count
+         */
+        explicit task_group(const size_t thread_count=0);
+        /** Destructor waits for the running tasks, exceptions are ignored */
+        ~task_group();
+
+    public:
+        /** Schedule a task on the shared thread pool
+         *
+         * @param task task to run
+         */
+        void run(abstract_task& task);
+        /** Wait for all scheduled tasks to finish, running queued tasks while waiting
+         *
+         * The first exception thrown by a task is rethrown.
+         */
+        void wait();
+        /** Cancel the tasks that have not started
+         *
+         * Running tasks may poll is_cancelled to stop early.
+         */
+        void cancel();
+        /** Test if the group has been cancelled, either explicitly or by an exception
+         *
+         * @return true if the group was cancelled
+         */
+        bool is_cancelled()const;
+
+    private:
+        task_group(const task_group&);
+        task_group& operator=(const task_group&);
+
+    private:
+        state* m_state;
+    };
+
+    /** Mutual exclusion for data shared between tasks
+     *
+     * When the pool is not concurrent, locking does nothing.
+     */
+    class mutex
+    {
+    public:
+        /** Implementation defined lock */
+        struct state;
+
+    public:
+        /** Constructor */
+        mutex();
+        /** Destructor */
+        ~mutex();
+
+    public:
+        /** Block until the lock is acquired */
+        void lock();
+        /** Release the lock */
+        void unlock();
+
+    private:
+        mutex(const mutex&);
+        mutex& operator=(const mutex&);
+        friend class condition_variable;
+
+    private:
+        state* m_state;
+    };
+
+    /** Mutex held as a member of a copyable class
+     *
+     * A copy of the owner gets its own unlocked mutex, the lock state is never copied.
+     */
+    class member_mutex : public mutex
+    {
+    public:
+        /** Constructor */
+        member_mutex(){}
+        /** Copy constructor creates a new mutex */
+        member_mutex(const member_mutex&) : mutex(){}
+        /** Assignment keeps this mutex
+         *
+         * @return this mutex
+         */
+        member_mutex& operator=(const member_mutex&)
+        {
+            return *this;
+        }
+    };
+
+    /** Hold a lock on a mutex for the lifetime of this object
+     */
+    class scoped_lock
+    {
+    public:
+        /** Constructor acquires the lock
+         *
+         * @param lock_mutex mutex to lock
+         */
+        scoped_lock(mutex& lock_mutex) : m_mutex(lock_mutex)
+        {
+            m_mutex.lock();
+        }
+        /** Destructor releases the lock */
+        ~scoped_lock()
+        {
+            m_mutex.unlock();
+        }
+
+    private:
+        scoped_lock(const scoped_lock&);
+        scoped_lock& operator=(const scoped_lock&);
+
+    private:
+        mutex& m_mutex;
+    };
+
+    /** Block a thread until another thread changes data guarded by a mutex
+     *
+     * When the pool is not concurrent, waiting returns immediately, so the caller must recheck its condition.
+     */
+    class condition_variable
+    {
+    public:
+        /** Implementation defined condition */
+        struct state;
+
+    public:
+        /** Constructor */
+        condition_variable();
+        /** Destructor */
+        ~condition_variable();
+
+    public:
+        /** Release the mutex, block until notified, then lock the mutex again
+         *
+         * As with any condition variable, the wait may end without a notification.
+         *
+         * @param locked_mutex mutex locked by the calling thread
+         */
+        void wait(mutex& locked_mutex);
+        /** Wake all threads waiting on this condition */
+        void notify_all();
+
+    private:
+        condition_variable(const condition_variable&);
+        condition_variable& operator=(const condition_variable&);
+
+    private:
+        state* m_state;
+    };
+
+    /** Run each iteration of a loop on the shared thread pool
+     *
+     * Iterations are handed out one at a time, so the cost of each iteration may vary. The calling thread runs
+     * iterations along with the pool. The first exception thrown by the body stops the loop and is rethrown.
+     *
+     * @param count number of iterations
+     * @param body body of the loop
+     * @param thread_count maximum number of threads running the loop, 0 for the default thread count
+     */
+    void parallel_for(const size_t count, abstract_loop_body& body, const size_t thread_count=0);
+
+    namespace detail
+    {
+        /** Adapt a functor taking an index to the loop body interface
+         */
+        template<class Function>
+        class loop_body_adapter : public abstract_loop_body
+        {
+        public:
+            /** Constructor
+             *
+             * @param function functor taking the index of the iteration
+             */
+            loop_body_adapter(Function& function) : m_function(function){}
+            /** Run a single iteration of the loop
+             *
+             * @param index index of the iteration
+             */
+            void operator()(const size_t index)
+            {
+                m_function(index);
+            }
+
+        private:
+            Function& m_function;
+        };
+    }
+
+    /** Run each iteration of a loop on the shared thread pool
+     *
+     * @see parallel_for(const size_t, abstract_loop_body&, const size_t)
+     * @param count number of iterations
+     * @param function functor taking the index of the iteration
+     * @param thread_count maximum number of threads running the loop, 0 for the default thread count
+     */
+    template<class Function>
+    void parallel_for_each_index(const size_t count, Function& function, const size_t thread_count=0)
+    {
+        detail::loop_body_adapter<Function> body(function);
+        parallel_for(count, body, thread_count);
+    }
+
+    /** Set the number of threads used when a thread count of 0 is requested
+     *
+     * This is the single global concurrency setting, each call may request its own thread count.
+     *
+     * @param thread_count number of threads, 0 for the number of processors
+     */
+    void set_default_thread_count(const size_t thread_count);
+    /** Get the number of threads used when a thread count of 0 is requested
+     *
+     * @return number of threads
+     */
+    size_t default_thread_count();
+    /** Test if tasks run on a pool of threads, or serially
+     *
+     * @return true if the pool runs tasks concurrently
+     */
+    bool is_thread_pool_concurrent();
+
+}}}
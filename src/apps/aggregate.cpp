@@ -110,6 +110,9 @@ int main(int argc, const char** argv)
     const std::string input_file=argv[1];
     const std::string run_name = io::basename(input_file);
     std::cout << "# Run Folder: " << run_name << std::endl;
+    // Skip tiles above the maximum tile number while decoding rather than after loading the whole run
+    if(max_tile_number > 0)
+        run.set_read_filter(model::metric_base::record_filter(0, 0, 0, 0, static_cast< ::uint32_t >(max_tile_number)));
     int ret = read_run_metrics(input_file.c_str(), run, thread_count);
     if(ret != SUCCESS) return ret;
     io::mkdir("InterOp");
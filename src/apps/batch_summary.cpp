@@ -0,0 +1,330 @@
+/** @page batch_summary Summarize many run folders
+ *
+ *
+ * This application summarizes the run and index metrics of many run folders in a single process. The run folders
+ * are summarized concurrently on a shared pool of threads and the results are written as a single CSV or JSON
+ * document.
+ *
+ * ### Running the Program
+ *
+ * The program runs as follows:
+ *
+ *      $ batch_summary --threads=8 --memory-budget=4096 run_folder1 run_folder2 ... run_folderN
+ *
+ * In this sample, eight run folders are summarized at a time, as long as the InterOp files of the run folders being
+ * summarized are estimated to need less than 4096 MB. The summary is written to the standard output as follows
+ *
+ *      # Version: v1.0.4-224-gacc6c8e
+ *      Run,Level,Yield,Projected Yield,Aligned,Error Rate,Intensity C1,%>=Q30,% Occupied
+ *      run_folder1,Read 1,9.92,9.92,0.00,nan,178,96.70,nan
+ *      run_folder1,Non-indexed,9.92,9.92,0.00,nan,178,96.70,nan
+ *      run_folder1,Total,9.92,9.92,0.00,nan,178,96.70,nan
+ *      ...
+ *
+ *      Run,Lane,Total Reads,PF Reads,% Read Identified (PF),CV,Min,Max
+ *      run_folder1,1,22855008,19391826,96.7232,0.5136,0.0001,2.9831
+ *      ...
+ *
+ * With --json=1, a JSON array holding an object for each run folder is written instead.
+ *
+ * ### Error Handling
+ *
+ *  A run folder that cannot be summarized does not stop the batch. The error is written to the error stream, or
+ *  to the "error" field in JSON, and the program returns an error code (any number except 0) after all run folders
+ *  are summarized.
+ */
+
+#include <iostream>
+#include "interop/util/math.h"
+#include "interop/util/length_of.h"
+#include "interop/util/lexical_cast.h"
+#include "interop/io/metric_file_stream.h"
+#include "interop/logic/summary/batch_summary.h"
+#include "interop/util/option_parser.h"
+#include "interop/version.h"
+#include "inc/application.h"
+
+using namespace illumina::interop::model::summary;
+using namespace illumina::interop::logic::summary;
+using namespace illumina::interop;
+
+/** Print the run summaries of each run folder as CSV
+ *
+ * @param out output stream
+ * @param summaries summary of each run folder
+ */
+void print_csv(std::ostream& out, const std::vector<batch_run_summary>& summaries);
+/** Print the run summaries of each run folder as JSON
+ *
+ * @param out output stream
+ * @param summaries summary of each run folder
+ */
+void print_json(std::ostream& out, const std::vector<batch_run_summary>& summaries);
+
+int main(int argc, const char** argv)
+{
+    const bool skip_median_calculation=true;
+    if(argc == 0)
+    {
+        std::cerr << "No arguments specified!" << std::endl;
+        return INVALID_ARGUMENTS;
+    }
+
+    size_t thread_count=0;
+    size_t memory_budget_mb=0;
+    int json_format=0;
+    util::option_parser description;
+    description
+            (thread_count, "threads", "Number of run folders summarized at the same time, 0 for the number of processors")
+            (memory_budget_mb, "memory-budget", "Estimated memory in MB of the run folders summarized at the same time, 0 for no limit")
+            (json_format, "json", "Format output as JSON rather than CSV");
+    if(description.is_help_requested(argc, argv))
+    {
+        std::cout << "Usage: " << io::basename(argv[0]) << " run_folder1 run_folder2 ... [--option1=value1] [--option2=value2]" << std::endl;
+        description.display_help(std::cout);
+        return SUCCESS;
+    }
+    try
+    {
+        description.parse(argc, argv);
+        description.check_for_unknown_options(argc, argv);
+    }
+    catch(const util::option_exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return INVALID_ARGUMENTS;
+    }
+    if(argc < 2)
+    {
+        std::cerr << "Expected: $ batch_summary <run-folder1> <run-folder2> ... <run-folderN>" << std::endl;
+        return INVALID_ARGUMENTS;
+    }
+
+    const std::vector<std::string> run_folders(argv+1, argv+argc);
+    std::vector<batch_run_summary> summaries;
+    summarize_run_folders(run_folders,
+                          summaries,
+                          thread_count,
+                          static_cast< ::uint64_t >(memory_budget_mb) << 20,
+                          skip_median_calculation);
+
+    int ret = SUCCESS;
+    for(size_t i=0;i<summaries.size();++i)
+    {
+        if(summaries[i].error.empty()) continue;
+        if(json_format == 0) std::cerr << summaries[i].run_folder << ": " << summaries[i].error << std::endl;
+        ret = UNEXPECTED_EXCEPTION;
+    }
+    try
+    {
+        if(json_format != 0) print_json(std::cout, summaries);
+        else
+        {
+            std::cout << "# Version: " << INTEROP_VERSION << std::endl;
+            print_csv(std::cout, summaries);
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return UNEXPECTED_EXCEPTION;
+    }
+    return ret;
+}
+
+/** Format the read name
+ *
+ * @param read read information
+ * @return read name
+ */
+std::string format_read(const model::run::read_info& read)
+{
+    return "Read "+util::lexical_cast<std::string>(read.number()) + (read.is_index() ? " (I)" : "");
+}
+/** Format the values of a metric summary
+ *
+ * @param summary metric summary
+ * @param values destination values, the first is the level and is not set
+ */
+void summarize(const metric_summary& summary, std::vector<std::string>& values)
+{
+    size_t i=1;
+    values[i++] = util::format(summary.yield_g(), 0, 2);
+    values[i++] = util::format(summary.projected_yield_g(), 0, 2);
+    values[i++] = util::format(summary.percent_aligned(), 0, 2);
+    values[i++] = util::format(summary.error_rate(), 0, 2);
+    values[i++] = util::lexical_cast<std::string>(long(summary.first_cycle_intensity()+0.5));
+    values[i++] = util::format(summary.percent_gt_q30(), 0, 2);
+    values[i++] = util::format(summary.percent_occupied(), 0, 2);
+    if(i != values.size()) INTEROP_THROW(std::runtime_error, "There is a bug in the program, columns do not match header");
+}
+/** Format the values of an index lane summary
+ *
+ * @param summary index lane summary
+ * @param values destination values, the first is the lane and is not set
+ */
+void summarize(const index_lane_summary& summary, std::vector<std::string>& values)
+{
+    size_t i=1;
+    values[i++] = util::format(static_cast<float>(summary.total_reads()), 0, 0);
+    values[i++] = util::format(static_cast<float>(summary.total_pf_reads()), 0, 0);
+    values[i++] = util::format(summary.total_fraction_mapped_reads(), 0, 4);
+    values[i++] = util::format(summary.mapped_reads_cv(), 0, 4);
+    values[i++] = util::format(summary.min_mapped_reads(), 0, 4);
+    values[i++] = util::format(summary.max_mapped_reads(), 0, 4);
+    if(i != values.size()) INTEROP_THROW(std::runtime_error, "There is a bug in the program, columns do not match header");
+}
+/** Write a row of comma separated values
+ *
+ * @param out output stream
+ * @param run run folder name
+ * @param values values in the row
+ */
+void print_row(std::ostream& out, const std::string& run, const std::vector<std::string>& values)
+{
+    out << run;
+    for(size_t i=0;i<values.size();++i) out << "," << values[i];
+    out << "\n";
+}
+
+void print_csv(std::ostream& out, const std::vector<batch_run_summary>& summaries)
+{
+    const char* read_header[] = {"Level", "Yield", "Projected Yield", "Aligned", "Error Rate", "Intensity C1", "%>=Q30", "% Occupied"};
+    std::vector<std::string> values(read_header, read_header+util::length_of(read_header));
+    print_row(out, "Run", values);
+    for(size_t i=0;i<summaries.size();++i)
+    {
+        const run_summary& summary = summaries[i].run;
+        if(summary.size() == 0) continue;
+        const std::string run = io::basename(summaries[i].run_folder);
+        for (size_t read = 0; read < summary.size(); ++read)
+        {
+            values[0] = format_read(summary[read].read());
+            summarize(summary[read].summary(), values);
+            print_row(out, run, values);
+        }
+        values[0] = "Non-indexed";
+        summarize(summary.nonindex_summary(), values);
+        print_row(out, run, values);
+        values[0] = "Total";
+        summarize(summary.total_summary(), values);
+        print_row(out, run, values);
+    }
+    out << "\n";
+
+    const char* index_header[] = {"Lane", "Total Reads", "PF Reads", "% Read Identified (PF)", "CV", "Min", "Max"};
+    values.assign(index_header, index_header+util::length_of(index_header));
+    print_row(out, "Run", values);
+    for(size_t i=0;i<summaries.size();++i)
+    {
+        const index_flowcell_summary& summary = summaries[i].index;
+        const std::string run = io::basename(summaries[i].run_folder);
+        for(size_t lane=0;lane<summary.size();++lane)
+        {
+            if(summary[lane].size() == 0) continue;
+            values[0] = util::lexical_cast<std::string>(lane+1);
+            summarize(summary[lane], values);
+            print_row(out, run, values);
+        }
+    }
+    out.flush();
+}
+
+/** Quote and escape a string for JSON
+ *
+ * @param str string
+ * @return JSON string
+ */
+std::string json_string(const std::string& str)
+{
+    std::string quoted = "\"";
+    for(size_t i=0;i<str.length();++i)
+    {
+        const char ch = str[i];
+        if(ch == '"' || ch == '\\') quoted += '\\';
+        if(static_cast<unsigned char>(ch) < 0x20)
+        {
+            const char* hex = "0123456789abcdef";
+            quoted += "\\u00";
+            quoted += hex[(ch >> 4) & 0xF];
+            quoted += hex[ch & 0xF];
+        }
+        else quoted += ch;
+    }
+    return quoted + "\"";
+}
+/** Format a number for JSON, where a missing value is null
+ *
+ * @param value number
+ * @param precision number of digits after the decimal point
+ * @return JSON number
+ */
+std::string json_number(const float value, const int precision)
+{
+    if(std::isnan(value) || std::isinf(value)) return "null";
+    return util::format(value, 0, precision);
+}
+/** Write a metric summary as a JSON object
+ *
+ * @param out output stream
+ * @param level name of the summary level
+ * @param summary metric summary
+ */
+void print_json(std::ostream& out, const std::string& level, const metric_summary& summary)
+{
+    out << "{\"level\": " << json_string(level)
+        << ", \"yield_g\": " << json_number(summary.yield_g(), 2)
+        << ", \"projected_yield_g\": " << json_number(summary.projected_yield_g(), 2)
+        << ", \"percent_aligned\": " << json_number(summary.percent_aligned(), 2)
+        << ", \"error_rate\": " << json_number(summary.error_rate(), 2)
+        << ", \"first_cycle_intensity\": " << json_number(summary.first_cycle_intensity(), 0)
+        << ", \"percent_gt_q30\": " << json_number(summary.percent_gt_q30(), 2)
+        << ", \"percent_occupied\": " << json_number(summary.percent_occupied(), 2)
+        << "}";
+}
+
+void print_json(std::ostream& out, const std::vector<batch_run_summary>& summaries)
+{
+    out << "[";
+    for(size_t i=0;i<summaries.size();++i)
+    {
+        const run_summary& summary = summaries[i].run;
+        out << (i == 0 ? "\n" : ",\n");
+        out << "  {\"run_folder\": " << json_string(summaries[i].run_folder)
+            << ", \"error\": " << (summaries[i].error.empty() ? std::string("null") : json_string(summaries[i].error))
+            << ",\n   \"summary\": [";
+        for (size_t read = 0; read < summary.size(); ++read)
+        {
+            out << "\n    ";
+            print_json(out, format_read(summary[read].read()), summary[read].summary());
+            out << ",";
+        }
+        if(summary.size() > 0)
+        {
+            out << "\n    ";
+            print_json(out, "Non-indexed", summary.nonindex_summary());
+            out << ",\n    ";
+            print_json(out, "Total", summary.total_summary());
+        }
+        out << "],\n   \"index\": [";
+        const index_flowcell_summary& index = summaries[i].index;
+        bool first = true;
+        for(size_t lane=0;lane<index.size();++lane)
+        {
+            if(index[lane].size() == 0) continue;
+            out << (first ? "\n    " : ",\n    ");
+            first = false;
+            out << "{\"lane\": " << lane+1
+                << ", \"total_reads\": " << index[lane].total_reads()
+                << ", \"pf_reads\": " << index[lane].total_pf_reads()
+                << ", \"percent_read_identified_pf\": " << json_number(index[lane].total_fraction_mapped_reads(), 4)
+                << ", \"cv\": " << json_number(index[lane].mapped_reads_cv(), 4)
+                << ", \"min\": " << json_number(index[lane].min_mapped_reads(), 4)
+                << ", \"max\": " << json_number(index[lane].max_mapped_reads(), 4)
+                << "}";
+        }
+        out << "]}";
+    }
+    out << "\n]\n";
+    out.flush();
+}
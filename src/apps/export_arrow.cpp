@@ -0,0 +1,91 @@
+/** @page export_arrow Export the Imaging Table in the Apache Arrow IPC Format
+ *
+ *
+ * This application writes the same data as the imaging_table application in the Apache Arrow IPC format, which
+ * Pandas, Polars, DuckDB and other analytics tools load without parsing text.
+ *
+ * ### Running the Program
+ *
+ * The program runs as follows:
+ *
+ *      $ export_arrow 9166157_221Bin2R0I imaging.arrow
+ *
+ * In this sample, 9166157_221Bin2R0I is a run folder and the table is written to imaging.arrow in the random
+ * access file format, which can be memory mapped. If the output file ends with .arrows or is -, the table is written
+ * in the streaming format, the latter to the standard output.
+ *
+ * The file can then be loaded, for example, in Python:
+ *
+ *      import pyarrow as pa
+ *      table = pa.ipc.open_file(pa.memory_map("imaging.arrow")).read_all()
+ *      frame = table.to_pandas()
+ */
+
+#include <iostream>
+#include "interop/io/metric_file_stream.h"
+#include "interop/model/run_metrics.h"
+#include "interop/logic/table/create_imaging_table.h"
+#include "interop/io/table/arrow_format.h"
+#include "interop/version.h"
+#include "inc/application.h"
+
+using namespace illumina::interop::model::metrics;
+using namespace illumina::interop;
+
+/** Test if the output file should be written in the streaming format
+ *
+ * @param file_name name of the output file
+ * @return true if the streaming format should be used
+ */
+bool use_stream_layout(const std::string& file_name)
+{
+    const std::string extension = ".arrows";
+    if(file_name == "-") return true;
+    return file_name.length() >= extension.length() &&
+           file_name.compare(file_name.length()-extension.length(), extension.length(), extension) == 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Expected: $ export_arrow <run-folder> <output-file>" << std::endl;
+        return INVALID_ARGUMENTS;
+    }
+    const size_t thread_count = 1;
+    const std::string output_file = argv[2];
+
+    std::vector<unsigned char> valid_to_load;
+    logic::table::list_imaging_table_metrics_to_load(valid_to_load);
+    run_metrics run;
+    int ret = read_run_metrics(argv[1], run, valid_to_load, thread_count);
+    if (ret != SUCCESS)
+    {
+        std::cerr << "Expected: $ export_arrow <run-folder> <output-file>" << std::endl;
+        return ret;
+    }
+
+    model::table::imaging_table table;
+    try
+    {
+        logic::table::create_imaging_table(run, table);
+        const io::table::arrow_layout layout = use_stream_layout(output_file) ? io::table::ArrowStream :
+                                                                                io::table::ArrowFile;
+        if(output_file == "-")
+        {
+            io::table::write_arrow(std::cout, table, layout);
+            if(!std::cout.good()) return UNEXPECTED_EXCEPTION;
+        }
+        else if(!io::table::write_arrow(output_file, table, layout))
+        {
+            std::cerr << "Failed to write " << output_file << std::endl;
+            return UNEXPECTED_EXCEPTION;
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return UNEXPECTED_EXCEPTION;
+    }
+    return SUCCESS;
+}
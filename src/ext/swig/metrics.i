@@ -81,6 +81,8 @@ METRICS_EXCEPTION_WRAPPER(WRAP_EXCEPTION)
 %include "interop/model/metric_base/base_metric.h"
 %include "interop/model/metric_base/base_cycle_metric.h"
 %include "interop/model/metric_base/base_read_metric.h"
+%ignore illumina::interop::model::metric_base::record_filter::operator();
+%include "interop/model/metric_base/record_filter.h"
 %include "interop/model/metric_base/metric_set.h"
 
 
@@ -99,6 +101,8 @@ METRICS_EXCEPTION_WRAPPER(WRAP_EXCEPTION)
     %ignore illumina::interop::model::metric_base::metric_set<metric_t>::populate_tile_numbers_for_lane_surface;
     %ignore illumina::interop::model::metric_base::metric_set<metric_t>::offset_map;
     %ignore illumina::interop::model::metric_base::metric_set<metric_t>::remove;
+    %ignore illumina::interop::model::metric_base::metric_set<metric_t>::lane_view;
+    %ignore illumina::interop::model::metric_base::metric_set<metric_t>::cycle_view;
 
     %apply size_t { std::map< std::size_t, metric_t >::size_type };
     %apply uint64_t { metric_base::metric_set<metric_t>::id_t };
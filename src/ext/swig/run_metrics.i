@@ -96,6 +96,8 @@ RUN_METRICS_EXCEPTION_WRAPPER(WRAP_EXCEPTION)
 %{
 #include "interop/model/run_metrics.h"
 %}
+%ignore illumina::interop::model::metrics::run_metrics::find_result;
+%ignore illumina::interop::model::metrics::run_metrics::store_result;
 %include "interop/model/run_metrics.h"
 
 %define WRAP_RUN_METRICS(metric_t)
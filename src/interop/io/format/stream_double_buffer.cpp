@@ -0,0 +1,139 @@
+/** Double buffered stream that reads the next block of a file while the current block is decoded
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#include "interop/io/format/stream_double_buffer.h"
+
+namespace illumina { namespace interop { namespace io { namespace detail
+{
+    /** Constructor
+     *
+     * @param source source stream
+     * @param buffer_size number of bytes in each buffer
+     */
+    double_buffer::double_buffer(std::istream& source, const size_t buffer_size) :
+            m_source(source),
+            m_front(buffer_size > 0 ? buffer_size : 1),
+            m_back(buffer_size > 0 ? buffer_size : 1),
+            m_back_count(0),
+            m_position(0),
+            m_pending(false),
+            m_fill_task(*this),
+            m_fill_group(2) // One worker fills the back buffer while this thread decodes
+    {
+        const std::streampos start = source.tellg();
+        if (start > std::streampos(0)) m_position = start;
+        setg(0, 0, 0);
+        start_fill();
+    }
+
+    /** Destructor waits for any pending read of the source stream
+     */
+    double_buffer::~double_buffer()
+    {
+        try
+        {
+            wait();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    /** Swap in the next buffer when the current buffer is exhausted
+     *
+     * @return next character or eof
+     */
+    double_buffer::int_type double_buffer::underflow()
+    {
+        if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+        wait();
+        m_position += egptr() - eback();
+        setg(0, 0, 0);
+        if (m_back_count <= 0) return traits_type::eof();
+        m_front.swap(m_back);
+        char* begin = &m_front.front();
+        setg(begin, begin, begin + m_back_count);
+        start_fill();
+        return traits_type::to_int_type(*gptr());
+    }
+
+    /** Get the current position of the stream
+     *
+     * @param off offset, must be 0
+     * @param dir seek direction, must be current
+     * @param which open mode, must include input
+     * @return current position or -1 if the seek is not supported
+     */
+    double_buffer::pos_type double_buffer::seekoff(off_type off,
+                                                   std::ios_base::seekdir dir,
+                                                   std::ios_base::openmode which)
+    {
+        if (off != 0 || dir != std::ios_base::cur || (which & std::ios_base::in) == 0)
+            return pos_type(off_type(-1));
+        return pos_type(m_position + (gptr() - eback()));
+    }
+
+    void double_buffer::start_fill()
+    {
+        m_back_count = 0;
+        m_pending = true;
+        m_fill_group.run(m_fill_task);
+    }
+
+    void double_buffer::fill()
+    {
+        m_source.read(&m_back.front(), static_cast<std::streamsize>(m_back.size()));
+        m_back_count = m_source.gcount();
+    }
+
+    void double_buffer::wait()
+    {
+        if (!m_pending) return;
+        m_pending = false;
+        m_fill_group.wait();
+    }
+
+    /** Decode the source stream, reading the next block of the source while the current block is decoded
+     *
+     * @param source source stream
+     * @param buffer_size number of bytes in each buffer
+     * @param reader decodes the buffered stream
+     */
+    void read_double_buffered(std::istream& source, const size_t buffer_size, abstract_stream_reader& reader)
+    INTEROP_THROW_SPEC((io::file_not_found_exception,
+    io::bad_format_exception,
+    io::incomplete_file_exception,
+    model::index_out_of_bounds_exception))
+    {
+        try
+        {
+            double_buffer buffer(source, buffer_size);
+            std::istream in(&buffer);
+            reader(in);
+        }
+        catch (const io::file_not_found_exception&)
+        {
+            throw;
+        }
+        catch (const io::bad_format_exception&)
+        {
+            throw;
+        }
+        catch (const io::incomplete_file_exception&)
+        {
+            throw;
+        }
+        catch (const model::index_out_of_bounds_exception&)
+        {
+            throw;
+        }
+        catch (const std::exception& ex)
+        {
+            throw io::bad_format_exception(ex.what());
+        }
+    }
+}}}}
@@ -0,0 +1,140 @@
+/** Stream buffer that decompresses a gzip compressed file
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+
+#include "interop/io/format/stream_gzip.h"
+#include <fstream>
+#include "interop/util/filesystem.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace illumina { namespace interop { namespace io
+{
+    namespace detail
+    {
+        /** Constructor
+         *
+         * @param file_name path to the gzip compressed file
+         * @param buffer_size number of decompressed bytes in the buffer
+         */
+        gzip_buffer::gzip_buffer(const std::string& file_name, const size_t buffer_size) :
+                m_file(0),
+                m_buffer(buffer_size > 0 ? buffer_size : 1),
+                m_position(0)
+        {
+#ifdef HAVE_ZLIB
+            m_file = gzopen(file_name.c_str(), "rb");
+#   if ZLIB_VERNUM >= 0x1240
+            if(m_file != 0) gzbuffer(m_file, static_cast<unsigned>(m_buffer.size() < 8192 ? 8192 : m_buffer.size()));
+#   endif
+#else
+            (void)file_name;
+#endif
+            setg(0, 0, 0);
+        }
+
+        /** Destructor closes the file
+         */
+        gzip_buffer::~gzip_buffer()
+        {
+#ifdef HAVE_ZLIB
+            if(m_file != 0) gzclose(m_file);
+#endif
+        }
+
+        /** Test if the file was opened
+         *
+         * @return true if the file was opened
+         */
+        bool gzip_buffer::is_open()const
+        {
+            return m_file != 0;
+        }
+
+        /** Decompress the next block of the file when the buffer is exhausted
+         *
+         * @return next character or eof
+         */
+        gzip_buffer::int_type gzip_buffer::underflow()
+        {
+            if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+            m_position += egptr() - eback();
+            setg(0, 0, 0);
+#ifdef HAVE_ZLIB
+            if(m_file == 0) return traits_type::eof();
+            const int count = gzread(m_file, &m_buffer.front(), static_cast<unsigned>(m_buffer.size()));
+            if(count <= 0) return traits_type::eof();
+            char* begin = &m_buffer.front();
+            setg(begin, begin, begin + count);
+            return traits_type::to_int_type(*gptr());
+#else
+            return traits_type::eof();
+#endif
+        }
+
+        /** Get the current position of the decompressed stream
+         *
+         * @param off offset, must be 0
+         * @param dir seek direction, must be current
+         * @param which open mode, must include input
+         * @return current position or -1 if the seek is not supported
+         */
+        gzip_buffer::pos_type gzip_buffer::seekoff(off_type off,
+                                                   std::ios_base::seekdir dir,
+                                                   std::ios_base::openmode which)
+        {
+            if (off != 0 || dir != std::ios_base::cur || (which & std::ios_base::in) == 0)
+                return pos_type(off_type(-1));
+            return pos_type(m_position + (gptr() - eback()));
+        }
+
+        /** Estimate the size of the decompressed file
+         *
+         * This reads the size stored in the gzip trailer, which is only a hint: it holds the size modulo 2^32
+         * of the last member of the file. A size that deflate cannot reach from the compressed size is rejected. The
+         * hint may still be wrong, so it is only used to reserve memory.
+         *
+         * @param file_name path to the gzip compressed file
+         * @return size of the decompressed file or 0 if unknown
+         */
+        size_t gzip_uncompressed_size_hint(const std::string& file_name)
+        {
+            const ::int64_t compressed_size = file_size(file_name);
+            if(compressed_size < 4) return 0;
+            std::ifstream fin(file_name.c_str(), std::ios::binary);
+            fin.seekg(-4, std::ios::end);
+            unsigned char trailer[4];
+            fin.read(reinterpret_cast<char*>(trailer), 4);
+            if(!fin) return 0;
+            const ::uint32_t size = static_cast< ::uint32_t >(trailer[0]) |
+                                    (static_cast< ::uint32_t >(trailer[1]) << 8) |
+                                    (static_cast< ::uint32_t >(trailer[2]) << 16) |
+                                    (static_cast< ::uint32_t >(trailer[3]) << 24);
+            // A wrapped size is smaller than the compressed file, so it cannot be trusted
+            if(static_cast< ::int64_t >(size) < compressed_size) return 0;
+            // Deflate cannot expand data by more than this ratio, so a larger size is corrupt
+            const ::int64_t max_deflate_ratio = 1032;
+            if(static_cast< ::int64_t >(size) > compressed_size * max_deflate_ratio) return 0;
+            return static_cast<size_t>(size);
+        }
+    }
+
+    /** Test if the library can read gzip compressed InterOp files
+     *
+     * @return true if the library was built with zlib
+     */
+    bool is_gzip_supported()
+    {
+#ifdef HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    }
+}}}
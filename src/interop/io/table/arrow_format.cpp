@@ -0,0 +1,737 @@
+/** Write tables in the Apache Arrow IPC format
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+
+#include "interop/io/table/arrow_format.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "interop/util/cstdint.h"
+#include "interop/util/math.h"
+#include "interop/model/metric_base/metric_exceptions.h"
+#include "interop/logic/table/table_util.h"
+#include "interop/model/table/imaging_table.h"
+
+namespace illumina { namespace interop { namespace io { namespace table
+{
+    namespace
+    {
+        /** Values of the flatbuffer enums and unions in the Arrow schema (Schema.fbs and Message.fbs) */
+        enum arrow_constants
+        {
+            MetadataVersionV5 = 4,
+            SchemaHeader = 1,
+            DictionaryBatchHeader = 2,
+            RecordBatchHeader = 3,
+            IntType = 2,
+            FloatingPointType = 3,
+            SinglePrecision = 1
+        };
+        /** Physical type of an exported column */
+        enum arrow_value_type
+        {
+            ArrowFloat,
+            ArrowUInt,
+            ArrowUShort,
+            ArrowDictionary
+        };
+        /** Continuation marker that starts each encapsulated message */
+        const ::uint32_t ContinuationMarker = 0xFFFFFFFF;
+        /** Magic string at the start and end of the file layout */
+        const char ArrowMagic[] = "ARROW1";
+        /** Size of the magic string */
+        const size_t ArrowMagicSize = 6;
+
+        /** Round up to a multiple of 8 bytes
+         *
+         * @param size size in bytes
+         * @return padded size in bytes
+         */
+        inline size_t pad8(const size_t size)
+        {
+            return (size + 7) & ~static_cast<size_t>(7);
+        }
+
+        /** Flatbuffer written from front to back
+         *
+         * Flatbuffers are usually built back to front. Here, each table is written before its children and every
+         * offset is patched once the child is written, so all offsets point forward as required. Each vtable is
+         * written directly before its table.
+         *
+         * @note Like the InterOp binary format, this assumes a little endian host
+         */
+        class flatbuffer_writer
+        {
+        public:
+            /** Constructor reserves the offset to the root table */
+            flatbuffer_writer()
+            {
+                put< ::uint32_t >(0);
+            }
+
+        public:
+            /** Pad the buffer with zeros to a multiple of the alignment
+             *
+             * @param alignment alignment in bytes
+             */
+            void align(const size_t alignment)
+            {
+                while(m_buffer.size() % alignment != 0) m_buffer.push_back(0);
+            }
+            /** Append a scalar value
+             *
+             * @param value scalar value
+             * @return position of the value
+             */
+            template<typename T>
+            size_t put(const T value)
+            {
+                return put_bytes(&value, sizeof(T));
+            }
+            /** Append raw bytes
+             *
+             * @param data pointer to bytes
+             * @param size number of bytes
+             * @return position of the bytes
+             */
+            size_t put_bytes(const void* data, const size_t size)
+            {
+                const size_t position = m_buffer.size();
+                m_buffer.resize(position + size);
+                if(size > 0) std::memcpy(&m_buffer[position], data, size);
+                return position;
+            }
+            /** Point the offset at the given position to the target position
+             *
+             * @param position position of the offset
+             * @param target position of the target, must follow the offset
+             */
+            void set_offset(const size_t position, const size_t target)
+            {
+                INTEROP_ASSERT(target > position);
+                const ::uint32_t offset = static_cast< ::uint32_t >(target - position);
+                std::memcpy(&m_buffer[position], &offset, sizeof(offset));
+            }
+            /** Append a null terminated string
+             *
+             * @param str string
+             * @return position of the string
+             */
+            size_t put_string(const std::string& str)
+            {
+                align(4);
+                const size_t position = put(static_cast< ::uint32_t >(str.length()));
+                put_bytes(str.c_str(), str.length() + 1);
+                return position;
+            }
+            /** Append a vector of structs
+             *
+             * @param data pointer to the structs
+             * @param count number of structs
+             * @param struct_size size of each struct in bytes
+             * @param alignment alignment of the struct
+             * @return position of the vector
+             */
+            size_t put_vector(const void* data, const size_t count, const size_t struct_size, const size_t alignment)
+            {
+                align(4);
+                while((m_buffer.size() + 4) % alignment != 0) put< ::uint32_t >(0);
+                const size_t position = put(static_cast< ::uint32_t >(count));
+                put_bytes(data, count * struct_size);
+                return position;
+            }
+            /** Append a vector of offsets to tables, which are set later with set_offset
+             *
+             * @param count number of offsets
+             * @return position of the vector, the offset of the ith table is at position + 4 + 4*i
+             */
+            size_t put_offset_vector(const size_t count)
+            {
+                align(4);
+                const size_t position = put(static_cast< ::uint32_t >(count));
+                m_buffer.resize(m_buffer.size() + 4 * count, 0);
+                return position;
+            }
+            /** Get the current size of the flatbuffer
+             *
+             * @return size in bytes
+             */
+            size_t size()const
+            {
+                return m_buffer.size();
+            }
+            /** Get the encoded flatbuffer padded to a multiple of 8 bytes
+             *
+             * @param root position of the root table
+             * @return encoded flatbuffer
+             */
+            const std::vector<char>& finish(const size_t root)
+            {
+                set_offset(0, root);
+                align(8);
+                return m_buffer;
+            }
+
+        private:
+            std::vector<char> m_buffer;
+        };
+
+        /** Fields of a single flatbuffer table
+         *
+         * Fields are added by their id in the schema, then the table is written with finish. Offset fields are
+         * patched with flatbuffer_writer::set_offset using the position of the field.
+         */
+        class table_writer
+        {
+            struct field
+            {
+                field() : size(0), value(0), position(0){}
+                size_t size;
+                ::uint64_t value;
+                size_t position;
+            };
+
+        public:
+            /** Add a scalar field
+             *
+             * @param id field id
+             * @param value scalar value
+             */
+            template<typename T>
+            void add(const size_t id, const T value)
+            {
+                if(id >= m_fields.size()) m_fields.resize(id + 1);
+                m_fields[id].size = sizeof(T);
+                std::memcpy(&m_fields[id].value, &value, sizeof(T));
+            }
+            /** Add an offset field, which must be set after the table is written
+             *
+             * @param id field id
+             */
+            void add_offset(const size_t id)
+            {
+                add(id, ::uint32_t(0));
+            }
+            /** Get the position of a field in the flatbuffer
+             *
+             * @param id field id
+             * @return position of the field
+             */
+            size_t position(const size_t id)const
+            {
+                INTEROP_ASSERT(id < m_fields.size() && m_fields[id].size > 0);
+                return m_fields[id].position;
+            }
+            /** Write the vtable followed by the table
+             *
+             * @param buffer flatbuffer
+             * @return position of the table
+             */
+            size_t finish(flatbuffer_writer& buffer)
+            {
+                // Lay out the fields from largest to smallest so each is aligned without padding
+                std::vector< ::uint16_t > offsets(m_fields.size(), 0);
+                size_t table_size = sizeof(::int32_t);
+                size_t table_alignment = sizeof(::int32_t);
+                for(size_t size = 8; size > 0; size /= 2)
+                {
+                    for(size_t id = 0; id < m_fields.size(); ++id)
+                    {
+                        if(m_fields[id].size != size) continue;
+                        table_size = (table_size + size - 1) / size * size;
+                        offsets[id] = static_cast< ::uint16_t >(table_size);
+                        table_size += size;
+                        table_alignment = std::max(table_alignment, size);
+                    }
+                }
+                buffer.align(2);
+                const size_t vtable = buffer.put(static_cast< ::uint16_t >(4 + 2 * m_fields.size()));
+                buffer.put(static_cast< ::uint16_t >(table_size));
+                for(size_t id = 0; id < offsets.size(); ++id) buffer.put(offsets[id]);
+                buffer.align(table_alignment);
+                const size_t table = buffer.put(static_cast< ::int32_t >(buffer.size() - vtable));
+                for(size_t id = 0; id < m_fields.size(); ++id)
+                {
+                    if(m_fields[id].size == 0) continue;
+                    m_fields[id].position = table + offsets[id];
+                }
+                std::vector<char> fields(table_size - sizeof(::int32_t), 0);
+                for(size_t id = 0; id < m_fields.size(); ++id)
+                {
+                    if(m_fields[id].size == 0) continue;
+                    std::memcpy(&fields[offsets[id] - sizeof(::int32_t)], &m_fields[id].value, m_fields[id].size);
+                }
+                if(!fields.empty()) buffer.put_bytes(&fields.front(), fields.size());
+                return table;
+            }
+
+        private:
+            std::vector<field> m_fields;
+        };
+
+        /** FieldNode and Buffer structs in the Arrow schema */
+        struct arrow_pair
+        {
+            ::int64_t first;
+            ::int64_t second;
+        };
+        /** Block struct in the Arrow footer */
+        struct arrow_block
+        {
+            ::int64_t offset;
+            ::int32_t metadata_length;
+            ::int32_t padding;
+            ::int64_t body_length;
+        };
+
+        /** Description of an exported column
+         */
+        struct arrow_column
+        {
+            arrow_column(const std::string& column_name, const size_t column_index, const size_t subcolumn,
+                         const arrow_value_type value_type) :
+                    name(column_name), index(column_index), sub_index(subcolumn), type(value_type){}
+            /** Name of the column */
+            std::string name;
+            /** Index of the column in the imaging table */
+            size_t index;
+            /** Index of the sub column */
+            size_t sub_index;
+            /** Physical type of the column */
+            arrow_value_type type;
+            /** Sorted values of a dictionary encoded column */
+            std::vector< ::uint32_t > dictionary;
+        };
+
+        /** Get the physical type of an imaging table column
+         *
+         * @param id column id
+         * @return physical type of the column
+         */
+        arrow_value_type column_type(const model::table::column_id id)
+        {
+            using namespace constants;
+#           define INTEROP_TUPLE7(Ignored0, Ignored1, Ignored2, Ignored3, Type, Kind, Ignored6) \
+                Kind == IdType ? ArrowDictionary : Arrow##Type,
+            static const arrow_value_type types[] = {INTEROP_IMAGING_COLUMN_TYPES ArrowFloat};
+#           undef INTEROP_TUPLE7
+            if(static_cast<size_t>(id) >= static_cast<size_t>(model::table::ImagingColumnCount)) return ArrowFloat;
+            return types[id];
+        }
+
+        /** Append a buffer to the body of a record batch, padded to 8 bytes
+         *
+         * @param body record batch body
+         * @param buffers buffer locations in the body
+         * @param data buffer data
+         * @param size size of the buffer in bytes
+         */
+        void append_buffer(std::vector<char>& body, std::vector<arrow_pair>& buffers, const void* data, const size_t size)
+        {
+            arrow_pair buffer = {static_cast< ::int64_t >(body.size()), static_cast< ::int64_t >(size)};
+            buffers.push_back(buffer);
+            const size_t position = body.size();
+            body.resize(position + pad8(size), 0);
+            if(size > 0) std::memcpy(&body[position], data, size);
+        }
+
+        /** Append a column of a record batch to the body
+         *
+         * @param body record batch body
+         * @param nodes field nodes of the record batch
+         * @param buffers buffer locations in the body
+         * @param valid validity bitmap
+         * @param null_count number of null values
+         * @param values column values
+         */
+        template<typename T>
+        void append_column(std::vector<char>& body,
+                           std::vector<arrow_pair>& nodes,
+                           std::vector<arrow_pair>& buffers,
+                           const std::vector< ::uint8_t >& valid,
+                           const size_t null_count,
+                           const std::vector<T>& values)
+        {
+            arrow_pair node = {static_cast< ::int64_t >(values.size()), static_cast< ::int64_t >(null_count)};
+            nodes.push_back(node);
+            // The validity bitmap may be omitted when there are no nulls
+            if(null_count > 0) append_buffer(body, buffers, &valid.front(), valid.size());
+            else append_buffer(body, buffers, 0, 0);
+            append_buffer(body, buffers, values.empty() ? 0 : &values.front(), values.size() * sizeof(T));
+        }
+
+        /** Fill the values and validity bitmap of a column for a range of rows
+         *
+         * @param table imaging table
+         * @param column exported column
+         * @param row_beg first row
+         * @param row_end last row
+         * @param valid validity bitmap
+         * @param values column values
+         * @return number of null values
+         */
+        template<typename T>
+        size_t fill_column(const model::table::imaging_table& table,
+                           const arrow_column& column,
+                           const size_t row_beg,
+                           const size_t row_end,
+                           std::vector< ::uint8_t >& valid,
+                           std::vector<T>& values)
+        {
+            values.assign(row_end - row_beg, T(0));
+            valid.assign((values.size() + 7) / 8, 0);
+            size_t null_count = 0;
+            for(size_t row = row_beg; row < row_end; ++row)
+            {
+                const float value = table(row, column.index, column.sub_index);
+                const size_t offset = row - row_beg;
+                if(std::isnan(value))
+                {
+                    ++null_count;
+                    continue;
+                }
+                valid[offset / 8] |= static_cast< ::uint8_t >(1u << (offset % 8));
+                if(column.type == ArrowDictionary)
+                {
+                    const ::uint32_t id = static_cast< ::uint32_t >(value);
+                    values[offset] = static_cast<T>(
+                            std::lower_bound(column.dictionary.begin(), column.dictionary.end(), id) -
+                            column.dictionary.begin());
+                }
+                else values[offset] = static_cast<T>(value);
+            }
+            return null_count;
+        }
+
+        /** Write a RecordBatch table
+         *
+         * @param buffer flatbuffer
+         * @param length number of rows
+         * @param nodes field nodes
+         * @param buffers buffer locations in the body
+         * @return position of the table
+         */
+        size_t write_record_batch(flatbuffer_writer& buffer,
+                                  const size_t length,
+                                  const std::vector<arrow_pair>& nodes,
+                                  const std::vector<arrow_pair>& buffers)
+        {
+            table_writer batch;
+            batch.add(0, static_cast< ::int64_t >(length));
+            batch.add_offset(1);
+            batch.add_offset(2);
+            const size_t position = batch.finish(buffer);
+            buffer.set_offset(batch.position(1), buffer.put_vector(nodes.empty() ? 0 : &nodes.front(),
+                                                                   nodes.size(), sizeof(arrow_pair), 8));
+            buffer.set_offset(batch.position(2), buffer.put_vector(buffers.empty() ? 0 : &buffers.front(),
+                                                                   buffers.size(), sizeof(arrow_pair), 8));
+            return position;
+        }
+
+        /** Write an Int type table
+         *
+         * @param buffer flatbuffer
+         * @param bit_width number of bits
+         * @param is_signed true if the integer is signed
+         * @return position of the table
+         */
+        size_t write_int_type(flatbuffer_writer& buffer, const ::int32_t bit_width, const bool is_signed)
+        {
+            table_writer type;
+            type.add(0, bit_width);
+            type.add(1, static_cast< ::uint8_t >(is_signed));
+            return type.finish(buffer);
+        }
+
+        /** Write a Schema table
+         *
+         * @param buffer flatbuffer
+         * @param columns exported columns
+         * @return position of the table
+         */
+        size_t write_schema(flatbuffer_writer& buffer, const std::vector<arrow_column>& columns)
+        {
+            table_writer schema;
+            schema.add(0, ::int16_t(0)); // Little endian
+            schema.add_offset(1);
+            const size_t position = schema.finish(buffer);
+            const size_t fields = buffer.put_offset_vector(columns.size());
+            buffer.set_offset(schema.position(1), fields);
+            for(size_t i = 0; i < columns.size(); ++i)
+            {
+                const arrow_column& column = columns[i];
+                table_writer field;
+                field.add_offset(0);
+                field.add(1, ::uint8_t(1));
+                field.add(2, static_cast< ::uint8_t >(column.type == ArrowFloat ? FloatingPointType : IntType));
+                field.add_offset(3);
+                if(column.type == ArrowDictionary) field.add_offset(4);
+                field.add_offset(5);
+                buffer.set_offset(fields + 4 + 4 * i, field.finish(buffer));
+                buffer.set_offset(field.position(0), buffer.put_string(column.name));
+                if(column.type == ArrowFloat)
+                {
+                    table_writer type;
+                    type.add(0, static_cast< ::int16_t >(SinglePrecision));
+                    buffer.set_offset(field.position(3), type.finish(buffer));
+                }
+                else buffer.set_offset(field.position(3), write_int_type(buffer, column.type == ArrowUShort ? 16 : 32, false));
+                if(column.type == ArrowDictionary)
+                {
+                    table_writer encoding;
+                    encoding.add(0, static_cast< ::int64_t >(i));
+                    encoding.add_offset(1);
+                    encoding.add(2, ::uint8_t(1)); // The dictionary is sorted
+                    buffer.set_offset(field.position(4), encoding.finish(buffer));
+                    buffer.set_offset(encoding.position(1), write_int_type(buffer, 32, true));
+                }
+                buffer.set_offset(field.position(5), buffer.put_offset_vector(0));
+            }
+            return position;
+        }
+
+        /** Write a Message table
+         *
+         * @param buffer flatbuffer
+         * @param message fields of the message, the header offset is set after the header is written
+         * @param header_type type of the message header
+         * @param body_length size of the message body in bytes
+         * @return position of the table
+         */
+        size_t write_message(flatbuffer_writer& buffer, table_writer& message, const ::uint8_t header_type,
+                             const size_t body_length)
+        {
+            message.add(0, static_cast< ::int16_t >(MetadataVersionV5));
+            message.add(1, header_type);
+            message.add_offset(2);
+            message.add(3, static_cast< ::int64_t >(body_length));
+            return message.finish(buffer);
+        }
+
+        /** Writes encapsulated messages and tracks their location
+         */
+        class message_stream
+        {
+        public:
+            /** Constructor
+             *
+             * @param out binary output stream
+             */
+            message_stream(std::ostream& out) : m_out(out), m_position(0){}
+
+        public:
+            /** Write raw bytes
+             *
+             * @param data pointer to bytes
+             * @param size number of bytes
+             */
+            void write(const void* data, const size_t size)
+            {
+                m_out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+                m_position += size;
+            }
+            /** Write an encapsulated message
+             *
+             * @param metadata flatbuffer Message padded to 8 bytes
+             * @param body message body padded to 8 bytes
+             * @return location of the message
+             */
+            arrow_block write_message(const std::vector<char>& metadata, const std::vector<char>& body)
+            {
+                arrow_block block = {static_cast< ::int64_t >(m_position),
+                                     static_cast< ::int32_t >(8 + metadata.size()),
+                                     0,
+                                     static_cast< ::int64_t >(body.size())};
+                const ::int32_t metadata_size = static_cast< ::int32_t >(metadata.size());
+                write(&ContinuationMarker, sizeof(ContinuationMarker));
+                write(&metadata_size, sizeof(metadata_size));
+                write(&metadata.front(), metadata.size());
+                if(!body.empty()) write(&body.front(), body.size());
+                return block;
+            }
+            /** Write the end of stream marker
+             */
+            void write_end()
+            {
+                const ::int32_t zero = 0;
+                write(&ContinuationMarker, sizeof(ContinuationMarker));
+                write(&zero, sizeof(zero));
+            }
+
+        private:
+            std::ostream& m_out;
+            size_t m_position;
+        };
+
+        /** Describe the columns to export and build the dictionaries of the id columns
+         *
+         * @param table imaging table
+         * @param columns exported columns
+         */
+        void create_arrow_columns(const model::table::imaging_table& table, std::vector<arrow_column>& columns)
+        {
+            const model::table::imaging_table::column_vector_t& table_columns = table.columns();
+            for(size_t i = 0; i < table_columns.size(); ++i)
+            {
+                const arrow_value_type type = column_type(table_columns[i].id());
+                const size_t subcolumn_count = table_columns[i].has_children() ? table_columns[i].subcolumns().size() : 1;
+                for(size_t sub = 0; sub < subcolumn_count; ++sub)
+                {
+                    columns.push_back(arrow_column(table_columns[i].full_name(sub), i, sub, type));
+                    if(type != ArrowDictionary) continue;
+                    std::vector< ::uint32_t >& dictionary = columns.back().dictionary;
+                    for(size_t row = 0; row < table.row_count(); ++row)
+                    {
+                        const float value = table(row, i, sub);
+                        if(!std::isnan(value)) dictionary.push_back(static_cast< ::uint32_t >(value));
+                    }
+                    std::sort(dictionary.begin(), dictionary.end());
+                    dictionary.erase(std::unique(dictionary.begin(), dictionary.end()), dictionary.end());
+                }
+            }
+        }
+    }
+
+    /** Write the imaging table in the Apache Arrow IPC format
+     *
+     * The schema is followed by a dictionary batch for each id column, then the rows in record batches.
+     *
+     * @param out binary output stream
+     * @param table imaging table
+     * @param layout file or stream layout
+     * @param rows_per_batch maximum number of rows in each record batch
+     */
+    void write_arrow(std::ostream& out,
+                     const model::table::imaging_table& table,
+                     const arrow_layout layout,
+                     const size_t rows_per_batch)
+    {
+        std::vector<arrow_column> columns;
+        create_arrow_columns(table, columns);
+        message_stream stream(out);
+        if(layout == ArrowFile)
+        {
+            const char padding[2] = {0, 0};
+            stream.write(ArrowMagic, ArrowMagicSize);
+            stream.write(padding, sizeof(padding));
+        }
+
+        std::vector<char> body;
+        {
+            flatbuffer_writer buffer;
+            table_writer message;
+            const size_t root = write_message(buffer, message, SchemaHeader, 0);
+            buffer.set_offset(message.position(2), write_schema(buffer, columns));
+            stream.write_message(buffer.finish(root), body);
+        }
+
+        std::vector<arrow_block> dictionaries;
+        std::vector<arrow_pair> nodes;
+        std::vector<arrow_pair> buffers;
+        const std::vector< ::uint8_t > no_nulls;
+        for(size_t i = 0; i < columns.size(); ++i)
+        {
+            if(columns[i].type != ArrowDictionary) continue;
+            body.clear();
+            nodes.clear();
+            buffers.clear();
+            append_column(body, nodes, buffers, no_nulls, 0, columns[i].dictionary);
+            flatbuffer_writer buffer;
+            table_writer message;
+            const size_t root = write_message(buffer, message, DictionaryBatchHeader, body.size());
+            table_writer batch;
+            batch.add(0, static_cast< ::int64_t >(i));
+            batch.add_offset(1);
+            buffer.set_offset(message.position(2), batch.finish(buffer));
+            buffer.set_offset(batch.position(1), write_record_batch(buffer, columns[i].dictionary.size(), nodes, buffers));
+            dictionaries.push_back(stream.write_message(buffer.finish(root), body));
+        }
+
+        std::vector<arrow_block> record_batches;
+        std::vector< ::uint8_t > valid;
+        std::vector<float> float_values;
+        std::vector< ::uint32_t > uint_values;
+        std::vector< ::int32_t > index_values;
+        std::vector< ::uint16_t > ushort_values;
+        const size_t batch_size = rows_per_batch > 0 ? rows_per_batch : DefaultArrowBatchSize;
+        for(size_t row_beg = 0; row_beg < table.row_count(); row_beg += batch_size)
+        {
+            const size_t row_end = std::min(table.row_count(), row_beg + batch_size);
+            body.clear();
+            nodes.clear();
+            buffers.clear();
+            for(size_t i = 0; i < columns.size(); ++i)
+            {
+                size_t null_count;
+                switch(columns[i].type)
+                {
+                    case ArrowDictionary:
+                        null_count = fill_column(table, columns[i], row_beg, row_end, valid, index_values);
+                        append_column(body, nodes, buffers, valid, null_count, index_values);
+                        break;
+                    case ArrowUInt:
+                        null_count = fill_column(table, columns[i], row_beg, row_end, valid, uint_values);
+                        append_column(body, nodes, buffers, valid, null_count, uint_values);
+                        break;
+                    case ArrowUShort:
+                        null_count = fill_column(table, columns[i], row_beg, row_end, valid, ushort_values);
+                        append_column(body, nodes, buffers, valid, null_count, ushort_values);
+                        break;
+                    default:
+                        null_count = fill_column(table, columns[i], row_beg, row_end, valid, float_values);
+                        append_column(body, nodes, buffers, valid, null_count, float_values);
+                        break;
+                }
+            }
+            flatbuffer_writer buffer;
+            table_writer message;
+            const size_t root = write_message(buffer, message, RecordBatchHeader, body.size());
+            buffer.set_offset(message.position(2), write_record_batch(buffer, row_end - row_beg, nodes, buffers));
+            record_batches.push_back(stream.write_message(buffer.finish(root), body));
+        }
+        stream.write_end();
+        if(layout != ArrowFile) return;
+
+        flatbuffer_writer buffer;
+        table_writer footer;
+        footer.add(0, static_cast< ::int16_t >(MetadataVersionV5));
+        footer.add_offset(1);
+        footer.add_offset(2);
+        footer.add_offset(3);
+        const size_t root = footer.finish(buffer);
+        buffer.set_offset(footer.position(1), write_schema(buffer, columns));
+        buffer.set_offset(footer.position(2), buffer.put_vector(dictionaries.empty() ? 0 : &dictionaries.front(),
+                                                                dictionaries.size(), sizeof(arrow_block), 8));
+        buffer.set_offset(footer.position(3), buffer.put_vector(record_batches.empty() ? 0 : &record_batches.front(),
+                                                                record_batches.size(), sizeof(arrow_block), 8));
+        const std::vector<char>& metadata = buffer.finish(root);
+        const ::int32_t footer_size = static_cast< ::int32_t >(metadata.size());
+        stream.write(&metadata.front(), metadata.size());
+        stream.write(&footer_size, sizeof(footer_size));
+        stream.write(ArrowMagic, ArrowMagicSize);
+    }
+
+    /** Write the imaging table to a file in the Apache Arrow IPC format
+     *
+     * @param file_name path to the output file
+     * @param table imaging table
+     * @param layout file or stream layout
+     * @param rows_per_batch maximum number of rows in each record batch
+     * @return true if the file was written
+     */
+    bool write_arrow(const std::string& file_name,
+                     const model::table::imaging_table& table,
+                     const arrow_layout layout,
+                     const size_t rows_per_batch)
+    INTEROP_THROW_SPEC((io::file_not_found_exception))
+    {
+        std::ofstream fout(file_name.c_str(), std::ios::binary);
+        if(!fout.good()) INTEROP_THROW(file_not_found_exception, "File not found: " << file_name);
+        write_arrow(fout, table, layout, rows_per_batch);
+        return fout.good();
+    }
+}}}}
@@ -7,11 +7,14 @@
  */
 #include <algorithm>
 #include "interop/logic/metric/dynamic_phasing_metric.h"
-#include "interop/util/map.h"
+#include "interop/util/thread_pool.h"
 
 namespace illumina { namespace interop { namespace logic { namespace metric
 {
     /** Compute the linear fit online
+     *
+     * The sums are accumulated in double precision, as the sums of squares lose precision in single precision
+     * for long reads.
      */
     class linear_fit
     {
@@ -25,7 +28,7 @@ namespace illumina { namespace interop { namespace logic { namespace metric
          * @param x x-coordinate
          * @param y y-coordinate
          */
-        void add(const float x, const float y)
+        void add(const double x, const double y)
         {
             m_sx += x;
             m_sy += y;
@@ -40,10 +43,10 @@ namespace illumina { namespace interop { namespace logic { namespace metric
          */
         float slope()const
         {
-            const float den = denominator();
+            const double den = denominator();
             if (den <= std::numeric_limits<float>::epsilon())
                 return std::numeric_limits<float>::quiet_NaN();
-            return (m_sample_count * m_sxy - m_sx * m_sy) / den;
+            return static_cast<float>((m_sample_count * m_sxy - m_sx * m_sy) / den);
         }
 
         /** Offset of the line
@@ -52,10 +55,10 @@ namespace illumina { namespace interop { namespace logic { namespace metric
          */
         float offset()const
         {
-            const float den = denominator();
+            const double den = denominator();
             if (den <= std::numeric_limits<float>::epsilon())
                 return std::numeric_limits<float>::quiet_NaN();
-            return (m_sy * m_sxx - m_sx * m_sxy) / den;
+            return static_cast<float>((m_sy * m_sxx - m_sx * m_sxy) / den);
         }
         /** Get the current sample count
          *
@@ -67,61 +70,130 @@ namespace illumina { namespace interop { namespace logic { namespace metric
         }
 
     private:
-        float denominator()const
+        double denominator()const
         {
             return  m_sample_count * m_sxx - m_sx * m_sx;
         }
 
     private:
-        float m_sx;
-        float m_sy;
-        float m_sxy;
-        float m_sxx;
+        double m_sx;
+        double m_sy;
+        double m_sxy;
+        double m_sxx;
         size_t m_sample_count;
     };
 
-    /** Container for both phasing and prephasing linear fits
+    /** Container for both phasing and prephasing linear fits of a single tile and read
      */
     struct phasing_prephasing_fit
     {
-        typedef model::metric_base::base_read_metric::uint_t uint_t;
-        /** Constructor
-         *
-         * @param id_ base metric id
-         * @param read read number
-         */
-        phasing_prephasing_fit(const model::metric_base::base_metric& id_, const size_t read) :
-                id(model::metric_base::base_read_metric(id_.lane(), id_.tile(), static_cast<uint_t>(read))){}
         /** Phasing fit */
         linear_fit phasing;
         /** Prephasing fit */
         linear_fit prehasing;
-        /** Id for value */
-        model::metric_base::base_read_metric id;
+    };
+
+    /** Number of cycles of a read used to fill in missing phasing values of the tile metric */
+    static const size_t TilePhasingCycleCount = 25;
+
+    /** Fit the phasing and prephasing of each read of a tile at each iteration of a parallel loop
+     *
+     * The phasing metrics must be sorted, so the records of a tile are contiguous and in cycle order. Each tile
+     * writes its own block of read fits and its own tile metric, so tiles can be fit concurrently and the result
+     * does not depend on the number of threads.
+     */
+    class fit_tile_phasing_body : public util::abstract_loop_body
+    {
+        typedef model::metric_base::metric_set<model::metrics::phasing_metric> phasing_metric_set_t;
+        typedef model::metric_base::metric_set<model::metrics::tile_metric> tile_metric_set_t;
+    public:
+        /** Constructor
+         *
+         * @param phasing_metrics sorted phasing metric set
+         * @param tile_offsets offset of the first record of each tile, followed by the number of records
+         * @param cycle_to_read map of cycle to read information
+         * @param read_count number of reads
+         * @param fits destination fit for each tile and read
+         * @param tile_metrics tile metric set to update
+         */
+        fit_tile_phasing_body(const phasing_metric_set_t& phasing_metrics,
+                              const std::vector<size_t>& tile_offsets,
+                              const logic::summary::read_cycle_vector_t& cycle_to_read,
+                              const size_t read_count,
+                              std::vector<phasing_prephasing_fit>& fits,
+                              tile_metric_set_t& tile_metrics) :
+                m_phasing_metrics(phasing_metrics),
+                m_tile_offsets(tile_offsets),
+                m_cycle_to_read(cycle_to_read),
+                m_read_count(read_count),
+                m_fits(fits),
+                m_tile_metrics(tile_metrics)
+        {
+        }
+        /** Fit each read of a tile
+         *
+         * @param tile_index index of the tile
+         */
+        void operator()(const size_t tile_index)
+        {
+            phasing_prephasing_fit* fits = &m_fits[tile_index * m_read_count];
+            const size_t first = m_tile_offsets[tile_index];
+            const size_t last = m_tile_offsets[tile_index + 1];
+            const model::metrics::phasing_metric& tile_id = m_phasing_metrics[first];
+            const size_t tile_offset = m_tile_metrics.find(tile_id.lane(), tile_id.tile());
+            for(size_t i = first; i < last; ++i)
+            {
+                const model::metrics::phasing_metric& metric = m_phasing_metrics[i];
+                INTEROP_ASSERT(metric.cycle()-1 < m_cycle_to_read.size());
+                logic::summary::read_cycle_vector_t::const_reference read = m_cycle_to_read[metric.cycle()-1];
+                INTEROP_ASSERTMSG(read.number > 0, "Cycle: " << metric.cycle() << " -> Read: " << read.number);
+                if(read.number == 0) continue;
+                phasing_prephasing_fit& fit = fits[read.number - 1];
+                const double cycle_within_read = static_cast<double>(read.cycle_within_read);
+                fit.phasing.add(cycle_within_read, metric.phasing_weight());
+                fit.prehasing.add(cycle_within_read, metric.prephasing_weight());
+                if(fit.phasing.sample_count() == TilePhasingCycleCount && tile_offset < m_tile_metrics.size())
+                {
+                    m_tile_metrics[tile_offset].update_phasing_if_missing(read.number,
+                                                                          fit.phasing.slope(),
+                                                                          fit.prehasing.slope());
+                }
+            }
+        }
+
+    private:
+        const phasing_metric_set_t& m_phasing_metrics;
+        const std::vector<size_t>& m_tile_offsets;
+        const logic::summary::read_cycle_vector_t& m_cycle_to_read;
+        const size_t m_read_count;
+        std::vector<phasing_prephasing_fit>& m_fits;
+        tile_metric_set_t& m_tile_metrics;
     };
 
     /** Populate the dynamic phasing metrics (slope & offset for phasing/prephasing) data structure given the phasing metrics data
+     *
+     * The fits are held in a dense array indexed by tile and read, and the dynamic phasing metrics are added in
+     * lane, tile and read order.
      *
      * @param phasing_metrics phasing metric set
      * @param cycle_to_read map of cycle to read information
      * @param dynamic_phasing_metrics dynamic phasing metric set (to be populated)
+     * @param tile_metrics tile metric set (to be populated)
+     * @param thread_count number of threads fitting tiles concurrently, 0 for the default thread count
      */
     void populate_dynamic_phasing_metrics(model::metric_base::metric_set<model::metrics::phasing_metric>& phasing_metrics,
                                           const logic::summary::read_cycle_vector_t& cycle_to_read,
                                           model::metric_base::metric_set<model::metrics::dynamic_phasing_metric>& dynamic_phasing_metrics,
-                                          model::metric_base::metric_set<model::metrics::tile_metric>& tile_metrics)
+                                          model::metric_base::metric_set<model::metrics::tile_metric>& tile_metrics,
+                                          const size_t thread_count)
     {
-        typedef INTEROP_UNORDERED_MAP(model::metric_base::base_metric::id_t, phasing_prephasing_fit) lookup_map_t;
-        typedef model::metric_base::metric_set<model::metrics::phasing_metric> phasing_metric_set_t;
         typedef model::metrics::dynamic_phasing_metric::uint_t uint_t;
-        typedef phasing_metric_set_t::const_iterator const_iterator;
 
         if (phasing_metrics.size() == 0u)
             return;
-        if (phasing_metrics.max_cycle() < 25u)
+        if (phasing_metrics.max_cycle() < TilePhasingCycleCount)
             return;
         phasing_metrics.sort();
-        lookup_map_t fit_map;
         if( phasing_metrics.max_cycle() > cycle_to_read.size())
         {
             INTEROP_THROW(model::index_out_of_bounds_exception, "Number of expected cycles does not match phasing metrics");
@@ -130,48 +202,40 @@ namespace illumina { namespace interop { namespace logic { namespace metric
         {
             INTEROP_THROW(model::index_out_of_bounds_exception, "Number of expected cycles does not match phasing metrics");
         }
-        for(const_iterator beg = phasing_metrics.begin();beg != phasing_metrics.end();++beg)
+        size_t read_count = 0;
+        for(size_t i = 0; i < cycle_to_read.size(); ++i)
+            read_count = std::max(read_count, cycle_to_read[i].number);
+        if(read_count == 0) return;
+
+        std::vector<size_t> tile_offsets;
+        for(size_t i = 0; i < phasing_metrics.size(); ++i)
         {
-            const uint_t lane = beg->lane();
-            const uint_t tile = beg->tile();
-            INTEROP_ASSERT(beg->cycle()-1 < cycle_to_read.size());
-            logic::summary::read_cycle_vector_t::const_reference read = cycle_to_read[beg->cycle()-1];
-            const model::metric_base::base_read_metric::id_t id =
-                    model::metric_base::base_read_metric::create_id(lane, tile, read.number);
-            lookup_map_t::iterator fit_for_tile = fit_map.find(id);
-            if(fit_for_tile == fit_map.end())
-            {
-                INTEROP_ASSERTMSG(read.number > 0, "Cycle: " << beg->cycle() << " -> Read: " << read.number);
-                fit_for_tile = fit_map.insert(lookup_map_t::value_type(id, phasing_prephasing_fit(*beg, read.number))).first;
-            }
-            const float cycle_within_read = static_cast<float>(read.cycle_within_read);
-            fit_for_tile->second.phasing.add(cycle_within_read, beg->phasing_weight());
-            fit_for_tile->second.prehasing.add(cycle_within_read, beg->prephasing_weight());
-            if(fit_for_tile->second.phasing.sample_count() == 25)
-            {
-                const size_t tile_offset = tile_metrics.find(lane, tile);
-                if(tile_offset < tile_metrics.size())
-                {
-                    model::metrics::tile_metric& tile_metric = tile_metrics[tile_offset];
-                    INTEROP_ASSERTMSG(read.number > 0, read.number);
-                    tile_metric.update_phasing_if_missing(read.number,
-                                                          fit_for_tile->second.phasing.slope(),
-                                                          fit_for_tile->second.prehasing.slope());
-                }
-            }
+            if(i == 0 || phasing_metrics[i].tile_hash() != phasing_metrics[i-1].tile_hash())
+                tile_offsets.push_back(i);
         }
-        for(lookup_map_t::const_iterator beg = fit_map.begin();beg != fit_map.end();++beg)
+        const size_t tile_count = tile_offsets.size();
+        tile_offsets.push_back(phasing_metrics.size());
+
+        std::vector<phasing_prephasing_fit> fits(tile_count * read_count);
+        fit_tile_phasing_body body(phasing_metrics, tile_offsets, cycle_to_read, read_count, fits, tile_metrics);
+        util::parallel_for(tile_count, body, thread_count);
+
+        for(size_t tile_index = 0; tile_index < tile_count; ++tile_index)
         {
-            INTEROP_ASSERTMSG(beg->second.id.read() > 0, beg->second.id.read());
-            dynamic_phasing_metrics.insert(model::metrics::dynamic_phasing_metric(
-                    beg->second.id.lane(), beg->second.id.tile(), beg->second.id.read(),
-                    beg->second.phasing.slope(),
-                    beg->second.phasing.offset(),
-                    beg->second.prehasing.slope(),
-                    beg->second.prehasing.offset()
-            ));
+            const model::metrics::phasing_metric& tile_id = phasing_metrics[tile_offsets[tile_index]];
+            for(size_t read = 1; read <= read_count; ++read)
+            {
+                const phasing_prephasing_fit& fit = fits[tile_index * read_count + read - 1];
+                if(fit.phasing.sample_count() == 0) continue;
+                dynamic_phasing_metrics.insert(model::metrics::dynamic_phasing_metric(
+                        tile_id.lane(), tile_id.tile(), static_cast<uint_t>(read),
+                        fit.phasing.slope(),
+                        fit.phasing.offset(),
+                        fit.prehasing.slope(),
+                        fit.prehasing.offset()
+                ));
+            }
         }
     }
 
 }}}}
-
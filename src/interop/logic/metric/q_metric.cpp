@@ -6,7 +6,9 @@
  *  @copyright GNU Public License.
  */
 #include <vector>
+#include <algorithm>
 #include "interop/util/map.h"
+#include "interop/util/histogram.h"
 #include "interop/logic/metric/q_metric.h"
 
 
@@ -57,6 +59,57 @@ namespace illumina { namespace interop { namespace logic { namespace metric
                 return lhs.cycle() < rhs.cycle();
             }
         };
+        template<class QMetric>
+        struct reverse_cycle
+        {
+            bool operator()(const QMetric &lhs, const QMetric &rhs) const
+            {
+                return lhs.cycle() > rhs.cycle();
+            }
+        };
+        /** Test if the records of each tile are ordered by increasing cycle
+         *
+         * @param metric_set q-metric set
+         * @return true if each tile is ordered by cycle
+         */
+        template<class QMetric>
+        bool is_cycle_ordered_by_tile(const model::metric_base::metric_set<QMetric>& metric_set)
+        {
+            typedef model::metric_base::base_metric::id_t id_t;
+            typedef model::metric_base::base_metric::uint_t uint_t;
+            typedef typename model::metric_base::metric_set<QMetric>::const_iterator const_iterator;
+            typedef INTEROP_UNORDERED_MAP(id_t, uint_t) lookup_map_t;
+            typedef typename lookup_map_t::iterator lookup_iterator;
+
+            // InterOps are written cycle by cycle, so avoid the lookup when the whole set is ordered
+            const_iterator beg = metric_set.begin(), end = metric_set.end();
+            if(std::adjacent_find(beg, end, reverse_cycle<QMetric>()) == end) return true;
+            lookup_map_t last_cycle;
+            for(;beg != end;++beg)
+            {
+                lookup_iterator it = last_cycle.find(beg->tile_hash());
+                if(it == last_cycle.end()) last_cycle[beg->tile_hash()] = beg->cycle();
+                else if(it->second >= beg->cycle()) return false;
+                else it->second = beg->cycle();
+            }
+            return true;
+        }
+        /** Populate legacy bins and set the version of newly created by lane Q-metrics
+         *
+         * @param bylane bylane Q-metrics
+         * @param instrument instrument type
+         */
+        void finalize_q_metrics_by_lane(model::metric_base::metric_set<model::metrics::q_by_lane_metric>& bylane,
+                                        const constants::instrument_type instrument)
+        {
+            const size_t bin_count = logic::metric::count_legacy_q_score_bins(bylane);
+            if(requires_legacy_bins(bin_count))
+            {
+                populate_legacy_q_score_bins(bylane.bins(), instrument, bin_count);
+                compress_q_metrics(bylane);
+            }
+            bylane.set_version(model::metrics::q_by_lane_metric::LATEST_VERSION);
+        }
     }
 
     /** Populate cumulative q-metric distribution
@@ -195,12 +248,14 @@ namespace illumina { namespace interop { namespace logic { namespace metric
         const uint_t q20_idx = static_cast<uint_t>(index_for_q_value(metric_set, 20));
         const uint_t q30_idx = static_cast<uint_t>(index_for_q_value(metric_set, 30));
 
-        collapsed.set_version(model::metrics::q_collapsed_metric::LATEST_VERSION);
+        // Only write the version when it changes, so a published snapshot with no q-metrics is never modified
+        if(collapsed.version() != model::metrics::q_collapsed_metric::LATEST_VERSION)
+            collapsed.set_version(model::metrics::q_collapsed_metric::LATEST_VERSION);
         for(const_iterator beg = metric_set.begin(), end = metric_set.end();beg != end;++beg)
         {
-            const uint64_t q20 = beg->total_over_qscore(q20_idx);
-            const uint64_t q30 = beg->total_over_qscore(q30_idx);
-            const uint64_t total = beg->sum_qscore();
+            uint64_t q20, q30, total;
+            util::histogram_tail_sums(beg->qscore_hist().begin(), beg->qscore_hist().end(), q20_idx, q30_idx,
+                                      total, q20, q30);
             const uint64_t median = beg->median(metric_set.get_bins());
             collapsed.insert(model::metrics::q_collapsed_metric(beg->lane(),
                                                                 beg->tile(),
@@ -260,13 +315,186 @@ namespace illumina { namespace interop { namespace logic { namespace metric
     INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
     {
         create_q_metrics_by_lane_base(metric_set, bylane);
-        const size_t bin_count = logic::metric::count_legacy_q_score_bins(bylane);
-        if(requires_legacy_bins(bin_count))
+        detail::finalize_q_metrics_by_lane(bylane, instrument);
+    }
+
+    /** Generate all Q-metric data derived from Q-metrics in a single pass
+     *
+     * This populates the cumulative distribution of the Q-metrics and, if they are empty, creates the
+     * collapsed and by lane Q-metrics. Each tile is visited in cycle order once, so a single tile lookup
+     * serves both the collapsed and the Q-metric cumulative distributions.
+     *
+     * @param metric_set Q-metrics
+     * @param collapsed collapsed Q-metrics
+     * @param bylane bylane Q-metrics
+     * @param instrument instrument type
+     * @param populate_tile_cumulative if false, the q-metric cumulative histogram is left empty
+     * @throws index_out_of_bounds_exception
+     */
+    void create_derived_q_metrics(model::metric_base::metric_set<model::metrics::q_metric>& metric_set,
+                                  model::metric_base::metric_set<model::metrics::q_collapsed_metric>& collapsed,
+                                  model::metric_base::metric_set<model::metrics::q_by_lane_metric>& bylane,
+                                  const constants::instrument_type instrument,
+                                  const bool populate_tile_cumulative)
+    INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+    {
+        typedef model::metric_base::metric_set<model::metrics::q_metric>::iterator iterator;
+        typedef model::metric_base::metric_set<model::metrics::q_metric>::header_type header_type;
+        typedef model::metric_base::base_metric::id_t id_t;
+        typedef INTEROP_UNORDERED_MAP(id_t, size_t) lookup_map_t;
+        typedef lookup_map_t::iterator lookup_iterator;
+
+        if(metric_set.empty())
+        {
+            populate_cumulative_distribution(collapsed);
+            populate_cumulative_distribution(bylane);
+            return;
+        }
+        const bool create_collapsed = collapsed.empty();
+        const bool create_bylane = bylane.empty();
+        if(!detail::is_cycle_ordered_by_tile(metric_set))
+        {
+            std::sort(metric_set.begin(), metric_set.end(), detail::by_cycle<model::metrics::q_metric>());
+            metric_set.clear_lookup();
+        }
+
+        const size_t q20_idx = index_for_q_value(metric_set, 20);
+        const size_t q30_idx = index_for_q_value(metric_set, 30);
+        if(create_collapsed)
+        {
+            collapsed.set_version(model::metrics::q_collapsed_metric::LATEST_VERSION);
+            collapsed.reserve(metric_set.size());
+        }
+        if(create_bylane) bylane = static_cast<const header_type&>(metric_set);
+
+        lookup_map_t previous_by_tile;
+        lookup_map_t bylane_index;
+        size_t index = 0;
+        for(iterator beg = metric_set.begin(), end = metric_set.end();beg != end;++beg, ++index)
+        {
+            if(create_collapsed)
+            {
+                ::uint64_t q20, q30, total;
+                util::histogram_tail_sums(beg->qscore_hist().begin(), beg->qscore_hist().end(), q20_idx, q30_idx,
+                                          total, q20, q30);
+                collapsed.insert(model::metrics::q_collapsed_metric(beg->lane(),
+                                                                    beg->tile(),
+                                                                    beg->cycle(),
+                                                                    q20,
+                                                                    q30,
+                                                                    total,
+                                                                    beg->median(metric_set.get_bins())));
+            }
+            if(create_bylane)
+            {
+                const id_t id = model::metric_base::base_cycle_metric::create_id(beg->lane(), 0, beg->cycle());
+                lookup_iterator it = bylane_index.find(id);
+                if(it == bylane_index.end())
+                {
+                    bylane_index[id] = bylane.size();
+                    bylane.insert(model::metrics::q_by_lane_metric(beg->lane(), 0, beg->cycle(), beg->qscore_hist()));
+                }
+                else
+                {
+                    bylane[it->second].accumulate_by_lane(*beg);
+                }
+            }
+            const id_t tile_id = beg->tile_hash();
+            lookup_iterator previous = previous_by_tile.find(tile_id);
+            if(previous == previous_by_tile.end())
+            {
+                if(populate_tile_cumulative) beg->accumulate(*beg);
+                if(create_collapsed) collapsed[index].accumulate(collapsed[index]);
+                previous_by_tile[tile_id] = index;
+            }
+            else
+            {
+                if(populate_tile_cumulative) beg->accumulate(metric_set[previous->second]);
+                if(create_collapsed) collapsed[index].accumulate(collapsed[previous->second]);
+                previous->second = index;
+            }
+        }
+        if(create_bylane) detail::finalize_q_metrics_by_lane(bylane, instrument);
+        if(!create_collapsed) populate_cumulative_distribution(collapsed);
+        populate_cumulative_distribution(bylane);
+    }
+
+    /** Compute the cumulative q-score histogram of a tile up to the given cycle
+     *
+     * This sums the q-score histograms of the tile over all cycles up to and including the given
+     * cycle. It does not require the cumulative histogram stored in each record.
+     *
+     * @param metric_set q-metric set
+     * @param lane lane number
+     * @param tile tile number
+     * @param cycle last cycle to include
+     * @param hist destination cumulative q-score histogram
+     */
+    void cumulative_qscore_hist(const model::metric_base::metric_set<model::metrics::q_metric>& metric_set,
+                                const size_t lane,
+                                const size_t tile,
+                                const size_t cycle,
+                                std::vector< ::uint64_t >& hist)
+    {
+        typedef model::metric_base::metric_set<model::metrics::q_metric>::const_iterator const_iterator;
+        typedef model::metric_base::base_metric::id_t id_t;
+        hist.assign(count_q_metric_bins(metric_set), 0);
+        if(metric_set.offset_map().size() != metric_set.size())
+        {
+            for(const_iterator beg = metric_set.begin(), end = metric_set.end();beg != end;++beg)
+            {
+                if(beg->lane() != lane || beg->tile() != tile || beg->cycle() > cycle) continue;
+                beg->accumulate_into(hist);
+            }
+            return;
+        }
+        for(size_t cur = 1;cur <= cycle;++cur)
+        {
+            const id_t id = model::metrics::q_metric::create_id(lane, tile, cur);
+            if(!metric_set.has_metric(id)) continue;
+            metric_set.get_metric(id).accumulate_into(hist);
+        }
+    }
+    /** Populate the q-score cube from the q-metrics of each tile
+     *
+     * The cube is left empty if a record has a lane, surface or cycle of 0, or if the records have
+     * different number of bins. The key of the source data is set either way.
+     *
+     * @param metric_set q-metric set
+     * @param naming_method tile naming method used to determine the surface
+     * @param data_version version of the run metrics
+     * @param cube destination q-score cube
+     */
+    void populate_qscore_cube(const model::metric_base::metric_set<model::metrics::q_metric>& metric_set,
+                              const constants::tile_naming_method naming_method,
+                              const size_t data_version,
+                              model::metrics::q_score_cube& cube)
+    {
+        typedef model::metric_base::metric_set<model::metrics::q_metric>::const_iterator const_iterator;
+        cube.clear();
+        cube.source(qscore_cube_source(metric_set, naming_method, data_version));
+        if(metric_set.empty()) return;
+        const size_t bin_count = count_q_metric_bins(metric_set);
+        size_t max_lane = 0;
+        size_t max_surface = 0;
+        size_t max_cycle = 0;
+        for(const_iterator beg = metric_set.begin(), end = metric_set.end();beg != end;++beg)
+        {
+            const size_t surface = beg->surface(naming_method);
+            if(beg->lane() == 0 || surface == 0 || beg->cycle() == 0 || beg->size() != bin_count) return;
+            max_lane = std::max(max_lane, static_cast<size_t>(beg->lane()));
+            max_surface = std::max(max_surface, surface);
+            max_cycle = std::max(max_cycle, static_cast<size_t>(beg->cycle()));
+        }
+        cube.resize(max_lane, max_surface, max_cycle, bin_count);
+        for(const_iterator beg = metric_set.begin(), end = metric_set.end();beg != end;++beg)
         {
-            populate_legacy_q_score_bins(bylane.bins(), instrument, bin_count);
-            compress_q_metrics(bylane);
+            cube.accumulate(beg->lane(),
+                            beg->surface(naming_method),
+                            beg->cycle(),
+                            beg->qscore_hist().begin(),
+                            beg->qscore_hist().end());
         }
-        bylane.set_version(model::metrics::q_by_lane_metric::LATEST_VERSION);
     }
 
     /** Compress the q-metric set using the bins in the header
@@ -0,0 +1,239 @@
+/** Logic for the per tile aggregate table
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#include "interop/logic/metric/tile_aggregate.h"
+#include "interop/logic/metric/q_metric.h"
+
+namespace illumina { namespace interop { namespace logic { namespace metric
+{
+    namespace
+    {
+        /** Sort tiles by id */
+        bool less_tile_id(const model::metrics::tile_aggregate& lhs, const model::metrics::tile_aggregate& rhs)
+        {
+            return lhs.id() < rhs.id();
+        }
+        /** Test if two tiles have the same id */
+        bool equal_tile_id(const model::metrics::tile_aggregate& lhs, const model::metrics::tile_aggregate& rhs)
+        {
+            return lhs.id() == rhs.id();
+        }
+        /** Get the read of a cycle, if the cycle is not the last cycle of the read
+         *
+         * @param cycle_to_read map cycle to the read number and cycle within read
+         * @param cycle cycle number
+         * @param read_count number of reads in the table
+         * @return read number, or 0 if the cycle should not be averaged
+         */
+        size_t averaged_read(const summary::read_cycle_vector_t& cycle_to_read,
+                             const size_t cycle,
+                             const size_t read_count)
+        {
+            if (cycle == 0 || cycle > cycle_to_read.size()) return 0;
+            const summary::read_cycle& read = cycle_to_read[cycle - 1];
+            if (read.is_last_cycle_in_read || read.number > read_count) return 0;
+            return read.number;
+        }
+    }
+
+    /** Populate the per tile aggregate table
+     *
+     * The table has a row for each tile with a tile or extended tile metric. The error rate and percent over Q30
+     * of each read are averaged over the cycles of the read, excluding the last cycle as the summary does. The key of
+     * the source data is set even if the table is empty.
+     *
+     * @param tile_metrics tile metric set
+     * @param extended_tile_metrics extended tile metric set
+     * @param error_metrics error metric set
+     * @param q_metrics q-metric set
+     * @param cycle_to_read map cycle to the read number and cycle within read
+     * @param data_version version of the run metrics the table is built from
+     * @param table destination table
+     */
+    void populate_tile_aggregate_table(
+            const model::metric_base::metric_set<model::metrics::tile_metric>& tile_metrics,
+            const model::metric_base::metric_set<model::metrics::extended_tile_metric>& extended_tile_metrics,
+            const model::metric_base::metric_set<model::metrics::error_metric>& error_metrics,
+            const model::metric_base::metric_set<model::metrics::q_metric>& q_metrics,
+            const summary::read_cycle_vector_t& cycle_to_read,
+            const size_t data_version,
+            model::metrics::tile_aggregate_table& table)
+    {
+        typedef model::metric_base::metric_set<model::metrics::tile_metric>::const_iterator tile_iterator;
+        typedef model::metric_base::metric_set<model::metrics::extended_tile_metric>::const_iterator
+                extended_tile_iterator;
+        typedef model::metric_base::metric_set<model::metrics::error_metric>::const_iterator error_iterator;
+        typedef model::metric_base::metric_set<model::metrics::q_metric>::const_iterator q_iterator;
+        typedef model::metrics::tile_metric::read_metric_vector::const_iterator read_iterator;
+        typedef model::metrics::tile_aggregate_table::tile_vector_t tile_vector_t;
+
+        const model::metrics::tile_aggregate_table::source_key_t key =
+                tile_aggregate_source(tile_metrics, extended_tile_metrics, error_metrics, q_metrics, data_version);
+        table.clear();
+        if (tile_metrics.empty() && extended_tile_metrics.empty())
+        {
+            table.source(0, 0, key);
+            return;
+        }
+
+        size_t read_count = 0;
+        for (size_t i = 0; i < cycle_to_read.size(); ++i) read_count = std::max(read_count, cycle_to_read[i].number);
+        tile_vector_t tiles;
+        tiles.reserve(tile_metrics.size() + extended_tile_metrics.size());
+        for (tile_iterator it = tile_metrics.begin(); it != tile_metrics.end(); ++it)
+        {
+            tiles.push_back(model::metrics::tile_aggregate(it->lane(), it->tile()));
+            for (read_iterator rit = it->read_metrics().begin(); rit != it->read_metrics().end(); ++rit)
+                read_count = std::max(read_count, static_cast<size_t>(rit->read()));
+        }
+        for (extended_tile_iterator it = extended_tile_metrics.begin(); it != extended_tile_metrics.end(); ++it)
+            tiles.push_back(model::metrics::tile_aggregate(it->lane(), it->tile()));
+        std::sort(tiles.begin(), tiles.end(), less_tile_id);
+        tiles.erase(std::unique(tiles.begin(), tiles.end(), equal_tile_id), tiles.end());
+        table.assign(tiles, read_count);
+
+        for (tile_iterator it = tile_metrics.begin(); it != tile_metrics.end(); ++it)
+        {
+            const size_t row = table.find(it->id());
+            INTEROP_ASSERT(row < table.size());
+            table[row].tile_values(it->cluster_density(),
+                                   it->cluster_density_pf(),
+                                   it->cluster_count(),
+                                   it->cluster_count_pf());
+            for (read_iterator rit = it->read_metrics().begin(); rit != it->read_metrics().end(); ++rit)
+            {
+                if (!table.has_read(rit->read())) continue;
+                table.read(row, rit->read()).read_values(rit->percent_aligned(),
+                                                         rit->percent_phasing(),
+                                                         rit->percent_prephasing());
+            }
+        }
+        for (extended_tile_iterator it = extended_tile_metrics.begin(); it != extended_tile_metrics.end(); ++it)
+        {
+            const size_t row = table.find(it->id());
+            INTEROP_ASSERT(row < table.size());
+            table[row].extended_tile_values(it->cluster_count_occupied(), it->percent_occupied());
+        }
+
+        if (read_count > 0 && !error_metrics.empty())
+        {
+            std::vector<double> error_sum(table.size() * read_count, 0);
+            std::vector<size_t> error_count(error_sum.size(), 0);
+            for (error_iterator it = error_metrics.begin(); it != error_metrics.end(); ++it)
+            {
+                const size_t read = averaged_read(cycle_to_read, it->cycle(), read_count);
+                if (read == 0 || std::isnan(it->error_rate())) continue;
+                const size_t row = table.find(it->lane(), it->tile());
+                if (row == table.size()) continue;
+                error_sum[row * read_count + read - 1] += it->error_rate();
+                ++error_count[row * read_count + read - 1];
+            }
+            for (size_t row = 0; row < table.size(); ++row)
+            {
+                for (size_t read = 1; read <= read_count; ++read)
+                {
+                    const size_t offset = row * read_count + read - 1;
+                    if (error_count[offset] == 0) continue;
+                    table.read(row, read).error_rate(static_cast<float>(error_sum[offset] / error_count[offset]));
+                }
+            }
+        }
+        if (read_count > 0 && !q_metrics.empty())
+        {
+            const size_t q30_index = index_for_q_value(q_metrics, 30);
+            std::vector< ::uint64_t > over_q30(table.size() * read_count, 0);
+            std::vector< ::uint64_t > total(over_q30.size(), 0);
+            for (q_iterator it = q_metrics.begin(); it != q_metrics.end(); ++it)
+            {
+                const size_t read = averaged_read(cycle_to_read, it->cycle(), read_count);
+                if (read == 0) continue;
+                const size_t row = table.find(it->lane(), it->tile());
+                if (row == table.size()) continue;
+                over_q30[row * read_count + read - 1] += it->total_over_qscore(q30_index);
+                total[row * read_count + read - 1] += it->sum_qscore();
+            }
+            for (size_t row = 0; row < table.size(); ++row)
+            {
+                for (size_t read = 1; read <= read_count; ++read)
+                {
+                    const size_t offset = row * read_count + read - 1;
+                    if (total[offset] == 0) continue;
+                    table.read(row, read).percent_over_q30(
+                            static_cast<float>(100.0 * over_q30[offset] / total[offset]));
+                }
+            }
+        }
+        table.source(tile_metrics.size(), extended_tile_metrics.size(), key);
+    }
+
+    /** Test if the value of a metric type is held by the per tile aggregate table
+     *
+     * @param type metric type
+     * @return true if the metric type is a tile or extended tile metric type
+     */
+    bool is_tile_aggregate_metric(const constants::metric_type type)
+    {
+        switch (type)
+        {
+            case constants::Clusters:
+            case constants::ClustersPF:
+            case constants::ClusterCount:
+            case constants::ClusterCountPF:
+            case constants::PercentPhasing:
+            case constants::PercentPrephasing:
+            case constants::PercentAligned:
+            case constants::OccupiedCountK:
+            case constants::PercentOccupied:
+            case constants::PercentPF:
+                return true;
+            default:
+                return false;
+        }
+    }
+    /** Get the value of a metric type for a tile in the per tile aggregate table
+     *
+     * The value matches the value plotted for the corresponding tile or extended tile metric.
+     *
+     * @param table per tile aggregate table
+     * @param row index of the tile in the table
+     * @param type metric type
+     * @param read read number, used by the read metric types
+     * @return value of the metric, or NaN if the tile has no value or the type is not held by the table
+     */
+    float tile_aggregate_value(const model::metrics::tile_aggregate_table& table,
+                               const size_t row,
+                               const constants::metric_type type,
+                               const size_t read)
+    {
+        const model::metrics::tile_aggregate& tile = table[row];
+        switch (type)
+        {
+            case constants::Clusters:
+                return tile.cluster_density_k();
+            case constants::ClustersPF:
+                return tile.cluster_density_pf_k();
+            case constants::ClusterCount:
+                return tile.cluster_count_m();
+            case constants::ClusterCountPF:
+                return tile.cluster_count_pf_m();
+            case constants::PercentPhasing:
+                return table.percent_phasing_at(row, read);
+            case constants::PercentPrephasing:
+                return table.percent_prephasing_at(row, read);
+            case constants::PercentAligned:
+                return table.percent_aligned_at(row, read);
+            case constants::OccupiedCountK:
+                return tile.cluster_count_occupied_k();
+            case constants::PercentOccupied:
+                return tile.percent_occupied();
+            case constants::PercentPF:
+                return tile.percent_pf();
+            default:
+                return std::numeric_limits<float>::quiet_NaN();
+        }
+    }
+}}}}
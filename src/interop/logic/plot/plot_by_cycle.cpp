@@ -10,6 +10,7 @@
 #include "interop/logic/plot/plot_data.h"
 #include "interop/logic/metric/q_metric.h"
 #include "interop/logic/plot/plot_metric_proxy.h"
+#include "interop/util/thread_pool.h"
 
 namespace illumina { namespace interop { namespace logic { namespace plot
 {
@@ -99,6 +100,56 @@ namespace illumina { namespace interop { namespace logic { namespace plot
     };
 
 
+    /** Fill a quantile sketch for each cycle from one chunk of the metric records
+     *
+     * Each chunk has its own sketches, so the chunks can be filled concurrently and merged afterwards.
+     */
+    template<typename MetricSet, typename MetricProxy>
+    class by_cycle_sketch_body
+    {
+    public:
+        /** Collection of quantile sketches indexed by cycle */
+        typedef std::vector<util::quantile_sketch> sketch_vector_t;
+
+    public:
+        /** Constructor
+         *
+         * @param metrics set of metric records
+         * @param options filter for metric records
+         * @param proxy functor that takes a metric record and returns a metric value
+         * @param sketches sketches by cycle for each chunk
+         */
+        by_cycle_sketch_body(const MetricSet& metrics,
+                             const model::plot::filter_options& options,
+                             const MetricProxy& proxy,
+                             std::vector<sketch_vector_t>& sketches) :
+                m_metrics(metrics), m_options(options), m_proxy(proxy), m_sketches(sketches){}
+        /** Fill the sketches of a single chunk
+         *
+         * @param chunk index of the chunk
+         */
+        void operator()(const size_t chunk)
+        {
+            const size_t chunk_count = m_sketches.size();
+            typename MetricSet::const_iterator b = m_metrics.begin() + m_metrics.size() * chunk / chunk_count;
+            typename MetricSet::const_iterator e = m_metrics.begin() + m_metrics.size() * (chunk+1) / chunk_count;
+            sketch_vector_t& sketches = m_sketches[chunk];
+            for(;b != e;++b)
+            {
+                if(!m_options.valid_tile(*b)) continue;
+                const float val = m_proxy(*b);
+                if(std::isnan(val) || std::isinf(val)) continue;
+                sketches[b->cycle()-1].update(val);
+            }
+        }
+
+    private:
+        const MetricSet& m_metrics;
+        const model::plot::filter_options& m_options;
+        const MetricProxy& m_proxy;
+        std::vector<sketch_vector_t>& m_sketches;
+    };
+
     /** Plot the candle stick over all tiles of a specific metric by cycle
      *
      * @param metrics set of metric records
@@ -115,9 +166,11 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         /** Constructor
          *
          * @param points reference to collection of points
+         * @param sketch_accuracy capacity of the quantile sketch for each cycle, 0 to collect every tile value
          */
-        by_cycle_candle_stick_plot(model::plot::data_point_collection<Point>&  points) :
-            m_points(points), m_max_cycle(0), m_empty(true){}
+        by_cycle_candle_stick_plot(model::plot::data_point_collection<Point>&  points,
+                                   const size_t sketch_accuracy=0) :
+            m_points(points), m_max_cycle(0), m_empty(true), m_sketch_accuracy(sketch_accuracy){}
 
 
         /** Plot the candle stick over all tiles of a specific metric by cycle
@@ -165,6 +218,11 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         {
             m_max_cycle= metrics.max_cycle();
             m_empty = metrics.empty();
+            if(m_sketch_accuracy > 0)
+            {
+                plot_sketches(metrics, options, proxy);
+                return;
+            }
             const size_t tile_count = static_cast<size_t>(std::ceil(static_cast<float>(metrics.size())/m_max_cycle));
             std::vector< std::vector<float> > tile_by_cycle(m_max_cycle);
             for(size_t i=0;i<m_max_cycle;++i) tile_by_cycle[i].reserve(tile_count);
@@ -193,6 +251,49 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             }
             m_points.resize(j);
         }
+        /** Plot the candle stick over all tiles of a specific metric by cycle using a quantile sketch for each cycle
+         *
+         * The records are split into contiguous chunks, whose number depends only on the number of records. The chunks
+         * are sketched in parallel and then merged in chunk order, so the plot does not depend on the number of
+         * threads.
+         *
+         * @param metrics set of metric records
+         * @param options filter for metric records
+         * @param proxy functor that takes a metric record and returns a metric value
+         */
+        template<typename MetricSet, typename MetricProxy>
+        void plot_sketches(const MetricSet& metrics,
+                           const model::plot::filter_options& options,
+                           const MetricProxy& proxy)
+        {
+            typedef by_cycle_sketch_body<MetricSet, MetricProxy> sketch_body_t;
+            typedef typename sketch_body_t::sketch_vector_t sketch_vector_t;
+            // The chunks depend only on the number of records, so any number of threads merges the same sketches
+            const size_t chunk_count = std::max<size_t>(1, std::min<size_t>(MAX_CHUNK_COUNT,
+                                                                            metrics.size() / MIN_RECORDS_PER_CHUNK));
+            std::vector<sketch_vector_t> sketches(chunk_count,
+                                                  sketch_vector_t(m_max_cycle,
+                                                                  util::quantile_sketch(m_sketch_accuracy)));
+            sketch_body_t body(metrics, options, proxy, sketches);
+            util::parallel_for_each_index(chunk_count, body);
+            for(size_t chunk=1;chunk<chunk_count;++chunk)
+                for(size_t cycle=0;cycle<m_max_cycle;++cycle)
+                    sketches[0][cycle].merge(sketches[chunk][cycle]);
+
+            std::vector<float> outliers;
+            outliers.reserve(10); // TODO: use as flag for keeping outliers
+            std::vector<float> values;
+            m_points.resize(m_max_cycle);
+            size_t j=0;
+            for(size_t cycle=0;cycle<m_max_cycle;++cycle)
+            {
+                if(sketches[0][cycle].empty())
+                    continue;
+                plot_candle_stick(m_points[j], sketches[0][cycle], static_cast<float>(cycle+1), outliers, values);
+                ++j;
+            }
+            m_points.resize(j);
+        }
         template<typename MetricSet, typename MetricProxy>
         void plot(const MetricSet&,
                   const model::plot::filter_options&,
@@ -202,6 +303,8 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         model::plot::data_point_collection<Point>& m_points;
         size_t m_max_cycle;
         bool m_empty;
+        size_t m_sketch_accuracy;
+        enum { MIN_RECORDS_PER_CHUNK = 16384, MAX_CHUNK_COUNT = 64 };
     };
 
     /** Generate meta data for multiple plot series that compare data by channel
@@ -306,7 +409,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         else
         {
             data.assign(1, model::plot::series<Point>());
-            by_cycle_candle_stick_plot<Point> plot(data[0]);
+            by_cycle_candle_stick_plot<Point> plot(data[0], metrics.quantile_sketch_accuracy());
             plot_metric_proxy::select(metrics, options, type, plot);
             max_cycle = plot.max_cycle();
             is_empty = plot.empty();
@@ -346,29 +449,6 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         data.set_title(title);
     }
 
-    /** Plot a specified metric value by cycle
-     *
-     * @ingroup plot_logic
-     * @todo Is this temporary?
-     * @param metrics run metrics
-     * @param metric_name name of metric value to plot by cycle
-     * @param options options to filter the data
-     * @param data output plot data
-     * @param skip_empty set false for testing purposes
-     */
-    template<class Point>
-    void plot_by_cycle_t(model::metrics::run_metrics& metrics,
-                         const std::string& metric_name,
-                         const model::plot::filter_options& options,
-                         model::plot::plot_data<Point>& data,
-                         const bool skip_empty)
-    {
-        const constants::metric_type type = constants::parse<constants::metric_type>(metric_name);
-        if(type == constants::UnknownMetricType)
-            INTEROP_THROW(model::invalid_metric_type, "Unsupported metric type: " << metric_name);
-        plot_by_cycle_t(metrics, type, options, data, skip_empty);
-    }
-
     /** Plot a specified metric value by cycle
     *
     * @ingroup plot_logic
@@ -389,7 +469,15 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             model::invalid_filter_option,
             model::invalid_read_exception))
     {
+        if(!metrics.is_result_cache_enabled())
+        {
+            plot_by_cycle_t(metrics, type, options, data, skip_empty);
+            return;
+        }
+        const std::string key = model::metrics::result_cache::key("plot_by_cycle", type, options, skip_empty);
+        if(metrics.find_result(key, data)) return;
         plot_by_cycle_t(metrics, type, options, data, skip_empty);
+        metrics.store_result(key, data);
     }
 
     /** Plot a specified metric value by cycle using the candle stick model
@@ -412,7 +500,10 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             model::invalid_channel_exception,
             model::invalid_metric_type))
     {
-        plot_by_cycle_t(metrics, metric_name, options, data, skip_empty);
+        const constants::metric_type type = constants::parse<constants::metric_type>(metric_name);
+        if(type == constants::UnknownMetricType)
+            INTEROP_THROW(model::invalid_metric_type, "Unsupported metric type: " << metric_name);
+        plot_by_cycle(metrics, type, options, data, skip_empty);
     }
 
     /** List metric types available for by cycle plots
@@ -10,9 +10,55 @@
 #include "interop/logic/plot/plot_point.h"
 #include "interop/logic/plot/plot_data.h"
 #include "interop/logic/plot/plot_metric_proxy.h"
+#include "interop/logic/metric/tile_aggregate.h"
 
 namespace illumina { namespace interop { namespace logic { namespace plot
 {
+    /** Plot a candle stick for each lane with values
+     *
+     * @param tile_by_lane values of each tile grouped by lane
+     * @param points destination collection of points
+     */
+    template<class Point>
+    void plot_candle_stick_by_lane(std::vector< std::vector<float> >& tile_by_lane,
+                                   model::plot::data_point_collection<Point>& points)
+    {
+        std::vector<float> outliers;
+        outliers.reserve(10);
+        points.resize(tile_by_lane.size());
+        size_t offset=0;
+        for(size_t i=0;i<tile_by_lane.size();++i)
+        {
+            if(tile_by_lane[i].empty()) continue;
+            const float lane = static_cast<float>(i+1);
+            plot_candle_stick(points[offset], tile_by_lane[i].begin(), tile_by_lane[i].end(), lane, outliers);
+            ++offset;
+        }
+        points.resize(offset);
+    }
+    /** Plot a candle stick for each lane with a quantile sketch
+     *
+     * @param sketch_by_lane quantile sketch of the tile values in each lane
+     * @param points destination collection of points
+     */
+    template<class Point>
+    void plot_candle_stick_by_lane(const std::vector<util::quantile_sketch>& sketch_by_lane,
+                                   model::plot::data_point_collection<Point>& points)
+    {
+        std::vector<float> outliers;
+        outliers.reserve(10);
+        std::vector<float> values;
+        points.resize(sketch_by_lane.size());
+        size_t offset=0;
+        for(size_t i=0;i<sketch_by_lane.size();++i)
+        {
+            if(sketch_by_lane[i].empty()) continue;
+            const float lane = static_cast<float>(i+1);
+            plot_candle_stick(points[offset], sketch_by_lane[i], lane, outliers, values);
+            ++offset;
+        }
+        points.resize(offset);
+    }
    /** Plot the candle stick over all tiles of a specific metric by lane
     */
     template<class Point>
@@ -22,9 +68,11 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         /** Constructor
          *
          * @param points reference to collection of points
+         * @param sketch_accuracy capacity of the quantile sketch for each lane, 0 to collect every tile value
          */
-        by_lane_candle_stick_plot(model::plot::data_point_collection<Point>&  points) :
-                m_points(points){}
+        by_lane_candle_stick_plot(model::plot::data_point_collection<Point>&  points,
+                                  const size_t sketch_accuracy=0) :
+                m_points(points), m_sketch_accuracy(sketch_accuracy){}
 
 
         /** Plot the candle stick over all tiles of a specific metric by lane
@@ -55,12 +103,22 @@ namespace illumina { namespace interop { namespace logic { namespace plot
                   const constants::base_tile_t*)
         {
             if(metrics.max_lane() == 0) return;
+            if(m_sketch_accuracy > 0)
+            {
+                std::vector<util::quantile_sketch> sketch_by_lane(metrics.max_lane(),
+                                                                  util::quantile_sketch(m_sketch_accuracy));
+                for(typename MetricSet::const_iterator b = metrics.begin(), e = metrics.end();b != e;++b)
+                {
+                    if(!options.valid_tile(*b)) continue;
+                    sketch_by_lane[b->lane()-1].update(proxy(*b));
+                }
+                plot_candle_stick_by_lane(sketch_by_lane, m_points);
+                return;
+            }
             const size_t lane_count = metrics.max_lane();
             const size_t tile_count = static_cast<size_t>(std::ceil(static_cast<float>(metrics.size())/lane_count));
             std::vector< std::vector<float> > tile_by_lane(metrics.max_lane());
             for(size_t i=0;i<tile_by_lane.size();++i) tile_by_lane[i].reserve(tile_count); // optimize using lane ids
-            std::vector<float> outliers;
-            outliers.reserve(10);
 
             for(typename MetricSet::const_iterator b = metrics.begin(), e = metrics.end();b != e;++b)
             {
@@ -69,16 +127,7 @@ namespace illumina { namespace interop { namespace logic { namespace plot
                 if(std::isnan(val)) continue;
                 tile_by_lane[b->lane()-1].push_back(val);
             }
-            m_points.resize(lane_count);
-            size_t offset=0;
-            for(size_t i=0;i<tile_by_lane.size();++i)
-            {
-                if(tile_by_lane[i].empty()) continue;
-                const float lane = static_cast<float>(i+1);
-                plot_candle_stick(m_points[offset], tile_by_lane[i].begin(), tile_by_lane[i].end(), lane, outliers);
-                ++offset;
-            }
-            m_points.resize(offset);
+            plot_candle_stick_by_lane(tile_by_lane, m_points);
         }
         template<typename MetricSet, typename MetricProxy>
         void plot(const MetricSet&,
@@ -87,8 +136,77 @@ namespace illumina { namespace interop { namespace logic { namespace plot
                   const void*){}
     private:
         model::plot::data_point_collection<Point>& m_points;
+        size_t m_sketch_accuracy;
     };
 
+    /** Plot the candle stick over all tiles of a specific metric by lane from the per tile aggregate table
+     *
+     * @param table per tile aggregate table
+     * @param options filter for tiles
+     * @param type metric type held by the table
+     * @param points destination collection of points
+     * @param sketch_accuracy capacity of the quantile sketch for each lane, 0 to collect every tile value
+     */
+    template<class Point>
+    void plot_tile_aggregates_by_lane(const model::metrics::tile_aggregate_table& table,
+                                      const model::plot::filter_options& options,
+                                      const constants::metric_type type,
+                                      model::plot::data_point_collection<Point>& points,
+                                      const size_t sketch_accuracy)
+    {
+        if(table.max_lane() == 0) return;
+        const size_t read = options.read();
+        if(sketch_accuracy > 0)
+        {
+            std::vector<util::quantile_sketch> sketch_by_lane(table.max_lane(), util::quantile_sketch(sketch_accuracy));
+            for(size_t row=0;row<table.size();++row)
+            {
+                if(!options.valid_tile(table[row])) continue;
+                sketch_by_lane[table[row].lane()-1].update(metric::tile_aggregate_value(table, row, type, read));
+            }
+            plot_candle_stick_by_lane(sketch_by_lane, points);
+            return;
+        }
+        std::vector< std::vector<float> > tile_by_lane(table.max_lane());
+        for(size_t i=0;i<tile_by_lane.size();++i) tile_by_lane[i].reserve(table.size() / tile_by_lane.size() + 1);
+        for(size_t row=0;row<table.size();++row)
+        {
+            if(!options.valid_tile(table[row])) continue;
+            const float val = metric::tile_aggregate_value(table, row, type, read);
+            if(std::isnan(val)) continue;
+            tile_by_lane[table[row].lane()-1].push_back(val);
+        }
+        plot_candle_stick_by_lane(tile_by_lane, points);
+    }
+
+    /** Plot the candle stick over all tiles of a specific metric by lane
+     *
+     * The values of tile and extended tile metric types are taken from the per tile aggregate table.
+     *
+     * @param metrics run metrics
+     * @param options filter for metric records
+     * @param type metric type
+     * @param points destination collection of points
+     */
+    template<class Point>
+    void plot_by_lane_series(const model::metrics::run_metrics& metrics,
+                             const model::plot::filter_options& options,
+                             const constants::metric_type type,
+                             model::plot::data_point_collection<Point>& points)
+    {
+        if(metric::is_tile_aggregate_metric(type))
+        {
+            plot_tile_aggregates_by_lane(metrics.tile_aggregates(),
+                                         options,
+                                         type,
+                                         points,
+                                         metrics.quantile_sketch_accuracy());
+            return;
+        }
+        by_lane_candle_stick_plot<Point> plot(points, metrics.quantile_sketch_accuracy());
+        plot_metric_proxy::select(metrics, options, type, plot);
+    }
+
     /** Plot a specified metric value by lane
      *
      * @ingroup plot_logic
@@ -117,16 +235,14 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         data.assign(1, model::plot::series<Point>(utils::to_description(type), "Blue"));
 
 
-        by_lane_candle_stick_plot<Point> plot(data[0]);
-        plot_metric_proxy::select(metrics, options, type, plot);
+        plot_by_lane_series(metrics, options, type, data[0]);
         if (type == constants::ClusterCount || type == constants::Clusters)//constants::Density )
         {
             data.push_back(model::plot::series<Point>("PF", "DarkGreen"));
             const constants::metric_type second_type =
                     (type == constants::Clusters ? constants::ClustersPF : constants::ClusterCountPF);
 
-            by_lane_candle_stick_plot<Point> plot2(data[1]);
-            plot_metric_proxy::select(metrics, options, second_type, plot2);
+            plot_by_lane_series(metrics, options, second_type, data[1]);
         }
 
         auto_scale(data, true, 1.2f);
@@ -168,7 +284,15 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             model::invalid_metric_type,
             model::invalid_filter_option))
     {
+        if(!metrics.is_result_cache_enabled())
+        {
+            plot_by_lane_t(metrics, type, options, data, skip_empty);
+            return;
+        }
+        const std::string key = model::metrics::result_cache::key("plot_by_lane", type, options, skip_empty);
+        if(metrics.find_result(key, data)) return;
         plot_by_lane_t(metrics, type, options, data, skip_empty);
+        metrics.store_result(key, data);
     }
 
     /** Plot a specified metric value by cycle
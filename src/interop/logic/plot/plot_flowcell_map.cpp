@@ -9,6 +9,7 @@
 
 #include "interop/logic/metric/q_metric.h"
 #include "interop/logic/plot/plot_metric_proxy.h"
+#include "interop/logic/metric/tile_aggregate.h"
 
 namespace illumina { namespace interop { namespace logic { namespace plot
 {
@@ -45,18 +46,28 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             for (typename MetricSet::const_iterator beg = metrics.begin(); beg != metrics.end(); ++beg)
             {
                 if (!options.valid_tile_cycle(*beg)) continue;
-                const float val = proxy(*beg);
-                if (std::isnan(val)) continue;
-                m_data.set_data(beg->lane() - 1,
-                                beg->physical_location_index(
-                                        m_layout.naming_method(),
-                                        m_layout.sections_per_lane(),
-                                        m_layout.tile_count(),
-                                        m_layout.swath_count(),
-                                        all_surfaces),
-                                beg->tile(),
-                                val);
-                m_values_for_scaling.push_back(val);
+                set_data(*beg, proxy(*beg), all_surfaces);
+            }
+        }
+        /** Plot a specific metric from the per tile aggregate table
+         *
+         * @param table per tile aggregate table
+         * @param options filter for tiles
+         * @param type metric type held by the table
+         * @param empty true if the metric set of the metric type is empty
+         */
+        void operator()(const model::metrics::tile_aggregate_table& table,
+                        const model::plot::filter_options &options,
+                        const constants::metric_type type,
+                        const bool empty)
+        {
+            m_empty = empty;
+            const bool all_surfaces = !options.is_specific_surface();
+            const size_t read = options.read();
+            for (size_t row = 0; row < table.size(); ++row)
+            {
+                if (!options.valid_tile(table[row])) continue;
+                set_data(table[row], metric::tile_aggregate_value(table, row, type, read), all_surfaces);
             }
         }
 
@@ -70,6 +81,28 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         }
 
 
+    private:
+        /** Set the value of a tile in the flowcell map
+         *
+         * @param tile tile id
+         * @param val value of the tile, ignored if NaN
+         * @param all_surfaces true if all surfaces are shown
+         */
+        void set_data(const model::metric_base::base_metric& tile, const float val, const bool all_surfaces)
+        {
+            if (std::isnan(val)) return;
+            m_data.set_data(tile.lane() - 1,
+                            tile.physical_location_index(
+                                    m_layout.naming_method(),
+                                    m_layout.sections_per_lane(),
+                                    m_layout.tile_count(),
+                                    m_layout.swath_count(),
+                                    all_surfaces),
+                            tile.tile(),
+                            val);
+            m_values_for_scaling.push_back(val);
+        }
+
     private:
         model::plot::flowcell_data &m_data;
         std::vector<float> &m_values_for_scaling;
@@ -77,9 +110,8 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         bool m_empty;
     };
 
-    /** Plot a flowcell map
+    /** Plot a flowcell map without consulting the result cache
      *
-     * @ingroup plot_logic
      * @param metrics run metrics
      * @param type specific metric value to plot by cycle
      * @param options options to filter the data
@@ -88,16 +120,13 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param tile_buffer preallocated memory for tile ids
      * @param skip_empty set false for testing purposes
      */
-    void plot_flowcell_map(model::metrics::run_metrics &metrics,
-                           const constants::metric_type type,
-                           const model::plot::filter_options &options,
-                           model::plot::flowcell_data &data,
-                           float *buffer,
-                           ::uint32_t *tile_buffer,
-                           const bool skip_empty)
-    INTEROP_THROW_SPEC((model::invalid_filter_option,
-    model::invalid_metric_type,
-    model::index_out_of_bounds_exception))
+    void plot_flowcell_map_t(model::metrics::run_metrics &metrics,
+                             const constants::metric_type type,
+                             const model::plot::filter_options &options,
+                             model::plot::flowcell_data &data,
+                             float *buffer,
+                             ::uint32_t *tile_buffer,
+                             const bool skip_empty)
     {
         data.clear();
         if (skip_empty && metrics.empty()) return;
@@ -140,7 +169,9 @@ namespace illumina { namespace interop { namespace logic { namespace plot
                                                          metrics.get<model::metrics::q_collapsed_metric>());
         }
         flowcell_plot plot(data, values_for_scaling, layout);
-        plot_metric_proxy::select(metrics, options, type, plot);
+        if (metric::is_tile_aggregate_metric(type))
+            plot(metrics.tile_aggregates(), options, type, metrics.is_group_empty(logic::utils::to_group(type)));
+        else plot_metric_proxy::select(metrics, options, type, plot);
         const bool is_empty = plot.empty();
         if (is_empty && !skip_empty)
         {
@@ -183,6 +214,42 @@ namespace illumina { namespace interop { namespace logic { namespace plot
         data.set_label(utils::to_description(type));
     }
 
+    /** Plot a flowcell map
+     *
+     * If the result cache of the run metrics is enabled and no external buffers are given, a cached map
+     * for the same arguments is copied instead of being recomputed.
+     *
+     * @ingroup plot_logic
+     * @param metrics run metrics
+     * @param type specific metric value to plot by cycle
+     * @param options options to filter the data
+     * @param data output flowcell map
+     * @param buffer preallocated memory for data
+     * @param tile_buffer preallocated memory for tile ids
+     * @param skip_empty set false for testing purposes
+     */
+    void plot_flowcell_map(model::metrics::run_metrics &metrics,
+                           const constants::metric_type type,
+                           const model::plot::filter_options &options,
+                           model::plot::flowcell_data &data,
+                           float *buffer,
+                           ::uint32_t *tile_buffer,
+                           const bool skip_empty)
+    INTEROP_THROW_SPEC((model::invalid_filter_option,
+    model::invalid_metric_type,
+    model::index_out_of_bounds_exception))
+    {
+        if (!metrics.is_result_cache_enabled() || buffer != 0 || tile_buffer != 0)
+        {
+            plot_flowcell_map_t(metrics, type, options, data, buffer, tile_buffer, skip_empty);
+            return;
+        }
+        const std::string key = model::metrics::result_cache::key("plot_flowcell_map", type, options, skip_empty);
+        if (metrics.find_result(key, data)) return;
+        plot_flowcell_map_t(metrics, type, options, data, buffer, tile_buffer, skip_empty);
+        metrics.store_result(key, data);
+    }
+
     /** Plot a flowcell map
      *
      * @ingroup plot_logic
@@ -56,6 +56,33 @@ namespace illumina { namespace interop { namespace logic { namespace plot
                 data(beg->cycle()-1, bin) += beg->qscore_hist(bin);
         }
     }
+    /** Populate the q-score heatmap from the q-score cube
+     *
+     * @param cube q-score histograms summed by lane, surface and cycle
+     * @param bins q-score bins
+     * @param is_compressed true if the histogram holds one count per bin
+     * @param options filter for lane and surface
+     * @param data q-score heatmap
+     */
+    template<typename B>
+    void populate_heatmap_from_cube(const model::metrics::q_score_cube& cube,
+                                    const std::vector<B>& bins,
+                                    const bool is_compressed,
+                                    const model::plot::filter_options &options,
+                                    model::plot::heatmap_data& data)
+    {
+        typedef model::metrics::q_score_cube cube_t;
+        const size_t lane = options.all_lanes() ? static_cast<size_t>(cube_t::ALL) : options.lane();
+        const size_t surface = options.is_specific_surface() ? options.surface() : static_cast<size_t>(cube_t::ALL);
+        cube_t::count_vector_t hist(cube.bin_count());
+        for(size_t cycle=1;cycle <= cube.cycle_count();++cycle)
+        {
+            std::fill(hist.begin(), hist.end(), 0);
+            cube.add_cycle(lane, surface, cycle, hist);
+            for(size_t bin =0;bin < hist.size();++bin)
+                data(cycle-1, is_compressed ? bins[bin].value()-1 : bin) += static_cast<float>(hist[bin]);
+        }
+    }
     /** Normalize the heat map to a percent
      *
      * @param data output heat map data
@@ -98,12 +125,14 @@ namespace illumina { namespace interop { namespace logic { namespace plot
      * @param options options to filter the data
      * @param data output heat map data
      * @param buffer preallocated memory
+     * @param cube q-score cube used in place of the records, if not null
      */
     template<class Metric>
     void populate_heatmap(const model::metric_base::metric_set<Metric>& metric_set,
                           const model::plot::filter_options& options,
                           model::plot::heatmap_data& data,
-                          float* buffer)
+                          float* buffer,
+                          const model::metrics::q_score_cube* cube=0)
     {
         const size_t max_q_val = logic::metric::max_qval(metric_set);
         const size_t max_cycle = metric_set.max_cycle();
@@ -115,7 +144,13 @@ namespace illumina { namespace interop { namespace logic { namespace plot
                                                    << metric::is_compressed(metric_set) << ", "
                                                    << metric_set.get_bins().back().upper());
         const bool is_compressed = logic::metric::is_compressed(metric_set);
-        if(is_compressed)
+        if(cube != 0)
+            populate_heatmap_from_cube(*cube,
+                                       metric_set.get_bins(),
+                                       is_compressed,
+                                       options,
+                                       data);
+        else if(is_compressed)
             populate_heatmap_from_compressed(metric_set.begin(),
                                              metric_set.end(),
                                              metric_set.get_bins(),
@@ -154,7 +189,9 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             typedef model::metrics::q_metric metric_t;
             if (metrics.get<metric_t>().size() == 0)return;
             options.validate(constants::QScore, metrics.run_info());
-            populate_heatmap(metrics.get<metric_t>(), options, data, buffer);
+            const bool use_cube = options.is_lane_surface_only(metrics.run_info().flowcell().naming_method()) &&
+                                  !metrics.qscore_cube().empty();
+            populate_heatmap(metrics.get<metric_t>(), options, data, buffer, use_cube ? &metrics.qscore_cube() : 0);
         }
         else
         {
@@ -37,6 +37,27 @@ namespace illumina { namespace interop { namespace logic { namespace plot
             beg->accumulate_into(histogram);
         }
     }
+    /** Populate the q-score histogram from the q-score cube
+     *
+     * @param cube q-score histograms summed by lane, surface and cycle
+     * @param options filter for lane and surface
+     * @param first_cycle first cycle to keep
+     * @param last_cycle last cycle to keep
+     * @param histogram q-score histogram
+     */
+    inline void populate_distribution(const model::metrics::q_score_cube& cube,
+                                      const model::plot::filter_options &options,
+                                      const size_t first_cycle,
+                                      const size_t last_cycle,
+                                      std::vector<float>& histogram)
+    {
+        typedef model::metrics::q_score_cube cube_t;
+        const size_t lane = options.all_lanes() ? static_cast<size_t>(cube_t::ALL) : options.lane();
+        const size_t surface = options.is_specific_surface() ? options.surface() : static_cast<size_t>(cube_t::ALL);
+        cube_t::count_vector_t counts;
+        cube.sum_histogram(lane, surface, first_cycle, last_cycle, counts);
+        histogram.assign(counts.begin(), counts.end());
+    }
     /** Scale the histogram if necessary and provide the scale label
      *
      * @param histogram q-score histogram
@@ -189,13 +210,17 @@ namespace illumina { namespace interop { namespace logic { namespace plot
                                                               options,
                                                               metrics.get<metric_t>().max_cycle());
             if(metrics.get<metric_t>().size() == 0) return;
-            populate_distribution(
-                    metrics.get<metric_t>().begin(),
-                    metrics.get<metric_t>().end(),
-                    options,
-                    first_cycle,
-                    last_cycle,
-                    histogram);
+            if(options.is_lane_surface_only(metrics.run_info().flowcell().naming_method()) &&
+               !metrics.qscore_cube().empty())
+                populate_distribution(metrics.qscore_cube(), options, first_cycle, last_cycle, histogram);
+            else
+                populate_distribution(
+                        metrics.get<metric_t>().begin(),
+                        metrics.get<metric_t>().end(),
+                        options,
+                        first_cycle,
+                        last_cycle,
+                        histogram);
             axis_scale = scale_histogram(histogram);
             if(!metrics.get<metric_t>().bins().empty())
                 max_x_value=plot_binned_histogram(metrics.get<metric_t>().bins().begin(),
@@ -0,0 +1,270 @@
+/** Summary logic for a batch of run folders
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#include "interop/logic/summary/batch_summary.h"
+#include <algorithm>
+#include "interop/util/filesystem.h"
+#include "interop/util/thread_pool.h"
+#include "interop/logic/summary/run_summary.h"
+#include "interop/logic/summary/index_summary.h"
+#include "interop/logic/utils/metrics_to_load.h"
+
+namespace illumina { namespace interop { namespace logic { namespace summary
+{
+    namespace
+    {
+        /** Get the size of the InterOp files of a metric group
+         *
+         * The aggregate file is used if it exists, otherwise the size of the by cycle files is summed.
+         *
+         * @param metrics run metrics holding the run info
+         * @param group metric group
+         * @param run_folder run folder path
+         * @return size of the InterOp files in bytes, 0 if none are found
+         */
+        ::uint64_t interop_file_size(model::metrics::run_metrics& metrics,
+                                     const constants::metric_group group,
+                                     const std::string& run_folder)
+        {
+            std::vector<std::string> files;
+            metrics.list_filenames(group, files, run_folder, false);
+            if(!files.empty() && io::file_size(files[0]) >= 0) return static_cast< ::uint64_t >(io::file_size(files[0]));
+            metrics.list_filenames(group, files, run_folder, true);
+            if(files.empty()) return 0;
+            if(io::file_size(files[0]) >= 0) return static_cast< ::uint64_t >(io::file_size(files[0]));
+            ::uint64_t total = 0;
+            for(size_t i = 1; i < files.size(); ++i)
+            {
+                const ::int64_t size = io::file_size(files[i]);
+                if(size > 0) total += static_cast< ::uint64_t >(size);
+            }
+            return total;
+        }
+
+        /** Summarize the run and index metrics of a single run folder
+         *
+         * @param summary destination summary, holding the run folder path
+         * @param skip_median skip the median calculation
+         */
+        void summarize_run_folder(batch_run_summary& summary, const bool skip_median)
+        {
+            try
+            {
+                summarize_run_metrics(summary.run_folder, summary.run, skip_median);
+            }
+            catch(const model::invalid_run_info_cycle_exception& ex)
+            {
+                summary.error = ex.what();
+            }
+            catch(const std::exception& ex)
+            {
+                summary.error = ex.what();
+                return;
+            }
+            try
+            {
+                // The run summary has released its metrics, only the index and tile metrics are read here
+                std::vector<unsigned char> valid_to_load;
+                utils::list_index_metrics_to_load(valid_to_load);
+                model::metrics::run_metrics metrics;
+                try
+                {
+                    metrics.read(summary.run_folder, valid_to_load);
+                }
+                catch(const model::invalid_run_info_cycle_exception&)
+                {
+                    // Already reported by the run summary
+                }
+                summarize_index_metrics(metrics, summary.index);
+                summary.index.sort();
+            }
+            catch(const std::exception& ex)
+            {
+                summary.error = ex.what();
+            }
+        }
+
+        /** Estimate the peak memory of a single run folder at each iteration of a parallel loop
+         */
+        class estimate_memory_body : public util::abstract_loop_body
+        {
+        public:
+            /** Constructor
+             *
+             * @param summaries summaries holding the run folder paths
+             */
+            estimate_memory_body(std::vector<batch_run_summary>& summaries) : m_summaries(summaries){}
+            /** Estimate the memory of a run folder
+             *
+             * @param index index of the run folder
+             */
+            void operator()(const size_t index)
+            {
+                m_summaries[index].memory_estimate = estimate_summary_memory(m_summaries[index].run_folder);
+            }
+
+        private:
+            std::vector<batch_run_summary>& m_summaries;
+        };
+
+        /** Summarize run folders that fit in the memory budget until none are left
+         *
+         * Each iteration of the parallel loop is a member of the team of threads sharing the budget.
+         */
+        class summarize_team_body : public util::abstract_loop_body
+        {
+        public:
+            /** Constructor
+             *
+             * @param summaries destination summaries, holding the run folder paths
+             * @param memory_budget maximum estimated memory in bytes of the run folders summarized at the same time
+             * @param skip_median skip the median calculation
+             */
+            summarize_team_body(std::vector<batch_run_summary>& summaries,
+                                const ::uint64_t memory_budget,
+                                const bool skip_median) :
+                    m_summaries(summaries),
+                    m_memory_budget(memory_budget),
+                    m_skip_median(skip_median),
+                    m_started(summaries.size(), 0),
+                    m_memory_in_use(0),
+                    m_running(0)
+            {
+            }
+            /** Summarize run folders until none are left
+             *
+             * @param index index of the team member (unused)
+             */
+            void operator()(const size_t index)
+            {
+                (void)index;
+                for(;;)
+                {
+                    const size_t next = take_next();
+                    if(next == m_summaries.size()) break;
+                    summarize_run_folder(m_summaries[next], m_skip_median);
+                    {
+                        util::scoped_lock lock(m_mutex);
+                        m_memory_in_use -= m_summaries[next].memory_estimate;
+                        --m_running;
+                    }
+                    m_memory_released.notify_all();
+                }
+            }
+
+        private:
+            /** Take the first run folder that fits, blocking until another member releases memory
+             *
+             * A member blocks only while another member is running, which releases its memory when it finishes.
+             *
+             * @return index of the run folder, or the number of run folders if none are left
+             */
+            size_t take_next()
+            {
+                util::scoped_lock lock(m_mutex);
+                for(;;)
+                {
+                    bool finished = true;
+                    for(size_t i = 0; i < m_summaries.size(); ++i)
+                    {
+                        if(m_started[i] != 0) continue;
+                        finished = false;
+                        if(m_running > 0 && m_memory_budget > 0 &&
+                           m_memory_in_use + m_summaries[i].memory_estimate > m_memory_budget)
+                            continue;
+                        m_started[i] = 1;
+                        m_memory_in_use += m_summaries[i].memory_estimate;
+                        ++m_running;
+                        return i;
+                    }
+                    if(finished) return m_summaries.size();
+                    m_memory_released.wait(m_mutex);
+                }
+            }
+
+        private:
+            std::vector<batch_run_summary>& m_summaries;
+            const ::uint64_t m_memory_budget;
+            const bool m_skip_median;
+            std::vector<unsigned char> m_started;
+            ::uint64_t m_memory_in_use;
+            size_t m_running;
+            util::mutex m_mutex;
+            util::condition_variable m_memory_released;
+        };
+    }
+
+    /** Estimate the peak memory used to summarize a run folder
+     *
+     * The estimate is the size of the InterOp files read by the summary. As the Q-metrics are collapsed before the
+     * other files are read, it is the larger of the Q-metric files and all other files.
+     *
+     * @ingroup summary_logic
+     * @param run_folder run folder path
+     * @return estimated peak memory in bytes, 0 if the RunInfo.xml cannot be read
+     */
+    ::uint64_t estimate_summary_memory(const std::string& run_folder)
+    {
+        try
+        {
+            model::metrics::run_metrics metrics;
+            metrics.read_run_info(run_folder);
+            std::vector<unsigned char> valid_to_load;
+            utils::list_summary_metrics_to_load(valid_to_load);
+            ::uint64_t q_size = 0;
+            ::uint64_t other_size = 0;
+            for(size_t group = 0; group < valid_to_load.size(); ++group)
+            {
+                if(valid_to_load[group] == 0) continue;
+                const ::uint64_t size = interop_file_size(metrics, static_cast<constants::metric_group>(group), run_folder);
+                if(group == static_cast<size_t>(constants::Q)) q_size += size;
+                else other_size += size;
+            }
+            return std::max(q_size, other_size);
+        }
+        catch(const std::exception&)
+        {
+            return 0;
+        }
+    }
+
+    /** Summarize the run and index metrics of many run folders on a shared pool of threads
+     *
+     * Each thread takes the next run folder whose memory estimate fits in the budget along with the run folders
+     * being summarized. A run folder larger than the budget is summarized alone. Errors are reported in each
+     * summary rather than thrown, so one bad run folder does not stop the batch.
+     *
+     * @ingroup summary_logic
+     * @param run_folders run folder paths
+     * @param summaries destination summaries in the same order as the run folders
+     * @param thread_count number of run folders summarized at the same time, 0 for the number of processors
+     * @param memory_budget maximum estimated memory in bytes of the run folders summarized at the same time,
+     *        0 for no limit
+     * @param skip_median skip the median calculation
+     */
+    void summarize_run_folders(const std::vector<std::string>& run_folders,
+                               std::vector<batch_run_summary>& summaries,
+                               const size_t thread_count,
+                               const ::uint64_t memory_budget,
+                               const bool skip_median)
+    {
+        summaries.assign(run_folders.size(), batch_run_summary());
+        if(run_folders.empty()) return;
+        const size_t team_size = std::min(thread_count > 0 ? thread_count : util::default_thread_count(),
+                                          run_folders.size());
+
+        for(size_t i = 0; i < summaries.size(); ++i) summaries[i].run_folder = run_folders[i];
+        if(memory_budget > 0)
+        {
+            estimate_memory_body estimate_body(summaries);
+            util::parallel_for(summaries.size(), estimate_body, team_size);
+        }
+        summarize_team_body team_body(summaries, memory_budget, skip_median);
+        util::parallel_for(team_size, team_body, team_size);
+    }
+
+}}}}
@@ -0,0 +1,378 @@
+/** Preview summary estimated from a stratified sample of tiles
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#include "interop/logic/summary/preview_summary.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include "interop/logic/summary/run_summary.h"
+#include "interop/logic/metric/tile_metric.h"
+#include "interop/logic/metric/tile_aggregate.h"
+#include "interop/logic/utils/metrics_to_load.h"
+
+
+namespace illumina { namespace interop { namespace logic { namespace summary
+{
+    namespace
+    {
+        /** Two sided critical value of the standard normal distribution for a 95% confidence interval */
+        const double CONFIDENCE_Z_SCORE = 1.959963984540054;
+
+        /** Lane and surface of a stratum */
+        typedef std::pair<size_t, size_t> stratum_key_t;
+
+        /** Running sums of a tile metric over the sampled tiles of a stratum
+         */
+        struct running_stat
+        {
+            running_stat() : sum(0), sum_squares(0), count(0){}
+            /** Add the value of a tile, NaN values are skipped
+             *
+             * @param value value of the tile metric
+             */
+            void add(const float value)
+            {
+                if (std::isnan(value)) return;
+                sum += value;
+                sum_squares += static_cast<double>(value) * value;
+                ++count;
+            }
+            /** Get the sample mean
+             *
+             * @return sample mean
+             */
+            double mean() const
+            {
+                return sum / count;
+            }
+            /** Get the unbiased sample variance
+             *
+             * @return sample variance
+             */
+            double variance() const
+            {
+                return std::max(0.0, (sum_squares - sum * sum / count) / (count - 1));
+            }
+
+            double sum;
+            double sum_squares;
+            size_t count;
+        };
+
+        /** Tiles of a lane and surface in the flowcell layout, and the metrics of its sampled tiles
+         */
+        struct stratum
+        {
+            stratum(const size_t read_count=0) : tile_count(0), error_rate(read_count), percent_gt_q30(read_count){}
+
+            size_t tile_count;
+            running_stat density;
+            running_stat percent_pf;
+            std::vector<running_stat> error_rate;
+            std::vector<running_stat> percent_gt_q30;
+        };
+
+        typedef std::map<stratum_key_t, stratum> stratum_map_t;
+
+        /** Estimate the mean of a tile metric over a group of strata
+         *
+         * @param strata strata of the group
+         * @param stat function selecting the running sums of the tile metric
+         * @param read_index index of the read, for metrics estimated by read
+         * @return stratified estimate of the mean
+         */
+        template<class Selector>
+        model::summary::metric_estimate stratified_estimate(const std::vector<const stratum*>& strata,
+                                                            Selector stat,
+                                                            const size_t read_index)
+        {
+            double total = 0;
+            size_t sample_count = 0;
+            for (size_t i = 0; i < strata.size(); ++i)
+            {
+                const running_stat& values = stat(*strata[i], read_index);
+                if (values.count == 0) continue;
+                total += std::max(strata[i]->tile_count, values.count);
+                sample_count += values.count;
+            }
+            if (sample_count == 0) return model::summary::metric_estimate();
+            double mean = 0;
+            double variance = 0;
+            for (size_t i = 0; i < strata.size(); ++i)
+            {
+                const running_stat& values = stat(*strata[i], read_index);
+                if (values.count == 0) continue;
+                const size_t population = std::max(strata[i]->tile_count, values.count);
+                const double weight = population / total;
+                const double sample_fraction = static_cast<double>(values.count) / population;
+                mean += weight * values.mean();
+                // Every tile of the stratum was sampled, so its mean is known exactly
+                if (values.count == population) continue;
+                if (values.count < 2) variance = std::numeric_limits<double>::quiet_NaN();
+                else variance += weight * weight * (1.0 - sample_fraction) * values.variance() / values.count;
+            }
+            const double half_width = CONFIDENCE_Z_SCORE * std::sqrt(variance);
+            return model::summary::metric_estimate(static_cast<float>(mean),
+                                                   static_cast<float>(mean - half_width),
+                                                   static_cast<float>(mean + half_width),
+                                                   sample_count);
+        }
+
+        /** Select the running sums of the cluster density */
+        const running_stat& select_density(const stratum& s, const size_t){return s.density;}
+        /** Select the running sums of the percent PF */
+        const running_stat& select_percent_pf(const stratum& s, const size_t){return s.percent_pf;}
+        /** Select the running sums of the error rate of a read */
+        const running_stat& select_error_rate(const stratum& s, const size_t read){return s.error_rate[read];}
+        /** Select the running sums of the percent over Q30 of a read */
+        const running_stat& select_percent_gt_q30(const stratum& s, const size_t read){return s.percent_gt_q30[read];}
+
+        /** Estimate the tile metrics of a group of strata
+         *
+         * @param strata strata of the group
+         * @param sampled_tile_count number of sampled tiles in the group
+         * @param estimate destination estimate
+         */
+        void estimate_strata(const std::vector<const stratum*>& strata,
+                             const size_t sampled_tile_count,
+                             model::summary::summary_estimate& estimate)
+        {
+            size_t tile_count = 0;
+            for (size_t i = 0; i < strata.size(); ++i) tile_count += strata[i]->tile_count;
+            estimate.tile_count(tile_count, sampled_tile_count);
+            estimate.density(stratified_estimate(strata, select_density, 0));
+            estimate.percent_pf(stratified_estimate(strata, select_percent_pf, 0));
+            for (size_t read = 0; read < estimate.read_count(); ++read)
+            {
+                estimate.error_rate(read, stratified_estimate(strata, select_error_rate, read));
+                estimate.percent_gt_q30(read, stratified_estimate(strata, select_percent_gt_q30, read));
+            }
+        }
+    }
+
+    /** List the lane/tile id of every tile in the flowcell layout
+     *
+     * @param layout flowcell layout
+     * @param tile_ids destination sorted vector of lane/tile ids
+     */
+    void list_flowcell_tiles(const model::run::flowcell_layout& layout, tile_id_vector_t& tile_ids)
+    {
+        typedef model::metric_base::base_metric base_metric;
+        tile_ids.clear();
+        if (!layout.tiles().empty())
+        {
+            for (size_t i = 0; i < layout.tiles().size(); ++i)
+            {
+                const ::uint32_t lane = metric::lane_from_name(layout.tiles()[i]);
+                const ::uint32_t tile = metric::tile_from_name(layout.tiles()[i]);
+                if (lane > 0 && tile > 0) tile_ids.push_back(base_metric::create_id(lane, tile));
+            }
+        }
+        else
+        {
+            const constants::tile_naming_method naming_method = layout.naming_method();
+            const size_t section_count = naming_method == constants::FiveDigit ? layout.sections_per_lane() : 1;
+            const std::vector< ::uint32_t >& surfaces = layout.surface_list();
+            for (size_t lane = 1; lane <= layout.lane_count(); ++lane)
+            {
+                size_t absolute_tile = 0;
+                for (size_t surface_index = 0; surface_index < surfaces.size(); ++surface_index)
+                {
+                    const size_t surface = surfaces[surface_index];
+                    for (size_t swath = 1; swath <= layout.swath_count(); ++swath)
+                    {
+                        for (size_t section = 1; section <= section_count; ++section)
+                        {
+                            for (size_t number = 1; number <= layout.tile_count(); ++number)
+                            {
+                                size_t tile;
+                                switch (naming_method)
+                                {
+                                    case constants::FiveDigit:
+                                        tile = surface * 10000 + swath * 1000 + section * 100 + number;
+                                        break;
+                                    case constants::FourDigit:
+                                        tile = surface * 1000 + swath * 100 + number;
+                                        break;
+                                    case constants::Absolute:
+                                        tile = ++absolute_tile;
+                                        break;
+                                    default:
+                                        return;
+                                }
+                                tile_ids.push_back(base_metric::create_id(lane, tile));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        std::sort(tile_ids.begin(), tile_ids.end());
+        tile_ids.erase(std::unique(tile_ids.begin(), tile_ids.end()), tile_ids.end());
+    }
+
+    /** Select a stratified sample of tiles from the flowcell layout
+     *
+     * @param layout flowcell layout
+     * @param tiles_per_surface number of tiles sampled from each surface of each lane
+     * @param tile_ids destination sorted vector of lane/tile ids
+     */
+    void select_preview_tiles(const model::run::flowcell_layout& layout,
+                              const size_t tiles_per_surface,
+                              tile_id_vector_t& tile_ids)
+    {
+        typedef model::metric_base::base_metric base_metric;
+        tile_id_vector_t all_tiles;
+        list_flowcell_tiles(layout, all_tiles);
+        tile_ids.clear();
+        if (tiles_per_surface == 0) return;
+        // The tiles are sorted by lane, then surface, then swath and tile number
+        for (size_t first = 0, last; first < all_tiles.size(); first = last)
+        {
+            const ::uint32_t lane = base_metric::lane_from_id(all_tiles[first]);
+            const ::uint32_t surface = metric::surface(base_metric::tile_from_id(all_tiles[first]),
+                                                       layout.naming_method());
+            for (last = first + 1; last < all_tiles.size(); ++last)
+            {
+                if (base_metric::lane_from_id(all_tiles[last]) != lane) break;
+                if (metric::surface(base_metric::tile_from_id(all_tiles[last]), layout.naming_method()) != surface)
+                    break;
+            }
+            const size_t count = last - first;
+            const size_t sample_count = std::min(count, tiles_per_surface);
+            for (size_t i = 0; i < sample_count; ++i)
+                tile_ids.push_back(all_tiles[first + (2 * i + 1) * count / (2 * sample_count)]);
+        }
+    }
+
+    /** Estimate the mean density, percent PF, error rate and percent over Q30 of each lane from sampled tiles
+     *
+     * The error rate and percent over Q30 of each tile are averaged over the cycles of the read, excluding the last
+     * cycle, so the percent over Q30 is a mean over tiles rather than the ratio of the summed histograms.
+     *
+     * @param metrics run metrics holding a sample of tiles
+     * @param estimate destination run summary estimate
+     */
+    void estimate_run_summary(const model::metrics::run_metrics& metrics,
+                              model::summary::run_summary_estimate& estimate)
+    INTEROP_THROW_SPEC((model::index_out_of_bounds_exception))
+    {
+        typedef model::metric_base::base_metric base_metric;
+        estimate.clear();
+        const model::run::flowcell_layout& layout = metrics.run_info().flowcell();
+        const constants::tile_naming_method naming_method = layout.naming_method();
+        const size_t read_count = metrics.run_info().reads().size();
+        const model::metrics::tile_aggregate_table& table = metrics.tile_aggregates();
+        if (table.empty()) return;
+
+        stratum_map_t strata;
+        tile_id_vector_t all_tiles;
+        list_flowcell_tiles(layout, all_tiles);
+        for (size_t i = 0; i < all_tiles.size(); ++i)
+        {
+            const stratum_key_t key(base_metric::lane_from_id(all_tiles[i]),
+                                    metric::surface(base_metric::tile_from_id(all_tiles[i]), naming_method));
+            stratum_map_t::iterator it = strata.find(key);
+            if (it == strata.end()) it = strata.insert(std::make_pair(key, stratum(read_count))).first;
+            ++it->second.tile_count;
+        }
+        std::map<size_t, size_t> sampled_tile_count;
+        for (size_t row = 0; row < table.size(); ++row)
+        {
+            const model::metrics::tile_aggregate& tile = table[row];
+            if (!tile.has_tile_metric()) continue;
+            const stratum_key_t key(tile.lane(), metric::surface(tile.tile(), naming_method));
+            stratum_map_t::iterator it = strata.find(key);
+            if (it == strata.end()) it = strata.insert(std::make_pair(key, stratum(read_count))).first;
+            ++sampled_tile_count[tile.lane()];
+            it->second.density.add(tile.cluster_density());
+            it->second.percent_pf.add(tile.percent_pf());
+            for (size_t read = 1; read <= std::min(read_count, table.read_count()); ++read)
+            {
+                it->second.error_rate[read - 1].add(table.read(row, read).error_rate());
+                it->second.percent_gt_q30[read - 1].add(table.read(row, read).percent_over_q30());
+            }
+        }
+
+        std::vector<const stratum*> run_strata;
+        for (stratum_map_t::const_iterator first = strata.begin(), last; first != strata.end(); first = last)
+        {
+            const size_t lane = first->first.first;
+            std::vector<const stratum*> lane_strata;
+            for (last = first; last != strata.end() && last->first.first == lane; ++last)
+                lane_strata.push_back(&last->second);
+            model::summary::summary_estimate lane_estimate(lane, read_count);
+            estimate_strata(lane_strata, sampled_tile_count[lane], lane_estimate);
+            estimate.push_back(lane_estimate);
+            run_strata.insert(run_strata.end(), lane_strata.begin(), lane_strata.end());
+        }
+        model::summary::summary_estimate total(0, read_count);
+        size_t total_sampled_tile_count = 0;
+        for (std::map<size_t, size_t>::const_iterator it = sampled_tile_count.begin();
+             it != sampled_tile_count.end(); ++it)
+            total_sampled_tile_count += it->second;
+        estimate_strata(run_strata, total_sampled_tile_count, total);
+        estimate.total(total);
+    }
+
+    /** Summarize a stratified sample of tiles from the InterOp files in a run folder
+     *
+     * @param run_folder run folder path
+     * @param summary destination run summary over the sampled tiles
+     * @param estimate destination run summary estimate
+     * @param tiles_per_surface number of tiles sampled from each surface of each lane
+     * @param thread_count number of threads to use for network loading
+     * @throws model::invalid_run_info_cycle_exception after the preview is complete, if a metric has a cycle
+     *         beyond the cycles in the RunInfo.xml
+     */
+    void summarize_run_metrics_preview(const std::string& run_folder,
+                                       model::summary::run_summary& summary,
+                                       model::summary::run_summary_estimate& estimate,
+                                       const size_t tiles_per_surface,
+                                       const size_t thread_count)
+    INTEROP_THROW_SPEC(( xml::xml_file_not_found_exception,
+    xml::bad_xml_format_exception,
+    xml::empty_xml_format_exception,
+    xml::missing_xml_element_exception,
+    xml::xml_parse_exception,
+    io::file_not_found_exception,
+    io::bad_format_exception,
+    io::incomplete_file_exception,
+    model::index_out_of_bounds_exception,
+    model::invalid_channel_exception,
+    model::invalid_tile_naming_method,
+    model::invalid_tile_list_exception,
+    model::invalid_run_info_exception,
+    model::invalid_run_info_cycle_exception,
+    model::invalid_parameter ))
+    {
+        model::metrics::run_metrics metrics;
+        metrics.read_run_info(run_folder);
+        tile_id_vector_t tile_ids;
+        select_preview_tiles(metrics.run_info().flowcell(), tiles_per_surface, tile_ids);
+        // Without a known layout no tile can be selected, so every tile is read
+        metrics.set_read_filter(model::metric_base::record_filter(tile_ids));
+
+        std::vector<unsigned char> valid_to_load;
+        utils::list_summary_metrics_to_load(valid_to_load);
+        std::string cycle_error;
+        try
+        {
+            metrics.read(run_folder, valid_to_load, thread_count);
+        }
+        catch(const model::invalid_run_info_cycle_exception& ex)
+        {
+            cycle_error = ex.what();
+        }
+        summarize_run_metrics(metrics, summary);
+        estimate_run_summary(metrics, estimate);
+        if(!cycle_error.empty())
+            INTEROP_THROW(model::invalid_run_info_cycle_exception, cycle_error);
+    }
+
+}}}}
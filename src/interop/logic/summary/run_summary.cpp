@@ -14,6 +14,7 @@
 #include "interop/logic/metric/q_metric.h"
 #include "interop/logic/summary/phasing_summary.h"
 #include "interop/logic/metric/dynamic_phasing_metric.h"
+#include "interop/logic/metric/tile_aggregate.h"
 #include "interop/model/metrics/summary_run_metric.h"
 
 
@@ -23,8 +24,11 @@ namespace illumina { namespace interop { namespace logic { namespace summary
      *
      * @param metrics run metrics
      * @param summary run summary
+     * @param use_collapsed_q take the Q-metric tiles from the collapsed Q-metrics
      */
-    void summarize_tile_count(const model::metrics::run_metrics& metrics, model::summary::run_summary& summary)
+    void summarize_tile_count(const model::metrics::run_metrics& metrics,
+                              model::summary::run_summary& summary,
+                              const bool use_collapsed_q)
     {
         using namespace model::metrics;
         model::metrics::run_metrics::id_set_t tile_count_set;
@@ -47,10 +51,16 @@ namespace illumina { namespace interop { namespace logic { namespace summary
                                                                                         lane+1,
                                                                                         surface_list[surface_index],
                                                                                         naming_convention);
-                metrics.get<q_metric>().populate_tile_numbers_for_lane_surface(tile_count_set,
-                                                                               lane+1,
-                                                                               surface_list[surface_index],
-                                                                               naming_convention);
+                if(use_collapsed_q)
+                    metrics.get<q_collapsed_metric>().populate_tile_numbers_for_lane_surface(tile_count_set,
+                                                                                             lane+1,
+                                                                                             surface_list[surface_index],
+                                                                                             naming_convention);
+                else
+                    metrics.get<q_metric>().populate_tile_numbers_for_lane_surface(tile_count_set,
+                                                                                   lane+1,
+                                                                                   surface_list[surface_index],
+                                                                                   naming_convention);
                 metrics.get<corrected_intensity_metric>().populate_tile_numbers_for_lane_surface(tile_count_set,
                                                                                                  lane+1,
                                                                                                  surface_list[surface_index],
@@ -107,23 +117,19 @@ namespace illumina { namespace interop { namespace logic { namespace summary
     }
 
 
-    /** Summarize a collection run metrics
-     *
-     * TODO speed up calculation by adding no_median flag
+    /** Summarize a collection run metrics without consulting the result cache
      *
-     * @ingroup summary_logic
      * @param metrics source collection of all metrics
      * @param summary destination run summary
      * @param skip_median skip the median calculation
      * @param trim removed unset lanes
+     * @param use_collapsed_q take the Q-metric tiles and cycles from the collapsed Q-metrics
      */
-    void summarize_run_metrics(model::metrics::run_metrics& metrics,
-                               model::summary::run_summary& summary,
-                               const bool skip_median,
-                               const bool trim)
-    INTEROP_THROW_SPEC(( model::index_out_of_bounds_exception,
-    model::invalid_channel_exception,
-    model::invalid_run_info_exception ))
+    void summarize_run_metrics_t(model::metrics::run_metrics& metrics,
+                                 model::summary::run_summary& summary,
+                                 const bool skip_median,
+                                 const bool trim,
+                                 const bool use_collapsed_q=false)
     {
         using namespace model::metrics;
         if(metrics.empty())
@@ -136,14 +142,9 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         read_cycle_vector_t cycle_to_read;
         const constants::tile_naming_method naming_method = metrics.run_info().flowcell().naming_method();
         map_read_to_cycle_number(summary.begin(), summary.end(), cycle_to_read);
-        summarize_tile_metrics(metrics.get<tile_metric>().begin(),
-                               metrics.get<tile_metric>().end(),
-                               naming_method,
-                               summary);
-        summarize_extended_tile_metrics(metrics.get<extended_tile_metric>().begin(),
-                                        metrics.get<extended_tile_metric>().end(),
-                                        naming_method,
-                                        summary);
+        const tile_aggregate_table& tile_aggregates = metrics.tile_aggregates();
+        summarize_tile_aggregates(tile_aggregates, naming_method, summary);
+        summarize_extended_tile_aggregates(tile_aggregates, naming_method, summary);
         validate_cycle_to_read(metrics.get<error_metric>(), cycle_to_read);
         summarize_error_metrics(metrics.get<error_metric>().begin(),
                                 metrics.get<error_metric>().end(),
@@ -161,16 +162,32 @@ namespace illumina { namespace interop { namespace logic { namespace summary
                                      summary,
                                      skip_median);
 
-        if(0 == metrics.get<q_collapsed_metric>().size())
-            logic::metric::create_collapse_q_metrics(metrics.get<q_metric>(),
-                                                     metrics.get<q_collapsed_metric>());
-        validate_cycle_to_read(metrics.get<q_collapsed_metric>(), cycle_to_read);
-        summarize_collapsed_quality_metrics(metrics.get<q_collapsed_metric>().begin(),
-                                            metrics.get<q_collapsed_metric>().end(),
-                                            cycle_to_read,
-                                            naming_method,
-                                            summary);
-        summarize_tile_count(metrics, summary);
+        // The q-score cube sums the histograms of each lane, surface and cycle, so the q-metrics need not be
+        // collapsed record by record. Without q-metrics, or when they cannot be binned, the collapsed
+        // q-metrics are used.
+        if(!metrics.get<q_metric>().empty() && !metrics.qscore_cube().empty())
+        {
+            validate_cycle_to_read(metrics.get<q_metric>(), cycle_to_read);
+            summarize_quality_cube(metrics.qscore_cube(),
+                                   metrics.get<q_metric>(),
+                                   logic::metric::index_for_q_value(metrics.get<q_metric>(), 30),
+                                   cycle_to_read,
+                                   naming_method,
+                                   summary);
+        }
+        else
+        {
+            if(0 == metrics.get<q_collapsed_metric>().size())
+                logic::metric::create_collapse_q_metrics(metrics.get<q_metric>(),
+                                                         metrics.get<q_collapsed_metric>());
+            validate_cycle_to_read(metrics.get<q_collapsed_metric>(), cycle_to_read);
+            summarize_collapsed_quality_metrics(metrics.get<q_collapsed_metric>().begin(),
+                                                metrics.get<q_collapsed_metric>().end(),
+                                                cycle_to_read,
+                                                naming_method,
+                                                summary);
+        }
+        summarize_tile_count(metrics, summary, use_collapsed_q);
 
         summarize_cycle_state(metrics.get<tile_metric>(),
                               metrics.get<error_metric>(),
@@ -182,12 +199,23 @@ namespace illumina { namespace interop { namespace logic { namespace summary
                               cycle_to_read,
                               &model::summary::cycle_state_summary::extracted_cycle_range,
                               summary);
-        validate_cycle_to_read(metrics.get<q_metric>(), cycle_to_read);
-        summarize_cycle_state(metrics.get<tile_metric>(),
-                              metrics.get<q_metric>(),
-                              cycle_to_read,
-                              &model::summary::cycle_state_summary::qscored_cycle_range,
-                              summary);
+        if(use_collapsed_q)
+        {
+            summarize_cycle_state(metrics.get<tile_metric>(),
+                                  metrics.get<q_collapsed_metric>(),
+                                  cycle_to_read,
+                                  &model::summary::cycle_state_summary::qscored_cycle_range,
+                                  summary);
+        }
+        else
+        {
+            validate_cycle_to_read(metrics.get<q_metric>(), cycle_to_read);
+            summarize_cycle_state(metrics.get<tile_metric>(),
+                                  metrics.get<q_metric>(),
+                                  cycle_to_read,
+                                  &model::summary::cycle_state_summary::qscored_cycle_range,
+                                  summary);
+        }
         // Summarize called cycle state
         validate_cycle_to_read(metrics.get<corrected_intensity_metric>(), cycle_to_read);
         summarize_cycle_state(metrics.get<tile_metric>(),
@@ -233,5 +261,111 @@ namespace illumina { namespace interop { namespace logic { namespace summary
         }
     }
 
+    /** Summarize a collection run metrics
+     *
+     * If the result cache of the run metrics is enabled, a cached summary for the same arguments is copied
+     * instead of being recomputed.
+     *
+     * TODO speed up calculation by adding no_median flag
+     *
+     * @ingroup summary_logic
+     * @param metrics source collection of all metrics
+     * @param summary destination run summary
+     * @param skip_median skip the median calculation
+     * @param trim removed unset lanes
+     */
+    void summarize_run_metrics(model::metrics::run_metrics& metrics,
+                               model::summary::run_summary& summary,
+                               const bool skip_median,
+                               const bool trim)
+    INTEROP_THROW_SPEC(( model::index_out_of_bounds_exception,
+    model::invalid_channel_exception,
+    model::invalid_run_info_exception ))
+    {
+        if(!metrics.is_result_cache_enabled())
+        {
+            summarize_run_metrics_t(metrics, summary, skip_median, trim);
+            return;
+        }
+        const std::string key = model::metrics::result_cache::key("summarize_run_metrics", skip_median, trim);
+        if(metrics.find_result(key, summary)) return;
+        summarize_run_metrics_t(metrics, summary, skip_median, trim);
+        metrics.store_result(key, summary);
+    }
+
+    /** Summarize the InterOp files in a run folder
+     *
+     * The Q-metrics are read on their own and folded into collapsed Q-metrics, then the full Q-score histograms
+     * are released before the remaining InterOp files required for the summary are read. The result is the same
+     * as reading the summary metrics into a run_metrics and calling summarize_run_metrics.
+     *
+     * @ingroup summary_logic
+     * @param run_folder run folder path
+     * @param summary destination run summary
+     * @param skip_median skip the median calculation
+     * @param trim removed unset lanes
+     * @param thread_count number of threads to use for network loading
+     * @throws model::invalid_run_info_cycle_exception after the summary is complete, if a metric has a cycle
+     *         beyond the cycles in the RunInfo.xml
+     */
+    void summarize_run_metrics(const std::string& run_folder,
+                               model::summary::run_summary& summary,
+                               const bool skip_median,
+                               const bool trim,
+                               const size_t thread_count)
+    INTEROP_THROW_SPEC(( xml::xml_file_not_found_exception,
+    xml::bad_xml_format_exception,
+    xml::empty_xml_format_exception,
+    xml::missing_xml_element_exception,
+    xml::xml_parse_exception,
+    io::file_not_found_exception,
+    io::bad_format_exception,
+    io::incomplete_file_exception,
+    model::index_out_of_bounds_exception,
+    model::invalid_channel_exception,
+    model::invalid_tile_naming_method,
+    model::invalid_tile_list_exception,
+    model::invalid_run_info_exception,
+    model::invalid_run_info_cycle_exception,
+    model::invalid_parameter ))
+    {
+        using namespace model::metrics;
+        std::vector<unsigned char> valid_to_load;
+        utils::list_summary_metrics_to_load(valid_to_load);
+        // Like the summary application, metrics beyond the cycles in the RunInfo.xml are dropped and the
+        // summary is still produced before the error is reported
+        std::string cycle_error;
+        run_metrics metrics;
+        {
+            std::vector<unsigned char> q_to_load(valid_to_load.size(), 0);
+            q_to_load[constants::Q] = valid_to_load[constants::Q];
+            q_to_load[constants::QCollapsed] = valid_to_load[constants::QCollapsed];
+            run_metrics q_metrics;
+            try
+            {
+                q_metrics.read(run_folder, q_to_load, thread_count);
+            }
+            catch(const model::invalid_run_info_cycle_exception& ex)
+            {
+                cycle_error = ex.what();
+            }
+            metrics.get<q_collapsed_metric>() = q_metrics.get<q_collapsed_metric>();
+        }
+        valid_to_load[constants::Q] = 0;
+        valid_to_load[constants::QCollapsed] = 0;
+        valid_to_load[constants::QByLane] = 0;
+        try
+        {
+            metrics.read(run_folder, valid_to_load, thread_count);
+        }
+        catch(const model::invalid_run_info_cycle_exception& ex)
+        {
+            if(cycle_error.empty()) cycle_error = ex.what();
+        }
+        summarize_run_metrics_t(metrics, summary, skip_median, trim, true);
+        if(!cycle_error.empty())
+            INTEROP_THROW(model::invalid_run_info_cycle_exception, cycle_error);
+    }
+
 }}}}
 
@@ -11,6 +11,7 @@
 #include "interop/logic/table/create_imaging_table_columns.h"
 #include "interop/logic/table/table_populator.h"
 #include "interop/logic/metric/q_metric.h"
+#include "interop/logic/metric/tile_aggregate.h"
 #include "interop/logic/utils/metric_type_ext.h"
 
 namespace illumina { namespace interop { namespace logic { namespace table
@@ -128,6 +129,52 @@ namespace illumina { namespace interop { namespace logic { namespace table
     {
         for(;beg != end;beg+=column_count) *beg = 0;
     }
+    /** Populate the tile columns of the imaging table from the per tile aggregate table
+     *
+     * Rows are ordered by tile, so the aggregate row of a tile is found once per run of rows of the same tile.
+     *
+     * @param table per tile aggregate table
+     * @param cycle_to_read map cycle to the read number and cycle within read
+     * @param cmap map from the column id to the offset in the row
+     * @param row_offset offset for each metric into the sorted table
+     * @param column_count number of columns in the table
+     * @param data_beg iterator to start of table data
+     * @param data_end iterator to end of table data
+     */
+    template<typename I>
+    void populate_imaging_table_data_by_tile(const model::metrics::tile_aggregate_table& table,
+                                             const summary::read_cycle_vector_t& cycle_to_read,
+                                             const std::vector<size_t>& cmap,
+                                             const row_offset_map_t& row_offset,
+                                             const size_t column_count,
+                                             I data_beg,
+                                             I data_end)
+    {
+        typedef model::metric_base::base_metric::id_t id_t;
+        id_t last_tile_id = 0;
+        size_t tile_row = table.size();
+        for(row_offset_map_t::const_iterator it = row_offset.begin();it != row_offset.end();++it)
+        {
+            const id_t tid = model::metric_base::base_cycle_metric::tile_hash_from_id(it->first);
+            if(it == row_offset.begin() || tid != last_tile_id)
+            {
+                last_tile_id = tid;
+                tile_row = table.find(tid);
+            }
+            if(tile_row == table.size() || !table[tile_row].has_tile_metric()) continue;
+            const id_t cycle = model::metric_base::base_cycle_metric::cycle_from_id(it->first);
+            INTEROP_ASSERTMSG(cycle <= cycle_to_read.size(),
+                              cycle << " <= " << cycle_to_read.size()
+                                    <<  " tile: " << model::metric_base::base_cycle_metric::tile_from_id(it->first));
+            const summary::read_cycle& read = cycle_to_read[static_cast<size_t>(cycle-1)];
+            table_populator::populate(table,
+                                      tile_row,
+                                      read.number,
+                                      cmap,
+                                      data_beg+it->second*column_count,
+                                      data_end);
+        }
+    }
     /** Populate the imaging table with all the metrics in the run
      *
      * @param metrics collection of all run metrics
@@ -144,9 +191,7 @@ namespace illumina { namespace interop { namespace logic { namespace table
                                    I data_end)
     {
         typedef typename model::metrics::run_metrics::id_t id_t;
-        typedef model::metric_base::metric_set< model::metrics::tile_metric > tile_metric_set_t;
         typedef model::metric_base::metric_set< model::metrics::dynamic_phasing_metric > dynamic_phasing_metric_set_t;
-        typedef model::metric_base::metric_set< model::metrics::extended_tile_metric > extended_tile_metric_set_t;
 
         if(columns.empty())return;
         const size_t column_count = columns.back().column_count();
@@ -219,42 +264,12 @@ namespace illumina { namespace interop { namespace logic { namespace table
                                              column_count,
                                              data_beg, data_end);
 
-        const tile_metric_set_t& tile_metrics = metrics.get<model::metrics::tile_metric>();
-        for(typename row_offset_map_t::const_iterator it = row_offset.begin();it != row_offset.end();++it)
-        {
-            const id_t tid = model::metric_base::base_cycle_metric::tile_hash_from_id(it->first);
-            if (!tile_metrics.has_metric(tid)) continue;
-            const id_t cycle = model::metric_base::base_cycle_metric::cycle_from_id(it->first);
-            const ::uint64_t row = it->second;
-            INTEROP_ASSERTMSG(cycle <= cycle_to_read.size(),
-                              cycle << " <= " << cycle_to_read.size()
-                                    <<  " tile: " << model::metric_base::base_cycle_metric::tile_from_id(it->first));
-            const summary::read_cycle& read = cycle_to_read[static_cast<size_t>(cycle-1)];
-            table_populator::populate(tile_metrics.get_metric(tid),
-                                      read.number,
-                                      q20_idx,
-                                      q30_idx,
-                                      naming_method,
-                                      cmap,
-                                      data_beg+row*column_count,
-                                      data_end);
-        }
-        const extended_tile_metric_set_t& extended_tile_metrics = metrics.get<model::metrics::extended_tile_metric>();
-        for(typename row_offset_map_t::const_iterator it = row_offset.begin();it != row_offset.end();++it)
-        {
-            const id_t tid = model::metric_base::base_cycle_metric::tile_hash_from_id(it->first);
-            if (!tile_metrics.has_metric(tid) || !extended_tile_metrics.has_metric(tid)) continue;
-            const id_t cycle = model::metric_base::base_cycle_metric::cycle_from_id(it->first);
-            const ::uint64_t row = it->second;
-            const summary::read_cycle& read = cycle_to_read[static_cast<size_t>(cycle-1)];
-            table_populator::populate(extended_tile_metrics.get_metric(tid),
-                                      read.number,
-                                      q20_idx,
-                                      q30_idx,
-                                      naming_method,
-                                      cmap,
-                                      data_beg+row*column_count, data_end);
-        }
+        populate_imaging_table_data_by_tile(metrics.tile_aggregates(),
+                                            cycle_to_read,
+                                            cmap,
+                                            row_offset,
+                                            column_count,
+                                            data_beg, data_end);
         const dynamic_phasing_metric_set_t& dynamic_phasing_metrics =
                 metrics.get<model::metrics::dynamic_phasing_metric>();
         for(typename row_offset_map_t::const_iterator it = row_offset.begin();it != row_offset.end();++it)
@@ -12,9 +12,43 @@
 #include "interop/logic/table/check_imaging_table_column.h"
 #include "interop/logic/metric/q_metric.h"
 #include "interop/logic/metric/dynamic_phasing_metric.h"
+#include "interop/logic/metric/tile_aggregate.h"
+#include "interop/logic/table/table_populator.h"
 
 namespace illumina { namespace interop { namespace logic { namespace table
 {
+    /** Determine whether the tile columns should be filled from the per tile aggregate table
+     *
+     * @param table per tile aggregate table
+     * @param tile_hash map between the tile has and base metric
+     * @param run_info run info
+     * @param filled destination array that indicates whether a column should be filled
+     */
+    void set_filled_for_tile_aggregates(const model::metrics::tile_aggregate_table& table,
+                                        const model::metrics::run_metrics::tile_metric_map_t& tile_hash,
+                                        const model::run::info& run_info,
+                                        std::vector< bool >& filled)
+    {
+        typedef model::metrics::run_metrics::tile_metric_map_t tile_metric_map_t;
+        for(tile_metric_map_t::const_iterator it = tile_hash.begin();it != tile_hash.end();++it)
+        {
+            const size_t row = table.find(it->first);
+            if(row == table.size() || !table[row].has_tile_metric()) continue;
+            for(size_t column = 0;column < filled.size();++column)
+            {
+                if(filled[column]) continue;
+                const model::table::column_id id = static_cast<model::table::column_id>(column);
+                for(model::run::info::const_read_iterator read_it = run_info.reads().begin();read_it != run_info.reads().end();++read_it)
+                {
+                    if(!std::isnan(table_populator::tile_aggregate_value(table, row, read_it->number(), id)))
+                    {
+                        filled[column] = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
     /** Determine whether a column should be filled
      *
      * @param metrics run metrics
@@ -34,37 +68,11 @@ namespace illumina { namespace interop { namespace logic { namespace table
         check_imaging_table_column::set_filled_for_metric_set(metrics.get<model::metrics::q_metric>(), filled);
         check_imaging_table_column::set_filled_for_metric_set(metrics.get<model::metrics::phasing_metric>(), filled);
 
-        const model::metric_base::metric_set<model::metrics::tile_metric>& tile_metrics =
-                metrics.get<model::metrics::tile_metric>();
+        set_filled_for_tile_aggregates(metrics.tile_aggregates(), tile_hash, metrics.run_info(), filled);
+
         const constants::tile_naming_method naming_method = metrics.run_info().flowcell().naming_method();
         const size_t q20_idx = metric::index_for_q_value(metrics.get<model::metrics::q_metric>(), 20);
         const size_t q30_idx = metric::index_for_q_value(metrics.get<model::metrics::q_metric>(), 30);
-        for(tile_metric_map_t::const_iterator it = tile_hash.begin();it != tile_hash.end();++it)
-        {
-            if(!tile_metrics.has_metric(it->first)) continue;
-            for(model::run::info::const_read_iterator read_it = metrics.run_info().reads().begin();read_it != metrics.run_info().reads().end();++read_it)
-            {
-                check_imaging_table_column::set_filled_for_metric(tile_metrics.get_metric(it->first),
-                                                                  read_it->number(),
-                                                                  q20_idx,
-                                                                  q30_idx,
-                                                                  naming_method,
-                                                                  filled);
-            }
-        }
-        const model::metric_base::metric_set<model::metrics::extended_tile_metric>& extended_tile_metrics =
-                metrics.get<model::metrics::extended_tile_metric>();
-        for(tile_metric_map_t::const_iterator it = tile_hash.begin();it != tile_hash.end();++it)
-        {
-            if (!extended_tile_metrics.has_metric(it->first) || !tile_metrics.has_metric(it->first)) continue;
-            check_imaging_table_column::set_filled_for_metric(extended_tile_metrics.get_metric(it->first),
-                                                              1,
-                                                              q20_idx,
-                                                              q30_idx,
-                                                              naming_method,
-                                                              filled);
-        }
-
         summary::read_cycle_vector_t cycle_to_read;
         summary::map_read_to_cycle_number(metrics.run_info().reads().begin(),
                                           metrics.run_info().reads().end(),
@@ -11,6 +11,7 @@
 #include <vector>
 #include <algorithm>
 #include "interop/util/assert.h"
+#include "interop/util/number_format.h"
 #include "interop/model/metrics/q_metric.h"
 #include "interop/model/metrics/q_by_lane_metric.h"
 #include "interop/io/format/text_format_factory.h"
@@ -1261,12 +1262,19 @@ namespace illumina { namespace interop { namespace io
             if( static_cast<size_t>(header.q_val_count()) != metric.size() )
                 INTEROP_THROW(bad_format_exception, "Header and metric bin count mismatch: "
                         << header.q_val_count() << " != " << metric.size());
-            out << metric.lane() << sep << metric.tile() << sep << metric.cycle();
+            util::number_formatter formatter(out);
+            formatter.append(metric.lane());
+            formatter.append(sep);
+            formatter.append(metric.tile());
+            formatter.append(sep);
+            formatter.append(metric.cycle());
             for(size_t i=0;i<header.q_val_count();++i)
             {
-                out << sep << metric.qscore_hist()[i];
+                formatter.append(sep);
+                formatter.append(metric.qscore_hist()[i]);
             }
-            out << eol;
+            formatter.append(eol);
+            formatter.write(out);
             return 0;
         }
     };
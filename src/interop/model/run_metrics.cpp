@@ -5,10 +5,7 @@
  *  @version 1.0
  *  @copyright GNU Public License.
  */
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
+#include <algorithm>
 #include "interop/model/run_metrics.h"
 
 #include "interop/logic/metric/q_metric.h"
@@ -17,6 +14,8 @@
 #include "interop/logic/utils/channel.h"
 #include "interop/logic/metric/dynamic_phasing_metric.h"
 #include "interop/logic/metric/extended_tile_metric.h"
+#include "interop/logic/metric/tile_aggregate.h"
+#include "interop/util/thread_pool.h"
 
 namespace illumina { namespace interop { namespace model { namespace metrics
 {
@@ -30,6 +29,29 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         }
     };
 
+    struct append_source_key
+    {
+        append_source_key(std::vector<size_t>& key) : m_key(key){}
+        template<class MetricSet>
+        void operator()(const MetricSet &metrics)const
+        {
+            metrics.append_source_key(m_key);
+        }
+        std::vector<size_t>& m_key;
+    };
+
+    struct set_read_filter_func
+    {
+        set_read_filter_func(const metric_base::record_filter& filter) : m_filter(filter){}
+        template<class MetricSet>
+        void operator()(MetricSet &metrics)const
+        {
+            metrics.read_filter(m_filter);
+        }
+    private:
+        const metric_base::record_filter& m_filter;
+    };
+
     struct read_func
     {
         typedef const unsigned char* bool_pointer;
@@ -105,14 +127,25 @@ namespace illumina { namespace interop { namespace model { namespace metrics
 
     struct validate_run_info
     {
-        validate_run_info(const run::info& info) : m_info(info){}
+        validate_run_info(const run::info& info) :
+                m_info(info),
+                m_max_cycle(info.total_cycles()),
+                m_invalid_cycle_count(0){}
 
         template<class MetricSet>
-        void operator()(MetricSet &metrics)const
+        void operator()(MetricSet &metrics)
         {
             typedef typename MetricSet::base_t base_t;
             validate(metrics, base_t::null());
         }
+        size_t invalid_cycle_count()const
+        {
+            return m_invalid_cycle_count;
+        }
+        const std::string& invalid_cycle_message()const
+        {
+            return m_invalid_cycle_message;
+        }
     private:
         template<class MetricSet>
         void validate(const MetricSet &metrics, const constants::base_tile_t*)const
@@ -124,27 +157,41 @@ namespace illumina { namespace interop { namespace model { namespace metrics
             }
         }
         template<class MetricSet>
-        void validate(MetricSet &metrics, const constants::base_cycle_t*)const
+        void validate(MetricSet &metrics, const constants::base_cycle_t*)
         {
+            typedef typename MetricSet::iterator iterator;
+            typedef typename MetricSet::id_t id_t;
             const std::string name =  io::interop_basename<MetricSet>();
-            bool exception_is_thrown = false;
-            std::string exception_string = "";
-            for(typename MetricSet::iterator it = metrics.begin();it != metrics.end();++it)
+            id_t last_tile_id = 0;
+            iterator valid_end = metrics.begin();
+            for(iterator it = metrics.begin(), end = metrics.end();it != end;++it)
             {
-                try
+                // The tile layout check is the same for every cycle of a tile
+                if(it->tile_hash() != last_tile_id)
                 {
-                    m_info.validate_cycle(it->lane(), it->tile(), it->cycle(), name);
+                    m_info.validate(it->lane(), it->tile(), name);
+                    last_tile_id = it->tile_hash();
                 }
-                catch(const model::invalid_run_info_cycle_exception& ex)
+                if(it->cycle() > m_max_cycle)
                 {
-                    metrics.remove(it);
-                    --it;
-                    exception_is_thrown = true;
-                    exception_string = ex.what();
+                    if(m_invalid_cycle_count == 0)
+                    {
+                        std::ostringstream message;
+                        message << "Cycle number exceeds number of cycles in RunInfo.xml for record "
+                                << it->lane() << "_" << it->tile() << " @ " << it->cycle() << " in file " << name;
+                        m_invalid_cycle_message = message.str();
+                    }
+                    ++m_invalid_cycle_count;
+                    continue;
                 }
+                if(valid_end != it) std::iter_swap(valid_end, it);
+                ++valid_end;
             }
-            if(exception_is_thrown)
-                INTEROP_THROW(model::invalid_run_info_cycle_exception, exception_string + ": truncating invalid entries");
+            if(valid_end == metrics.end()) return;
+            const bool has_lookup = !metrics.offset_map().empty();
+            metrics.trim(static_cast<size_t>(valid_end - metrics.begin()));
+            metrics.clear_lookup();
+            if(has_lookup) metrics.rebuild_index(true);
         }
         template<class MetricSet>
         void validate(const MetricSet &metrics, const constants::base_read_t*)const
@@ -159,6 +206,9 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         void validate(const MetricSet &, const void*)const{}
 
         const run::info& m_info;
+        const size_t m_max_cycle;
+        size_t m_invalid_cycle_count;
+        std::string m_invalid_cycle_message;
     };
 
     class rebuild_index
@@ -229,6 +279,205 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         bool_pointer m_load_metric_check;
     };
 
+    struct select_empty_func
+    {
+        typedef unsigned char* bool_pointer;
+
+        select_empty_func(bool_pointer load_metric_check) : m_load_metric_check(load_metric_check)
+        {}
+
+        template<class MetricSet>
+        void operator()(const MetricSet &metrics) const
+        {
+            if(!metrics.empty()) m_load_metric_check[MetricSet::TYPE] = 0;
+        }
+
+        bool_pointer m_load_metric_check;
+    };
+
+    struct list_by_cycle_files_func
+    {
+        typedef const unsigned char* bool_pointer;
+
+        list_by_cycle_files_func(const std::string &f,
+                                 const size_t first_cycle,
+                                 const size_t last_cycle,
+                                 bool_pointer load_metric_check,
+                                 std::vector<std::string>& files,
+                                 std::vector<size_t>& groups) :
+                m_run_folder(f),
+                m_first_cycle(first_cycle),
+                m_last_cycle(last_cycle),
+                m_load_metric_check(load_metric_check),
+                m_files(files),
+                m_groups(groups)
+        {}
+
+        template<class MetricSet>
+        void operator()(const MetricSet &) const
+        {
+            if(m_load_metric_check[MetricSet::TYPE] == 0) return;
+            for(size_t cycle=m_first_cycle;cycle <= m_last_cycle;++cycle)
+            {
+                m_files.push_back(io::interop_filename<MetricSet>(m_run_folder, cycle, true));
+                m_groups.push_back(static_cast<size_t>(MetricSet::TYPE));
+            }
+        }
+
+        std::string m_run_folder;
+        size_t m_first_cycle;
+        size_t m_last_cycle;
+        bool_pointer m_load_metric_check;
+        std::vector<std::string>& m_files;
+        std::vector<size_t>& m_groups;
+    };
+
+    struct read_by_cycle_from_buffers_func
+    {
+        typedef const unsigned char* bool_pointer;
+
+        read_by_cycle_from_buffers_func(const std::vector<std::string>& files,
+                                        std::vector<std::string>& contents,
+                                        const std::vector<unsigned char>& found,
+                                        const std::vector<size_t>& groups,
+                                        bool_pointer load_metric_check,
+                                        std::vector<std::string>& incomplete_messages) :
+                m_files(files),
+                m_contents(contents),
+                m_found(found),
+                m_groups(groups),
+                m_load_metric_check(load_metric_check),
+                m_incomplete_messages(incomplete_messages)
+        {}
+
+        template<class MetricSet>
+        void operator()(MetricSet &metrics) const
+        {
+            if(m_load_metric_check[MetricSet::TYPE] == 0) return;
+            for(size_t i=0;i<m_contents.size();++i)
+            {
+                if(m_groups[i] != static_cast<size_t>(MetricSet::TYPE)) continue;
+                try
+                {
+                    if(m_found[i] == 0)
+                    {
+                        io::read_interop_gzip(m_files[i], metrics, false);
+                        continue;
+                    }
+                    std::string& content = m_contents[i];
+                    ::uint8_t* buffer = content.empty() ? 0 : reinterpret_cast< ::uint8_t* >(&content[0]);
+                    io::read_interop_from_buffer(buffer, content.size(), metrics);
+                }
+                catch(const io::incomplete_file_exception& ex)
+                {
+                    m_incomplete_messages[MetricSet::TYPE] = ex.what();
+                }
+            }
+        }
+
+        const std::vector<std::string>& m_files;
+        std::vector<std::string>& m_contents;
+        const std::vector<unsigned char>& m_found;
+        const std::vector<size_t>& m_groups;
+        bool_pointer m_load_metric_check;
+        std::vector<std::string>& m_incomplete_messages;
+    };
+
+    struct rebuild_index_func
+    {
+        typedef const unsigned char* bool_pointer;
+
+        rebuild_index_func(bool_pointer load_metric_check) : m_load_metric_check(load_metric_check)
+        {}
+
+        template<class MetricSet>
+        void operator()(MetricSet &metrics) const
+        {
+            if(m_load_metric_check[MetricSet::TYPE] != 0) metrics.rebuild_index();
+        }
+
+        bool_pointer m_load_metric_check;
+    };
+
+    /** Read the InterOp file of a single metric group at each iteration of a parallel loop
+     */
+    template<class MetricList>
+    class read_metric_group_body : public util::abstract_loop_body
+    {
+    public:
+        read_metric_group_body(MetricList& metrics,
+                               const std::string& run_folder,
+                               const std::vector<size_t>& groups,
+                               const bool skip_loaded,
+                               std::vector<unsigned char>& files_missing) :
+                m_metrics(metrics),
+                m_run_folder(run_folder),
+                m_groups(groups),
+                m_skip_loaded(skip_loaded),
+                m_files_missing(files_missing)
+        {}
+
+        void operator()(const size_t index)
+        {
+            std::vector<unsigned char> valid_to_load(constants::MetricCount, 0);
+            valid_to_load[m_groups[index]] = 1;
+            read_func read_functor(m_run_folder, &valid_to_load.front(), m_skip_loaded);
+            m_metrics.apply(read_functor);
+            m_files_missing[index] = read_functor.are_all_files_missing() ? 1 : 0;
+        }
+
+    private:
+        MetricList& m_metrics;
+        const std::string& m_run_folder;
+        const std::vector<size_t>& m_groups;
+        bool m_skip_loaded;
+        std::vector<unsigned char>& m_files_missing;
+    };
+
+    /** Decode the buffered by cycle InterOp files of a single metric group at each iteration of a parallel loop
+     */
+    template<class MetricList>
+    class read_by_cycle_group_body : public util::abstract_loop_body
+    {
+    public:
+        read_by_cycle_group_body(MetricList& metrics,
+                                 const std::vector<size_t>& metric_groups,
+                                 const std::vector<std::string>& files,
+                                 std::vector<std::string>& contents,
+                                 const std::vector<unsigned char>& found,
+                                 const std::vector<size_t>& groups,
+                                 std::vector<std::string>& incomplete_messages) :
+                m_metrics(metrics),
+                m_metric_groups(metric_groups),
+                m_files(files),
+                m_contents(contents),
+                m_found(found),
+                m_groups(groups),
+                m_incomplete_messages(incomplete_messages)
+        {}
+
+        void operator()(const size_t index)
+        {
+            std::vector<unsigned char> valid_to_load(constants::MetricCount, 0);
+            valid_to_load[m_metric_groups[index]] = 1;
+            m_metrics.apply(read_by_cycle_from_buffers_func(m_files,
+                                                            m_contents,
+                                                            m_found,
+                                                            m_groups,
+                                                            &valid_to_load.front(),
+                                                            m_incomplete_messages));
+        }
+
+    private:
+        MetricList& m_metrics;
+        const std::vector<size_t>& m_metric_groups;
+        const std::vector<std::string>& m_files;
+        std::vector<std::string>& m_contents;
+        const std::vector<unsigned char>& m_found;
+        const std::vector<size_t>& m_groups;
+        std::vector<std::string>& m_incomplete_messages;
+    };
+
     class read_metric_set_from_binary_buffer
     {
     public:
@@ -319,6 +568,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
     void run_metrics::append_tiles(const run_metrics& metrics, const metric_base::base_metric& tile_id)
     {
         m_metrics.apply(append_tiles_functor(metrics, tile_id));
+        m_result_cache.invalidate();
     }
 
     /** Read binary metrics and XML files from the run folder
@@ -411,6 +661,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
     xml::xml_parse_exception))
     {
         m_run_info.read(run_folder);
+        m_result_cache.invalidate();
     }
 
     /** Read RunParameters.xml if necessary
@@ -431,6 +682,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
             try
             {
                 m_run_parameters.read(run_folder);
+                m_result_cache.invalidate();
             }
             catch (const xml::xml_file_not_found_exception &)
             {
@@ -446,6 +698,15 @@ namespace illumina { namespace interop { namespace model { namespace metrics
     }
 
     /** Finalize the metric sets after loading from disk
+     *
+     * The derivation steps form a dependency graph, where steps that touch disjoint metric sets run
+     * concurrently on the shared thread pool:
+     *
+     *  - The tile naming method is determined from all metric sets, so it precedes the other steps
+     *  - Index, q-metric, extended tile and channel steps touch disjoint metric sets
+     *  - Validation truncates every cycle metric set, so it waits for all of the above
+     *  - Dynamic phasing uses the validated metrics
+     *  - The per tile aggregate table holds the phasing values updated by dynamic phasing
      *
      * @param count number of bins for legacy q-metrics
      */
@@ -457,6 +718,70 @@ namespace illumina { namespace interop { namespace model { namespace metrics
     model::invalid_tile_list_exception,
     model::invalid_run_info_exception,
     model::invalid_run_info_cycle_exception))
+    {
+        typedef util::member_function_task<run_metrics, const size_t> step_t;
+        m_result_cache.invalidate();
+        // BaseSpace calls finalize_after_load with the default argument (SAV does not)
+        // We need to ensure rebuild index is done for BaseSpace
+        // This is already taken care of for SAV by the read_by_cycle function
+        const bool rebuild = count == std::numeric_limits<size_t>::max();
+        if (rebuild) count = count_legacy_bins();
+
+        step_t rebuild_step(*this, &run_metrics::finalize_rebuild_index, count);
+        step_t naming_step(*this, &run_metrics::finalize_tile_naming, count);
+        step_t indices_step(*this, &run_metrics::finalize_indices, count);
+        step_t legacy_step(*this, &run_metrics::finalize_legacy_q_bins, count);
+        step_t derived_step(*this, &run_metrics::finalize_derived_q_metrics, count);
+        step_t occupied_step(*this, &run_metrics::finalize_percent_occupied, count);
+        step_t channels_step(*this, &run_metrics::finalize_channels, count);
+        step_t validate_step(*this, &run_metrics::finalize_validate, count);
+        step_t phasing_step(*this, &run_metrics::finalize_dynamic_phasing, count);
+        step_t aggregate_step(*this, &run_metrics::finalize_tile_aggregates, count);
+
+        util::task_graph graph;
+        const size_t naming = graph.add("tile_naming", naming_step);
+        if (rebuild)
+        {
+            const size_t rebuild_node = graph.add("rebuild_index", rebuild_step);
+            graph.depends_on(rebuild_node, naming);
+        }
+        const size_t barrier = graph.size() - 1;
+        const size_t indices = graph.add("populate_indices", indices_step);
+        graph.depends_on(indices, barrier);
+        const size_t legacy = graph.add("legacy_q_bins", legacy_step);
+        graph.depends_on(legacy, barrier);
+        const size_t derived = graph.add("derived_q_metrics", derived_step);
+        graph.depends_on(derived, legacy);
+        const size_t occupied = graph.add("percent_occupied", occupied_step);
+        graph.depends_on(occupied, barrier);
+        const size_t channels = graph.add("channels", channels_step);
+        graph.depends_on(channels, barrier);
+        const size_t validate = graph.add("validate", validate_step);
+        graph.depends_on(validate, indices);
+        graph.depends_on(validate, derived);
+        graph.depends_on(validate, occupied);
+        graph.depends_on(validate, channels);
+        const size_t phasing = graph.add("dynamic_phasing", phasing_step);
+        graph.depends_on(phasing, validate);
+        graph.depends_on(graph.add("tile_aggregates", aggregate_step), phasing);
+        try
+        {
+            graph.run();
+        }
+        catch (...)
+        {
+            m_finalize_timings = graph.timings();
+            throw;
+        }
+        m_finalize_timings = graph.timings();
+    }
+
+    void run_metrics::finalize_rebuild_index(const size_t)
+    {
+        m_metrics.apply(rebuild_index());
+    }
+
+    void run_metrics::finalize_tile_naming(const size_t)
     {
         if (m_run_info.flowcell().naming_method() == constants::UnknownTileNamingMethod)
         {
@@ -464,19 +789,18 @@ namespace illumina { namespace interop { namespace model { namespace metrics
             m_metrics.apply(naming_method_determinator);
             m_run_info.set_naming_method( naming_method_determinator.naming_method());
         }
+    }
+
+    void run_metrics::finalize_indices(const size_t)
+    {
         if(!get<model::metrics::index_metric>().empty())
         {
             logic::metric::populate_indices(get<model::metrics::tile_metric>(), get<model::metrics::index_metric>());
         }
-        if (count == std::numeric_limits<size_t>::max())
-        {
-            count = count_legacy_bins();
+    }
 
-            // BaseSpace calls finalize_after_load with the default argument (SAV does not)
-            // We need to ensure rebuild index is done for BaseSpace
-            // This is already taken care of for SAV by the read_by_cycle function
-            m_metrics.apply(rebuild_index());
-        }
+    void run_metrics::finalize_legacy_q_bins(const size_t count)
+    {
         if(logic::metric::requires_legacy_bins(count))
         {
             logic::metric::populate_legacy_q_score_bins(get<q_metric>().bins(), m_run_parameters.instrument_type(),
@@ -487,27 +811,32 @@ namespace illumina { namespace interop { namespace model { namespace metrics
             logic::metric::compress_q_metrics(get<q_metric>());
             logic::metric::compress_q_metrics(get<q_by_lane_metric>());
         }
-        if (get<q_metric>().size() > 0 && get<q_collapsed_metric>().size() == 0)
-        {
-            logic::metric::create_collapse_q_metrics(get<q_metric>(), get<q_collapsed_metric>());
-        }
+    }
+
+    void run_metrics::finalize_derived_q_metrics(const size_t)
+    {
+        logic::metric::create_derived_q_metrics(get<q_metric>(),
+                                                get<q_collapsed_metric>(),
+                                                get<q_by_lane_metric>(),
+                                                m_run_parameters.instrument_type(),
+                                                !m_tile_q_cumulative_on_demand);
         INTEROP_ASSERTMSG(
                 get<q_metric>().size() == 0 ||
                 get<q_metric>().size() == get<q_collapsed_metric>().size(),
                 get<q_metric>().size() << " == " << get<q_collapsed_metric>().size());
-        if (get<q_metric>().size() > 0 && get<q_by_lane_metric>().size() == 0)
-            logic::metric::create_q_metrics_by_lane(get<q_metric>(),
-                                                    get<q_by_lane_metric>(),
-                                                    m_run_parameters.instrument_type());
-        logic::metric::populate_cumulative_distribution(get<q_metric>());
-        logic::metric::populate_cumulative_distribution(get<q_by_lane_metric>());
-        logic::metric::populate_cumulative_distribution(get<q_collapsed_metric>());
+    }
+
+    void run_metrics::finalize_percent_occupied(const size_t)
+    {
         if(!get<model::metrics::extended_tile_metric>().empty() && !get<model::metrics::tile_metric>().empty())
         {
             logic::metric::populate_percent_occupied(get<model::metrics::tile_metric>(),
                                                      get<model::metrics::extended_tile_metric>());
         }
+    }
 
+    void run_metrics::finalize_channels(const size_t)
+    {
         if (m_run_info.channels().empty())
         {
             legacy_channel_update(m_run_parameters.instrument_type());
@@ -529,7 +858,10 @@ namespace illumina { namespace interop { namespace model { namespace metrics
             for (image_metric_set_t::iterator it = image_metrics.begin(); it != image_metrics.end(); ++it)
                 it->trim(run_info().channels().size());
         }
+    }
 
+    void run_metrics::finalize_validate(const size_t)
+    {
         if (!empty())
         {
             if(run_info().flowcell().naming_method() == constants::UnknownTileNamingMethod)
@@ -538,7 +870,29 @@ namespace illumina { namespace interop { namespace model { namespace metrics
             validate();
             m_run_info.validate_tiles();
         }
+    }
 
+    void run_metrics::sync_result_cache() const
+    {
+        std::vector<size_t> key(1, data_version());
+        m_metrics.apply(append_source_key(key));
+        if(key == m_result_source) return;
+        m_result_cache.clear();
+        m_result_source.swap(key);
+    }
+
+    const q_score_cube& run_metrics::qscore_cube() const
+    {
+        // Readers of a published snapshot share this cube, so the first one builds it and the others wait
+        util::scoped_lock lock(m_derived_mutex);
+        const constants::tile_naming_method naming_method = m_run_info.flowcell().naming_method();
+        if(!logic::metric::is_qscore_cube_current(get<q_metric>(), naming_method, data_version(), m_qscore_cube))
+            logic::metric::populate_qscore_cube(get<q_metric>(), naming_method, data_version(), m_qscore_cube);
+        return m_qscore_cube;
+    }
+
+    void run_metrics::finalize_dynamic_phasing(const size_t)
+    {
         if(!get<model::metrics::phasing_metric>().empty())
         {
             logic::summary::read_cycle_vector_t cycle_to_read;
@@ -548,10 +902,45 @@ namespace illumina { namespace interop { namespace model { namespace metrics
             logic::metric::populate_dynamic_phasing_metrics(get<model::metrics::phasing_metric>(),
                                                             cycle_to_read,
                                                             get<model::metrics::dynamic_phasing_metric>(),
-                                                            get<model::metrics::tile_metric>());
+                                                            get<model::metrics::tile_metric>(),
+                                                            0);
         }
     }
 
+    void run_metrics::finalize_tile_aggregates(const size_t)
+    {
+        populate_tile_aggregates();
+    }
+
+    const tile_aggregate_table& run_metrics::tile_aggregates() const
+    {
+        // Readers of a published snapshot share this table, so the first one builds it and the others wait
+        util::scoped_lock lock(m_derived_mutex);
+        if(!logic::metric::is_tile_aggregate_table_current(get<model::metrics::tile_metric>(),
+                                                           get<model::metrics::extended_tile_metric>(),
+                                                           get<model::metrics::error_metric>(),
+                                                           get<q_metric>(),
+                                                           data_version(),
+                                                           m_tile_aggregates))
+            populate_tile_aggregates();
+        return m_tile_aggregates;
+    }
+
+    void run_metrics::populate_tile_aggregates() const
+    {
+        logic::summary::read_cycle_vector_t cycle_to_read;
+        logic::summary::map_read_to_cycle_number(run_info().reads().begin(),
+                                                 run_info().reads().end(),
+                                                 cycle_to_read);
+        logic::metric::populate_tile_aggregate_table(get<model::metrics::tile_metric>(),
+                                                     get<model::metrics::extended_tile_metric>(),
+                                                     get<model::metrics::error_metric>(),
+                                                     get<q_metric>(),
+                                                     cycle_to_read,
+                                                     data_version(),
+                                                     m_tile_aggregates);
+    }
+
     /** Clear all the metrics
      */
     void run_metrics::clear()
@@ -559,6 +948,19 @@ namespace illumina { namespace interop { namespace model { namespace metrics
         m_run_info = run::info();
         m_run_parameters = run::parameters();
         m_metrics.apply(clear_metric());
+        m_qscore_cube.clear();
+        m_tile_aggregates.clear();
+        m_result_cache.invalidate();
+    }
+
+    /** Set the filter that selects which records are read from each InterOp file
+     *
+     * @param filter record filter
+     */
+    void run_metrics::set_read_filter(const metric_base::record_filter& filter)
+    {
+        m_read_filter = filter;
+        m_metrics.apply(set_read_filter_func(m_read_filter));
     }
 
     /** Update channels for legacy runs
@@ -577,6 +979,23 @@ namespace illumina { namespace interop { namespace model { namespace metrics
     void run_metrics::set_naming_method(const constants::tile_naming_method naming_method)
     {
         m_run_info.set_naming_method(naming_method);
+        m_result_cache.invalidate();
+    }
+
+    /** Compute the cumulative q-score histogram of each tile on demand
+     *
+     * @param on_demand true if the tile cumulative histogram should not be stored
+     */
+    void run_metrics::set_tile_q_cumulative_on_demand(const bool on_demand)
+    {
+        m_tile_q_cumulative_on_demand = on_demand;
+    }
+
+    void run_metrics::set_quantile_sketch_accuracy(const size_t accuracy)
+    {
+        if(accuracy == m_quantile_sketch_accuracy) return;
+        m_quantile_sketch_accuracy = accuracy;
+        m_result_cache.clear();
     }
 
     /** Read binary metrics from the run folder
@@ -596,24 +1015,20 @@ namespace illumina { namespace interop { namespace model { namespace metrics
     io::bad_format_exception,
     io::incomplete_file_exception))
     {
-        (void)thread_count;
-#ifdef _OPENMP
+        m_result_cache.invalidate();
         if(thread_count > 1)
         {
             std::vector<unsigned char> valid_to_load(constants::MetricCount, 1);
             read_metrics(run_folder, last_cycle, valid_to_load, thread_count);
         }
         else{
-#endif
             read_func read_functor(run_folder);
             m_metrics.apply(read_functor);
             if (read_functor.are_all_files_missing())
             {
                 m_metrics.apply(read_by_cycle_func(run_folder, last_cycle));
             }
-#ifdef _OPENMP
         }
-#endif
     }
 
     /** Read binary metrics from the run folder
@@ -639,98 +1054,112 @@ namespace illumina { namespace interop { namespace model { namespace metrics
     io::incomplete_file_exception,
     model::invalid_parameter))
     {
-        (void)thread_count;
         if(valid_to_load.empty()) return;
+        m_result_cache.invalidate();
         if(valid_to_load.size() != constants::MetricCount)
             INTEROP_THROW(invalid_parameter, "Boolean array valid_to_load does not match expected number of metrics: "
                     << valid_to_load.size() << " != " << constants::MetricCount);
 
         bool all_files_are_missing = true;
-#ifdef _OPENMP
         if(thread_count > 1)
         {
-            std::vector<bool> local_files_missing(thread_count, true);
             std::vector<size_t> offset;
             offset.reserve(valid_to_load.size());
             for(size_t i=0;i<valid_to_load.size();++i)
                 if(valid_to_load[i]) offset.push_back(i);
-            std::vector< std::vector<unsigned char> > valid_to_load_local(thread_count, std::vector<unsigned char>(valid_to_load.size(), 0));
-            bool exception_thrown = false;
-            std::string exception_msg;
-#           pragma omp parallel for default(shared) num_threads(static_cast<int>(thread_count)) schedule(dynamic)
-            for(int i=0;i<static_cast<int>(offset.size());++i)
+            std::vector<unsigned char> files_missing(offset.size(), 1);
+            read_metric_group_body<metric_list_t> body(m_metrics, run_folder, offset, skip_loaded, files_missing);
+            try
             {
-#               pragma omp flush(exception_thrown)
-                if(exception_thrown) continue;
-                valid_to_load_local[ omp_get_thread_num() ][offset[i]] = 1;
-                read_func read_functor_l(run_folder, &valid_to_load_local[ omp_get_thread_num() ].front(), skip_loaded);
-                try{
-                    m_metrics.apply(read_functor_l);
-                }
-                catch(const std::exception& ex)
-                {
-#pragma             omp critical(SaveMessage)
-                    exception_msg = ex.what();
-
-                    exception_thrown = true;
-#pragma             omp flush(exception_thrown)
-                }
-                valid_to_load_local[ omp_get_thread_num() ][offset[i]] = 0;
-                local_files_missing[omp_get_thread_num()] = local_files_missing[omp_get_thread_num()] && read_functor_l.are_all_files_missing();
+                util::parallel_for(offset.size(), body, thread_count);
             }
-            if(exception_thrown)
-                throw io::bad_format_exception(exception_msg);
-            for(size_t i=0;i<local_files_missing.size();++i)
-                all_files_are_missing = all_files_are_missing && local_files_missing[i];
+            catch(const std::exception& ex)
+            {
+                throw io::bad_format_exception(ex.what());
+            }
+            for(size_t i=0;i<files_missing.size();++i)
+                all_files_are_missing = all_files_are_missing && files_missing[i] != 0;
         }
         else{
-#endif
             read_func read_functor(run_folder, &valid_to_load.front(), skip_loaded);
             m_metrics.apply(read_functor);
             all_files_are_missing = read_functor.are_all_files_missing();
-#ifdef _OPENMP
         }
-#endif
         if (all_files_are_missing)
         {
-#ifdef _OPENMP
             if(thread_count > 1)
             {
-                std::vector<size_t> offset;
-                offset.reserve(valid_to_load.size());
-                for(size_t i=0;i<valid_to_load.size();++i)
-                    if(valid_to_load[i]) offset.push_back(i);
-                std::vector< std::vector<unsigned char> > valid_to_load_local(thread_count, std::vector<unsigned char>(valid_to_load.size(), 0));
-                bool exception_thrown = false;
-                std::string exception_msg;
-#               pragma omp parallel for default(shared) num_threads(static_cast<int>(thread_count)) schedule(dynamic)
-                for(int i=0;i<static_cast<int>(offset.size());++i)
-                {
-#               pragma omp flush(exception_thrown)
-                    valid_to_load_local[ omp_get_thread_num() ][offset[i]] = 1;
-                    try{
-                        m_metrics.apply(read_by_cycle_func(run_folder, last_cycle, &valid_to_load_local[ omp_get_thread_num() ].front()));
-                    }
-                    catch(const std::exception& ex)
-                    {
-#pragma                 omp critical(SaveMessage)
-                        exception_msg = ex.what();
-
-                        exception_thrown = true;
-#pragma                 omp flush(exception_thrown)
-                    }
-                    valid_to_load_local[ omp_get_thread_num() ][offset[i]] = 0;
-                }
-                if(exception_thrown)
-                    throw io::bad_format_exception(exception_msg);
+                read_by_cycle_batched(run_folder, last_cycle, valid_to_load, thread_count);
             }
             else
             {
-#endif
                 m_metrics.apply(read_by_cycle_func(run_folder, last_cycle, &valid_to_load.front()));
-#ifdef _OPENMP
             }
-#endif
+        }
+    }
+
+    /** Read the per-cycle InterOp files of all selected and empty metric sets in batches of cycles
+     *
+     * Each batch of files is read concurrently, then each metric set is decoded from memory in cycle order.
+     *
+     * @param run_folder run folder path
+     * @param last_cycle last cycle of run
+     * @param valid_to_load boolean vector indicating which files to load
+     * @param thread_count number of threads to use for network loading
+     */
+    void run_metrics::read_by_cycle_batched(const std::string &run_folder,
+                                            const size_t last_cycle,
+                                            const std::vector<unsigned char>& valid_to_load,
+                                            const size_t thread_count)
+    INTEROP_THROW_SPEC((io::bad_format_exception))
+    {
+        // Bound the memory held by a batch while keeping enough requests in flight to hide the latency
+        const size_t max_files_per_batch = 512;
+        std::vector<unsigned char> to_load(valid_to_load);
+        m_metrics.apply(select_empty_func(&to_load.front()));
+        std::vector<size_t> offset;
+        offset.reserve(to_load.size());
+        for(size_t i=0;i<to_load.size();++i)
+            if(to_load[i]) offset.push_back(i);
+        if(offset.empty()) return;
+        const size_t cycles_per_batch = std::max(max_files_per_batch / offset.size(), static_cast<size_t>(1));
+
+        std::vector<std::string> incomplete_messages(to_load.size());
+        std::vector<std::string> files;
+        std::vector<size_t> groups;
+        std::vector<std::string> contents;
+        std::vector<unsigned char> found;
+        read_by_cycle_group_body<metric_list_t> body(m_metrics,
+                                                     offset,
+                                                     files,
+                                                     contents,
+                                                     found,
+                                                     groups,
+                                                     incomplete_messages);
+        std::string exception_msg;
+        for(size_t first_cycle=1;first_cycle <= last_cycle && exception_msg.empty();first_cycle+=cycles_per_batch)
+        {
+            const size_t last_batch_cycle = std::min(first_cycle+cycles_per_batch-1, last_cycle);
+            files.clear();
+            groups.clear();
+            m_metrics.apply(list_by_cycle_files_func(run_folder, first_cycle, last_batch_cycle, &to_load.front(), files, groups));
+            io::read_files(files, contents, found, thread_count);
+            try
+            {
+                util::parallel_for(offset.size(), body, thread_count);
+            }
+            catch(const std::exception& ex)
+            {
+                exception_msg = ex.what();
+            }
+        }
+        m_metrics.apply(rebuild_index_func(&to_load.front()));
+        if(!exception_msg.empty())
+            throw io::bad_format_exception(exception_msg);
+        for(size_t i=0;i<incomplete_messages.size();++i)
+        {
+            if(incomplete_messages[i] != "")
+                throw io::bad_format_exception(incomplete_messages[i]);
         }
     }
 
@@ -761,6 +1190,7 @@ namespace illumina { namespace interop { namespace model { namespace metrics
     model::index_out_of_bounds_exception))
     {
         m_metrics.apply(read_metric_set_from_binary_buffer(group, buffer, buffer_size));
+        m_result_cache.invalidate();
     }
     /** Write a single metric set to a binary buffer
      *
@@ -784,7 +1214,11 @@ namespace illumina { namespace interop { namespace model { namespace metrics
      */
     void run_metrics::validate() INTEROP_THROW_SPEC((invalid_run_info_exception, invalid_run_info_cycle_exception))
     {
-        m_metrics.apply(validate_run_info(m_run_info));
+        validate_run_info validator(m_run_info);
+        m_metrics.apply(validator);
+        if(validator.invalid_cycle_count() > 0)
+            INTEROP_THROW(model::invalid_run_info_cycle_exception, validator.invalid_cycle_message()
+                    << ": truncating " << validator.invalid_cycle_count() << " invalid entries");
     }
 
 }}}}
@@ -0,0 +1,194 @@
+/** Versioned snapshots of the run metrics shared by concurrent readers
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#include "interop/model/run_metrics_snapshot.h"
+#include "interop/logic/metric/q_metric.h"
+
+#ifdef HAVE_STD_THREAD
+#include <atomic>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace illumina { namespace interop { namespace model { namespace metrics
+{
+    /** Version of the run metrics along with its reference count
+     */
+    struct run_metrics_snapshot::holder
+    {
+        /** Constructor holding a single reference
+         *
+         * @param source run metrics to copy
+         */
+        holder(const run_metrics& source) : metrics(source), version(0), references(1){}
+
+        /** Run metrics of this version */
+        run_metrics metrics;
+        /** Version number */
+        size_t version;
+        /** Number of snapshots and publishers referring to this version */
+#ifdef HAVE_STD_THREAD
+        std::atomic<size_t> references;
+#else
+        size_t references;
+#endif
+    };
+
+    namespace
+    {
+        typedef run_metrics_snapshot::holder holder_t;
+
+        /** Add a reference to a version
+         *
+         * @param version version of the run metrics, may be null
+         */
+        void acquire(holder_t* version)
+        {
+            if(version == 0) return;
+#ifdef HAVE_STD_THREAD
+            version->references.fetch_add(1, std::memory_order_relaxed);
+#else
+            ++version->references;
+#endif
+        }
+        /** Remove a reference to a version, freeing it after the last reference
+         *
+         * @param version version of the run metrics, may be null
+         */
+        void release(holder_t* version)
+        {
+            if(version == 0) return;
+#ifdef HAVE_STD_THREAD
+            if(version->references.fetch_sub(1, std::memory_order_acq_rel) == 1) delete version;
+#else
+            if(--version->references == 0) delete version;
+#endif
+        }
+    }
+
+    run_metrics_snapshot::run_metrics_snapshot() : m_holder(0){}
+    run_metrics_snapshot::run_metrics_snapshot(holder* version) : m_holder(version){}
+    run_metrics_snapshot::run_metrics_snapshot(const run_metrics_snapshot& other) : m_holder(other.m_holder)
+    {
+        acquire(m_holder);
+    }
+    run_metrics_snapshot& run_metrics_snapshot::operator=(const run_metrics_snapshot& other)
+    {
+        acquire(other.m_holder);
+        release(m_holder);
+        m_holder = other.m_holder;
+        return *this;
+    }
+    run_metrics_snapshot::~run_metrics_snapshot()
+    {
+        release(m_holder);
+    }
+    bool run_metrics_snapshot::empty() const
+    {
+        return m_holder == 0;
+    }
+    size_t run_metrics_snapshot::version() const
+    {
+        return m_holder == 0 ? 0 : m_holder->version;
+    }
+    const run_metrics& run_metrics_snapshot::metrics() const INTEROP_THROW_SPEC((model::invalid_parameter))
+    {
+        return logic_metrics();
+    }
+    run_metrics& run_metrics_snapshot::logic_metrics() const INTEROP_THROW_SPEC((model::invalid_parameter))
+    {
+        if(m_holder == 0) INTEROP_THROW(model::invalid_parameter, "Snapshot of the run metrics is empty");
+        return m_holder->metrics;
+    }
+
+    /** Publication state
+     *
+     * A reader announces itself in the reader count before loading the current version and adding its reference.
+     * After swapping in a new version, the writer waits for the count to reach zero before releasing the old
+     * version, so no reader can add a reference to a version that was already freed.
+     */
+    struct run_metrics_publisher::state
+    {
+        /** Constructor */
+        state() : current(0), readers(0), version(0){}
+
+#ifdef HAVE_STD_THREAD
+        /** Current version */
+        std::atomic<holder_t*> current;
+        /** Number of readers taking a snapshot */
+        std::atomic<size_t> readers;
+        /** Serializes the writers */
+        std::mutex writer;
+#else
+        /** Current version */
+        holder_t* current;
+        /** Number of readers taking a snapshot */
+        size_t readers;
+#endif
+        /** Number of the last published version */
+        size_t version;
+    };
+
+    run_metrics_publisher::run_metrics_publisher() : m_state(new state){}
+    run_metrics_publisher::~run_metrics_publisher()
+    {
+#ifdef HAVE_STD_THREAD
+        release(m_state->current.load());
+#else
+        release(m_state->current);
+#endif
+        delete m_state;
+    }
+
+    run_metrics_snapshot run_metrics_publisher::publish(const run_metrics& metrics)
+    {
+        holder_t* next = new holder_t(metrics);
+        // Readers share this copy, so nothing may be cached and the collapsed q-metrics are derived now. The lane,
+        // cycle and tile lookups of each metric set are built on first use under the lock of that set.
+        next->metrics.set_result_cache_size(0);
+        if(0 == next->metrics.get<q_collapsed_metric>().size())
+            logic::metric::create_collapse_q_metrics(next->metrics.get<q_metric>(),
+                                                     next->metrics.get<q_collapsed_metric>());
+        // One reference for the publisher, one for the returned snapshot
+        acquire(next);
+#ifdef HAVE_STD_THREAD
+        holder_t* previous;
+        {
+            std::lock_guard<std::mutex> lock(m_state->writer);
+            next->version = ++m_state->version;
+            previous = m_state->current.exchange(next);
+            while(m_state->readers.load() != 0) std::this_thread::yield();
+        }
+#else
+        next->version = ++m_state->version;
+        holder_t* previous = m_state->current;
+        m_state->current = next;
+#endif
+        release(previous);
+        return run_metrics_snapshot(next);
+    }
+
+    run_metrics_snapshot run_metrics_publisher::snapshot() const
+    {
+#ifdef HAVE_STD_THREAD
+        m_state->readers.fetch_add(1);
+        holder_t* current = m_state->current.load();
+        acquire(current);
+        m_state->readers.fetch_sub(1);
+#else
+        holder_t* current = m_state->current;
+        acquire(current);
+#endif
+        return run_metrics_snapshot(current);
+    }
+
+    size_t run_metrics_publisher::version() const
+    {
+        const run_metrics_snapshot current = snapshot();
+        return current.version();
+    }
+}}}}
@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include "interop/util/thread_pool.h"
 
 namespace illumina { namespace interop { namespace io
 {
@@ -166,6 +167,71 @@ namespace illumina { namespace interop { namespace io
 #       endif
 
     }
-}}}
 
+    namespace
+    {
+        /** Read the whole content of a single file of a batch
+         */
+        class read_file_body : public util::abstract_loop_body
+        {
+        public:
+            /** Constructor
+             *
+             * @param file_names paths to the files
+             * @param contents destination content of each file
+             * @param found destination flag for each file
+             */
+            read_file_body(const std::vector<std::string>& file_names,
+                           std::vector<std::string>& contents,
+                           std::vector<unsigned char>& found) :
+                    m_file_names(file_names), m_contents(contents), m_found(found)
+            {
+            }
+            /** Read the file at the given index
+             *
+             * @param index index of the file
+             */
+            void operator()(const size_t index)
+            {
+                const ::int64_t size_in_bytes = file_size(m_file_names[index]);
+                if(size_in_bytes < 0) return;
+                std::ifstream fin(m_file_names[index].c_str(), std::ios::binary);
+                if(!fin.good()) return;
+                std::string& content = m_contents[index];
+                content.resize(static_cast<size_t>(size_in_bytes));
+                if(!content.empty())
+                {
+                    fin.read(&content[0], static_cast<std::streamsize>(content.size()));
+                    content.resize(static_cast<size_t>(fin.gcount()));
+                }
+                m_found[index] = 1;
+            }
 
+        private:
+            const std::vector<std::string>& m_file_names;
+            std::vector<std::string>& m_contents;
+            std::vector<unsigned char>& m_found;
+        };
+    }
+
+    /** Read the whole content of each file in a batch
+     *
+     * The files are stat'ed, opened and read concurrently, which hides the latency of network filesystems when
+     * reading many small files.
+     *
+     * @param file_names paths to the files
+     * @param contents destination content of each file, empty if missing
+     * @param found destination flag for each file, 1 if the file was read
+     * @param thread_count number of files to read concurrently
+     */
+    void read_files(const std::vector<std::string>& file_names,
+                    std::vector<std::string>& contents,
+                    std::vector<unsigned char>& found,
+                    const size_t thread_count)
+    {
+        contents.assign(file_names.size(), std::string());
+        found.assign(file_names.size(), 0);
+        read_file_body body(file_names, contents, found);
+        util::parallel_for(file_names.size(), body, thread_count > 0 ? thread_count : 1);
+    }
+}}}
@@ -0,0 +1,156 @@
+/** Graph of named tasks that run on the shared thread pool once their dependencies finish
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#include "interop/util/task_graph.h"
+#include "interop/util/assert.h"
+
+#ifdef HAVE_STD_THREAD
+#include <chrono>
+#else
+#include <ctime>
+#endif
+
+namespace illumina { namespace interop { namespace util
+{
+    namespace
+    {
+        /** Get the wall clock time
+         *
+         * Without std::chrono, the tasks run serially, so the processor time is used instead.
+         *
+         * @return time in seconds from an arbitrary origin
+         */
+        double seconds_now()
+        {
+#ifdef HAVE_STD_THREAD
+            return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+            return std::clock() / static_cast<double>(CLOCKS_PER_SEC);
+#endif
+        }
+
+        struct graph_run;
+
+        /** Run a task of the graph, then schedule each dependent task that has no remaining dependencies
+         */
+        class graph_node_task : public abstract_task
+        {
+        public:
+            graph_node_task(graph_run* run=0, const size_t index=0) : m_run(run), m_index(index){}
+            /** Run the task and schedule the dependent tasks that are ready */
+            void operator()();
+
+        private:
+            graph_run* m_run;
+            size_t m_index;
+        };
+
+        /** State shared by the tasks of a single run of a task graph
+         */
+        struct graph_run
+        {
+            graph_run(const std::vector<abstract_task*>& tasks,
+                      const std::vector< std::vector<size_t> >& dependents,
+                      const std::vector<size_t>& dependency_count,
+                      std::vector<task_timing>& timings,
+                      task_group& group) :
+                    tasks(tasks),
+                    dependents(dependents),
+                    remaining(dependency_count),
+                    timings(timings),
+                    group(group),
+                    origin(seconds_now())
+            {
+            }
+
+            const std::vector<abstract_task*>& tasks;
+            const std::vector< std::vector<size_t> >& dependents;
+            std::vector<size_t> remaining;
+            std::vector<task_timing>& timings;
+            task_group& group;
+            std::vector<graph_node_task> nodes;
+            mutex lock;
+            const double origin;
+        };
+
+        void graph_node_task::operator()()
+        {
+            const double start = seconds_now();
+            (*m_run->tasks[m_index])();
+            const double end = seconds_now();
+            std::vector<size_t> ready;
+            {
+                scoped_lock lock(m_run->lock);
+                task_timing& timing = m_run->timings[m_index];
+                timing.start = start - m_run->origin;
+                timing.duration = end - start;
+                timing.ran = true;
+                const std::vector<size_t>& dependents = m_run->dependents[m_index];
+                for(size_t i = 0; i < dependents.size(); ++i)
+                    if(--m_run->remaining[dependents[i]] == 0) ready.push_back(dependents[i]);
+            }
+            for(size_t i = 0; i < ready.size(); ++i) m_run->group.run(m_run->nodes[ready[i]]);
+        }
+    }
+
+    /** Add a task to the graph
+     *
+     * @param name name of the task, reported in the timings
+     * @param task task to run
+     * @return index of the task in the graph
+     */
+    size_t task_graph::add(const std::string& name, abstract_task& task)
+    {
+        m_tasks.push_back(&task);
+        m_dependents.push_back(std::vector<size_t>());
+        m_dependency_count.push_back(0);
+        m_timings.push_back(task_timing(name));
+        return m_tasks.size() - 1;
+    }
+    /** Add a dependency between two tasks of the graph
+     *
+     * @param task index of the dependent task
+     * @param dependency index of the task that must finish first, added before the dependent task
+     */
+    void task_graph::depends_on(const size_t task, const size_t dependency)
+    {
+        INTEROP_ASSERTMSG(dependency < task && task < m_tasks.size(), dependency << " < " << task);
+        m_dependents[dependency].push_back(task);
+        ++m_dependency_count[task];
+    }
+    /** Run all tasks of the graph
+     *
+     * @param thread_count 1 runs the tasks serially in the order added, otherwise the tasks run on the shared
+     *        thread pool
+     */
+    void task_graph::run(const size_t thread_count)
+    {
+        for(size_t i = 0; i < m_timings.size(); ++i) m_timings[i] = task_timing(m_timings[i].name);
+        if(thread_count == 1 || !is_thread_pool_concurrent())
+        {
+            // Dependencies are added before their dependents, so the order added is a valid order
+            const double origin = seconds_now();
+            for(size_t i = 0; i < m_tasks.size(); ++i)
+            {
+                const double start = seconds_now();
+                (*m_tasks[i])();
+                m_timings[i].start = start - origin;
+                m_timings[i].duration = seconds_now() - start;
+                m_timings[i].ran = true;
+            }
+            return;
+        }
+        task_group group(thread_count);
+        graph_run state(m_tasks, m_dependents, m_dependency_count, m_timings, group);
+        state.nodes.reserve(m_tasks.size());
+        for(size_t i = 0; i < m_tasks.size(); ++i) state.nodes.push_back(graph_node_task(&state, i));
+        for(size_t i = 0; i < m_tasks.size(); ++i)
+            if(m_dependency_count[i] == 0) group.run(state.nodes[i]);
+        group.wait();
+    }
+
+}}}
@@ -0,0 +1,618 @@
+/** Work stealing pool of threads shared by the loading, summary and table logic
+ *
+ *  @file
+ *  @date 10/19/26
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#include "interop/util/thread_pool.h"
+#include <algorithm>
+#include <vector>
+
+#ifdef HAVE_STD_THREAD
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace illumina { namespace interop { namespace util
+{
+#ifdef HAVE_STD_THREAD
+    /** Shared state of a task group, updated by the worker threads
+     */
+    struct task_group::state
+    {
+        /** Constructor
+         *
+         * @param worker_count number of pool workers the group may use
+         */
+        state(const size_t worker_count) : pending(0), cancelled(false), workers(worker_count){}
+        /** Record the first exception thrown by a task and cancel the group */
+        void set_error()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(!error) error = std::current_exception();
+            cancelled = true;
+        }
+        /** Mark a task as finished, waking the waiting thread after the last task
+         *
+         * The count is decremented under the lock, so the waiting thread cannot see the last task finish, and
+         * destroy the state, before this thread is done with the lock and the condition.
+         */
+        void finish()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(pending.fetch_sub(1) == 1) done.notify_all();
+        }
+
+        /** Number of scheduled tasks that have not finished */
+        std::atomic<size_t> pending;
+        /** Set when the group is cancelled */
+        std::atomic<bool> cancelled;
+        /** Guards the error and the done condition */
+        std::mutex mutex;
+        /** Signalled when the last task finishes */
+        std::condition_variable done;
+        /** First exception thrown by a task */
+        std::exception_ptr error;
+        /** Number of pool workers the group may use */
+        const size_t workers;
+    };
+
+    namespace
+    {
+        /** Task along with the group it belongs to */
+        struct work_item
+        {
+            work_item(abstract_task* t=0, task_group::state* s=0) : task(t), group(s){}
+            abstract_task* task;
+            task_group::state* group;
+        };
+
+        /** Queue of tasks owned by a single worker */
+        struct work_queue
+        {
+            std::mutex mutex;
+            std::deque<work_item> items;
+        };
+
+        /** Index of the queue owned by the current thread, -1 for threads outside the pool */
+        thread_local int t_queue_index = -1;
+
+        /** Work stealing pool of threads
+         *
+         * The pool grows on demand to the largest thread count requested and lives until the program exits.
+         * The last queue receives tasks scheduled by threads outside of the pool.
+         */
+        class thread_pool
+        {
+            enum
+            {
+                /** Upper bound on the number of worker threads */
+                MaxWorkerCount = 256
+            };
+        public:
+            thread_pool() : m_queues(MaxWorkerCount + 1), m_worker_count(0), m_queued(0), m_stop(false)
+            {
+                for(size_t i = 0; i < m_queues.size(); ++i) m_queues[i].reset(new work_queue);
+            }
+            ~thread_pool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                    m_stop = true;
+                }
+                m_wake.notify_all();
+                for(size_t i = 0; i < m_threads.size(); ++i) m_threads[i].join();
+            }
+
+        public:
+            /** Start workers until the pool has at least the given number of worker threads
+             *
+             * @param worker_count number of worker threads
+             */
+            void reserve(size_t worker_count)
+            {
+                worker_count = std::min(worker_count, static_cast<size_t>(MaxWorkerCount));
+                if(m_worker_count.load() >= worker_count) return;
+                std::lock_guard<std::mutex> lock(m_grow_mutex);
+                while(m_threads.size() < worker_count)
+                {
+                    // The queue is visible to the other threads before its worker starts
+                    const int index = static_cast<int>(m_threads.size());
+                    m_worker_count.store(m_threads.size() + 1);
+                    m_threads.push_back(std::thread(&thread_pool::work, this, index));
+                }
+            }
+            /** Add a task to the queue of the current thread
+             *
+             * @param item task and its group
+             */
+            void push(const work_item& item)
+            {
+                work_queue& queue = *m_queues[t_queue_index >= 0 ? static_cast<size_t>(t_queue_index) : MaxWorkerCount];
+                {
+                    std::lock_guard<std::mutex> lock(queue.mutex);
+                    queue.items.push_back(item);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                    ++m_queued;
+                }
+                m_wake.notify_one();
+            }
+            /** Take the newest task from the queue of the current thread, or steal the oldest from another queue
+             *
+             * @param item destination task
+             * @param group only take tasks of this group, 0 for any task
+             * @return true if a task was found
+             */
+            bool pop(work_item& item, const task_group::state* group=0)
+            {
+                // The queue of threads outside the pool follows the worker queues when stealing
+                const size_t worker_count = m_worker_count.load();
+                const size_t own = t_queue_index >= 0 ? static_cast<size_t>(t_queue_index) : worker_count;
+                if(take(queue_at(own, worker_count), item, true, group)) return true;
+                for(size_t offset = 1; offset <= worker_count; ++offset)
+                {
+                    if(take(queue_at((own + offset) % (worker_count + 1), worker_count), item, false, group))
+                        return true;
+                }
+                return false;
+            }
+            /** Run a task unless its group was cancelled
+             *
+             * @param item task and its group
+             */
+            static void execute(const work_item& item)
+            {
+                if(!item.group->cancelled.load())
+                {
+                    try
+                    {
+                        (*item.task)();
+                    }
+                    catch(...)
+                    {
+                        item.group->set_error();
+                    }
+                }
+                item.group->finish();
+            }
+
+        private:
+            work_queue& queue_at(const size_t index, const size_t worker_count)
+            {
+                return *m_queues[index == worker_count ? static_cast<size_t>(MaxWorkerCount) : index];
+            }
+            bool take(work_queue& queue, work_item& item, const bool newest, const task_group::state* group)
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                const size_t count = queue.items.size();
+                for(size_t i = 0; i < count; ++i)
+                {
+                    const size_t index = newest ? count - 1 - i : i;
+                    if(group != 0 && queue.items[index].group != group) continue;
+                    item = queue.items[index];
+                    queue.items.erase(queue.items.begin() + static_cast<std::ptrdiff_t>(index));
+                    std::lock_guard<std::mutex> sleep_lock(m_sleep_mutex);
+                    --m_queued;
+                    return true;
+                }
+                return false;
+            }
+            void work(const int index)
+            {
+                t_queue_index = index;
+                work_item item;
+                for(;;)
+                {
+                    if(pop(item))
+                    {
+                        execute(item);
+                        continue;
+                    }
+                    std::unique_lock<std::mutex> lock(m_sleep_mutex);
+                    while(!m_stop && m_queued == 0) m_wake.wait(lock);
+                    if(m_stop) return;
+                }
+            }
+
+        private:
+            std::vector< std::unique_ptr<work_queue> > m_queues;
+            std::vector<std::thread> m_threads;
+            std::atomic<size_t> m_worker_count;
+            std::mutex m_grow_mutex;
+            std::mutex m_sleep_mutex;
+            std::condition_variable m_wake;
+            size_t m_queued;
+            bool m_stop;
+        };
+
+        thread_pool& shared_pool()
+        {
+            static thread_pool pool;
+            return pool;
+        }
+
+        std::atomic<size_t> s_default_thread_count(0);
+    }
+
+    /** Constructor
+     *
+     * @param thread_count number of threads running the tasks of the group, including the waiting thread,
+     *        0 for the default thread count
+     */
+    task_group::task_group(const size_t thread_count) :
+            m_state(new state(std::max(thread_count > 0 ? thread_count : default_thread_count(),
+                                       static_cast<size_t>(2)) - 1))
+    {
+    }
+    /** Destructor waits for the running tasks, exceptions are ignored */
+    task_group::~task_group()
+    {
+        try
+        {
+            wait();
+        }
+        catch(...)
+        {
+        }
+        delete m_state;
+    }
+    /** Schedule a task on the shared thread pool
+     *
+     * @param task task to run
+     */
+    void task_group::run(abstract_task& task)
+    {
+        thread_pool& pool = shared_pool();
+        pool.reserve(m_state->workers);
+        ++m_state->pending;
+        pool.push(work_item(&task, m_state));
+    }
+    /** Wait for all scheduled tasks to finish, running queued tasks of this group while waiting
+     *
+     * The first exception thrown by a task is rethrown.
+     */
+    void task_group::wait()
+    {
+        thread_pool& pool = shared_pool();
+        work_item item;
+        while(m_state->pending.load() > 0)
+        {
+            if(pool.pop(item, m_state))
+            {
+                thread_pool::execute(item);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_state->mutex);
+            if(m_state->pending.load() > 0) m_state->done.wait_for(lock, std::chrono::milliseconds(1));
+        }
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            std::swap(error, m_state->error);
+        }
+        if(error) std::rethrow_exception(error);
+    }
+    /** Cancel the tasks that have not started */
+    void task_group::cancel()
+    {
+        m_state->cancelled = true;
+    }
+    /** Test if the group has been cancelled, either explicitly or by an exception
+     *
+     * @return true if the group was cancelled
+     */
+    bool task_group::is_cancelled()const
+    {
+        return m_state->cancelled.load();
+    }
+
+    namespace
+    {
+        /** Run iterations of a loop until none are left or the group is cancelled */
+        class loop_task : public abstract_task
+        {
+        public:
+            loop_task(abstract_loop_body& body, std::atomic<size_t>& next, const size_t count, const task_group& group) :
+                    m_body(body), m_next(next), m_count(count), m_group(group)
+            {
+            }
+            void operator()()
+            {
+                for(size_t index = m_next++; index < m_count && !m_group.is_cancelled(); index = m_next++)
+                    m_body(index);
+            }
+
+        private:
+            abstract_loop_body& m_body;
+            std::atomic<size_t>& m_next;
+            const size_t m_count;
+            const task_group& m_group;
+        };
+    }
+
+    /** Run each iteration of a loop on the shared thread pool
+     *
+     * Iterations are handed out one at a time, so the cost of each iteration may vary. The calling thread runs
+     * iterations along with the pool. The first exception thrown by the body stops the loop and is rethrown.
+     *
+     * @param count number of iterations
+     * @param body body of the loop
+     * @param thread_count maximum number of threads running the loop, 0 for the default thread count
+     */
+    void parallel_for(const size_t count, abstract_loop_body& body, const size_t thread_count)
+    {
+        const size_t task_count = std::min(thread_count > 0 ? thread_count : default_thread_count(), count);
+        if(task_count <= 1)
+        {
+            for(size_t index = 0; index < count; ++index) body(index);
+            return;
+        }
+        shared_pool().reserve(task_count - 1);
+        std::atomic<size_t> next(0);
+        task_group group(task_count);
+        loop_task task(body, next, count, group);
+        for(size_t i = 1; i < task_count; ++i) group.run(task);
+        try
+        {
+            task();
+        }
+        catch(...)
+        {
+            group.cancel();
+            try
+            {
+                group.wait();
+            }
+            catch(...)
+            {
+            }
+            throw;
+        }
+        group.wait();
+    }
+
+    /** Standard mutex */
+    struct mutex::state
+    {
+        std::mutex lock;
+    };
+
+    /** Constructor */
+    mutex::mutex() : m_state(new state)
+    {
+    }
+    /** Destructor */
+    mutex::~mutex()
+    {
+        delete m_state;
+    }
+    /** Block until the lock is acquired */
+    void mutex::lock()
+    {
+        m_state->lock.lock();
+    }
+    /** Release the lock */
+    void mutex::unlock()
+    {
+        m_state->lock.unlock();
+    }
+
+    /** Standard condition variable */
+    struct condition_variable::state
+    {
+        std::condition_variable condition;
+    };
+
+    /** Constructor */
+    condition_variable::condition_variable() : m_state(new state)
+    {
+    }
+    /** Destructor */
+    condition_variable::~condition_variable()
+    {
+        delete m_state;
+    }
+    /** Release the mutex, block until notified, then lock the mutex again
+     *
+     * @param locked_mutex mutex locked by the calling thread
+     */
+    void condition_variable::wait(mutex& locked_mutex)
+    {
+        // The caller owns the lock before and after the wait
+        std::unique_lock<std::mutex> lock(locked_mutex.m_state->lock, std::adopt_lock);
+        m_state->condition.wait(lock);
+        lock.release();
+    }
+    /** Wake all threads waiting on this condition */
+    void condition_variable::notify_all()
+    {
+        m_state->condition.notify_all();
+    }
+
+    /** Set the number of threads used when a thread count of 0 is requested
+     *
+     * @param thread_count number of threads, 0 for the number of processors
+     */
+    void set_default_thread_count(const size_t thread_count)
+    {
+        s_default_thread_count = thread_count;
+    }
+    /** Get the number of threads used when a thread count of 0 is requested
+     *
+     * @return number of threads
+     */
+    size_t default_thread_count()
+    {
+        const size_t thread_count = s_default_thread_count.load();
+        if(thread_count > 0) return thread_count;
+        return std::max(static_cast<size_t>(std::thread::hardware_concurrency()), static_cast<size_t>(1));
+    }
+    /** Test if tasks run on a pool of threads, or serially
+     *
+     * @return true if the pool runs tasks concurrently
+     */
+    bool is_thread_pool_concurrent()
+    {
+        return true;
+    }
+#else
+    /** Tasks of a group, run serially by wait
+     */
+    struct task_group::state
+    {
+        state() : cancelled(false){}
+        std::vector<abstract_task*> tasks;
+        bool cancelled;
+    };
+
+    namespace
+    {
+        size_t s_default_thread_count = 0;
+    }
+
+    /** Constructor
+     *
+     * @param thread_count ignored
+     */
+    task_group::task_group(const size_t thread_count) : m_state(new state)
+    {
+        (void)thread_count;
+    }
+    /** Destructor waits for the running tasks, exceptions are ignored */
+    task_group::~task_group()
+    {
+        try
+        {
+            wait();
+        }
+        catch(...)
+        {
+        }
+        delete m_state;
+    }
+    /** Schedule a task, which runs when the group is waited on
+     *
+     * @param task task to run
+     */
+    void task_group::run(abstract_task& task)
+    {
+        m_state->tasks.push_back(&task);
+    }
+    /** Run the scheduled tasks in order
+     *
+     * The first exception thrown by a task is rethrown.
+     */
+    void task_group::wait()
+    {
+        // A task may schedule more tasks, which are appended to the list
+        for(size_t i = 0; i < m_state->tasks.size() && !m_state->cancelled; ++i)
+        {
+            try
+            {
+                (*m_state->tasks[i])();
+            }
+            catch(...)
+            {
+                m_state->tasks.clear();
+                m_state->cancelled = true;
+                throw;
+            }
+        }
+        m_state->tasks.clear();
+    }
+    /** Cancel the tasks that have not started */
+    void task_group::cancel()
+    {
+        m_state->cancelled = true;
+    }
+    /** Test if the group has been cancelled, either explicitly or by an exception
+     *
+     * @return true if the group was cancelled
+     */
+    bool task_group::is_cancelled()const
+    {
+        return m_state->cancelled;
+    }
+    /** Run each iteration of a loop serially
+     *
+     * @param count number of iterations
+     * @param body body of the loop
+     * @param thread_count ignored
+     */
+    void parallel_for(const size_t count, abstract_loop_body& body, const size_t thread_count)
+    {
+        (void)thread_count;
+        for(size_t index = 0; index < count; ++index) body(index);
+    }
+    /** Constructor */
+    mutex::mutex() : m_state(0)
+    {
+    }
+    /** Destructor */
+    mutex::~mutex()
+    {
+    }
+    /** Tasks run serially, so there is nothing to lock */
+    void mutex::lock()
+    {
+    }
+    /** Tasks run serially, so there is nothing to unlock */
+    void mutex::unlock()
+    {
+    }
+    /** Constructor */
+    condition_variable::condition_variable() : m_state(0)
+    {
+    }
+    /** Destructor */
+    condition_variable::~condition_variable()
+    {
+    }
+    /** Tasks run serially, so no other thread can change the condition
+     *
+     * @param locked_mutex ignored
+     */
+    void condition_variable::wait(mutex& locked_mutex)
+    {
+        (void)locked_mutex;
+    }
+    /** Tasks run serially, so no thread is waiting */
+    void condition_variable::notify_all()
+    {
+    }
+    /** Set the number of threads used when a thread count of 0 is requested
+     *
+     * @param thread_count number of threads, 0 for the number of processors
+     */
+    void set_default_thread_count(const size_t thread_count)
+    {
+        s_default_thread_count = thread_count;
+    }
+    /** Get the number of threads used when a thread count of 0 is requested
+     *
+     * @return number of threads
+     */
+    size_t default_thread_count()
+    {
+        return s_default_thread_count > 0 ? s_default_thread_count : 1;
+    }
+    /** Test if tasks run on a pool of threads, or serially
+     *
+     * @return true if the pool runs tasks concurrently
+     */
+    bool is_thread_pool_concurrent()
+    {
+        return false;
+    }
+#endif
+
+}}}
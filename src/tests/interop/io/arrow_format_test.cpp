@@ -0,0 +1,145 @@
+/** Unit tests for writing the Arrow IPC format
+ *
+ *  @file
+ *  @date 10/19/2026
+ *  @version 1.0
+ *  @copyright GNU Public License
+ */
+#include <gtest/gtest.h>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <vector>
+#include "interop/io/table/arrow_format.h"
+#include "interop/model/metric_base/metric_exceptions.h"
+#include "interop/logic/table/table_util.h"
+#include "interop/model/table/imaging_table.h"
+
+using namespace illumina::interop;
+
+namespace
+{
+    /** Create an imaging table with an id column, a value column holding a missing value and a sub column group
+     *
+     * @param table destination imaging table
+     */
+    void create_test_table(model::table::imaging_table& table)
+    {
+        std::vector<model::table::imaging_column> columns;
+        columns.push_back(model::table::imaging_column(model::table::LaneColumn, 0));
+        columns.push_back(model::table::imaging_column(model::table::ErrorRateColumn, 1));
+        std::vector<std::string> channels;
+        channels.push_back("Red");
+        channels.push_back("Green");
+        columns.push_back(model::table::imaging_column(model::table::P90Column, 2, channels));
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        const float values[] = {
+                2, 0.5f, 100, 200,
+                1, nan, 101, 201,
+                2, 1.5f, 102, 202
+        };
+        std::vector<float> data(values, values + sizeof(values) / sizeof(values[0]));
+        table.set_data(3, columns, data);
+    }
+
+    /** Read a little endian 32-bit integer
+     *
+     * @param buffer source buffer
+     * @param offset offset into the buffer
+     * @return integer value
+     */
+    ::int32_t read_int32(const std::string& buffer, const size_t offset)
+    {
+        ::int32_t value;
+        std::memcpy(&value, buffer.data() + offset, sizeof(value));
+        return value;
+    }
+
+    /** Read Message.bodyLength from the flatbuffer metadata of an encapsulated message
+     *
+     * @param buffer source buffer
+     * @param metadata offset of the flatbuffer metadata
+     * @return size of the message body
+     */
+    ::int64_t read_body_length(const std::string& buffer, const size_t metadata)
+    {
+        const size_t message = metadata + static_cast<size_t>(read_int32(buffer, metadata));
+        const size_t vtable = message - static_cast<size_t>(read_int32(buffer, message));
+        ::uint16_t field_offset;
+        std::memcpy(&field_offset, buffer.data() + vtable + 4 + 2 * 3, sizeof(field_offset));
+        if (field_offset == 0) return 0;
+        ::int64_t body_length;
+        std::memcpy(&body_length, buffer.data() + message + field_offset, sizeof(body_length));
+        return body_length;
+    }
+}
+
+/**
+ * @test Confirm the stream layout is a sequence of 8-byte aligned messages ending with the end of stream marker
+ */
+TEST(arrow_format_test, stream_layout)
+{
+    model::table::imaging_table table;
+    create_test_table(table);
+    std::ostringstream out;
+    io::table::write_arrow(out, table, io::table::ArrowStream, 2);
+    const std::string buffer = out.str();
+
+    size_t offset = 0;
+    size_t message_count = 0;
+    while (offset + 8 <= buffer.size())
+    {
+        EXPECT_EQ(-1, read_int32(buffer, offset));
+        const ::int32_t metadata_size = read_int32(buffer, offset + 4);
+        if (metadata_size == 0) break;
+        EXPECT_EQ(0, metadata_size % 8);
+        const ::int64_t body_length = read_body_length(buffer, offset + 8);
+        EXPECT_EQ(0, body_length % 8);
+        offset += 8 + metadata_size + static_cast<size_t>(body_length);
+        ++message_count;
+    }
+    EXPECT_EQ(buffer.size(), offset + 8);
+    // Schema, one dictionary and two record batches
+    EXPECT_EQ(4u, message_count);
+
+    const float error_rate = 1.5f;
+    const std::string error_rate_bytes(reinterpret_cast<const char*>(&error_rate), sizeof(error_rate));
+    EXPECT_NE(std::string::npos, buffer.find(error_rate_bytes));
+    EXPECT_NE(std::string::npos, buffer.find("P90_Green"));
+}
+
+/**
+ * @test Confirm the file layout wraps the stream layout with the magic string and a footer
+ */
+TEST(arrow_format_test, file_layout)
+{
+    model::table::imaging_table table;
+    create_test_table(table);
+    std::ostringstream stream_out;
+    io::table::write_arrow(stream_out, table, io::table::ArrowStream, 2);
+    std::ostringstream file_out;
+    io::table::write_arrow(file_out, table, io::table::ArrowFile, 2);
+    const std::string stream = stream_out.str();
+    const std::string file = file_out.str();
+
+    ASSERT_GT(file.size(), stream.size() + 24);
+    EXPECT_EQ(0, std::memcmp(file.data(), "ARROW1\0\0", 8));
+    EXPECT_EQ(stream, file.substr(8, stream.size()));
+    EXPECT_EQ("ARROW1", file.substr(file.size() - 6));
+    const ::int32_t footer_size = read_int32(file, file.size() - 10);
+    EXPECT_EQ(file.size(), 8 + stream.size() + footer_size + 10);
+}
+
+/**
+ * @test Confirm an empty table writes only the schema
+ */
+TEST(arrow_format_test, empty_table)
+{
+    model::table::imaging_table table;
+    std::ostringstream out;
+    io::table::write_arrow(out, table, io::table::ArrowStream);
+    const std::string buffer = out.str();
+    ASSERT_GE(buffer.size(), 16u);
+    EXPECT_EQ(-1, read_int32(buffer, 0));
+    EXPECT_EQ(8u + read_int32(buffer, 4) + 8u, buffer.size());
+}
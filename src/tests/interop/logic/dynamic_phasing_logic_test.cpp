@@ -108,4 +108,52 @@ TEST(dynamic_phasing_logic, populate_dynamic_phasing_metrics_reorder)
     EXPECT_NEAR(dynamic_phasing_metrics.get_metric(lane, tile, 2).phasing_offset(), R2_phasing_offset, tol);
     EXPECT_NEAR(dynamic_phasing_metrics.get_metric(lane, tile, 2).prephasing_slope(), R2_prephasing_slope, tol);
     EXPECT_NEAR(dynamic_phasing_metrics.get_metric(lane, tile, 2).prephasing_offset(), R2_prephasing_offset, tol);
-}
\ No newline at end of file
+}
+TEST(dynamic_phasing_logic, long_read_fit_is_precise_and_independent_of_thread_count)
+{
+    typedef model::metric_base::base_metric::uint_t uint_t;
+    typedef model::metric_base::metric_set<model::metrics::dynamic_phasing_metric> dynamic_phasing_metric_set_t;
+    const float phasing_slope = 0.001f, phasing_offset = 0.05f;
+    const float prephasing_slope = 0.0005f, prephasing_offset = 0.1f;
+    const size_t read_length = 300;
+    logic::summary::read_cycle_vector_t cycle_to_read;
+    for(size_t cycle = 1; cycle <= read_length; ++cycle)
+        cycle_to_read.push_back(logic::summary::read_cycle(1, cycle));
+    model::metric_base::metric_set<model::metrics::phasing_metric> phasing_metrics_set;
+    for(uint_t lane = 1; lane <= 2; ++lane)
+    {
+        for(uint_t tile = 1101; tile <= 1108; ++tile)
+        {
+            for(size_t cycle = 1; cycle <= read_length; ++cycle)
+            {
+                phasing_metrics_set.insert(phasing_metric(lane, tile, static_cast<uint_t>(cycle),
+                                                          cycle * phasing_slope + phasing_offset,
+                                                          cycle * prephasing_slope + prephasing_offset));
+            }
+        }
+    }
+
+    const size_t thread_counts[] = {1, 4};
+    std::vector<dynamic_phasing_metric_set_t> results(util::length_of(thread_counts));
+    for(size_t i = 0; i < util::length_of(thread_counts); ++i)
+    {
+        model::metric_base::metric_set<model::metrics::phasing_metric> phasing_metrics(phasing_metrics_set);
+        model::metric_base::metric_set<model::metrics::tile_metric> tile_metrics;
+        populate_dynamic_phasing_metrics(phasing_metrics, cycle_to_read, results[i], tile_metrics, thread_counts[i]);
+    }
+    ASSERT_EQ(16u, results[0].size());
+    ASSERT_EQ(results[0].size(), results[1].size());
+    for(size_t i = 0; i < results[0].size(); ++i)
+    {
+        EXPECT_EQ(results[0][i].lane(), results[1][i].lane());
+        EXPECT_EQ(results[0][i].tile(), results[1][i].tile());
+        EXPECT_EQ(results[0][i].phasing_slope(), results[1][i].phasing_slope());
+        EXPECT_EQ(results[0][i].phasing_offset(), results[1][i].phasing_offset());
+        EXPECT_EQ(results[0][i].prephasing_slope(), results[1][i].prephasing_slope());
+        EXPECT_EQ(results[0][i].prephasing_offset(), results[1][i].prephasing_offset());
+        EXPECT_NEAR(phasing_slope, results[0][i].phasing_slope(), 1e-6f);
+        EXPECT_NEAR(phasing_offset, results[0][i].phasing_offset(), 1e-5f);
+        EXPECT_NEAR(prephasing_slope, results[0][i].prephasing_slope(), 1e-6f);
+        EXPECT_NEAR(prephasing_offset, results[0][i].prephasing_offset(), 1e-5f);
+    }
+}
@@ -14,6 +14,12 @@
 #include "interop/logic/plot/plot_flowcell_map.h"
 #include "interop/logic/plot/plot_sample_qc.h"
 #include "interop/logic/plot/plot_metric_list.h"
+#include "interop/logic/plot/plot_point.h"
+#include "interop/logic/metric/q_metric.h"
+#include "interop/logic/metric/tile_aggregate.h"
+#include "interop/model/run_metrics_snapshot.h"
+#include "interop/util/thread_pool.h"
+#include "interop/util/length_of.h"
 #include "src/tests/interop/metrics/inc/corrected_intensity_metrics_test.h"
 #include "src/tests/interop/metrics/inc/extraction_metrics_test.h"
 #include "src/tests/interop/metrics/inc/tile_metrics_test.h"
@@ -122,6 +128,150 @@ TEST(plot_logic, intensity_by_cycle)
     }
 }
 
+TEST(plot_logic, candle_stick_from_quantile_sketch)
+{
+    std::vector<float> values;
+    util::quantile_sketch sketch(200);
+    ::uint32_t state = 4321;
+    for (size_t i = 0; i < 100000; ++i)
+    {
+        state = state * 1664525u + 1013904223u;
+        values.push_back(static_cast<float>(state >> 8) / static_cast<float>(1 << 24) * 100.0f);
+        sketch.update(values.back());
+    }
+    values.push_back(1000.0f);
+    sketch.update(values.back());
+    ASSERT_FALSE(sketch.is_exact());
+
+    std::vector<float> outliers;
+    outliers.reserve(10);
+    std::vector<float> buffer;
+    model::plot::candle_stick_point expected;
+    model::plot::candle_stick_point actual;
+    logic::plot::plot_candle_stick(expected, values.begin(), values.end(), 1.0f, outliers);
+    logic::plot::plot_candle_stick(actual, sketch, 1.0f, outliers, buffer);
+    EXPECT_EQ(expected.data_point_count(), actual.data_point_count());
+    EXPECT_NEAR(expected.p25(), actual.p25(), 1.0f);
+    EXPECT_NEAR(expected.y(), actual.y(), 1.0f);
+    EXPECT_NEAR(expected.p75(), actual.p75(), 1.0f);
+    // The whiskers are the retained values nearest the fences, within the rank error of the sketch
+    EXPECT_NEAR(expected.lower(), actual.lower(), 2.0f);
+    EXPECT_NEAR(expected.upper(), actual.upper(), 2.0f);
+    ASSERT_EQ(1u, actual.outliers().size());
+    EXPECT_EQ(1000.0f, actual.outliers()[0]);
+}
+
+TEST(plot_logic, intensity_by_cycle_quantile_sketch)
+{
+    model::metrics::run_metrics metrics;
+    model::plot::filter_options options(constants::FourDigit);
+    model::run::info run_info;
+    hiseq4k_run_info::create_expected(run_info);
+    metrics.run_info(run_info);
+    unittest::extraction_metric_v2::create_expected(metrics.get<model::metrics::extraction_metric>());
+    unittest::tile_metric_v2::create_expected(metrics.get<model::metrics::tile_metric>());
+    metrics.set_result_cache_size(4);
+
+    const model::plot::filter_options channel_options(constants::FourDigit,
+                                                      model::plot::filter_options::ALL_IDS,
+                                                      0);
+    model::plot::plot_data<model::plot::candle_stick_point> expected_cycle;
+    logic::plot::plot_by_cycle(metrics, constants::Intensity, channel_options, expected_cycle);
+    model::plot::plot_data<model::plot::candle_stick_point> expected_lane;
+    logic::plot::plot_by_lane(metrics, constants::ClusterCountPF, options, expected_lane);
+
+    // Changing the setting drops the cached plots, but keeps the data version
+    const size_t version = metrics.data_version();
+    metrics.set_quantile_sketch_accuracy(200);
+    EXPECT_EQ(200u, metrics.quantile_sketch_accuracy());
+    EXPECT_EQ(version, metrics.data_version());
+    EXPECT_EQ(0u, metrics.cached_result_count());
+
+    // A sketch holding fewer values than its capacity is exact
+    model::plot::plot_data<model::plot::candle_stick_point> actual_cycle;
+    logic::plot::plot_by_cycle(metrics, constants::Intensity, channel_options, actual_cycle);
+    model::plot::plot_data<model::plot::candle_stick_point> actual_lane;
+    logic::plot::plot_by_lane(metrics, constants::ClusterCountPF, options, actual_lane);
+    ASSERT_EQ(expected_cycle.size(), actual_cycle.size());
+    ASSERT_EQ(expected_lane.size(), actual_lane.size());
+    for (size_t series = 0; series < expected_cycle.size(); ++series)
+    {
+        ASSERT_EQ(expected_cycle[series].size(), actual_cycle[series].size());
+        for (size_t i = 0; i < expected_cycle[series].size(); ++i)
+        {
+            EXPECT_EQ(expected_cycle[series][i].y(), actual_cycle[series][i].y());
+            EXPECT_EQ(expected_cycle[series][i].p25(), actual_cycle[series][i].p25());
+            EXPECT_EQ(expected_cycle[series][i].p75(), actual_cycle[series][i].p75());
+            EXPECT_EQ(expected_cycle[series][i].data_point_count(), actual_cycle[series][i].data_point_count());
+        }
+    }
+    for (size_t series = 0; series < expected_lane.size(); ++series)
+    {
+        ASSERT_EQ(expected_lane[series].size(), actual_lane[series].size());
+        for (size_t i = 0; i < expected_lane[series].size(); ++i)
+        {
+            EXPECT_EQ(expected_lane[series][i].y(), actual_lane[series][i].y());
+            EXPECT_EQ(expected_lane[series][i].data_point_count(), actual_lane[series][i].data_point_count());
+        }
+    }
+}
+
+TEST(plot_logic, intensity_by_cycle_sketch_ignores_thread_count)
+{
+    model::metrics::run_metrics metrics;
+    model::run::info run_info;
+    hiseq4k_run_info::create_expected(run_info);
+    metrics.run_info(run_info);
+    typedef model::metrics::extraction_metric extraction_metric;
+    typedef model::metric_base::metric_set<extraction_metric> extraction_metric_set;
+    extraction_metric::ushort_t intensities[] = {0, 0, 0, 0};
+    float focus[] = {2.0f, 2.0f, 2.0f, 2.0f};
+    ::uint32_t state = 1234;
+    extraction_metric_set& extraction = metrics.get<extraction_metric>();
+    extraction = extraction_metric_set(extraction_metric::header_type(4), 2);
+    // Enough records for several chunks, each cycle holding more values than the sketch keeps
+    for (::uint32_t lane = 1; lane <= 8; ++lane)
+    {
+        for (::uint32_t tile = 1101; tile <= 1128; ++tile)
+        {
+            for (::uint32_t cycle = 1; cycle <= 300; ++cycle)
+            {
+                state = state * 1664525u + 1013904223u;
+                intensities[0] = static_cast<extraction_metric::ushort_t>(state >> 20);
+                extraction.insert(extraction_metric(lane, tile, cycle, static_cast<extraction_metric::ulong_t>(0),
+                                                    intensities, focus, 4));
+            }
+        }
+    }
+    metrics.set_result_cache_size(0);
+    metrics.set_quantile_sketch_accuracy(50);
+
+    const model::plot::filter_options options(constants::FourDigit, model::plot::filter_options::ALL_IDS, 0);
+    model::plot::plot_data<model::plot::candle_stick_point> expected;
+    util::set_default_thread_count(1);
+    logic::plot::plot_by_cycle(metrics, constants::Intensity, options, expected);
+    model::plot::plot_data<model::plot::candle_stick_point> actual;
+    util::set_default_thread_count(8);
+    logic::plot::plot_by_cycle(metrics, constants::Intensity, options, actual);
+    util::set_default_thread_count(0);
+
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t series = 0; series < expected.size(); ++series)
+    {
+        ASSERT_EQ(300u, expected[series].size());
+        ASSERT_EQ(expected[series].size(), actual[series].size());
+        for (size_t i = 0; i < expected[series].size(); ++i)
+        {
+            EXPECT_EQ(expected[series][i].y(), actual[series][i].y());
+            EXPECT_EQ(expected[series][i].p25(), actual[series][i].p25());
+            EXPECT_EQ(expected[series][i].p75(), actual[series][i].p75());
+            EXPECT_EQ(expected[series][i].lower(), actual[series][i].lower());
+            EXPECT_EQ(expected[series][i].upper(), actual[series][i].upper());
+            EXPECT_EQ(expected[series][i].data_point_count(), actual[series][i].data_point_count());
+        }
+    }
+}
+
 //Check that reading in an empty interop sets values to 0 etc for plot_by_cycle
 TEST(plot_logic, intensity_by_cycle_empty_interop)
 {
@@ -324,6 +474,104 @@ TEST(plot_logic, q_score_heatmap)
     }
 }
 
+//Checks that the q-score heatmap and histogram from the q-score cube match the plots from the records
+TEST(plot_logic, q_score_plots_from_cube)
+{
+    model::metrics::run_metrics metrics;
+    model::plot::filter_options options(constants::FourDigit);
+    options.surface(1);
+
+    model::run::info run_info;
+    hiseq4k_run_info::create_expected(run_info);
+    metrics.run_info(run_info);
+    unittest::q_metric_v6::create_expected(metrics.get<model::metrics::q_metric>());
+    metrics.finalize_after_load();
+    ASSERT_FALSE(metrics.qscore_cube().empty());
+    // All tiles are in the first swath, so selecting it gives the same plots from the records
+    model::plot::filter_options record_options = options;
+    record_options.swath(1);
+    ASSERT_FALSE(record_options.is_lane_surface_only(constants::FourDigit));
+
+    model::plot::heatmap_data expected_heatmap;
+    model::plot::heatmap_data actual_heatmap;
+    logic::plot::plot_qscore_heatmap(metrics, record_options, expected_heatmap);
+    logic::plot::plot_qscore_heatmap(metrics, options, actual_heatmap);
+    ASSERT_EQ(actual_heatmap.row_count(), expected_heatmap.row_count());
+    ASSERT_EQ(actual_heatmap.column_count(), expected_heatmap.column_count());
+    for (size_t row = 0; row < actual_heatmap.row_count(); ++row)
+        for (size_t col = 0; col < actual_heatmap.column_count(); ++col)
+            EXPECT_NEAR(actual_heatmap(row, col), expected_heatmap(row, col), 1e-3f);
+
+    model::plot::plot_data<model::plot::bar_point> expected_histogram;
+    model::plot::plot_data<model::plot::bar_point> actual_histogram;
+    logic::plot::plot_qscore_histogram(metrics, record_options, expected_histogram);
+    logic::plot::plot_qscore_histogram(metrics, options, actual_histogram);
+    ASSERT_EQ(actual_histogram.size(), expected_histogram.size());
+    ASSERT_EQ(actual_histogram[0].size(), expected_histogram[0].size());
+    for (size_t i = 0; i < actual_histogram[0].size(); ++i)
+        EXPECT_NEAR(actual_histogram[0][i].y(), expected_histogram[0][i].y(), 1e-3f);
+}
+
+TEST(plot_logic, tile_plots_from_aggregate_table_built_on_demand)
+{
+    const model::plot::filter_options::id_t ALL_IDS = model::plot::filter_options::ALL_IDS;
+    model::metrics::run_metrics metrics;
+    model::run::info run_info;
+    hiseq4k_run_info::create_expected(run_info);
+    metrics.run_info(run_info);
+    unittest::tile_metric_v2::create_expected(metrics.get<model::metrics::tile_metric>());
+    metrics.finalize_after_load();
+
+    // Without finalize_after_load, the table is built on first use
+    model::metrics::run_metrics records;
+    records.run_info(metrics.run_info());
+    records.get<model::metrics::tile_metric>() = metrics.get<model::metrics::tile_metric>();
+    ASSERT_EQ(metrics.tile_aggregates().size(), records.tile_aggregates().size());
+
+    const constants::metric_type types[] = {constants::ClusterCount, constants::Clusters, constants::PercentAligned};
+    model::plot::filter_options options(constants::FourDigit, ALL_IDS, 0, constants::A, ALL_IDS, 1);
+    for (size_t t = 0; t < util::length_of(types); ++t)
+    {
+        model::plot::plot_data<model::plot::candle_stick_point> expected_lane;
+        model::plot::plot_data<model::plot::candle_stick_point> actual_lane;
+        logic::plot::plot_by_lane(records, types[t], options, expected_lane);
+        logic::plot::plot_by_lane(metrics, types[t], options, actual_lane);
+        ASSERT_EQ(actual_lane.size(), expected_lane.size());
+        for (size_t s = 0; s < actual_lane.size(); ++s)
+        {
+            ASSERT_EQ(actual_lane[s].size(), expected_lane[s].size());
+            for (size_t i = 0; i < actual_lane[s].size(); ++i)
+            {
+                EXPECT_NEAR(actual_lane[s][i].p50(), expected_lane[s][i].p50(), 1e-3f);
+                EXPECT_NEAR(actual_lane[s][i].lower(), expected_lane[s][i].lower(), 1e-3f);
+                EXPECT_NEAR(actual_lane[s][i].upper(), expected_lane[s][i].upper(), 1e-3f);
+            }
+        }
+    }
+
+    model::plot::filter_options flowcell_options(constants::FourDigit, ALL_IDS, 0, constants::A, 1, 1, 1);
+    model::plot::flowcell_data expected_map;
+    model::plot::flowcell_data actual_map;
+    logic::plot::plot_flowcell_map(records, constants::PercentPhasing, flowcell_options, expected_map);
+    logic::plot::plot_flowcell_map(metrics, constants::PercentPhasing, flowcell_options, actual_map);
+    ASSERT_EQ(actual_map.length(), expected_map.length());
+    for (size_t i = 0; i < actual_map.length(); ++i)
+    {
+        EXPECT_EQ(actual_map.tile_at(i), expected_map.tile_at(i));
+        if (!std::isnan(expected_map.at(i)))
+            EXPECT_NEAR(actual_map.at(i), expected_map.at(i), 1e-3f);
+        else
+            EXPECT_TRUE(std::isnan(actual_map.at(i)));
+    }
+
+    // Changing the tile metric set rebuilds the table
+    records.get<model::metrics::tile_metric>().clear();
+    EXPECT_TRUE(records.tile_aggregates().empty());
+    model::plot::plot_data<model::plot::candle_stick_point> cleared_lane;
+    logic::plot::plot_by_lane(records, constants::ClusterCount, options, cleared_lane);
+    EXPECT_EQ(0u, cleared_lane.size());
+}
+
 //Checks that q-score heatmap works as intended
 TEST(plot_logic, q_score_heatmap_empty_interop)
 {
@@ -384,6 +632,200 @@ TEST(plot_logic, q_score_heatmap_buffer)
     }
 }
 
+//Checks that repeated plots are served from the result cache until it is invalidated
+TEST(plot_logic, result_cache)
+{
+    const model::plot::filter_options::id_t ALL_IDS = model::plot::filter_options::ALL_IDS;
+    const float tol = 1e-3f;
+    model::metrics::run_metrics metrics;
+    model::run::info run_info;
+    hiseq4k_run_info::create_expected(run_info);
+    metrics.run_info(run_info);
+    unittest::tile_metric_v2::create_expected(metrics.get<model::metrics::tile_metric>());
+    unittest::extraction_metric_v2::create_expected(metrics.get<model::metrics::extraction_metric>());
+    metrics.set_result_cache_size(4);
+
+    model::plot::filter_options options(constants::FourDigit);
+    model::plot::plot_data<model::plot::candle_stick_point> expected_lane;
+    logic::plot::plot_by_lane(metrics, constants::ClusterCountPF, options, expected_lane);
+    ASSERT_EQ(expected_lane.size(), 1u);
+    EXPECT_EQ(metrics.cached_result_count(), 1u);
+
+    model::plot::filter_options flowcell_options(constants::FourDigit, ALL_IDS, 0, constants::A, ALL_IDS, 1, 1);
+    model::plot::flowcell_data expected_map;
+    logic::plot::plot_flowcell_map(metrics, constants::Intensity, flowcell_options, expected_map);
+    EXPECT_EQ(metrics.cached_result_count(), 2u);
+
+    // Repeated plots are copied from the cache
+    model::plot::plot_data<model::plot::candle_stick_point> actual_lane;
+    logic::plot::plot_by_lane(metrics, constants::ClusterCountPF, options, actual_lane);
+    ASSERT_EQ(actual_lane.size(), expected_lane.size());
+    ASSERT_EQ(actual_lane[0].size(), expected_lane[0].size());
+    EXPECT_NEAR(actual_lane[0][0].y(), expected_lane[0][0].y(), tol);
+    EXPECT_EQ(actual_lane.title(), expected_lane.title());
+
+    model::plot::flowcell_data actual_map;
+    logic::plot::plot_flowcell_map(metrics, constants::Intensity, flowcell_options, actual_map);
+    ASSERT_EQ(actual_map.length(), expected_map.length());
+    EXPECT_EQ(actual_map.subtitle(), expected_map.subtitle());
+    for (size_t i = 0; i < actual_map.length(); ++i)
+    {
+        EXPECT_EQ(actual_map.tile_at(i), expected_map.tile_at(i));
+        if (!std::isnan(expected_map.at(i)))
+        {
+            EXPECT_NEAR(actual_map.at(i), expected_map.at(i), tol);
+        }
+    }
+    EXPECT_EQ(metrics.cached_result_count(), 2u);
+
+    // Clearing a metric set through get changes its revision, so the cached results are dropped
+    metrics.get<model::metrics::tile_metric>().clear();
+    logic::plot::plot_by_lane(metrics, constants::ClusterCountPF, options, actual_lane);
+    EXPECT_EQ(actual_lane.size(), 0u);
+    EXPECT_EQ(metrics.cached_result_count(), 1u);
+
+    unittest::tile_metric_v2::create_expected(metrics.get<model::metrics::tile_metric>());
+    logic::plot::plot_by_lane(metrics, constants::ClusterCountPF, options, actual_lane);
+    ASSERT_EQ(actual_lane.size(), expected_lane.size());
+    EXPECT_NEAR(actual_lane[0][0].y(), expected_lane[0][0].y(), tol);
+
+    const size_t version = metrics.data_version();
+    metrics.invalidate_results();
+    EXPECT_GT(metrics.data_version(), version);
+    EXPECT_EQ(metrics.cached_result_count(), 0u);
+}
+
+namespace
+{
+    /** Count the candle sticks that differ between two plots
+     *
+     * @param expected expected plot
+     * @param actual actual plot
+     * @return number of differences
+     */
+    size_t count_differences(const model::plot::plot_data<model::plot::candle_stick_point>& expected,
+                             const model::plot::plot_data<model::plot::candle_stick_point>& actual)
+    {
+        if(expected.size() != actual.size()) return 1;
+        size_t differences = 0;
+        for (size_t series = 0; series < expected.size(); ++series)
+        {
+            if(expected[series].size() != actual[series].size())
+            {
+                ++differences;
+                continue;
+            }
+            for (size_t i = 0; i < expected[series].size(); ++i)
+            {
+                if(expected[series][i].y() != actual[series][i].y() ||
+                   expected[series][i].data_point_count() != actual[series][i].data_point_count())
+                    ++differences;
+            }
+        }
+        return differences;
+    }
+    /** Plot the same snapshot from every task, counting the differences from a serial plot
+     */
+    struct plot_shared_snapshot
+    {
+        plot_shared_snapshot(const model::metrics::run_metrics_snapshot& snapshot, const size_t task_count) :
+                m_snapshot(snapshot),
+                m_lane_options(constants::FourDigit),
+                m_cycle_options(constants::FourDigit, model::plot::filter_options::ALL_IDS, 0),
+                m_flowcell_options(constants::FourDigit, model::plot::filter_options::ALL_IDS, 0, constants::A,
+                                   model::plot::filter_options::ALL_IDS, 1, 1),
+                m_differences(task_count, 0)
+        {
+            logic::plot::plot_by_lane(m_snapshot.logic_metrics(), constants::ClusterCountPF, m_lane_options,
+                                      m_expected_lane);
+            logic::plot::plot_by_cycle(m_snapshot.logic_metrics(), constants::Intensity, m_cycle_options,
+                                       m_expected_cycle);
+            logic::plot::plot_flowcell_map(m_snapshot.logic_metrics(), constants::Intensity, m_flowcell_options,
+                                           m_expected_map);
+        }
+        void operator()(const size_t index)
+        {
+            model::plot::plot_data<model::plot::candle_stick_point> lane;
+            logic::plot::plot_by_lane(m_snapshot.logic_metrics(), constants::ClusterCountPF, m_lane_options, lane);
+            m_differences[index] += count_differences(m_expected_lane, lane);
+            model::plot::plot_data<model::plot::candle_stick_point> cycle;
+            logic::plot::plot_by_cycle(m_snapshot.logic_metrics(), constants::Intensity, m_cycle_options, cycle);
+            m_differences[index] += count_differences(m_expected_cycle, cycle);
+            model::plot::flowcell_data map;
+            logic::plot::plot_flowcell_map(m_snapshot.logic_metrics(), constants::Intensity, m_flowcell_options, map);
+            if(map.length() != m_expected_map.length())
+            {
+                ++m_differences[index];
+                return;
+            }
+            for (size_t i = 0; i < map.length(); ++i)
+            {
+                if(map.tile_at(i) != m_expected_map.tile_at(i)) ++m_differences[index];
+                else if(!std::isnan(m_expected_map.at(i)) && map.at(i) != m_expected_map.at(i))
+                    ++m_differences[index];
+            }
+        }
+        model::metrics::run_metrics_snapshot m_snapshot;
+        model::plot::filter_options m_lane_options;
+        model::plot::filter_options m_cycle_options;
+        model::plot::filter_options m_flowcell_options;
+        model::plot::plot_data<model::plot::candle_stick_point> m_expected_lane;
+        model::plot::plot_data<model::plot::candle_stick_point> m_expected_cycle;
+        model::plot::flowcell_data m_expected_map;
+        std::vector<size_t> m_differences;
+    };
+}
+
+//Checks that concurrent plots of one published snapshot match a serial plot
+TEST(plot_logic, concurrent_plots_of_snapshot)
+{
+    model::metrics::run_metrics metrics;
+    model::run::info run_info;
+    hiseq4k_run_info::create_expected(run_info);
+    metrics.run_info(run_info);
+    unittest::tile_metric_v2::create_expected(metrics.get<model::metrics::tile_metric>());
+    unittest::extraction_metric_v2::create_expected(metrics.get<model::metrics::extraction_metric>());
+    metrics.set_result_cache_size(4);
+
+    const size_t task_count = 16;
+    for(size_t trial = 0; trial < 10; ++trial)
+    {
+        // Each published version builds its lookups on first use, so the readers race to build them
+        model::metrics::run_metrics_publisher publisher;
+        const model::metrics::run_metrics_snapshot snapshot = publisher.publish(metrics);
+        model::metrics::run_metrics_snapshot serial = model::metrics::run_metrics_publisher().publish(metrics);
+        plot_shared_snapshot body(serial, task_count);
+        body.m_snapshot = snapshot;
+        util::parallel_for_each_index(task_count, body, 8);
+        for(size_t i = 0; i < task_count; ++i) EXPECT_EQ(0u, body.m_differences[i]) << "Task: " << i;
+    }
+}
+
+//Checks that concurrent plots sharing one result cache match a serial plot
+TEST(plot_logic, concurrent_plots_share_result_cache)
+{
+    model::metrics::run_metrics metrics;
+    model::run::info run_info;
+    hiseq4k_run_info::create_expected(run_info);
+    metrics.run_info(run_info);
+    unittest::tile_metric_v2::create_expected(metrics.get<model::metrics::tile_metric>());
+    unittest::extraction_metric_v2::create_expected(metrics.get<model::metrics::extraction_metric>());
+
+    const size_t task_count = 16;
+    for(size_t trial = 0; trial < 10; ++trial)
+    {
+        // The readers race to find, compute and store the same results
+        const model::metrics::run_metrics_snapshot snapshot = model::metrics::run_metrics_publisher().publish(metrics);
+        snapshot.logic_metrics().set_result_cache_size(4);
+        model::metrics::run_metrics_snapshot serial = model::metrics::run_metrics_publisher().publish(metrics);
+        plot_shared_snapshot body(serial, task_count);
+        body.m_snapshot = snapshot;
+        util::parallel_for_each_index(task_count, body, 8);
+        for(size_t i = 0; i < task_count; ++i) EXPECT_EQ(0u, body.m_differences[i]) << "Task: " << i;
+        EXPECT_EQ(3u, snapshot->cached_result_count());
+    }
+}
+
 //Tests that plot_flowcell_map works normally with interop read in
 TEST(plot_logic, flowcell_map)
 {
@@ -11,7 +11,10 @@
 #include <gtest/gtest.h>
 #include "interop/util/math.h"
 #include "interop/logic/summary/run_summary.h"
+#include "interop/logic/summary/batch_summary.h"
+#include "interop/logic/summary/preview_summary.h"
 #include "interop/logic/utils/channel.h"
+#include "interop/logic/metric/q_metric.h"
 #include "src/tests/interop/metrics/inc/corrected_intensity_metrics_test.h"
 #include "src/tests/interop/metrics/inc/error_metrics_test.h"
 #include "src/tests/interop/metrics/inc/extraction_metrics_test.h"
@@ -414,6 +417,71 @@ TEST(summary_metrics_test, cycle_35_cycle_34_tile)
 
 }
 
+TEST(summary_metrics_test, quality_from_cube_matches_collapsed)
+{
+    const float tol = 1e-5f;
+    const model::run::read_info reads[] = {model::run::read_info(1, 1, 3), model::run::read_info(2, 4, 6)};
+    model::run::flowcell_layout layout(2, 2, 2, 16, 1, 1, std::vector<std::string>(), constants::FourDigit);
+    const std::string channels[] = {"Red", "Green"};
+    const model::run::info run_info(layout, util::to_vector(reads), util::to_vector(channels));
+    const ::uint32_t tiles[] = {1101, 1102, 2101};
+
+    model::metrics::run_metrics cube_metrics(run_info);
+    model::metric_base::metric_set<q_metric>& q_metrics = cube_metrics.get<q_metric>();
+    for (::uint32_t lane = 1; lane <= 2; ++lane)
+    {
+        for (size_t t = 0; t < util::length_of(tiles); ++t)
+        {
+            // The last tile of lane 2 stops early, so the lanes have a different number of records per read
+            const ::uint32_t cycle_count = (lane == 2 && t == 2) ? 4 : 6;
+            for (::uint32_t cycle = 1; cycle <= cycle_count; ++cycle)
+            {
+                std::vector< ::uint64_t > hist(50, 0);
+                for (size_t bin = 0; bin < hist.size(); ++bin)
+                    hist[bin] = static_cast< ::uint64_t >(((lane * 7 + tiles[t] + cycle * 3 + bin) % 11) * 100);
+                q_metrics.insert(q_metric(lane, tiles[t], cycle, hist));
+            }
+        }
+    }
+    ASSERT_FALSE(cube_metrics.qscore_cube().empty());
+    model::metrics::run_metrics collapsed_metrics(run_info);
+    logic::metric::create_collapse_q_metrics(q_metrics, collapsed_metrics.get<q_collapsed_metric>());
+
+    model::summary::run_summary expected;
+    logic::summary::summarize_run_metrics(collapsed_metrics, expected, false, false);
+    model::summary::run_summary actual;
+    logic::summary::summarize_run_metrics(cube_metrics, actual, false, false);
+    EXPECT_EQ(0u, cube_metrics.get<q_collapsed_metric>().size());
+    EXPECT_FALSE(std::isnan(actual.total_summary().percent_gt_q30()));
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t read = 0; read < actual.size(); ++read)
+    {
+        INTEROP_EXPECT_NEAR(actual[read].summary().percent_gt_q30(), expected[read].summary().percent_gt_q30(), tol);
+        INTEROP_EXPECT_NEAR(actual[read].summary().projected_yield_g(),
+                            expected[read].summary().projected_yield_g(), tol);
+        ASSERT_EQ(actual[read].size(), expected[read].size());
+        for (size_t lane = 0; lane < actual[read].size(); ++lane)
+        {
+            INTEROP_EXPECT_NEAR(actual[read][lane].percent_gt_q30(), expected[read][lane].percent_gt_q30(), tol);
+            INTEROP_EXPECT_NEAR(actual[read][lane].yield_g(), expected[read][lane].yield_g(), tol);
+            INTEROP_EXPECT_NEAR(actual[read][lane].projected_yield_g(), expected[read][lane].projected_yield_g(), tol);
+            ASSERT_EQ(actual[read][lane].size(), expected[read][lane].size());
+            for (size_t surface = 0; surface < actual[read][lane].size(); ++surface)
+            {
+                INTEROP_EXPECT_NEAR(actual[read][lane][surface].percent_gt_q30(),
+                                    expected[read][lane][surface].percent_gt_q30(), tol);
+                INTEROP_EXPECT_NEAR(actual[read][lane][surface].projected_yield_g(),
+                                    expected[read][lane][surface].projected_yield_g(), tol);
+            }
+        }
+    }
+    INTEROP_EXPECT_NEAR(actual.total_summary().percent_gt_q30(), expected.total_summary().percent_gt_q30(), tol);
+    INTEROP_EXPECT_NEAR(actual.total_summary().yield_g(), expected.total_summary().yield_g(), tol);
+    INTEROP_EXPECT_NEAR(actual.total_summary().projected_yield_g(), expected.total_summary().projected_yield_g(), tol);
+    INTEROP_EXPECT_NEAR(actual.nonindex_summary().percent_gt_q30(), expected.nonindex_summary().percent_gt_q30(), tol);
+}
+
 TEST(summary_metrics_test, clear_run_metrics) // TODO Expand to catch everything: probably use a fixture and the methods above
 {
     const float tol = 1e-9f;
@@ -455,6 +523,108 @@ TEST(summary_metrics_test, empty_run_metrics)
     EXPECT_EQ(summary.size(), 0u);
 }
 
+TEST(summary_metrics_test, batch_missing_run_folders)
+{
+    std::vector<std::string> run_folders;
+    run_folders.push_back("batch_summary_missing_run_1");
+    run_folders.push_back("batch_summary_missing_run_2");
+    run_folders.push_back("batch_summary_missing_run_3");
+    std::vector<logic::summary::batch_run_summary> summaries;
+    logic::summary::summarize_run_folders(run_folders, summaries, 2, 1);
+    ASSERT_EQ(run_folders.size(), summaries.size());
+    for(size_t i=0;i<summaries.size();++i)
+    {
+        EXPECT_EQ(run_folders[i], summaries[i].run_folder);
+        EXPECT_FALSE(summaries[i].error.empty());
+        EXPECT_EQ(0u, summaries[i].run.size());
+        EXPECT_EQ(0u, summaries[i].memory_estimate);
+    }
+    EXPECT_EQ(0u, logic::summary::estimate_summary_memory(run_folders[0]));
+}
+
+TEST(summary_metrics_test, preview_tile_sample)
+{
+    typedef model::metric_base::base_metric base_metric;
+    const model::run::flowcell_layout layout(2, 2, 2, 4, 1, 1, model::run::flowcell_layout::str_vector_t(),
+                                             constants::FourDigit);
+    logic::summary::tile_id_vector_t all_tiles;
+    logic::summary::list_flowcell_tiles(layout, all_tiles);
+    EXPECT_EQ(layout.total_tiles(), all_tiles.size());
+
+    logic::summary::tile_id_vector_t tile_ids;
+    logic::summary::select_preview_tiles(layout, 3, tile_ids);
+    ASSERT_EQ(12u, tile_ids.size());
+    // Three of the eight tiles of each surface, spread over both swaths
+    const ::uint32_t expected_tiles[] = {1102, 1201, 1203, 2102, 2201, 2203};
+    for (size_t i = 0; i < tile_ids.size(); ++i)
+    {
+        EXPECT_EQ(i / 6 + 1, base_metric::lane_from_id(tile_ids[i]));
+        EXPECT_EQ(expected_tiles[i % 6], base_metric::tile_from_id(tile_ids[i]));
+    }
+
+    const model::metric_base::record_filter filter(tile_ids);
+    EXPECT_TRUE(filter.is_active());
+    EXPECT_TRUE(filter(tile_metric(1, 1102, 0, 0, 0, 0)));
+    EXPECT_FALSE(filter(tile_metric(1, 1101, 0, 0, 0, 0)));
+    EXPECT_FALSE(filter(tile_metric(3, 1102, 0, 0, 0, 0)));
+    EXPECT_TRUE(filter(error_metric(2, 2203, 5, 0, 0)));
+
+    logic::summary::select_preview_tiles(layout, 100, tile_ids);
+    EXPECT_EQ(all_tiles, tile_ids);
+}
+
+TEST(summary_metrics_test, preview_estimate_from_sample)
+{
+    const float tol = 1e-3f;
+    const model::run::read_info reads[] = {model::run::read_info(1, 1, 3)};
+    const std::string channels[] = {"A", "G", "T", "C"};
+    const model::run::info run_info("preview", "", "", 1, 3,
+                                    model::run::flowcell_layout(2, 2, 2, 4, 1, 1,
+                                                                model::run::flowcell_layout::str_vector_t(),
+                                                                constants::FourDigit),
+                                    util::to_vector(channels),
+                                    model::run::image_dimensions(),
+                                    util::to_vector(reads));
+    model::metrics::run_metrics metrics(run_info);
+    model::metric_base::metric_set<tile_metric>& tiles = metrics.get<tile_metric>();
+    tiles.insert(tile_metric(1, 1101, 100, 90, 1000, 900));
+    tiles.insert(tile_metric(1, 1102, 200, 180, 2000, 1600));
+    tiles.insert(tile_metric(1, 2101, 300, 270, 3000, 2700));
+    tiles.insert(tile_metric(1, 2102, 500, 450, 5000, 4000));
+    tiles.insert(tile_metric(2, 1101, 100, 90, 1000, 900));
+    metrics.finalize_after_load();
+
+    model::summary::run_summary_estimate estimate;
+    logic::summary::estimate_run_summary(metrics, estimate);
+    ASSERT_EQ(2u, estimate.size());
+
+    // Both surfaces of lane 1 hold 8 tiles, so the stratified mean is the mean of the surface means
+    const model::summary::summary_estimate& lane1 = estimate[0];
+    EXPECT_EQ(1u, lane1.lane());
+    EXPECT_EQ(16u, lane1.tile_count());
+    EXPECT_EQ(4u, lane1.sampled_tile_count());
+    EXPECT_EQ(4u, lane1.density().sample_count());
+    EXPECT_NEAR(275.0f, lane1.density().mean(), tol);
+    const float half_width = 1.95996398f * std::sqrt(0.25f * 0.75f * (5000.0f + 20000.0f) / 2.0f);
+    EXPECT_NEAR(275.0f - half_width, lane1.density().lower(), tol);
+    EXPECT_NEAR(275.0f + half_width, lane1.density().upper(), tol);
+    EXPECT_NEAR((90.0f + 80.0f + 90.0f + 80.0f) / 4.0f, lane1.percent_pf().mean(), tol);
+    ASSERT_EQ(1u, lane1.read_count());
+    EXPECT_TRUE(std::isnan(lane1.error_rate(0).mean()));
+    EXPECT_EQ(0u, lane1.percent_gt_q30(0).sample_count());
+
+    // A single sampled tile cannot estimate the variance of its surface
+    const model::summary::summary_estimate& lane2 = estimate[1];
+    EXPECT_EQ(2u, lane2.lane());
+    EXPECT_NEAR(100.0f, lane2.density().mean(), tol);
+    EXPECT_TRUE(std::isnan(lane2.density().lower()));
+    EXPECT_TRUE(std::isnan(lane2.density().upper()));
+
+    EXPECT_EQ(32u, estimate.total().tile_count());
+    EXPECT_EQ(5u, estimate.total().sampled_tile_count());
+    EXPECT_NEAR((150.0f + 400.0f + 100.0f) / 3.0f, estimate.total().density().mean(), tol);
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 // Unit test section
 //---------------------------------------------------------------------------------------------------------------------
@@ -724,4 +894,77 @@ INSTANTIATE_TEST_CASE_P(run_summary_regression_test,
                         run_summary_tests,
                         ProxyValuesIn(run_summary_regression_gen, regression_test_data::instance().files()));
 
+/** Generate the actual run summary directly from the InterOp files in the run folder
+ */
+class regression_test_summary_from_folder_generator : public regression_test_summary_generator<summary_logic>
+{
+    typedef regression_test_summary_generator<summary_logic> parent_t;
+public:
+    /** Constructor
+     *
+     * @param test_dir sub folder where tests are stored
+     */
+    regression_test_summary_from_folder_generator(const std::string &test_dir) : parent_t(test_dir)
+    {}
+
+    /** Constructor
+     *
+     * @param run_folder run folder with data
+     * @param test_dir sub folder where tests are stored
+     */
+    regression_test_summary_from_folder_generator(const std::string &run_folder, const std::string &test_dir) :
+            parent_t(run_folder, test_dir)
+    {}
+
+protected:
+    /** Summarize the run folder without loading all the metrics
+     *
+     * @param run_folder run folder
+     * @param actual actual model data
+     * @return true if data was generated
+     */
+    bool generate_actual(const std::string &run_folder, model::summary::run_summary &actual) const
+    {
+        try
+        {
+            logic::summary::summarize_run_metrics(run_folder, actual);
+        }
+        catch(const model::invalid_run_info_cycle_exception&){}
+        return actual.size() > 0;
+    }
+    /** Create a copy of the current object with the given run folder
+     *
+     * @param run_folder run folder
+     * @return pointer to new copy
+     */
+    base_t clone(const std::string& run_folder)const
+    {
+        return new regression_test_summary_from_folder_generator(run_folder, m_test_dir);
+    }
+
+    /** Create a copy of the current object
+     *
+     * @return pointer to new copy
+     */
+    base_t clone() const
+    {
+        return new regression_test_summary_from_folder_generator(*this);
+    }
+
+    /** Write generator info to output stream
+     *
+     * @param out output stream
+     */
+    void write(std::ostream &out) const
+    {
+        out << "regression_test_summary_from_folder_generator - " << io::basename(m_run_folder);
+    }
+};
+
+regression_test_summary_from_folder_generator run_summary_from_folder_regression_gen("summary");
+
+INSTANTIATE_TEST_CASE_P(run_summary_from_folder_regression_test,
+                        run_summary_tests,
+                        ProxyValuesIn(run_summary_from_folder_regression_gen,
+                                      regression_test_data::instance().files()));
 
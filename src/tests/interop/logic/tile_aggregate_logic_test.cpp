@@ -0,0 +1,169 @@
+/** Unit tests for the per tile aggregate table
+ *
+ *  @file
+ *  @date 10/19/2026
+ *  @version 1.0
+ *  @copyright GNU Public License.
+ */
+#include <gtest/gtest.h>
+#include "interop/logic/metric/tile_aggregate.h"
+
+
+using namespace illumina::interop;
+using namespace illumina::interop::model::metrics;
+
+namespace
+{
+    /** Create a q-score histogram with counts at Q20 and Q30 */
+    q_metric::uint32_vector qscore_hist(const ::uint32_t q20_count, const ::uint32_t q30_count)
+    {
+        q_metric::uint32_vector hist(q_metric::MAX_Q_BINS, 0);
+        hist[19] = q20_count;
+        hist[29] = q30_count;
+        return hist;
+    }
+}
+
+TEST(tile_aggregate_logic, populate_tile_aggregate_table)
+{
+    model::metric_base::metric_set<tile_metric> tile_metrics;
+    model::metric_base::metric_set<extended_tile_metric> extended_tile_metrics;
+    model::metric_base::metric_set<error_metric> error_metrics;
+    model::metric_base::metric_set<q_metric> q_metrics;
+
+    tile_metric::read_metric_vector reads;
+    reads.push_back(read_metric(1, 90.0f, 0.1f, 0.2f));
+    reads.push_back(read_metric(2, 80.0f, 0.3f, 0.4f));
+    tile_metrics.insert(tile_metric(1, 1102, 200000.0f, 180000.0f, 2000000.0f, 1500000.0f));
+    tile_metrics.insert(tile_metric(1, 1101, 100000.0f, 90000.0f, 1000000.0f, 800000.0f, reads));
+    extended_tile_metrics.insert(extended_tile_metric(1, 1101, 700000.0f));
+    extended_tile_metrics.insert(extended_tile_metric(2, 1101, 600000.0f));
+
+    // Two reads of three cycles, the last cycle of each read is excluded from the averages
+    logic::summary::read_cycle_vector_t cycle_to_read;
+    for(size_t read = 1; read <= 2; ++read)
+    {
+        for(size_t cycle = 1; cycle <= 3; ++cycle)
+            cycle_to_read.push_back(logic::summary::read_cycle(read, cycle));
+        cycle_to_read.back().is_last_cycle_in_read = true;
+    }
+    const float error_rates[] = {1.0f, 2.0f, 10.0f, 3.0f, 5.0f, 10.0f};
+    for(::uint32_t cycle = 1; cycle <= 6; ++cycle)
+    {
+        error_metrics.insert(error_metric(1, 1101, cycle, error_rates[cycle - 1], 0.0f));
+        q_metrics.insert(q_metric(1, 1101, cycle, qscore_hist(cycle, 3 * cycle)));
+    }
+
+    tile_aggregate_table table;
+    logic::metric::populate_tile_aggregate_table(tile_metrics,
+                                                 extended_tile_metrics,
+                                                 error_metrics,
+                                                 q_metrics,
+                                                 cycle_to_read,
+                                                 7,
+                                                 table);
+    ASSERT_EQ(3u, table.size());
+    EXPECT_EQ(2u, table.read_count());
+    EXPECT_EQ(2u, table.max_lane());
+    EXPECT_TRUE(logic::metric::is_tile_aggregate_table_current(tile_metrics,
+                                                               extended_tile_metrics,
+                                                               error_metrics,
+                                                               q_metrics,
+                                                               7,
+                                                               table));
+    EXPECT_FALSE(logic::metric::is_tile_aggregate_table_current(tile_metrics,
+                                                                extended_tile_metrics,
+                                                                error_metrics,
+                                                                q_metrics,
+                                                                8,
+                                                                table));
+
+    // Rows are sorted by tile id
+    EXPECT_EQ(0u, table.find(1, 1101));
+    EXPECT_EQ(1u, table.find(1, 1102));
+    EXPECT_EQ(2u, table.find(2, 1101));
+    EXPECT_EQ(table.size(), table.find(2, 1102));
+
+    const tile_aggregate& tile = table[table.find(1, 1101)];
+    EXPECT_TRUE(tile.has_tile_metric());
+    EXPECT_TRUE(tile.has_extended_tile_metric());
+    EXPECT_FLOAT_EQ(tile_metrics.get_metric(1, 1101).cluster_density_k(), tile.cluster_density_k());
+    EXPECT_FLOAT_EQ(tile_metrics.get_metric(1, 1101).percent_pf(), tile.percent_pf());
+    EXPECT_FLOAT_EQ(700.0f, tile.cluster_count_occupied_k());
+
+    const tile_aggregate& extended_only = table[table.find(2, 1101)];
+    EXPECT_FALSE(extended_only.has_tile_metric());
+    EXPECT_TRUE(std::isnan(extended_only.cluster_density()));
+    EXPECT_TRUE(std::isnan(table.percent_aligned_at(table.find(2, 1101), 1)));
+
+    const size_t row = table.find(1, 1101);
+    EXPECT_FLOAT_EQ(80.0f, table.percent_aligned_at(row, 2));
+    EXPECT_FLOAT_EQ(0.1f, table.percent_phasing_at(row, 1));
+    EXPECT_FLOAT_EQ(0.4f, table.percent_prephasing_at(row, 2));
+    EXPECT_TRUE(std::isnan(table.percent_phasing_at(row, 3)));
+    EXPECT_FLOAT_EQ(1.5f, table.read(row, 1).error_rate());
+    EXPECT_FLOAT_EQ(4.0f, table.read(row, 2).error_rate());
+    EXPECT_FLOAT_EQ(75.0f, table.read(row, 1).percent_over_q30());
+    EXPECT_FLOAT_EQ(75.0f, table.read(row, 2).percent_over_q30());
+    EXPECT_TRUE(std::isnan(table.read(table.find(1, 1102), 1).error_rate()));
+
+    EXPECT_FLOAT_EQ(tile.cluster_count_m(),
+                    logic::metric::tile_aggregate_value(table, row, constants::ClusterCount, 1));
+    EXPECT_FLOAT_EQ(90.0f, logic::metric::tile_aggregate_value(table, row, constants::PercentAligned, 1));
+    EXPECT_TRUE(std::isnan(logic::metric::tile_aggregate_value(table, row, constants::ErrorRate, 1)));
+}
+
+TEST(tile_aggregate_logic, table_is_stale_after_any_input_set_changes)
+{
+    model::metric_base::metric_set<tile_metric> tile_metrics;
+    model::metric_base::metric_set<extended_tile_metric> extended_tile_metrics;
+    model::metric_base::metric_set<error_metric> error_metrics;
+    model::metric_base::metric_set<q_metric> q_metrics;
+    tile_metrics.insert(tile_metric(1, 1101, 2000.0f, 1500.0f, 200000.0f, 150000.0f));
+    logic::summary::read_cycle_vector_t cycle_to_read;
+    cycle_to_read.push_back(logic::summary::read_cycle(1, 1));
+    cycle_to_read.push_back(logic::summary::read_cycle(1, 2));
+    cycle_to_read.back().is_last_cycle_in_read = true;
+
+    tile_aggregate_table table;
+    logic::metric::populate_tile_aggregate_table(tile_metrics, extended_tile_metrics, error_metrics, q_metrics,
+                                                 cycle_to_read, 1, table);
+    EXPECT_TRUE(logic::metric::is_tile_aggregate_table_current(tile_metrics, extended_tile_metrics, error_metrics,
+                                                               q_metrics, 1, table));
+
+    error_metrics.insert(error_metric(1, 1101, 1, 1.0f, 0.0f));
+    EXPECT_FALSE(logic::metric::is_tile_aggregate_table_current(tile_metrics, extended_tile_metrics, error_metrics,
+                                                                q_metrics, 1, table));
+    logic::metric::populate_tile_aggregate_table(tile_metrics, extended_tile_metrics, error_metrics, q_metrics,
+                                                 cycle_to_read, 1, table);
+    EXPECT_FLOAT_EQ(1.0f, table.read(0, 1).error_rate());
+
+    q_metrics.insert(q_metric(1, 1101, 1, qscore_hist(1, 3)));
+    EXPECT_FALSE(logic::metric::is_tile_aggregate_table_current(tile_metrics, extended_tile_metrics, error_metrics,
+                                                                q_metrics, 1, table));
+    logic::metric::populate_tile_aggregate_table(tile_metrics, extended_tile_metrics, error_metrics, q_metrics,
+                                                 cycle_to_read, 1, table);
+
+    error_metrics.set_version(static_cast< ::int16_t >(error_metrics.version() + 1));
+    EXPECT_FALSE(logic::metric::is_tile_aggregate_table_current(tile_metrics, extended_tile_metrics, error_metrics,
+                                                                q_metrics, 1, table));
+}
+
+TEST(tile_aggregate_logic, empty_metrics_give_empty_table)
+{
+    tile_aggregate_table table;
+    logic::metric::populate_tile_aggregate_table(model::metric_base::metric_set<tile_metric>(),
+                                                 model::metric_base::metric_set<extended_tile_metric>(),
+                                                 model::metric_base::metric_set<error_metric>(),
+                                                 model::metric_base::metric_set<q_metric>(),
+                                                 logic::summary::read_cycle_vector_t(),
+                                                 1,
+                                                 table);
+    EXPECT_TRUE(table.empty());
+    EXPECT_TRUE(logic::metric::is_tile_aggregate_table_current(model::metric_base::metric_set<tile_metric>(),
+                                                               model::metric_base::metric_set<extended_tile_metric>(),
+                                                               model::metric_base::metric_set<error_metric>(),
+                                                               model::metric_base::metric_set<q_metric>(),
+                                                               1,
+                                                               table));
+}
@@ -13,6 +13,7 @@
 
 #include <gtest/gtest.h>
 #include "interop/model/run_metrics.h"
+#include "interop/util/thread_pool.h"
 #include "src/tests/interop/metrics/inc/error_metrics_test.h"
 #include "src/tests/interop/inc/generic_fixture.h"
 #include "src/tests/interop/inc/proxy_parameter_generator.h"
@@ -96,6 +97,81 @@ TEST(error_metrics_single_test, test_tile_metric_count_for_lane)
 }
 
 
+/**
+ * @test Ensure the lane, cycle and tile lookups match the metrics and follow changes to the set
+ */
+TEST(error_metrics_single_test, test_lane_and_cycle_views)
+{
+    error_metric_set metrics;
+    metrics.insert(error_metric(1, 1101, 1, 0.5f, 0.0f));
+    metrics.insert(error_metric(1, 2101, 1, 0.5f, 0.0f));
+    metrics.insert(error_metric(2, 1101, 1, 0.5f, 0.0f));
+    metrics.insert(error_metric(1, 1102, 2, 0.5f, 0.0f));
+
+    error_metric_set::metric_view_t lane1 = metrics.lane_view(1);
+    ASSERT_EQ(lane1.size(), 3u);
+    for(error_metric_set::metric_view_t::const_iterator it = lane1.begin();it != lane1.end();++it)
+        EXPECT_EQ(it->lane(), 1u);
+    EXPECT_EQ(metrics.cycle_view(1).size(), 3u);
+    EXPECT_EQ(metrics.cycle_view(2)[0].tile(), 1102u);
+    EXPECT_TRUE(metrics.cycle_view(3).empty());
+    EXPECT_EQ(metrics.lane_tile_numbers(1).size(), 3u);
+    EXPECT_EQ(metrics.lane_tile_numbers(1).front(), 1101u);
+    EXPECT_TRUE(metrics.lane_tile_numbers(3).empty());
+    EXPECT_EQ(metrics.lane_surface_tile_numbers(1, 2, constants::FourDigit).size(), 1u);
+    EXPECT_EQ(metrics.lanes().size(), 2u);
+    EXPECT_EQ(metrics.cycles().size(), 2u);
+
+    metrics.insert(error_metric(3, 1101, 3, 0.5f, 0.0f));
+    EXPECT_EQ(metrics.lanes().size(), 3u);
+    EXPECT_EQ(metrics.metrics_for_cycle(3).size(), 1u);
+    EXPECT_EQ(metrics.metrics_for_lane(1).size(), 3u);
+}
+
+/** Read the lookups of a shared metric set, recording each mismatch */
+struct read_lookups
+{
+    read_lookups(const error_metric_set& metrics, std::vector<int>& mismatch) : m_metrics(metrics), m_mismatch(mismatch){}
+    void operator()(const size_t index)const
+    {
+        const ::uint32_t lane = static_cast< ::uint32_t >(index % 4 + 1);
+        int mismatch = 0;
+        if(m_metrics.lane_view(lane).size() != 20u) ++mismatch;
+        if(m_metrics.lane_tile_numbers(lane).size() != 20u) ++mismatch;
+        if(m_metrics.cycle_view(1).size() != 80u) ++mismatch;
+        if(m_metrics.lane_surface_tile_numbers(lane, 1, constants::FourDigit).size() != 10u) ++mismatch;
+        if(m_metrics.lane_surface_tile_numbers(lane, 2, constants::FiveDigit).size() != 10u) ++mismatch;
+        if(m_metrics.lanes().size() != 4u) ++mismatch;
+        m_mismatch[index] = mismatch;
+    }
+    const error_metric_set& m_metrics;
+    std::vector<int>& m_mismatch;
+};
+
+/**
+ * @test Ensure concurrent readers build the lookups of the same metric set once, each seeing the full lookup
+ */
+TEST(error_metrics_single_test, test_concurrent_lookups)
+{
+    error_metric_set metrics;
+    for(::uint32_t lane = 1;lane <= 4;++lane)
+    {
+        for(::uint32_t tile = 1;tile <= 10;++tile)
+        {
+            metrics.insert(error_metric(lane, 1100+tile, 1, 0.5f, 0.0f));
+            metrics.insert(error_metric(lane, 21100+tile, 1, 0.5f, 0.0f));
+        }
+    }
+    for(size_t trial = 0;trial < 20;++trial)
+    {
+        error_metric_set copy(metrics);
+        std::vector<int> mismatch(64, 0);
+        read_lookups body(copy, mismatch);
+        util::parallel_for_each_index(mismatch.size(), body, 8);
+        for(size_t i = 0;i < mismatch.size();++i) EXPECT_EQ(mismatch[i], 0) << "reader " << i;
+    }
+}
+
 /**
  * @test Ensure the adapter sequences are correct in header
  */
@@ -12,8 +12,12 @@
 #endif
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include "interop/io/metric_stream.h"
 #include "interop/io/metric_file_stream.h"
+#include "interop/util/length_of.h"
 #include "src/tests/interop/metrics/inc/metric_format_fixtures.h"
 #include "src/tests/interop/run/info_test.h"
 
@@ -21,6 +25,44 @@ using namespace illumina::interop;
 using namespace illumina::interop::unittest;
 
 
+/** Write data to a gzip file using uncompressed deflate blocks
+ *
+ * @param file_name destination file
+ * @param data uncompressed data
+ * @param append append another gzip member to the file
+ */
+static void write_stored_gzip(const std::string& file_name, const std::string& data, const bool append=false)
+{
+    ::uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        crc ^= static_cast<unsigned char>(data[i]);
+        for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    crc ^= 0xFFFFFFFFu;
+    std::ofstream fout(file_name.c_str(), append ? std::ios::binary | std::ios::app : std::ios::binary);
+    const unsigned char header[] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+    fout.write(reinterpret_cast<const char*>(header), sizeof(header));
+    size_t offset = 0;
+    do
+    {
+        const size_t length = std::min(data.size() - offset, static_cast<size_t>(0xFFFF));
+        const bool is_final = offset + length == data.size();
+        fout.put(static_cast<char>(is_final ? 1 : 0));
+        fout.put(static_cast<char>(length & 0xFF));
+        fout.put(static_cast<char>(length >> 8));
+        fout.put(static_cast<char>(~length & 0xFF));
+        fout.put(static_cast<char>((~length >> 8) & 0xFF));
+        fout.write(data.data() + offset, static_cast<std::streamsize>(length));
+        offset += length;
+    } while (offset < data.size());
+    const ::uint32_t trailer[] = {crc, static_cast< ::uint32_t >(data.size())};
+    for (size_t i = 0; i < util::length_of(trailer); ++i)
+    {
+        for (int k = 0; k < 4; ++k) fout.put(static_cast<char>((trailer[i] >> (8 * k)) & 0xFF));
+    }
+}
+
 /** Fixture for expected vs actual binary data */
 template<typename TestSetup>
 struct metric_stream_test : public ::testing::Test, public TestSetup
@@ -123,6 +165,146 @@ TYPED_TEST_P(metric_stream_test, test_write_data_size)
     EXPECT_NO_THROW(io::write_interop_to_buffer(metrics, &buffer.front(), buffer.size()));
 }
 
+/** Confirm records outside the read filter are skipped and all others are read
+ */
+TYPED_TEST_P(metric_stream_test, test_read_filter)
+{
+    typedef typename TypeParam::metric_set_t metric_set_t;
+    typedef typename metric_set_t::metric_comparison_t metric_comparison_t;
+    metric_set_t metrics;
+    TypeParam::create_expected(metrics);
+    std::string tmp;
+    io::write_interop_to_string(tmp, metrics);
+    metric_set_t all_metrics;
+    io::read_interop_from_string(tmp, all_metrics);
+    if (all_metrics.empty()) return;
+    const ::uint32_t lane = static_cast< ::uint32_t >(metric_comparison_t::to_lane(all_metrics[0]));
+    size_t expected_count = 0;
+    for (size_t i = 0; i < all_metrics.size(); ++i)
+    {
+        if (metric_comparison_t::to_lane(all_metrics[i]) == lane) ++expected_count;
+    }
+
+    metric_set_t buffered_metrics;
+    buffered_metrics.read_filter(model::metric_base::record_filter(lane));
+    io::read_interop_from_string(tmp, buffered_metrics);
+    ASSERT_EQ(expected_count, buffered_metrics.size());
+
+    metric_set_t streamed_metrics;
+    streamed_metrics.read_filter(model::metric_base::record_filter(lane));
+    std::istringstream in(tmp);
+    io::read_metrics(in, streamed_metrics, 0);
+    ASSERT_EQ(expected_count, streamed_metrics.size());
+    for (size_t i = 0; i < streamed_metrics.size(); ++i)
+    {
+        EXPECT_EQ(lane, static_cast< ::uint32_t >(metric_comparison_t::to_lane(streamed_metrics[i])));
+        EXPECT_EQ(metric_comparison_t::to_id(buffered_metrics[i]), metric_comparison_t::to_id(streamed_metrics[i]));
+    }
+}
+
+/** Confirm reading through the double buffer gives the same records for small and large buffers
+ */
+TYPED_TEST_P(metric_stream_test, test_read_double_buffered)
+{
+    typedef typename TypeParam::metric_set_t metric_set_t;
+    typedef typename metric_set_t::metric_comparison_t metric_comparison_t;
+    metric_set_t metrics;
+    TypeParam::create_expected(metrics);
+    std::string tmp;
+    io::write_interop_to_string(tmp, metrics);
+    metric_set_t expected_metrics;
+    io::read_interop_from_string(tmp, expected_metrics);
+
+    const size_t buffer_sizes[] = {1, 7, tmp.size()+1};
+    for (size_t b = 0; b < util::length_of(buffer_sizes); ++b)
+    {
+        metric_set_t actual_metrics;
+        std::istringstream in(tmp);
+        io::read_metrics_double_buffered(in, actual_metrics, tmp.size(), buffer_sizes[b]);
+        EXPECT_EQ(expected_metrics.version(), actual_metrics.version());
+        ASSERT_EQ(expected_metrics.size(), actual_metrics.size());
+        for (size_t i = 0; i < actual_metrics.size(); ++i)
+        {
+            EXPECT_EQ(metric_comparison_t::to_id(expected_metrics[i]), metric_comparison_t::to_id(actual_metrics[i]));
+        }
+    }
+}
+
+/** Confirm a gzip compressed InterOp file gives the same records as the uncompressed file
+ */
+TYPED_TEST_P(metric_stream_test, test_read_gzip)
+{
+    typedef typename TypeParam::metric_set_t metric_set_t;
+    typedef typename metric_set_t::metric_comparison_t metric_comparison_t;
+    if (!io::is_gzip_supported()) return;
+    metric_set_t metrics;
+    TypeParam::create_expected(metrics);
+    std::string tmp;
+    io::write_interop_to_string(tmp, metrics);
+    metric_set_t expected_metrics;
+    io::read_interop_from_string(tmp, expected_metrics);
+
+    const std::string file_name = "metric_stream_test_read_gzip.bin";
+    write_stored_gzip(file_name + ".gz", tmp);
+    metric_set_t actual_metrics;
+    const bool found = io::read_interop_gzip(file_name, actual_metrics);
+    std::remove((file_name + ".gz").c_str());
+    ASSERT_TRUE(found);
+    EXPECT_EQ(expected_metrics.version(), actual_metrics.version());
+    ASSERT_EQ(expected_metrics.size(), actual_metrics.size());
+    for (size_t i = 0; i < actual_metrics.size(); ++i)
+    {
+        EXPECT_EQ(metric_comparison_t::to_id(expected_metrics[i]), metric_comparison_t::to_id(actual_metrics[i]));
+    }
+    metric_set_t missing_metrics;
+    EXPECT_FALSE(io::read_interop_gzip(file_name, missing_metrics));
+}
+
+/** Confirm the size in the gzip trailer is rejected when deflate cannot reach it from the compressed size
+ */
+TEST(metric_stream_test, gzip_size_hint_bounds)
+{
+    const std::string file_name = "metric_stream_test_gzip_size_hint.gz";
+    const ::uint32_t sizes[] = {10u, 1000u, 0xFFFFFFFFu};
+    const size_t expected[] = {0u, 1000u, 0u};
+    for (size_t i = 0; i < util::length_of(sizes); ++i)
+    {
+        {
+            std::ofstream fout(file_name.c_str(), std::ios::binary);
+            fout << std::string(20, '\0');
+            for (int k = 0; k < 4; ++k) fout.put(static_cast<char>((sizes[i] >> (8 * k)) & 0xFF));
+        }
+        EXPECT_EQ(expected[i], io::detail::gzip_uncompressed_size_hint(file_name)) << sizes[i];
+    }
+    std::remove(file_name.c_str());
+}
+
+/** Confirm a gzip file of several members, whose trailer only gives the size of the last member, is read in full
+ */
+TEST(metric_stream_test, read_gzip_multiple_members)
+{
+    if (!io::is_gzip_supported()) return;
+    typedef model::metric_base::metric_set<model::metrics::error_metric> error_metric_set;
+    error_metric_set metrics(model::metrics::error_metric::LATEST_VERSION);
+    for (::uint32_t cycle = 1; cycle <= 100; ++cycle)
+        metrics.insert(model::metrics::error_metric(1, 1101, cycle, 0.5f, 0.0f));
+    std::string tmp;
+    io::write_interop_to_string(tmp, metrics);
+
+    const std::string file_name = "metric_stream_test_read_gzip_members.bin";
+    const size_t split = tmp.size() - 16;
+    write_stored_gzip(file_name + ".gz", tmp.substr(0, split));
+    write_stored_gzip(file_name + ".gz", tmp.substr(split), true);
+    EXPECT_EQ(0u, io::detail::gzip_uncompressed_size_hint(file_name + ".gz"));
+    error_metric_set actual_metrics;
+    const bool found = io::read_interop_gzip(file_name, actual_metrics);
+    std::remove((file_name + ".gz").c_str());
+    ASSERT_TRUE(found);
+    ASSERT_EQ(metrics.size(), actual_metrics.size());
+    for (size_t i = 0; i < metrics.size(); ++i)
+        EXPECT_EQ(metrics[i].id(), actual_metrics[i].id());
+}
+
 TEST(metric_stream_test, list_filenames)
 {
     std::vector<std::string> error_metric_files;
@@ -167,7 +349,10 @@ REGISTER_TYPED_TEST_CASE_P(metric_stream_test,
                            test_read_data_size,
                            test_header_size,
                            test_write_read_binary_data,
-                           test_write_data_size
+                           test_write_data_size,
+                           test_read_filter,
+                           test_read_double_buffered,
+                           test_read_gzip
 );
 
 
@@ -8,6 +8,7 @@
  */
 
 #include <limits>
+#include <numeric>
 #include <gtest/gtest.h>
 #include "interop/model/run_metrics.h"
 #include "src/tests/interop/metrics/inc/q_metrics_test.h"
@@ -180,6 +181,188 @@ TEST(q_metrics_test, test_cumulative_reorder)
     EXPECT_EQ(q_metric_set[3].sum_qscore_cumulative(), qsum);
 }
 
+/**
+ * @class illumina::interop::model::metrics::q_metrics
+ * @test Confirm the single pass derivation matches creating each derived set separately
+ */
+TEST(q_metrics_test, test_create_derived_matches_separate)
+{
+    typedef metric_test<q_metric, 0> helper_t;
+
+    uint64_t hist_all0[] = {0, 267963, 118702, 4281, 2796111, 0, 0};
+    uint64_t hist_all1[] = {0, 267962, 118703, 4284, 2796110, 0, 0};
+    uint64_t hist_all2[] = {0, 241483, 44960, 1100, 2899568, 0 ,0};
+    uint64_t hist_all3[] = {0, 212144, 53942, 427, 2920598, 0, 0};
+
+    std::vector<q_metric> q_metric_vec;
+    q_metric_vec.push_back(q_metric(7, 1114, 2, helper_t::to_vector(hist_all2)));
+    q_metric_vec.push_back(q_metric(7, 1114, 1, helper_t::to_vector(hist_all1)));
+    q_metric_vec.push_back(q_metric(6, 1114, 1, helper_t::to_vector(hist_all0)));
+    q_metric_vec.push_back(q_metric(7, 1114, 3, helper_t::to_vector(hist_all3)));
+    q_metric_vec.push_back(q_metric(7, 1115, 1, helper_t::to_vector(hist_all0)));
+
+    metric_set<q_metric> expected(q_metric_vec, 6, q_metric::header_type());
+    metric_set<q_metric> actual(expected);
+    metric_set<q_collapsed_metric> expected_collapsed;
+    metric_set<q_by_lane_metric> expected_bylane;
+    logic::metric::create_collapse_q_metrics(expected, expected_collapsed);
+    logic::metric::create_q_metrics_by_lane(expected, expected_bylane, constants::HiSeq);
+    logic::metric::populate_cumulative_distribution(expected);
+    logic::metric::populate_cumulative_distribution(expected_collapsed);
+    logic::metric::populate_cumulative_distribution(expected_bylane);
+
+    metric_set<q_collapsed_metric> actual_collapsed;
+    metric_set<q_by_lane_metric> actual_bylane;
+    logic::metric::create_derived_q_metrics(actual, actual_collapsed, actual_bylane, constants::HiSeq);
+    actual.rebuild_index(true);
+
+    ASSERT_EQ(actual.size(), expected.size());
+    ASSERT_EQ(actual_collapsed.size(), expected_collapsed.size());
+    ASSERT_EQ(actual_bylane.size(), expected_bylane.size());
+    for(size_t i=0;i<expected.size();++i)
+    {
+        const q_metric& actual_metric = actual.get_metric(expected[i].lane(), expected[i].tile(), expected[i].cycle());
+        EXPECT_EQ(actual_metric.sum_qscore_cumulative(), expected[i].sum_qscore_cumulative());
+
+        const q_collapsed_metric& expected_c = expected_collapsed[i];
+        const q_collapsed_metric& actual_c = actual_collapsed.get_metric(expected_c.lane(), expected_c.tile(),
+                                                                         expected_c.cycle());
+        EXPECT_EQ(actual_c.q20(), expected_c.q20());
+        EXPECT_EQ(actual_c.q30(), expected_c.q30());
+        EXPECT_EQ(actual_c.total(), expected_c.total());
+        EXPECT_EQ(actual_c.median_qscore(), expected_c.median_qscore());
+        EXPECT_EQ(actual_c.cumulative_q20(), expected_c.cumulative_q20());
+        EXPECT_EQ(actual_c.cumulative_q30(), expected_c.cumulative_q30());
+        EXPECT_EQ(actual_c.cumulative_total(), expected_c.cumulative_total());
+    }
+    for(size_t i=0;i<expected_bylane.size();++i)
+    {
+        const q_by_lane_metric& actual_metric = actual_bylane.get_metric(expected_bylane[i].lane(), 0,
+                                                                         expected_bylane[i].cycle());
+        EXPECT_EQ(actual_metric.qscore_hist(), expected_bylane[i].qscore_hist());
+        EXPECT_EQ(actual_metric.sum_qscore_cumulative(), expected_bylane[i].sum_qscore_cumulative());
+    }
+}
+
+/**
+ * @class illumina::interop::model::metrics::q_metrics
+ * @test Confirm the cumulative histogram computed on demand matches the stored cumulative histogram
+ */
+TEST(q_metrics_test, test_cumulative_on_demand)
+{
+    typedef metric_test<q_metric, 0> helper_t;
+
+    uint64_t hist_all1[] = {0, 267962, 118703, 4284, 2796110, 0, 0};
+    uint64_t hist_all2[] = {0, 241483, 44960, 1100, 2899568, 0 ,0};
+    uint64_t hist_all3[] = {0, 212144, 53942, 427, 2920598, 0, 0};
+
+    std::vector<q_metric> q_metric_vec;
+    q_metric_vec.push_back(q_metric(7, 1114, 1, helper_t::to_vector(hist_all1)));
+    q_metric_vec.push_back(q_metric(7, 1114, 2, helper_t::to_vector(hist_all2)));
+    q_metric_vec.push_back(q_metric(7, 1115, 1, helper_t::to_vector(hist_all2)));
+    q_metric_vec.push_back(q_metric(7, 1114, 3, helper_t::to_vector(hist_all3)));
+
+    metric_set<q_metric> expected(q_metric_vec, 6, q_metric::header_type());
+    metric_set<q_metric> actual(expected);
+    metric_set<q_collapsed_metric> expected_collapsed;
+    metric_set<q_by_lane_metric> expected_bylane;
+    metric_set<q_collapsed_metric> actual_collapsed;
+    metric_set<q_by_lane_metric> actual_bylane;
+    logic::metric::create_derived_q_metrics(expected, expected_collapsed, expected_bylane, constants::HiSeq);
+    logic::metric::create_derived_q_metrics(actual, actual_collapsed, actual_bylane, constants::HiSeq, false);
+
+    for(size_t i=0;i<actual.size();++i)
+    {
+        EXPECT_TRUE(actual[i].is_cumulative_empty());
+        EXPECT_EQ(actual_collapsed[i].cumulative_q30(), expected_collapsed[i].cumulative_q30());
+        EXPECT_EQ(actual_collapsed[i].cumulative_total(), expected_collapsed[i].cumulative_total());
+    }
+    std::vector< ::uint64_t > hist;
+    logic::metric::cumulative_qscore_hist(actual, 7, 1114, 3, hist);
+    EXPECT_EQ(std::accumulate(hist.begin(), hist.end(), ::uint64_t(0)), expected[3].sum_qscore_cumulative());
+    EXPECT_EQ(std::accumulate(hist.begin()+3, hist.end(), ::uint64_t(0)), expected[3].total_over_qscore_cumulative(3));
+    actual.clear_lookup();
+    logic::metric::cumulative_qscore_hist(actual, 7, 1114, 2, hist);
+    EXPECT_EQ(std::accumulate(hist.begin(), hist.end(), ::uint64_t(0)), expected[1].sum_qscore_cumulative());
+}
+
+/**
+ * @class illumina::interop::model::metrics::q_metrics
+ * @test Confirm the q-score cube sums the histograms of the tiles by lane, surface and cycle
+ */
+TEST(q_metrics_test, test_qscore_cube)
+{
+    typedef metric_test<q_metric, 0> helper_t;
+
+    uint64_t hist_all0[] = {0, 267963, 118702, 4281, 2796111, 0, 0};
+    uint64_t hist_all1[] = {0, 267962, 118703, 4284, 2796110, 0, 0};
+    uint64_t hist_all2[] = {0, 241483, 44960, 1100, 2899568, 0 ,0};
+    uint64_t hist_all3[] = {0, 212144, 53942, 427, 2920598, 0, 0};
+
+    std::vector<q_metric> q_metric_vec;
+    q_metric_vec.push_back(q_metric(7, 1114, 1, helper_t::to_vector(hist_all1)));
+    q_metric_vec.push_back(q_metric(7, 1114, 2, helper_t::to_vector(hist_all2)));
+    q_metric_vec.push_back(q_metric(7, 2114, 1, helper_t::to_vector(hist_all3)));
+    q_metric_vec.push_back(q_metric(6, 1114, 1, helper_t::to_vector(hist_all0)));
+    q_metric_set metrics(q_metric_vec, 6, q_metric::header_type());
+
+    q_score_cube cube;
+    logic::metric::populate_qscore_cube(metrics, constants::FourDigit, 1, cube);
+    EXPECT_TRUE(logic::metric::is_qscore_cube_current(metrics, constants::FourDigit, 1, cube));
+    EXPECT_FALSE(logic::metric::is_qscore_cube_current(metrics, constants::FourDigit, 2, cube));
+    EXPECT_FALSE(logic::metric::is_qscore_cube_current(metrics, constants::FiveDigit, 1, cube));
+    EXPECT_EQ(cube.lane_count(), 7u);
+    EXPECT_EQ(cube.surface_count(), 2u);
+    EXPECT_EQ(cube.cycle_count(), 2u);
+    EXPECT_EQ(cube.bin_count(), util::length_of(hist_all0));
+    EXPECT_EQ(cube.record_count(), metrics.size());
+    EXPECT_EQ(cube.record_count(7, 1, 1), 1u);
+    EXPECT_EQ(cube.record_count(7, 2, 2), 0u);
+
+    q_score_cube::count_vector_t hist;
+    cube.sum_histogram(7, 1, 1, 2, hist);
+    EXPECT_EQ(util::histogram_sum(hist.begin(), hist.end()), metrics[0].sum_qscore() + metrics[1].sum_qscore());
+    EXPECT_EQ(util::histogram_tail_sum(hist.begin(), hist.end(), 3),
+              metrics[0].total_over_qscore(size_t(3)) + metrics[1].total_over_qscore(size_t(3)));
+    cube.sum_histogram(q_score_cube::ALL, 2, 1, 2, hist);
+    EXPECT_EQ(util::histogram_sum(hist.begin(), hist.end()), metrics[2].sum_qscore());
+    cube.sum_histogram(q_score_cube::ALL, q_score_cube::ALL, 1, 1, hist);
+    EXPECT_EQ(util::histogram_sum(hist.begin(), hist.end()),
+              metrics[0].sum_qscore() + metrics[2].sum_qscore() + metrics[3].sum_qscore());
+    EXPECT_EQ(util::histogram_median_index(hist.begin(), hist.end(), util::histogram_sum(hist.begin(), hist.end())),
+              4u);
+
+    metrics.insert(q_metric(6, 1114, 2, helper_t::to_vector(hist_all0)));
+    EXPECT_FALSE(logic::metric::is_qscore_cube_current(metrics, constants::FourDigit, 1, cube));
+    logic::metric::populate_qscore_cube(metrics, constants::FourDigit, 1, cube);
+    metrics.trim(metrics.size() - 1);
+    metrics.insert(q_metric(6, 1114, 3, helper_t::to_vector(hist_all0)));
+    EXPECT_FALSE(logic::metric::is_qscore_cube_current(metrics, constants::FourDigit, 1, cube));
+}
+
+/**
+ * @class illumina::interop::model::metrics::q_metrics
+ * @test Confirm rebuild_index releases unused capacity only when requested and keeps the histograms
+ */
+TEST(q_metrics_test, test_rebuild_index_shrink)
+{
+    typedef metric_test<q_metric, 0> helper_t;
+    uint64_t hist_all1[] = {0, 267962, 118703, 4284, 2796110, 0, 0};
+
+    metric_set<q_metric> q_metric_set;
+    q_metric_set.reserve(64);
+    q_metric_set.insert(q_metric(7, 1114, 1, helper_t::to_vector(hist_all1)));
+    q_metric_set.insert(q_metric(7, 1114, 2, helper_t::to_vector(hist_all1)));
+    const uint64_t expected_sum = q_metric_set[1].sum_qscore();
+
+    q_metric_set.rebuild_index(false, false);
+    EXPECT_EQ(q_metric_set.metrics().capacity(), 64u);
+    q_metric_set.rebuild_index();
+    EXPECT_LT(q_metric_set.metrics().capacity(), 64u);
+    EXPECT_EQ(q_metric_set.size(), 2u);
+    EXPECT_EQ(q_metric_set[1].sum_qscore(), expected_sum);
+}
+
 TEST(q_metrics_test, test_percent_over_q30_unbinned)
 {
     q_score_header header;
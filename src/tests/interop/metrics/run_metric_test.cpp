@@ -12,6 +12,8 @@
 #include "src/tests/interop/metrics/inc/metric_format_fixtures.h"
 #include "interop/logic/utils/metrics_to_load.h"
 #include "interop/logic/table/create_imaging_table.h"
+#include "interop/model/run_metrics_snapshot.h"
+#include "interop/util/thread_pool.h"
 
 
 using namespace illumina::interop;
@@ -107,6 +109,192 @@ TEST(run_metric_test, summary_subset_of_imaging)
     }
 }
 
+TEST(run_metric_test, validate_truncates_cycles_beyond_run_info)
+{
+    std::vector<model::run::read_info> reads(1, model::run::read_info(1, 1, 3));
+    model::run::flowcell_layout layout(2, 2, 2, 16, 1, 1, std::vector<std::string>(), constants::FourDigit);
+    model::metrics::run_metrics metrics(model::run::info(layout, reads));
+    for(::uint32_t cycle=1;cycle<=5;++cycle)
+    {
+        metrics.get<model::metrics::error_metric>().insert(model::metrics::error_metric(1, 1101, cycle, 0.5f, 0.0f));
+        metrics.get<model::metrics::error_metric>().insert(model::metrics::error_metric(2, 2201, cycle, 0.5f, 0.0f));
+    }
+    EXPECT_THROW(metrics.validate(), model::invalid_run_info_cycle_exception);
+    const model::metric_base::metric_set<model::metrics::error_metric>& error_metrics =
+            metrics.get<model::metrics::error_metric>();
+    ASSERT_EQ(error_metrics.size(), 6u);
+    for(size_t i=0;i<error_metrics.size();++i)
+    {
+        EXPECT_LE(error_metrics[i].cycle(), 3u);
+        EXPECT_TRUE(error_metrics.has_metric(error_metrics[i].lane(), error_metrics[i].tile(), error_metrics[i].cycle()));
+    }
+    EXPECT_FALSE(error_metrics.has_metric(1, 1101, 4));
+    EXPECT_NO_THROW(metrics.validate());
+}
+
+TEST(run_metric_test, validate_rejects_tile_beyond_run_info)
+{
+    std::vector<model::run::read_info> reads(1, model::run::read_info(1, 1, 3));
+    model::run::flowcell_layout layout(2, 2, 2, 16, 1, 1, std::vector<std::string>(), constants::FourDigit);
+    model::metrics::run_metrics metrics(model::run::info(layout, reads));
+    metrics.get<model::metrics::error_metric>().insert(model::metrics::error_metric(1, 1101, 1, 0.5f, 0.0f));
+    metrics.get<model::metrics::error_metric>().insert(model::metrics::error_metric(1, 1199, 1, 0.5f, 0.0f));
+    EXPECT_THROW(metrics.validate(), model::invalid_run_info_exception);
+}
+
+namespace
+{
+    /** Find the timing of a finalize step by name
+     *
+     * @param timings timing of each step
+     * @param name name of the step
+     * @return timing of the step, or a timing that did not run if the step is missing
+     */
+    util::task_timing find_step(const std::vector<util::task_timing>& timings, const std::string& name)
+    {
+        for(size_t i=0;i<timings.size();++i)
+            if(timings[i].name == name) return timings[i];
+        return util::task_timing();
+    }
+}
+
+TEST(run_metric_test, finalize_reports_step_timings)
+{
+    std::vector<model::run::read_info> reads(1, model::run::read_info(1, 1, 3));
+    model::run::flowcell_layout layout(2, 2, 2, 16, 1, 1, std::vector<std::string>(), constants::FourDigit);
+    model::metrics::run_metrics metrics(model::run::info(layout, reads, std::vector<std::string>(2, "Red")));
+    metrics.get<model::metrics::error_metric>().insert(model::metrics::error_metric(1, 1101, 1, 0.5f, 0.0f));
+    metrics.finalize_after_load();
+    const std::vector<util::task_timing>& timings = metrics.finalize_timings();
+    const char* steps[] = {"tile_naming", "rebuild_index", "populate_indices", "legacy_q_bins", "derived_q_metrics",
+                           "percent_occupied", "channels", "validate", "dynamic_phasing", "tile_aggregates"};
+    EXPECT_EQ(sizeof(steps) / sizeof(steps[0]), timings.size());
+    for(size_t i=0;i<sizeof(steps) / sizeof(steps[0]);++i)
+    {
+        const util::task_timing timing = find_step(timings, steps[i]);
+        EXPECT_TRUE(timing.ran) << steps[i];
+        EXPECT_GE(timing.duration, 0.0) << steps[i];
+    }
+}
+
+TEST(run_metric_test, finalize_skips_steps_after_failed_validation)
+{
+    std::vector<model::run::read_info> reads(1, model::run::read_info(1, 1, 3));
+    model::run::flowcell_layout layout(2, 2, 2, 16, 1, 1, std::vector<std::string>(), constants::FourDigit);
+    model::metrics::run_metrics metrics(model::run::info(layout, reads, std::vector<std::string>(2, "Red")));
+    for(::uint32_t cycle=1;cycle<=5;++cycle)
+        metrics.get<model::metrics::error_metric>().insert(model::metrics::error_metric(1, 1101, cycle, 0.5f, 0.0f));
+    EXPECT_THROW(metrics.finalize_after_load(), model::invalid_run_info_cycle_exception);
+    const std::vector<util::task_timing>& timings = metrics.finalize_timings();
+    EXPECT_TRUE(find_step(timings, "derived_q_metrics").ran);
+    EXPECT_TRUE(find_step(timings, "channels").ran);
+    EXPECT_FALSE(find_step(timings, "validate").ran);
+    EXPECT_FALSE(find_step(timings, "dynamic_phasing").ran);
+    EXPECT_FALSE(find_step(timings, "tile_aggregates").ran);
+}
+
+TEST(run_metric_test, qscore_cube_follows_q_metrics)
+{
+    std::vector<model::run::read_info> reads(1, model::run::read_info(1, 1, 3));
+    model::run::flowcell_layout layout(2, 2, 2, 16, 1, 1, std::vector<std::string>(), constants::FourDigit);
+    model::metrics::run_metrics metrics(model::run::info(layout, reads, std::vector<std::string>(2, "Red")));
+    const std::vector< ::uint64_t > hist(50, 1);
+    metrics.get<model::metrics::q_metric>().insert(model::metrics::q_metric(1, 1101, 1, hist));
+    EXPECT_EQ(1u, metrics.qscore_cube().record_count());
+
+    metrics.get<model::metrics::q_metric>().insert(model::metrics::q_metric(1, 2101, 1, hist));
+    EXPECT_EQ(2u, metrics.qscore_cube().record_count());
+    EXPECT_EQ(2u, metrics.qscore_cube().surface_count());
+
+    // Same number of records, but a different cycle
+    metrics.get<model::metrics::q_metric>().trim(1);
+    metrics.get<model::metrics::q_metric>().insert(model::metrics::q_metric(1, 1101, 2, hist));
+    EXPECT_EQ(1u, metrics.qscore_cube().surface_count());
+    EXPECT_EQ(2u, metrics.qscore_cube().cycle_count());
+
+    metrics.get<model::metrics::q_metric>().clear();
+    EXPECT_TRUE(metrics.qscore_cube().empty());
+}
+
+TEST(run_metric_test, snapshot_keeps_published_version)
+{
+    model::metrics::run_metrics_publisher publisher;
+    EXPECT_EQ(0u, publisher.version());
+    EXPECT_TRUE(publisher.snapshot().empty());
+    EXPECT_THROW(publisher.snapshot().metrics(), model::invalid_parameter);
+
+    model::metrics::run_metrics metrics;
+    metrics.set_result_cache_size(4);
+    metrics.get<model::metrics::error_metric>().insert(model::metrics::error_metric(1, 1101, 1, 0.5f, 0.0f));
+    const model::metrics::run_metrics_snapshot first = publisher.publish(metrics);
+    EXPECT_EQ(1u, first.version());
+    EXPECT_EQ(0u, first->result_cache_size());
+    EXPECT_EQ(model::metrics::q_collapsed_metric::LATEST_VERSION,
+              first->get<model::metrics::q_collapsed_metric>().version());
+
+    metrics.get<model::metrics::error_metric>().insert(model::metrics::error_metric(1, 1101, 2, 0.5f, 0.0f));
+    publisher.publish(metrics);
+    EXPECT_EQ(2u, publisher.version());
+    EXPECT_EQ(1u, first->get<model::metrics::error_metric>().size());
+
+    model::metrics::run_metrics_snapshot current;
+    current = publisher.snapshot();
+    EXPECT_EQ(2u, current.version());
+    EXPECT_EQ(2u, (*current).get<model::metrics::error_metric>().size());
+    EXPECT_EQ(4u, metrics.result_cache_size());
+}
+
+namespace
+{
+    /** Publish versions from the first task while the other tasks take snapshots
+     *
+     * Version i holds i error metrics, so a reader can check that each snapshot is consistent.
+     */
+    struct publish_while_reading
+    {
+        publish_while_reading(model::metrics::run_metrics_publisher& publisher,
+                              const size_t version_count,
+                              const size_t task_count) :
+                m_publisher(publisher), m_version_count(version_count), m_inconsistent(task_count, 0){}
+        void operator()(const size_t index)
+        {
+            if(index == 0)
+            {
+                model::metrics::run_metrics metrics;
+                for(size_t i=1;i<=m_version_count;++i)
+                {
+                    metrics.get<model::metrics::error_metric>().insert(
+                            model::metrics::error_metric(1, 1101, static_cast< ::uint32_t >(i), 0.5f, 0.0f));
+                    m_publisher.publish(metrics);
+                }
+                return;
+            }
+            for(size_t i=0;i<m_version_count;++i)
+            {
+                const model::metrics::run_metrics_snapshot snapshot = m_publisher.snapshot();
+                if(snapshot.empty()) continue;
+                if(snapshot->get<model::metrics::error_metric>().size() != snapshot.version())
+                    ++m_inconsistent[index];
+            }
+        }
+        model::metrics::run_metrics_publisher& m_publisher;
+        size_t m_version_count;
+        std::vector<size_t> m_inconsistent;
+    };
+}
+
+TEST(run_metric_test, snapshot_while_publishing)
+{
+    const size_t version_count = 50;
+    const size_t task_count = 8;
+    model::metrics::run_metrics_publisher publisher;
+    publish_while_reading body(publisher, version_count, task_count);
+    util::parallel_for_each_index(task_count, body, 4);
+    for(size_t i=0;i<task_count;++i) EXPECT_EQ(0u, body.m_inconsistent[i]) << "Task: " << i;
+    EXPECT_EQ(version_count, publisher.version());
+    EXPECT_EQ(version_count, publisher.snapshot()->get<model::metrics::error_metric>().size());
+}
+
 TYPED_TEST_P(run_metric_test, append_tiles)
 {
     typedef typename TestFixture::metric_set_t metric_set_t;
@@ -0,0 +1,88 @@
+/** Unit tests for the fixed capacity vector
+*
+*
+*  @file
+*  @date 10/18/2026
+*  @version 1.0
+*  @copyright GNU Public License.
+*/
+#include <sstream>
+#include <gtest/gtest.h>
+#include "interop/util/fixed_vector.h"
+#include "interop/io/format/map_io.h"
+
+using namespace illumina::interop;
+
+typedef util::fixed_vector< ::uint16_t, 4 > ushort_array_t;
+
+TEST(fixed_vector_test, construct_fill)
+{
+    ushort_array_t values(3, 7);
+    EXPECT_EQ(values.size(), 3u);
+    EXPECT_EQ(ushort_array_t::capacity(), 4u);
+    for(size_t i=0;i<values.size();++i) EXPECT_EQ(values[i], 7);
+}
+
+TEST(fixed_vector_test, construct_from_pointer_range)
+{
+    const ::uint16_t source[] = {1, 2, 3, 4};
+    util::fixed_vector<float, 4> values(source, source+4);
+    EXPECT_EQ(values.size(), 4u);
+    EXPECT_FLOAT_EQ(values.back(), 4.0f);
+}
+
+TEST(fixed_vector_test, construct_from_vector)
+{
+    const ::uint16_t source[] = {1, 2, 3};
+    const std::vector< ::uint16_t > vec = util::to_vector(source);
+    ushort_array_t values(vec);
+    EXPECT_EQ(values.to_vector(), vec);
+}
+
+TEST(fixed_vector_test, resize_keeps_values)
+{
+    const ::uint16_t source[] = {1, 2, 3, 4};
+    ushort_array_t values(source, source+4);
+    values.resize(2);
+    EXPECT_EQ(values.size(), 2u);
+    values.resize(3, 9);
+    EXPECT_EQ(values[1], 2);
+    EXPECT_EQ(values[2], 9);
+    EXPECT_EQ(util::length_of(values), 3u);
+}
+
+TEST(fixed_vector_test, exceeds_capacity)
+{
+    ushort_array_t values(4, 0);
+    EXPECT_THROW(values.push_back(1), std::length_error);
+    EXPECT_THROW(values.resize(5), std::length_error);
+}
+
+TEST(fixed_vector_test, equality)
+{
+    ushort_array_t values1(2, 1);
+    ushort_array_t values2(2, 1);
+    EXPECT_TRUE(values1 == values2);
+    values2[1] = 3;
+    EXPECT_TRUE(values1 != values2);
+}
+
+TEST(fixed_vector_test, stream_map_round_trip)
+{
+    const ::uint16_t source[] = {10, 20, 30};
+    ushort_array_t expected(source, source+3);
+    std::ostringstream out;
+    io::stream_map< ::uint16_t >(out, expected, expected.size());
+
+    std::istringstream in(out.str());
+    ushort_array_t actual;
+    io::stream_map< ::uint16_t >(in, actual, expected.size());
+    EXPECT_EQ(actual.to_vector(), expected.to_vector());
+}
+
+TEST(fixed_vector_test, stream_map_rejects_too_many_values)
+{
+    std::istringstream in(std::string(10, '\0'));
+    ushort_array_t actual;
+    EXPECT_THROW(io::stream_map< ::uint16_t >(in, actual, 5), io::bad_format_exception);
+}
@@ -0,0 +1,55 @@
+/** Unit tests for the histogram reductions
+*
+*
+*  @file
+*  @date 10/19/2026
+*  @version 1.0
+*  @copyright GNU Public License.
+*/
+#include <vector>
+#include <numeric>
+#include <gtest/gtest.h>
+#include "interop/util/histogram.h"
+#include "interop/util/length_of.h"
+
+using namespace illumina::interop;
+
+TEST(histogram_test, sum_matches_accumulate)
+{
+    std::vector< ::uint64_t > hist;
+    for(size_t n=0;n<11;++n)
+    {
+        EXPECT_EQ(util::histogram_sum(hist.begin(), hist.end()),
+                  std::accumulate(hist.begin(), hist.end(), ::uint64_t(0)));
+        hist.push_back(n*1000+7);
+    }
+}
+
+TEST(histogram_test, tail_sums)
+{
+    const ::uint64_t hist[] = {0, 267962, 118703, 4284, 2796110, 0, 9};
+    const size_t n = util::length_of(hist);
+    ::uint64_t total, over_first, over_second;
+    util::histogram_tail_sums(hist, hist+n, 2, 4, total, over_first, over_second);
+    EXPECT_EQ(total, std::accumulate(hist, hist+n, ::uint64_t(0)));
+    EXPECT_EQ(over_first, std::accumulate(hist+2, hist+n, ::uint64_t(0)));
+    EXPECT_EQ(over_second, std::accumulate(hist+4, hist+n, ::uint64_t(0)));
+
+    util::histogram_tail_sums(hist, hist+n, 4, 2, total, over_first, over_second);
+    EXPECT_EQ(over_first, std::accumulate(hist+4, hist+n, ::uint64_t(0)));
+    EXPECT_EQ(over_second, std::accumulate(hist+2, hist+n, ::uint64_t(0)));
+
+    util::histogram_tail_sums(hist, hist+n, 19, 29, total, over_first, over_second);
+    EXPECT_EQ(over_first, 0u);
+    EXPECT_EQ(over_second, 0u);
+    EXPECT_EQ(util::histogram_tail_sum(hist, hist+n, n), 0u);
+}
+
+TEST(histogram_test, median_index)
+{
+    const ::uint64_t hist[] = {1, 1, 5, 1, 1};
+    const size_t n = util::length_of(hist);
+    EXPECT_EQ(util::histogram_median_index(hist, hist+n, util::histogram_sum(hist, hist+n)), 2u);
+    const ::uint64_t empty[] = {0, 0};
+    EXPECT_EQ(util::histogram_median_index(empty, empty+2, 0), 2u);
+}
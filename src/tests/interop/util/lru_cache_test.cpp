@@ -0,0 +1,59 @@
+/** Unit tests for the least recently used cache
+*
+*
+*  @file
+*  @date 10/19/2026
+*  @version 1.0
+*  @copyright GNU Public License.
+*/
+#include <string>
+#include <gtest/gtest.h>
+#include "interop/util/lru_cache.h"
+
+using namespace illumina::interop;
+
+typedef util::lru_cache<std::string, int> int_cache_t;
+
+TEST(lru_cache_test, disabled_by_default)
+{
+    int_cache_t cache;
+    cache.insert("a", 1);
+    int value = 0;
+    EXPECT_FALSE(cache.find("a", value));
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(lru_cache_test, evicts_least_recently_used)
+{
+    int_cache_t cache(2);
+    cache.insert("a", 1);
+    cache.insert("b", 2);
+    int value = 0;
+    EXPECT_TRUE(cache.find("a", value));
+    EXPECT_EQ(value, 1);
+    cache.insert("c", 3);
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_FALSE(cache.find("b", value));
+    EXPECT_TRUE(cache.find("a", value));
+    EXPECT_TRUE(cache.find("c", value));
+    EXPECT_EQ(value, 3);
+}
+
+TEST(lru_cache_test, replace_and_shrink)
+{
+    int_cache_t cache(3);
+    cache.insert("a", 1);
+    cache.insert("b", 2);
+    cache.insert("a", 4);
+    EXPECT_EQ(cache.size(), 2u);
+    cache.capacity(1);
+    int value = 0;
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_TRUE(cache.find("a", value));
+    EXPECT_EQ(value, 4);
+
+    int_cache_t copy(cache);
+    cache.clear();
+    EXPECT_TRUE(copy.find("a", value));
+    EXPECT_FALSE(cache.find("a", value));
+}
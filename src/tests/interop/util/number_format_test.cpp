@@ -0,0 +1,151 @@
+/** Unit tests for formatting and parsing numbers
+*
+*
+*  @file
+*  @date 10/19/2026
+*  @version 1.0
+*  @copyright GNU Public License.
+*/
+#include <clocale>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <gtest/gtest.h>
+#include "interop/util/number_format.h"
+#include "interop/util/lexical_cast.h"
+#include "interop/util/length_of.h"
+
+using namespace illumina::interop;
+
+namespace
+{
+    const double double_values[] = {0.0, -0.0, 1.0, -1.5, 0.1, 1.0/3.0, 123456789.125, 1e-7, 3.4e38, -2.5e-300,
+                                    98.7654321, 1e20, 5e-324, std::numeric_limits<double>::quiet_NaN(),
+                                    std::numeric_limits<double>::infinity(),
+                                    -std::numeric_limits<double>::infinity()};
+    const long int_values[] = {0, 1, -1, 9, 10, 12345, -98765, 2147483647, -2147483647-1};
+}
+
+TEST(number_format_test, double_matches_stream)
+{
+    const std::streamsize precisions[] = {0, 1, 6, 10, 17};
+    for (size_t p = 0; p < util::length_of(precisions); ++p)
+    {
+        for (size_t i = 0; i < util::length_of(double_values); ++i)
+        {
+            std::ostringstream expected;
+            expected.precision(precisions[p]);
+            util::number_formatter formatter(expected);
+            expected << double_values[i] << "," << static_cast<float>(double_values[i]);
+            formatter.append(double_values[i]);
+            formatter.append(',');
+            formatter.append(static_cast<float>(double_values[i]));
+            EXPECT_EQ(expected.str(), formatter.str());
+        }
+    }
+}
+
+TEST(number_format_test, integer_matches_stream)
+{
+    for (size_t i = 0; i < util::length_of(int_values); ++i)
+    {
+        std::ostringstream expected;
+        expected << int_values[i] << " " << static_cast<unsigned long>(int_values[i]) << " "
+                 << static_cast<int>(int_values[i]) << " " << static_cast<unsigned short>(int_values[i]);
+        util::number_formatter formatter;
+        formatter.append(int_values[i]);
+        formatter.append(' ');
+        formatter.append(static_cast<unsigned long>(int_values[i]));
+        formatter.append(' ');
+        formatter.append(static_cast<int>(int_values[i]));
+        formatter.append(' ');
+        formatter.append(static_cast<unsigned short>(int_values[i]));
+        EXPECT_EQ(expected.str(), formatter.str());
+    }
+}
+
+TEST(number_format_test, non_default_stream_matches_stream)
+{
+    std::ostringstream expected;
+    expected << std::fixed << std::setprecision(3) << std::setw(8);
+    util::number_formatter formatter(expected);
+    std::ostringstream actual;
+    actual.copyfmt(expected);
+    expected << 1.25 << "," << 2 << "," << 1.0/3.0;
+    formatter.append(1.25);
+    formatter.append(',');
+    formatter.append(2);
+    formatter.append(',');
+    formatter.append(1.0/3.0);
+    formatter.write(actual);
+    EXPECT_EQ(expected.str(), actual.str());
+    EXPECT_EQ(expected.width(), actual.width());
+}
+
+TEST(number_format_test, format_matches_stream)
+{
+    for (size_t i = 0; i < util::length_of(double_values); ++i)
+    {
+        const float value = static_cast<float>(double_values[i]);
+        if (value != value) continue;
+        std::ostringstream fixed;
+        fixed << std::fixed << std::setw(10) << std::setprecision(2) << std::setfill('0') << value;
+        EXPECT_EQ(fixed.str(), util::format(value, 10, 2, '0'));
+        std::ostringstream general;
+        general << std::setw(12) << std::setprecision(4) << value;
+        EXPECT_EQ(general.str(), util::format(value, 12, 4, ' ', false));
+    }
+    EXPECT_EQ("nan", util::format(std::numeric_limits<float>::quiet_NaN(), 10, 2));
+}
+
+TEST(number_format_test, parse_matches_stream)
+{
+    const char* values[] = {"0", "1.5", "-2.25e3", " 7", "1e", "1e+", "3.5x", "0x10", "abc", "", "1.2.3",
+                            "+.5", "1e-3", "12,5", "infinity", "4e400", "1e-50"};
+    for (size_t i = 0; i < util::length_of(values); ++i)
+    {
+        double expected_double = 0;
+        std::istringstream(values[i]) >> expected_double;
+        float expected_float = 0;
+        std::istringstream(values[i]) >> expected_float;
+        double actual_double = 0;
+        float actual_float = 0;
+        if (util::parse_number(values[i], actual_double))
+        {
+            EXPECT_EQ(expected_double, actual_double) << values[i];
+        }
+        if (util::parse_number(values[i], actual_float))
+        {
+            EXPECT_EQ(expected_float, actual_float) << values[i];
+        }
+        EXPECT_EQ(expected_float, util::lexical_cast<float>(std::string(values[i]))) << values[i];
+    }
+}
+
+TEST(number_format_test, ignores_c_numeric_locale)
+{
+    const char* locales[] = {"de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR.utf8", "fr_FR"};
+    const std::string previous = std::setlocale(LC_NUMERIC, 0);
+    bool found = false;
+    for (size_t i = 0; i < util::length_of(locales) && !found; ++i)
+        found = std::setlocale(LC_NUMERIC, locales[i]) != 0;
+    if (!found) return; // No locale with a comma decimal point is installed
+
+    util::number_formatter formatter;
+    formatter.append(1.5);
+    formatter.append(' ');
+    formatter.append_fixed(-2.25, 2);
+    const std::string text = formatter.str();
+    double value = 0;
+    const bool parsed = util::parse_number("12.5", value);
+    const float cast = util::lexical_cast<float>(std::string("12.5"));
+    std::setlocale(LC_NUMERIC, previous.c_str());
+
+    EXPECT_EQ("1.5 -2.25", text);
+    if (parsed)
+    {
+        EXPECT_EQ(12.5, value);
+    }
+    EXPECT_EQ(12.5f, cast);
+}
@@ -0,0 +1,92 @@
+/** Unit tests for the pool allocator
+*
+*
+*  @file
+*  @date 10/18/2026
+*  @version 1.0
+*  @copyright GNU Public License.
+*/
+#include <map>
+#include <gtest/gtest.h>
+#include "interop/util/pool_allocator.h"
+#include "interop/model/run_metrics.h"
+
+using namespace illumina::interop;
+
+typedef std::map< ::uint64_t, size_t, std::less< ::uint64_t >,
+        util::pool_allocator< std::pair<const ::uint64_t, size_t> > > pooled_map_t;
+
+TEST(pool_allocator_test, allocate_aligned)
+{
+    util::memory_pool pool;
+    for(size_t i=0;i<1000;++i)
+    {
+        void* ptr = pool.allocate(24, 8);
+        EXPECT_EQ(reinterpret_cast<size_t>(ptr) % 8, 0u);
+    }
+    EXPECT_GE(pool.reserved_bytes(), 24000u);
+    pool.release();
+    EXPECT_EQ(pool.reserved_bytes(), 0u);
+}
+
+TEST(pool_allocator_test, large_allocation)
+{
+    util::memory_pool pool;
+    void* ptr = pool.allocate(1<<21, 16);
+    EXPECT_TRUE(ptr != 0);
+    EXPECT_GE(pool.reserved_bytes(), static_cast<size_t>(1<<21));
+}
+
+TEST(pool_allocator_test, map_nodes_from_pool)
+{
+    pooled_map_t map;
+    for(size_t i=0;i<1000;++i) map[i] = i;
+    EXPECT_GT(map.get_allocator().reserved_bytes(), 0u);
+    for(size_t i=0;i<1000;++i) EXPECT_EQ(map[i], i);
+}
+
+TEST(pool_allocator_test, reuse_freed_blocks)
+{
+    util::memory_pool pool;
+    void* first = pool.allocate(24, 8);
+    pool.deallocate(first, 24, 8);
+    EXPECT_EQ(first, pool.allocate(24, 8));
+    void* small = pool.allocate(2, 2);
+    pool.deallocate(small, 2, 2);
+    EXPECT_NE(small, pool.allocate(4, 4));
+    EXPECT_EQ(small, pool.allocate(2, 2));
+}
+
+TEST(pool_allocator_test, erase_reuses_map_nodes)
+{
+    pooled_map_t map;
+    for(size_t i=0;i<1000;++i) map[i] = i;
+    const size_t reserved = map.get_allocator().reserved_bytes();
+    for(size_t round=1;round<=100;++round)
+    {
+        for(size_t i=0;i<1000;++i) map.erase(i + (round-1)*1000);
+        for(size_t i=0;i<1000;++i) map[i + round*1000] = i;
+    }
+    EXPECT_EQ(reserved, map.get_allocator().reserved_bytes());
+    EXPECT_EQ(1000u, map.size());
+}
+
+TEST(pool_allocator_test, copy_uses_new_pool)
+{
+    pooled_map_t map;
+    for(size_t i=0;i<10;++i) map[i] = i;
+    pooled_map_t copy(map);
+    EXPECT_TRUE(copy == map);
+    EXPECT_TRUE(copy.get_allocator() != map.get_allocator());
+}
+
+TEST(pool_allocator_test, metric_set_clear_releases_lookup)
+{
+    model::metric_base::metric_set<model::metrics::tile_metric> metrics;
+    for(model::metrics::tile_metric::uint_t tile=1;tile<=100;++tile)
+        metrics.insert(model::metrics::tile_metric(1, tile, 0, 0, 0, 0));
+    EXPECT_TRUE(metrics.has_metric(1, 50));
+    metrics.clear();
+    EXPECT_FALSE(metrics.has_metric(1, 50));
+    EXPECT_TRUE(metrics.offset_map().empty());
+}
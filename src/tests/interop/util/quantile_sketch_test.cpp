@@ -0,0 +1,102 @@
+/** Unit tests for the quantile sketch
+*
+*
+*  @file
+*  @date 10/19/2026
+*  @version 1.0
+*  @copyright GNU Public License.
+*/
+#include <algorithm>
+#include <vector>
+#include <gtest/gtest.h>
+#include "interop/util/quantile_sketch.h"
+
+using namespace illumina::interop;
+
+namespace
+{
+    /** Generate a reproducible sequence of values in a shuffled order
+     *
+     * @param count number of values
+     * @param values destination values
+     */
+    void shuffled_values(const size_t count, std::vector<float>& values)
+    {
+        values.resize(count);
+        ::uint32_t state = 12345;
+        for (size_t i = 0; i < count; ++i)
+        {
+            state = state * 1664525u + 1013904223u;
+            values[i] = static_cast<float>(state >> 8) / static_cast<float>(1 << 24) * 1000.0f;
+        }
+    }
+}
+
+TEST(quantile_sketch_test, exact_while_small)
+{
+    std::vector<float> values;
+    shuffled_values(150, values);
+    util::quantile_sketch sketch(200);
+    for (size_t i = 0; i < values.size(); ++i) sketch.update(values[i]);
+    sketch.update(std::numeric_limits<float>::quiet_NaN());
+    ASSERT_TRUE(sketch.is_exact());
+    EXPECT_EQ(values.size(), sketch.count());
+
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(values.front(), sketch.min_value());
+    EXPECT_EQ(values.back(), sketch.max_value());
+    for (size_t p = 5; p <= 100; p += 5)
+        EXPECT_EQ(util::percentile_sorted<float>(values.begin(), values.end(), p), sketch.percentile(p));
+}
+
+TEST(quantile_sketch_test, bounded_memory_and_rank_error)
+{
+    std::vector<float> values;
+    shuffled_values(100000, values);
+    util::quantile_sketch sketch(200);
+    for (size_t i = 0; i < values.size(); ++i) sketch.update(values[i]);
+    EXPECT_FALSE(sketch.is_exact());
+    EXPECT_EQ(values.size(), sketch.count());
+    EXPECT_LT(sketch.retained(), 3 * sketch.accuracy());
+
+    std::sort(values.begin(), values.end());
+    for (size_t p = 10; p < 100; p += 10)
+    {
+        const float estimate = sketch.percentile(p);
+        const double rank = static_cast<double>(std::lower_bound(values.begin(), values.end(), estimate) -
+                                                values.begin()) / values.size();
+        EXPECT_NEAR(p / 100.0, rank, 0.02) << "Percentile: " << p;
+    }
+}
+
+TEST(quantile_sketch_test, merge_matches_single_sketch)
+{
+    std::vector<float> values;
+    shuffled_values(50000, values);
+    util::quantile_sketch single(200);
+    util::quantile_sketch parts[4] = {util::quantile_sketch(200), util::quantile_sketch(200),
+                                      util::quantile_sketch(200), util::quantile_sketch(200)};
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        single.update(values[i]);
+        parts[i % 4].update(values[i]);
+    }
+    util::quantile_sketch merged(200);
+    for (size_t i = 0; i < 4; ++i) merged.merge(parts[i]);
+    EXPECT_EQ(single.count(), merged.count());
+    EXPECT_EQ(single.min_value(), merged.min_value());
+    EXPECT_EQ(single.max_value(), merged.max_value());
+    EXPECT_LT(merged.retained(), 3 * merged.accuracy());
+
+    util::quantile_sketch::weighted_vector_t weighted;
+    merged.weighted_values(weighted);
+    ::uint64_t total_weight = 0;
+    for (size_t i = 0; i < weighted.size(); ++i) total_weight += weighted[i].second;
+    EXPECT_EQ(merged.count(), total_weight);
+    for (size_t p = 25; p <= 75; p += 25)
+        EXPECT_NEAR(single.percentile(p), merged.percentile(p), 25.0f) << "Percentile: " << p;
+
+    merged.clear();
+    EXPECT_TRUE(merged.empty());
+    EXPECT_TRUE(std::isnan(merged.percentile(50)));
+}
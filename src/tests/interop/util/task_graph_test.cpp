@@ -0,0 +1,106 @@
+/** Unit tests for the task dependency graph
+*
+*
+*  @file
+*  @date 10/19/2026
+*  @version 1.0
+*  @copyright GNU Public License.
+*/
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include "interop/util/task_graph.h"
+
+using namespace illumina::interop;
+
+namespace
+{
+    /** Record the order in which tasks finish */
+    class record_task : public util::abstract_task
+    {
+    public:
+        record_task(const size_t id, std::vector<size_t>& order, util::mutex& lock_mutex, const bool fail=false) :
+                m_id(id), m_order(order), m_mutex(lock_mutex), m_fail(fail)
+        {
+        }
+        void operator()()
+        {
+            if(m_fail) throw std::runtime_error("Expected failure");
+            util::scoped_lock lock(m_mutex);
+            m_order.push_back(m_id);
+        }
+
+    private:
+        size_t m_id;
+        std::vector<size_t>& m_order;
+        util::mutex& m_mutex;
+        bool m_fail;
+    };
+
+    /** Find the position of a task in the finish order
+     *
+     * @param order order in which the tasks finished
+     * @param id id of the task
+     * @return position of the task, or the size of the order if the task did not run
+     */
+    size_t position_of(const std::vector<size_t>& order, const size_t id)
+    {
+        for(size_t i = 0; i < order.size(); ++i)
+            if(order[i] == id) return i;
+        return order.size();
+    }
+}
+
+TEST(task_graph_test, dependencies_finish_first)
+{
+    for(size_t thread_count = 1; thread_count <= 4; thread_count += 3)
+    {
+        std::vector<size_t> order;
+        util::mutex lock_mutex;
+        std::vector<record_task> tasks;
+        for(size_t i = 0; i < 6; ++i) tasks.push_back(record_task(i, order, lock_mutex));
+        // Diamond: 0 -> {1, 2, 3} -> 4 -> 5
+        util::task_graph graph;
+        for(size_t i = 0; i < tasks.size(); ++i) graph.add("task", tasks[i]);
+        for(size_t i = 1; i <= 3; ++i)
+        {
+            graph.depends_on(i, 0);
+            graph.depends_on(4, i);
+        }
+        graph.depends_on(5, 4);
+        graph.run(thread_count);
+
+        ASSERT_EQ(tasks.size(), order.size());
+        for(size_t i = 1; i <= 3; ++i)
+        {
+            EXPECT_LT(position_of(order, 0), position_of(order, i));
+            EXPECT_LT(position_of(order, i), position_of(order, 4));
+        }
+        EXPECT_EQ(5u, order.back());
+        ASSERT_EQ(tasks.size(), graph.timings().size());
+        for(size_t i = 0; i < graph.timings().size(); ++i)
+        {
+            EXPECT_TRUE(graph.timings()[i].ran);
+            EXPECT_GE(graph.timings()[i].duration, 0.0);
+        }
+    }
+}
+
+TEST(task_graph_test, exception_skips_dependent_tasks)
+{
+    for(size_t thread_count = 1; thread_count <= 4; thread_count += 3)
+    {
+        std::vector<size_t> order;
+        util::mutex lock_mutex;
+        record_task first(0, order, lock_mutex, true);
+        record_task second(1, order, lock_mutex);
+        util::task_graph graph;
+        const size_t first_index = graph.add("first", first);
+        graph.depends_on(graph.add("second", second), first_index);
+        EXPECT_THROW(graph.run(thread_count), std::runtime_error);
+        EXPECT_TRUE(order.empty());
+        EXPECT_EQ("first", graph.timings()[0].name);
+        EXPECT_FALSE(graph.timings()[0].ran);
+        EXPECT_FALSE(graph.timings()[1].ran);
+    }
+}
@@ -0,0 +1,184 @@
+/** Unit tests for the work stealing thread pool
+*
+*
+*  @file
+*  @date 10/19/2026
+*  @version 1.0
+*  @copyright GNU Public License.
+*/
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include "interop/util/thread_pool.h"
+
+using namespace illumina::interop;
+
+namespace
+{
+    /** Count the number of times each index is visited */
+    struct count_visits
+    {
+        count_visits(std::vector<int>& visits) : m_visits(visits){}
+        void operator()(const size_t index)
+        {
+            ++m_visits[index];
+        }
+        std::vector<int>& m_visits;
+    };
+
+    /** Throw at a single index */
+    struct throw_at
+    {
+        throw_at(const size_t index) : m_index(index){}
+        void operator()(const size_t index)
+        {
+            if(index == m_index) throw std::runtime_error("Expected failure");
+        }
+        size_t m_index;
+    };
+
+    /** Run a nested parallel loop at each index */
+    struct nested_sum
+    {
+        nested_sum(std::vector<int>& sums) : m_sums(sums){}
+        void operator()(const size_t index)
+        {
+            std::vector<int> visits(16, 0);
+            count_visits body(visits);
+            util::parallel_for_each_index(visits.size(), body, 4);
+            int sum = 0;
+            for(size_t i = 0; i < visits.size(); ++i) sum += visits[i];
+            m_sums[index] = sum;
+        }
+        std::vector<int>& m_sums;
+    };
+
+    /** Increment a shared counter under a lock */
+    struct locked_increment
+    {
+        locked_increment(util::mutex& lock_mutex, int& counter) : m_mutex(lock_mutex), m_counter(counter){}
+        void operator()(const size_t)
+        {
+            util::scoped_lock lock(m_mutex);
+            ++m_counter;
+        }
+        util::mutex& m_mutex;
+        int& m_counter;
+    };
+
+    /** Wait for the previous index to finish before finishing this one */
+    struct ordered_finish
+    {
+        ordered_finish(std::vector<size_t>& order) : m_order(order), m_finished(0){}
+        void operator()(const size_t index)
+        {
+            util::scoped_lock lock(m_mutex);
+            while(m_finished != index) m_changed.wait(m_mutex);
+            m_order.push_back(index);
+            ++m_finished;
+            m_changed.notify_all();
+        }
+        std::vector<size_t>& m_order;
+        size_t m_finished;
+        util::mutex m_mutex;
+        util::condition_variable m_changed;
+    };
+
+    /** Task that sets a flag, or throws */
+    class flag_task : public util::abstract_task
+    {
+    public:
+        flag_task(const bool fail=false) : m_ran(false), m_fail(fail){}
+        void operator()()
+        {
+            m_ran = true;
+            if(m_fail) throw std::runtime_error("Expected failure");
+        }
+        bool m_ran;
+        bool m_fail;
+    };
+}
+
+TEST(thread_pool_test, parallel_for_visits_each_index_once)
+{
+    std::vector<int> visits(1000, 0);
+    count_visits body(visits);
+    util::parallel_for_each_index(visits.size(), body, 4);
+    for(size_t i = 0; i < visits.size(); ++i) EXPECT_EQ(1, visits[i]) << "Index: " << i;
+}
+
+TEST(thread_pool_test, parallel_for_rethrows_exception)
+{
+    throw_at body(10);
+    EXPECT_THROW(util::parallel_for_each_index(100, body, 4), std::runtime_error);
+}
+
+TEST(thread_pool_test, nested_parallel_for)
+{
+    std::vector<int> sums(32, 0);
+    nested_sum body(sums);
+    util::parallel_for_each_index(sums.size(), body, 4);
+    for(size_t i = 0; i < sums.size(); ++i) EXPECT_EQ(16, sums[i]) << "Index: " << i;
+}
+
+TEST(thread_pool_test, mutex_guards_shared_counter)
+{
+    util::mutex lock_mutex;
+    int counter = 0;
+    locked_increment body(lock_mutex, counter);
+    util::parallel_for_each_index(500, body, 4);
+    EXPECT_EQ(500, counter);
+}
+
+TEST(thread_pool_test, task_group_waits_for_tasks)
+{
+    std::vector<flag_task> tasks(8);
+    util::task_group group;
+    for(size_t i = 0; i < tasks.size(); ++i) group.run(tasks[i]);
+    group.wait();
+    for(size_t i = 0; i < tasks.size(); ++i) EXPECT_TRUE(tasks[i].m_ran) << "Task: " << i;
+    EXPECT_FALSE(group.is_cancelled());
+}
+
+TEST(thread_pool_test, task_group_rethrows_exception)
+{
+    flag_task task(true);
+    util::task_group group;
+    group.run(task);
+    EXPECT_THROW(group.wait(), std::runtime_error);
+    EXPECT_TRUE(group.is_cancelled());
+}
+
+TEST(thread_pool_test, cancelled_task_group_skips_tasks)
+{
+    flag_task task;
+    util::task_group group;
+    group.cancel();
+    group.run(task);
+    group.wait();
+    EXPECT_FALSE(task.m_ran);
+}
+
+TEST(thread_pool_test, short_lived_task_groups)
+{
+    // The group is destroyed as soon as wait returns, while the worker may still be finishing the task
+    for(size_t i = 0; i < 2000; ++i)
+    {
+        flag_task task;
+        {
+            util::task_group group(2);
+            group.run(task);
+        }
+        ASSERT_TRUE(task.m_ran) << "Iteration: " << i;
+    }
+}
+
+TEST(thread_pool_test, condition_variable_orders_tasks)
+{
+    std::vector<size_t> order;
+    ordered_finish body(order);
+    // Iterations are handed out in order, so an iteration only waits on one that already started
+    util::parallel_for_each_index(16, body, 4);
+    ASSERT_EQ(16u, order.size());
+    for(size_t i = 0; i < order.size(); ++i) EXPECT_EQ(i, order[i]);
+}